@@ -52,6 +52,20 @@ namespace nodecpp
 		Port uport;
 	};
 
+	struct AcceptedConnData
+	{
+		uintptr_t socket;
+		Ip4 ip;
+		Port uport;
+	};
+
+	struct ConnAcceptedBatchEvMsg // followed by 'count' AcceptedConnData items
+	{
+		size_t requestID;
+		size_t serverIdx;
+		size_t count;
+	};
+
 	struct ServerErrorEvMsg
 	{
 		size_t requestID;
@@ -73,6 +87,7 @@ namespace nodecpp
 		uint16_t port;
 		int backlog;
 		IPFAMILY family;
+		net::ConnectionDistribution distribution;
 	};
 
 	struct ServerCloseRequest
@@ -95,8 +110,168 @@ namespace nodecpp
 		Ip4 ip;
 		Port port;
 		int backlog;
+		net::ConnectionDistribution distribution;
+	};
+
+	// application-level messaging between threads of the cluster (see Cluster::postMessage() and around)
+
+	struct UserMsgHeader // followed by 'inlineSize' bytes of payload
+	{
+		enum Kind : uint8_t { Post, Request, Reply, ErrorReply, BufferReturn }; // ErrorReply: a Request is not handled (no handler is set)
+		Kind kind;
+		uint32_t tag;
+		uint64_t requestID; // for Request and Reply
+		size_t inlineSize;
+		uintptr_t bufferData; // if not 0, a buffer passed by ownership transfer (see Buffer::release())
+		size_t bufferSize;
+		size_t bufferCapacity;
+	};
+
+	void returnForeignBufferToOwner( ThreadID owner, uint8_t* data, size_t size, size_t capacity );
+
+	// memory of a Buffer received from another thread; as with some allocators (e.g. iibmalloc) memory may only be freed at the thread
+	// it is allocated at, on destruction the memory is sent back to its owner
+	class ForeignBuffer
+	{
+		uint8_t* data_ = nullptr;
+		size_t size_ = 0;
+		size_t capacity_ = 0;
+		ThreadID owner;
+
+		void reset() {
+			if ( data_ != nullptr )
+				returnForeignBufferToOwner( owner, data_, size_, capacity_ );
+			data_ = nullptr;
+			size_ = 0;
+			capacity_ = 0;
+		}
+
+	public:
+		ForeignBuffer() {}
+		ForeignBuffer( ThreadID owner_, uint8_t* data, size_t size, size_t capacity ) : data_( data ), size_( size ), capacity_( capacity ), owner( owner_ ) {}
+		ForeignBuffer( const ForeignBuffer& ) = delete;
+		ForeignBuffer& operator = ( const ForeignBuffer& ) = delete;
+		ForeignBuffer( ForeignBuffer&& other ) { *this = std::move( other ); }
+		ForeignBuffer& operator = ( ForeignBuffer&& other ) {
+			reset();
+			std::swap( data_, other.data_ );
+			std::swap( size_, other.size_ );
+			std::swap( capacity_, other.capacity_ );
+			owner = other.owner;
+			return *this;
+		}
+		~ForeignBuffer() { reset(); }
+
+		size_t size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		uint8_t* begin() { return data_; }
+		const uint8_t* begin() const { return data_; }
+		uint8_t* end() { return data_ + size_; }
+		const uint8_t* end() const { return data_ + size_; }
+		Buffer clone() const { Buffer b( size_ ); b.append( data_, size_ ); return b; } // to a local Buffer
+	};
+
+	struct WorkerMessage
+	{
+		ThreadID source;
+		uint32_t tag = 0;
+		uint64_t requestID = 0; // not 0 if a reply is expected (see Cluster::reply())
+		const uint8_t* data = nullptr; // inline payload; for a received message, valid within the handler only
+		size_t size = 0;
+		ForeignBuffer buffer; // payload passed by ownership transfer, if any
+		Buffer ownedData; // keeps the inline payload of a reply to Cluster::a_request()
+
+		template<class T>
+		T as() const { // for messages sent as postMessage( target, tag, const T& )
+			static_assert( std::is_trivially_copyable<T>::value );
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof(T) <= size, "{} vs. {}", sizeof(T), size ); 
+			T ret;
+			memcpy( &ret, data, sizeof(T) ); // inline payload is not necessarily aligned
+			return ret;
+		}
 	};
 
+	// Runs a callable at the loop of a master or worker thread (e.g. getCluster().thisThreadID() taken there), within its immediate phase.
+	// Thread-safe; to be used by any thread including ones not run by node.cpp (e.g. of a database driver). Posts made while the target
+	// is busy are batched into a single wake-up. Returns false (and the callable is destroyed without being called) if the target
+	// is not running. A callable posted but not yet run when the target terminates is destroyed there without being called.
+	template<class F>
+	bool postToLoop( ThreadID target, F&& f )
+	{
+		using FnT = typename std::decay<F>::type;
+		struct Task : public PostedTask
+		{
+			FnT callable;
+			Task( F&& f_ ) : callable( std::forward<F>( f_ ) ) {}
+		};
+		nodecpp::safememory::stdallocator<Task> alloc; // may be freed at another thread
+		Task* task = alloc.allocate( 1 );
+		new(task) Task( std::forward<F>( f ) );
+		task->fn = []( PostedTask* self, bool invoke ) {
+			Task* t = static_cast<Task*>( self );
+			struct Destroyer { Task* t; ~Destroyer() { t->~Task(); nodecpp::safememory::stdallocator<Task> alloc; alloc.deallocate( t, 1 ); } } d{ t };
+			if ( invoke )
+				t->callable();
+		};
+		if ( postTaskToThread( task, target ) )
+			return true;
+		task->fn( task, false );
+		return false;
+	}
+
+#ifndef NODECPP_NO_COROUTINES
+	// resumes a coroutine suspended by a_awaitForeign() at its own loop; may be called from any thread, once. Move-only, so that
+	// exactly one owner may resume. resume() returns true once the resumption is posted (see postToLoop()); if the home thread
+	// terminates before running it, the coroutine is not resumed.
+	class LoopResumer
+	{
+		ThreadID home;
+		awaitable_handle_t h = nullptr;
+	public:
+		LoopResumer( ThreadID home_, awaitable_handle_t h_ ) : home( home_ ), h( h_ ) {}
+		LoopResumer( const LoopResumer& ) = delete;
+		LoopResumer& operator = ( const LoopResumer& ) = delete;
+		LoopResumer( LoopResumer&& other ) : home( other.home ), h( other.h ) { other.h = nullptr; }
+		LoopResumer& operator = ( LoopResumer&& other ) { home = other.home; h = other.h; other.h = nullptr; return *this; }
+		bool resume() { awaitable_handle_t handle = h; h = nullptr; return handle != nullptr && postToLoop( home, [handle]() { handle(); } ); }
+	};
+
+	// 'start' is called right away at this thread and is expected to pass the resumer to foreign work that calls LoopResumer::resume()
+	// on completion; results are to be passed via the state captured by 'start'. The loop itself takes no locks for that.
+	template<class StartFn>
+	auto a_awaitForeign( StartFn start )
+	{
+		struct foreign_awaiter {
+			std::experimental::coroutine_handle<> myawaiting = nullptr;
+			StartFn start;
+
+			foreign_awaiter(StartFn&& start_) : start( std::move( start_ ) ) {}
+
+			foreign_awaiter(const foreign_awaiter &) = delete;
+			foreign_awaiter &operator = (const foreign_awaiter &) = delete;
+
+			~foreign_awaiter() {}
+
+			bool await_ready() {
+				return false;
+			}
+
+			void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+				nodecpp::setNoException(awaiting);
+				myawaiting = awaiting;
+				start( LoopResumer( getThisThreadID(), awaiting ) );
+			}
+
+			auto await_resume() {
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, myawaiting != nullptr ); 
+				if ( nodecpp::isException(myawaiting) )
+					throw nodecpp::getException(myawaiting);
+			}
+		};
+		return foreign_awaiter( std::move( start ) );
+	}
+#endif // NODECPP_NO_COROUTINES
+
 	class Cluster; // forward declaration
 	class Worker
 	{
@@ -228,7 +403,7 @@ namespace nodecpp
 					addr.ip = msg->ip;
 					addr.port = msg->port;
 					addr.family = msg->family;
-					bool already = processRequestForListeningAtMaster( requestingThreadId, msg->entryIndex, msg->requestID, addr, msg->backlog );
+					bool already = processRequestForListeningAtMaster( requestingThreadId, msg->entryIndex, msg->requestID, addr, msg->backlog, msg->distribution );
 					if ( already )
 						MasterProcessor::sendListeningEv( requestingThreadId, msg->requestID );
 					break;
@@ -241,6 +416,9 @@ namespace nodecpp
 					processRequestForServerCloseAtMaster( requestingThreadId, *msg );
 					break;
 				}
+				case InterThreadMsgType::UserDefined:
+					onUserMessage( requestingThreadId, riter );
+					break;
 				default:
 					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false, "unexpected type {}", (size_t)(msgtype) ); 
 					break;
@@ -257,7 +435,7 @@ namespace nodecpp
 			CO_RETURN;
 		}
 
-		static void serializeAndSendListeningRequest( ThreadID targetThreadId, size_t requestID, size_t entryIndex, Ip4 ip, uint16_t port, int backlog, IPFAMILY family ) {
+		static void serializeAndSendListeningRequest( ThreadID targetThreadId, size_t requestID, size_t entryIndex, Ip4 ip, uint16_t port, int backlog, IPFAMILY family, net::ConnectionDistribution distribution ) {
 //			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "Slave id = {}: serializing listening request for Addr = {}:{}, backlog = {}, entryIndex = {:x}", threadID, ip.toStr(), port, backlog, entryIndex );
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "Slave id = [...]: serializing listening request for Addr = {}:{}, backlog = {}, entryIndex = {:x}", ip.toStr(), port, backlog, entryIndex );
 
@@ -268,6 +446,7 @@ namespace nodecpp
 			msg.port = port;
 			msg.backlog = backlog;
 			msg.family = family;
+			msg.distribution = distribution;
 
 			nodecpp::platform::internal_msg::InternalMsg imsg;
 			imsg.append( &msg, sizeof(msg) );
@@ -298,9 +477,9 @@ namespace nodecpp
 			size_t assignedThreadID;
 			size_t requestIdBase = 0;
 
-			void sendListeningRequest( size_t entryIndex, Ip4 ip, uint16_t port, IPFAMILY family, int backlog)
+			void sendListeningRequest( size_t entryIndex, Ip4 ip, uint16_t port, IPFAMILY family, int backlog, net::ConnectionDistribution distribution )
 			{
-				Cluster::serializeAndSendListeningRequest( ThreadID({0,0}), ++requestIdBase, entryIndex, ip, port, backlog, family );
+				Cluster::serializeAndSendListeningRequest( ThreadID({0,0}), ++requestIdBase, entryIndex, ip, port, backlog, family, distribution );
 			}
 
 			void sendServerCloseRequest( size_t entryIndex )
@@ -366,6 +545,7 @@ namespace nodecpp
 				DataForCommandProcessing& operator=(DataForCommandProcessing&& other) = default;
 
 				net::Address localAddress;
+				net::ConnectionDistribution distribution = net::ConnectionDistribution::byLoad;
 			};
 			DataForCommandProcessing dataForCommandProcessing;
 			size_t nextStep = 0;
@@ -447,7 +627,7 @@ namespace nodecpp
 			return ret;
 		}
 
-		bool processRequestForListeningAtMaster(ThreadID targetThreadId, size_t entryIndex, size_t requestID, nodecpp::net::Address address, int backlog)
+		bool processRequestForListeningAtMaster(ThreadID targetThreadId, size_t entryIndex, size_t requestID, nodecpp::net::Address address, int backlog, net::ConnectionDistribution distribution)
 		{
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, isMaster() );
 			bool alreadyListening = false;
@@ -469,6 +649,7 @@ namespace nodecpp
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "processRequestForListeningAtMaster() for thread id: {} Addr {}:{}, requestID {}, and entryIndex = {:x} requires actually creating a new Agent server (curr num of Agent servers: {})", targetThreadId.slotId, address.ip.toStr(), address.port, requestID, entryIndex, agentServers.size() );
 			nodecpp::safememory::soft_ptr<AgentServer> server = createAgentServer();
 			server->requestID = requestID;
+			server->dataForCommandProcessing.distribution = distribution;
 			server->socketsToSlaves.push_back( slaveData );
 #ifdef NODECPP_USE_SHARED_SOCKS_FOR_LISTENERS
 			server->dataForCommandProcessing.localAddress.ip = address.ip;
@@ -491,6 +672,7 @@ namespace nodecpp
 			rq.ip = address.ip;
 			rq.port = Port::fromHost( address.port );
 			rq.backlog = backlog;
+			rq.distribution = distribution;
 			rq.socket = server->dataForCommandProcessing.osSocket;
 
 			auto listeners = getListeners();
@@ -534,11 +716,11 @@ nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_
 				MasterProcessor::sendServerCloseNotification( slave.targetThreadId, slave.entryIndex, agent->requestID, false ); // TODO-ITC: upgrade
 		}
 
-		void acceptRequestForListeningAtSlave(size_t entryIndex, Ip4 ip, uint16_t port, IPFAMILY family, int backlog)
+		void acceptRequestForListeningAtSlave(size_t entryIndex, Ip4 ip, uint16_t port, IPFAMILY family, int backlog, net::ConnectionDistribution distribution)
 		{
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, isWorker() );
 			Buffer b;
-			slaveProcessor.sendListeningRequest( entryIndex, ip, port, family, backlog );
+			slaveProcessor.sendListeningRequest( entryIndex, ip, port, family, backlog, distribution );
 		}
 
 		void acceptRequestForServerCloseAtSlave(size_t entryIndex)
@@ -587,6 +769,104 @@ nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_
 		Worker& fork();
 		void disconnect() { for ( auto& w : workers_ ) w.disconnect(); }
 
+		// how listener threads distribute accepted connections between workers (process-wide)
+		void setSchedulingPolicy( WorkerSelectionPolicy policy, WorkerCostFn costFn = nullptr ) { setWorkerSelectionPolicy( policy, costFn ); }
+
+		// application-level messaging; a target is either a worker (see workerThreadIDs()) or the master (ThreadID({0,0}));
+		// payloads above maxInlinePayload, as well as Buffers, are passed by ownership transfer rather than copied into a message
+		static constexpr size_t maxInlinePayload = 2048;
+		using MessageHandler = std::function<void(WorkerMessage&)>;
+		void onMessage( MessageHandler handler ) { userMsgHandler = std::move( handler ); }
+		ThreadID thisThreadID() const { return getThisThreadID(); }
+		size_t workerThreadIDs( ThreadID* ids, size_t maxCount ) const { return getWorkerThreadIDs( ids, maxCount ); }
+
+		bool postMessage( ThreadID target, uint32_t tag, const void* data, size_t sz ) { return sendUserMsg( target, UserMsgHeader::Post, tag, 0, data, sz, nullptr ); }
+		bool postMessage( ThreadID target, uint32_t tag, Buffer&& buffer ) { return sendUserMsg( target, UserMsgHeader::Post, tag, 0, nullptr, 0, &buffer ); }
+		template<class T>
+		bool postMessage( ThreadID target, uint32_t tag, const T& value ) {
+			static_assert( std::is_trivially_copyable<T>::value );
+			return postMessage( target, tag, &value, sizeof(T) );
+		}
+		size_t broadcastMessage( uint32_t tag, const void* data, size_t sz ); // to all workers but this thread; returns the number of recipients
+
+		bool reply( const WorkerMessage& request, const void* data, size_t sz ) { return sendReply( request, data, sz, nullptr ); }
+		bool reply( const WorkerMessage& request, Buffer&& buffer ) { return sendReply( request, nullptr, 0, &buffer ); }
+
+#ifndef NODECPP_NO_COROUTINES
+	private:
+		struct request_awaiter {
+			std::experimental::coroutine_handle<> myawaiting = nullptr;
+			Cluster& cluster;
+			uint64_t requestID;
+			bool sent;
+			WorkerMessage& response;
+			uint32_t period;
+			nodecpp::Timeout to;
+
+			request_awaiter(Cluster& cluster_, uint64_t requestID_, bool sent_, WorkerMessage& response_, uint32_t period_) : cluster( cluster_ ), requestID( requestID_ ), sent( sent_ ), response( response_ ), period( period_ ) {}
+
+			request_awaiter(const request_awaiter &) = delete;
+			request_awaiter &operator = (const request_awaiter &) = delete;
+
+			~request_awaiter() {}
+
+			bool await_ready() {
+				return !sent;
+			}
+
+			void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+				nodecpp::setNoException(awaiting);
+				cluster.pendingUserRequests.insert( std::make_pair( requestID, PendingUserRequest({awaiting, &response}) ) );
+				if ( period )
+					to = nodecpp::setTimeoutForAction( awaiting, period );
+				myawaiting = awaiting;
+			}
+
+			auto await_resume() {
+				if ( !sent )
+					throw Error();
+				if ( period )
+					nodecpp::clearTimeout( to );
+				cluster.pendingUserRequests.erase( requestID ); // still there if timed out; a late reply is then dropped
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, myawaiting != nullptr ); 
+				if ( nodecpp::isException(myawaiting) )
+					throw nodecpp::getException(myawaiting);
+			}
+		};
+
+	public:
+		// resumes when the target calls reply() for this request; throws if the request cannot be sent, if the target has no
+		// message handler set, or if no reply comes within timeoutMs (0 means no timeout)
+		static constexpr uint32_t defaultRequestTimeoutMs = 30000;
+		auto a_request( ThreadID target, uint32_t tag, const void* data, size_t sz, WorkerMessage& response, uint32_t timeoutMs = defaultRequestTimeoutMs ) {
+			uint64_t requestID = ++userRequestIdBase;
+			return request_awaiter( *this, requestID, sendUserMsg( target, UserMsgHeader::Request, tag, requestID, data, sz, nullptr ), response, timeoutMs );
+		}
+		auto a_request( ThreadID target, uint32_t tag, Buffer&& buffer, WorkerMessage& response, uint32_t timeoutMs = defaultRequestTimeoutMs ) {
+			uint64_t requestID = ++userRequestIdBase;
+			return request_awaiter( *this, requestID, sendUserMsg( target, UserMsgHeader::Request, tag, requestID, nullptr, 0, &buffer ), response, timeoutMs );
+		}
+#endif // NODECPP_NO_COROUTINES
+
+	private:
+		MessageHandler userMsgHandler;
+		struct PendingUserRequest
+		{
+			awaitable_handle_t h;
+			WorkerMessage* response;
+		};
+		nodecpp::map<uint64_t, PendingUserRequest> pendingUserRequests;
+		uint64_t userRequestIdBase = 0;
+
+		bool sendUserMsg( ThreadID target, UserMsgHeader::Kind kind, uint32_t tag, uint64_t requestID, const void* data, size_t sz, Buffer* buffer );
+		bool sendReply( const WorkerMessage& request, const void* data, size_t sz, Buffer* buffer ) {
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, request.requestID != 0 ); 
+			return sendUserMsg( request.source, UserMsgHeader::Reply, request.tag, request.requestID, data, sz, buffer );
+		}
+
+	public:
+		void onUserMessage( ThreadID source, nodecpp::platform::internal_msg::InternalMsg::ReadIter& riter ); // internal
+
 		// event handling (awaitable)
 	};
 	extern thread_local Cluster cluster;
@@ -30,6 +30,7 @@
 
 #include <functional>
 #include <vector>
+#include <algorithm>
 
 #include "error.h"
 #include "net_common.h"
@@ -140,143 +141,275 @@ namespace nodecpp
 	};
 #endif
 
+	namespace internal_usage_only {
+
+	/*
+		Listener storage shared by event emitters. Emitting does not allocate and does not copy listeners:
+		- listeners are called by index from the stable storage; listeners added while an event is being
+		  dispatched (including from nested emits) are put aside and merged once the outermost dispatch is over;
+		- 'once' listeners are marked as fired (and are skipped by nested emits), and are removed from
+		  the storage once the outermost dispatch is over;
+		- a listener may destroy the emitter (e.g. on 'close' or 'error'): the listeners are then handed over to the
+		  outermost dispatch (and are destroyed once it is over), and the dispatch stops without touching the emitter.
+	*/
+	template<class ElementT>
+	class EmitterListenerStorage
+	{
+	protected:
+		nodecpp::vector<ElementT> callbacks;
+		size_t firedCnt = 0; // 'once' listeners being still in 'callbacks'
+		struct EmitGuard;
+		EmitGuard* innermostGuard = nullptr;
+	private:
+		nodecpp::vector<std::pair<bool, ElementT>> pending; // added while being emitted; 'first' is true for prepended
+		size_t emitting = 0; // depth of (nested) emit() calls
+
+	protected:
+		void add(ElementT&& el) {
+			if ( emitting )
+				pending.emplace_back(false, std::move(el));
+			else
+				callbacks.push_back(std::move(el));
+		}
+		void prepend(ElementT&& el) {
+			if ( emitting )
+				pending.emplace_back(true, std::move(el));
+			else
+				callbacks.insert(callbacks.begin(), std::move(el));
+		}
+
+		struct EmitGuard
+		{
+			EmitterListenerStorage* storage;
+			EmitGuard* outer;
+			bool destroyed = false; // by a listener; the storage must not be touched anymore
+			nodecpp::vector<ElementT> orphaned; // for the outermost guard: listeners of a destroyed emitter, kept alive till it is over
+			EmitGuard(EmitterListenerStorage& storage_) : storage(&storage_), outer(storage_.innermostGuard) { ++(storage->emitting); storage->innermostGuard = this; }
+			~EmitGuard() {
+				if ( destroyed )
+					return;
+				storage->innermostGuard = outer;
+				if ( --(storage->emitting) == 0 )
+					storage->onEmitted();
+			}
+		};
+
+		// returns false, if the element should be skipped
+		bool prepareToCall(ElementT& el) {
+			if ( el.fired )
+				return false;
+			if ( el.once )
+			{
+				el.fired = true;
+				++firedCnt;
+			}
+			return true;
+		}
+
+	private:
+		void onEmitted() {
+			if ( firedCnt )
+			{
+				callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [](const ElementT& el) { return el.fired; }), callbacks.end());
+				firedCnt = 0;
+			}
+			if ( !pending.empty() )
+			{
+				for (auto& current : pending) {
+					if ( current.first )
+						callbacks.insert(callbacks.begin(), std::move(current.second));
+					else
+						callbacks.push_back(std::move(current.second));
+				}
+				pending.clear();
+			}
+		}
+
+	public:
+		EmitterListenerStorage() {}
+		EmitterListenerStorage(const EmitterListenerStorage& other) : callbacks(other.callbacks), firedCnt(other.firedCnt), pending(other.pending) {}
+		EmitterListenerStorage& operator = (const EmitterListenerStorage& other) { // dispatch state is not copied
+			callbacks = other.callbacks;
+			firedCnt = other.firedCnt;
+			pending = other.pending;
+			return *this;
+		}
+		~EmitterListenerStorage() {
+			if ( innermostGuard == nullptr )
+				return;
+			EmitGuard* guard = innermostGuard;
+			for (;;) {
+				guard->destroyed = true;
+				if ( guard->outer == nullptr )
+					break;
+				guard = guard->outer;
+			}
+			guard->orphaned = std::move(callbacks); // moves the buffer: elements being called stay in place
+		}
+
+		size_t listenerCount() const {
+			return callbacks.size() - firedCnt + pending.size();
+		}
+	};
+
+	} // namespace internal_usage_only
+
 	/*
 		Two important things:
 		1. handlers are called in the same order of registration, both regular and 'once'
 		2. handlers are called syncronously, and they shouln't be able to afect current 
-		event dispatch. So handler list must be copied before start calling them.
-		If any handler modify the handler list, the modification will be efective on the next
-		event dispatch
+		event dispatch. That is, handlers added while an event is being dispatched are not called
+		for that event; the modification will be efective on the next event dispatch
+		(see internal_usage_only::EmitterListenerStorage)
 	*/
 	template<class EV>
-	class EventEmitter
+	struct EventEmitterElement
 	{
-		nodecpp::vector<std::pair<bool, typename EV::callback>> callbacks;
+		bool once;
+		bool fired = false;
+		typename EV::callback cb;
+		EventEmitterElement(bool once_, typename EV::callback cb_) : once(once_), cb(std::move(cb_)) {}
+	};
+
+	template<class EV>
+	class EventEmitter : public internal_usage_only::EmitterListenerStorage<EventEmitterElement<EV>>
+	{
+		using Element = EventEmitterElement<EV>;
+		using Storage = internal_usage_only::EmitterListenerStorage<Element>;
 	public:
 		void on(typename EV::callback cb) {
-			callbacks.emplace_back(false,cb);
+			this->add(Element(false, std::move(cb)));
 		}
 		void once(typename EV::callback cb) {
-			callbacks.emplace_back(true, cb);
+			this->add(Element(true, std::move(cb)));
 		}
 
 		void prependListener(typename EV::callback cb) {
-			callbacks.insert(callbacks.begin(), std::make_pair(false, cb));
+			this->prepend(Element(false, std::move(cb)));
 		}
 
 		void prependOnceListener(typename EV::callback cb) {
-			callbacks.insert(std::make_pair(true, cb));
+			this->prepend(Element(true, std::move(cb)));
 		}
 
-		size_t listenerCount() const {
-			return callbacks.size();
-		}
 		const char* eventName() const {
 			return EV::name;
 		}
 
 		template<class... ARGS>
 		void emit(ARGS&... args) {
-
-			nodecpp::vector<std::pair<bool, typename EV::callback>> other;
-			
-			//first make a copy of handlers
-			for (auto& current : callbacks) {
-				if (!current.first)
-					other.push_back(current);
+			size_t cnt = this->callbacks.size(); // listeners added by handlers (if any) are not in 'callbacks' till we are done
+			if ( cnt == 0 )
+				return;
+			typename Storage::EmitGuard guard(*this);
+			if ( cnt == 1 && !this->callbacks[0].once && this->firedCnt == 0 ) // fast path for the most common case
+			{
+				this->callbacks[0].cb(args...);
+				return;
 			}
-	
-			std::swap(callbacks, other);
-
-			for (auto& current : other) {
-				current.second(args...);
+			for (size_t i=0; i<cnt; ++i) {
+				Element& current = this->callbacks[i];
+				if ( this->prepareToCall(current) )
+				{
+					current.cb(args...);
+					if ( guard.destroyed )
+						return;
+				}
 			}
 		}
 	};
 
+	template<class EV, class ListenerT>
+	struct EventEmitterSupportingListenersElement
+	{
+		bool once;
+		bool fired = false;
+		bool isLambda; // note: now we have only two options here: lambda and listeners
+		typename EV::callback cb;
+		nodecpp::safememory::soft_ptr<ListenerT> listener;
+		EventEmitterSupportingListenersElement(bool once_, typename EV::callback cb_) : once(once_), isLambda(true), cb(std::move(cb_)) {}
+		EventEmitterSupportingListenersElement(bool once_, nodecpp::safememory::soft_ptr<ListenerT> listener_) : once(once_), isLambda(false), listener(std::move(listener_)) {}
+	};
+
 	template<class EV, class ListenerT, auto onMyEvent>
-	class EventEmitterSupportingListeners
+	class EventEmitterSupportingListeners : public internal_usage_only::EmitterListenerStorage<EventEmitterSupportingListenersElement<EV, ListenerT>>
 	{
 //		static constexpr auto onMyEvent = F;
-		struct Element
-		{
-			bool once;
-			bool isLambda; // note: now we have only two options here: lambda and listeners
-			typename EV::callback cb;
-			nodecpp::safememory::soft_ptr<ListenerT> listener;
-			Element(bool once_, typename EV::callback cb_) : once(once_), isLambda(true), cb(cb_) {}
-			Element(bool once_, nodecpp::safememory::soft_ptr<ListenerT> listener_) : once(once_), isLambda(false), listener(std::move(listener_)) {}
-		};
-		nodecpp::vector<Element> callbacks;
+		using Element = EventEmitterSupportingListenersElement<EV, ListenerT>;
+		using Storage = internal_usage_only::EmitterListenerStorage<Element>;
+
+		template<class... ARGS>
+		static void call(Element& current, ARGS&... args) {
+			if ( current.isLambda )
+				current.cb(args...);
+			else
+			{
+#ifndef NODECPP_MSVC_BUG_379712_WORKAROUND_NO_LISTENER
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, current.listener );
+//				current.listener->*onMyEvent(args...);
+				auto ptr = current.listener.get().get_dereferencable();
+				(ptr->*onMyEvent)(args...);
+#else
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false );
+#endif
+			}
+		}
+
 	public:
 		void on(typename EV::callback cb) {
-			callbacks.emplace_back(false,cb);
+			this->add(Element(false, std::move(cb)));
 		}
 		void once(typename EV::callback cb) {
-			callbacks.emplace_back(true, cb);
+			this->add(Element(true, std::move(cb)));
 		}
 
 		void prepend(typename EV::callback cb) {
-			callbacks.insert(callbacks.begin(), std::make_pair(false, cb));
+			Storage::prepend(Element(false, std::move(cb)));
 		}
 		void prependOnce(typename EV::callback cb) {
-			callbacks.insert(std::make_pair(true, cb));
+			Storage::prepend(Element(true, std::move(cb)));
 		}
 
 		void on(nodecpp::safememory::soft_ptr<ListenerT> listener) {
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, listener );
-			callbacks.emplace_back(false,std::move(listener));
+			this->add(Element(false, std::move(listener)));
 		}
 		void once(nodecpp::safememory::soft_ptr<ListenerT> listener) {
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, listener );
-			callbacks.emplace_back(true, std::move(listener));
+			this->add(Element(true, std::move(listener)));
 		}
 
 		void prepend(nodecpp::safememory::soft_ptr<ListenerT> listener) {
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, listener );
-			callbacks.insert(callbacks.begin(), std::make_pair(false, std::move(listener)));
+			Storage::prepend(Element(false, std::move(listener)));
 		}
 		void prependOnce(nodecpp::safememory::soft_ptr<ListenerT> listener) {
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, listener );
-			callbacks.insert(std::make_pair(true, std::move(listener)));
+			Storage::prepend(Element(true, std::move(listener)));
 		}
 
-		size_t listenerCount() const {
-			return callbacks.size();
-		}
 		const char* eventName() const {
 			return EV::name;
 		}
 
 		template<class... ARGS>
 		void emit(ARGS... args) {
-
-			nodecpp::vector<Element> other;
-			
-			//first make a copy of handlers
-			for (auto& current : callbacks) {
-				if (!current.once)
-				{
-					NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, current.isLambda || current.listener);
-					other.push_back(current);
-				}
+			size_t cnt = this->callbacks.size(); // listeners added by handlers (if any) are not in 'callbacks' till we are done
+			if ( cnt == 0 )
+				return;
+			typename Storage::EmitGuard guard(*this);
+			if ( cnt == 1 && !this->callbacks[0].once && this->firedCnt == 0 ) // fast path for the most common case
+			{
+				call(this->callbacks[0], args...);
+				return;
 			}
-	
-			std::swap(callbacks, other);
-
-			for (auto& current : callbacks) {
-				if ( current.isLambda )
-					current.cb(args...);
-				else
+			for (size_t i=0; i<cnt; ++i) {
+				Element& current = this->callbacks[i];
+				if ( this->prepareToCall(current) )
 				{
-#ifndef NODECPP_MSVC_BUG_379712_WORKAROUND_NO_LISTENER
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, current.listener );
-//					current.listener->*onMyEvent(args...);
-					auto ptr = current.listener.get().get_dereferencable();
-					(ptr->*onMyEvent)(args...);
-#else
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false );
-#endif
+					call(current, args...);
+					if ( guard.destroyed )
+						return;
 				}
 			}
 		}
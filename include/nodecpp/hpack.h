@@ -0,0 +1,494 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HPACK_H
+#define HPACK_H
+
+#include "common.h"
+#include "net_common.h"
+
+#include <string_view>
+
+// HPACK (RFC 7541): header compression for HTTP/2
+
+namespace nodecpp {
+
+	namespace net {
+
+		class Hpack
+		{
+		public:
+			static constexpr size_t staticTableSize = 61;
+			static constexpr size_t entryOverhead = 32; // per entry of dynamic table (see RFC 7541, 4.1)
+
+			static const std::pair<const char*, const char*>& staticEntry( size_t idx ) // 1-based
+			{
+				static constexpr std::pair<const char*, const char*> entries[ staticTableSize ] = {
+					{ ":authority", "" },
+					{ ":method", "GET" },
+					{ ":method", "POST" },
+					{ ":path", "/" },
+					{ ":path", "/index.html" },
+					{ ":scheme", "http" },
+					{ ":scheme", "https" },
+					{ ":status", "200" },
+					{ ":status", "204" },
+					{ ":status", "206" },
+					{ ":status", "304" },
+					{ ":status", "400" },
+					{ ":status", "404" },
+					{ ":status", "500" },
+					{ "accept-charset", "" },
+					{ "accept-encoding", "gzip, deflate" },
+					{ "accept-language", "" },
+					{ "accept-ranges", "" },
+					{ "accept", "" },
+					{ "access-control-allow-origin", "" },
+					{ "age", "" },
+					{ "allow", "" },
+					{ "authorization", "" },
+					{ "cache-control", "" },
+					{ "content-disposition", "" },
+					{ "content-encoding", "" },
+					{ "content-language", "" },
+					{ "content-length", "" },
+					{ "content-location", "" },
+					{ "content-range", "" },
+					{ "content-type", "" },
+					{ "cookie", "" },
+					{ "date", "" },
+					{ "etag", "" },
+					{ "expect", "" },
+					{ "expires", "" },
+					{ "from", "" },
+					{ "host", "" },
+					{ "if-match", "" },
+					{ "if-modified-since", "" },
+					{ "if-none-match", "" },
+					{ "if-range", "" },
+					{ "if-unmodified-since", "" },
+					{ "last-modified", "" },
+					{ "link", "" },
+					{ "location", "" },
+					{ "max-forwards", "" },
+					{ "proxy-authenticate", "" },
+					{ "proxy-authorization", "" },
+					{ "range", "" },
+					{ "referer", "" },
+					{ "refresh", "" },
+					{ "retry-after", "" },
+					{ "server", "" },
+					{ "set-cookie", "" },
+					{ "strict-transport-security", "" },
+					{ "transfer-encoding", "" },
+					{ "user-agent", "" },
+					{ "vary", "" },
+					{ "via", "" },
+					{ "www-authenticate", "" },
+				};
+				return entries[ idx - 1 ];
+			}
+
+			static size_t findStaticName( std::string_view name ) // 0, if not found
+			{
+				for ( size_t i=1; i<=staticTableSize; ++i )
+					if ( name == staticEntry( i ).first )
+						return i;
+				return 0;
+			}
+
+			// integer with prefix of prefixBits bits (RFC 7541, 5.1); the first byte is ORed with firstByteFlags
+			static void encodeInt( uint64_t val, uint8_t prefixBits, uint8_t firstByteFlags, Buffer& out )
+			{
+				uint64_t maxPrefix = ( 1u << prefixBits ) - 1;
+				if ( val < maxPrefix )
+				{
+					out.appendUint8( (int8_t)( firstByteFlags | val ) );
+					return;
+				}
+				out.appendUint8( (int8_t)( firstByteFlags | maxPrefix ) );
+				val -= maxPrefix;
+				while ( val >= 0x80 )
+				{
+					out.appendUint8( (int8_t)( ( val & 0x7F ) | 0x80 ) );
+					val >>= 7;
+				}
+				out.appendUint8( (int8_t)val );
+			}
+
+			static bool decodeInt( const uint8_t*& ptr, const uint8_t* end, uint8_t prefixBits, uint64_t& val )
+			{
+				if ( ptr == end )
+					return false;
+				uint64_t maxPrefix = ( 1u << prefixBits ) - 1;
+				val = *ptr++ & maxPrefix;
+				if ( val < maxPrefix )
+					return true;
+				for ( unsigned shift = 0; ptr != end; shift += 7 )
+				{
+					if ( shift > 56 )
+						return false;
+					uint8_t b = *ptr++;
+					val += (uint64_t)( b & 0x7F ) << shift;
+					if ( ( b & 0x80 ) == 0 )
+						return true;
+				}
+				return false;
+			}
+
+			// string literal, with no Huffman coding (see RFC 7541, 5.2)
+			static void encodeString( std::string_view str, Buffer& out )
+			{
+				encodeInt( str.size(), 7, 0, out );
+				out.append( str.data(), str.size() );
+			}
+
+			static bool decodeString( const uint8_t*& ptr, const uint8_t* end, nodecpp::string& str )
+			{
+				if ( ptr == end )
+					return false;
+				bool huffman = ( *ptr & 0x80 ) != 0;
+				uint64_t len;
+				if ( !decodeInt( ptr, end, 7, len ) || len > (uint64_t)( end - ptr ) )
+					return false;
+				str.clear();
+				bool ok = huffman ? huffmanDecode( ptr, (size_t)len, str ) : ( str.assign( (const char*)ptr, (size_t)len ), true );
+				ptr += len;
+				return ok;
+			}
+
+			// the code of RFC 7541, Appendix B, is canonical; that is, it is fully defined by code lengths of symbols
+			static bool huffmanDecode( const uint8_t* ptr, size_t sz, nodecpp::string& str )
+			{
+				struct DecodingTable
+				{
+					uint16_t count[31] = {}; // number of codes of each length
+					uint16_t symbols[257]; // ordered by code
+					DecodingTable()
+					{
+						static constexpr uint8_t codeLength[257] = {
+								13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+								6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+								13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+								15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5, 6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+								20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23, 24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+								22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23, 21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+								26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25, 19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+								20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23, 26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+								30,
+						};
+						for ( size_t i=0; i<257; ++i )
+							++count[ codeLength[i] ];
+						uint16_t offsets[31];
+						offsets[0] = 0;
+						for ( size_t len=1; len<31; ++len )
+							offsets[len] = offsets[len - 1] + count[len - 1];
+						for ( size_t i=0; i<257; ++i )
+							symbols[ offsets[ codeLength[i] ]++ ] = (uint16_t)i;
+					}
+				};
+				static const DecodingTable table;
+
+				uint32_t code = 0; // bits read so far of the current symbol
+				uint32_t first = 0; // first code of the current length
+				uint32_t index = 0; // index of the first code of the current length in symbols
+				size_t len = 0;
+				bool allOnes = true; // padding is the most significant bits of EOS (i.e. all ones)
+				for ( size_t i=0; i<sz; ++i )
+					for ( int bit=7; bit>=0; --bit )
+					{
+						uint32_t b = ( ptr[i] >> bit ) & 1;
+						code |= b;
+						allOnes = allOnes && b;
+						++len;
+						uint32_t count = table.count[len];
+						if ( code - first < count )
+						{
+							uint16_t symbol = table.symbols[ index + ( code - first ) ];
+							if ( symbol == 256 ) // EOS must not appear in the string
+								return false;
+							str += (char)symbol;
+							code = first = index = 0;
+							len = 0;
+							allOnes = true;
+							continue;
+						}
+						if ( len == 30 )
+							return false;
+						index += count;
+						first = ( first + count ) << 1;
+						code <<= 1;
+					}
+				return len < 8 && allOnes;
+			}
+		};
+
+		// dynamic table (see RFC 7541, 2.3.2); the newest entry has index staticTableSize + 1
+		class HpackDynamicTable
+		{
+			nodecpp::vector<std::pair<nodecpp::string, nodecpp::string>> entries; // the oldest one first
+			size_t size = 0;
+			size_t maxSize = 4096;
+
+			void evict( size_t targetSize )
+			{
+				size_t cnt = 0;
+				while ( size > targetSize && cnt < entries.size() )
+				{
+					size -= entries[cnt].first.size() + entries[cnt].second.size() + Hpack::entryOverhead;
+					++cnt;
+				}
+				entries.erase( entries.begin(), entries.begin() + cnt );
+			}
+
+		public:
+			size_t getMaxSize() const { return maxSize; }
+			size_t count() const { return entries.size(); }
+
+			void setMaxSize( size_t sz )
+			{
+				maxSize = sz;
+				evict( maxSize );
+			}
+
+			void add( std::string_view name, std::string_view value )
+			{
+				size_t entrySize = name.size() + value.size() + Hpack::entryOverhead;
+				if ( entrySize > maxSize )
+				{
+					evict( 0 ); // not an error; the table is just emptied
+					return;
+				}
+				evict( maxSize - entrySize );
+				entries.push_back( std::make_pair( nodecpp::string( name.data(), name.size() ), nodecpp::string( value.data(), value.size() ) ) );
+				size += entrySize;
+			}
+
+			// idx is 1-based and covers both tables
+			const std::pair<nodecpp::string, nodecpp::string>* getDynamic( size_t idx ) const
+			{
+				size_t pos = idx - Hpack::staticTableSize - 1;
+				if ( idx <= Hpack::staticTableSize || pos >= entries.size() )
+					return nullptr;
+				return &( entries[ entries.size() - 1 - pos ] );
+			}
+
+			size_t find( std::string_view name, std::string_view value ) const // 0, if not found
+			{
+				for ( size_t i=entries.size(); i>0; --i )
+					if ( entries[i - 1].first == name && entries[i - 1].second == value )
+						return Hpack::staticTableSize + entries.size() - i + 1;
+				return 0;
+			}
+		};
+
+		class HpackDecoder
+		{
+			HpackDynamicTable table;
+			size_t maxTableSizeAllowed = 4096; // SETTINGS_HEADER_TABLE_SIZE sent to the peer
+			size_t maxListSize = 0; // SETTINGS_MAX_HEADER_LIST_SIZE sent to the peer; 0 means 'no limit'
+
+		public:
+			void setMaxTableSizeAllowed( size_t sz ) { maxTableSizeAllowed = sz; }
+			void setMaxListSize( size_t sz ) { maxListSize = sz; }
+
+			// decodes a complete header block calling onHeader( const nodecpp::string& name, const nodecpp::string& value ) for each field;
+			// false means a compression error (the connection cannot be used anymore).
+			// Once the decoded size of the list (RFC 7540, 6.5.2) exceeds maxListSize, tooLarge is set and onHeader is not called anymore;
+			// the rest of the block is still processed to keep the dynamic table in sync, but indexed fields are not copied, so that
+			// a small block referring to large table entries many times costs neither memory nor CPU
+			template<class OnHeaderT>
+			bool decode( const uint8_t* ptr, size_t sz, bool& tooLarge, OnHeaderT&& onHeader )
+			{
+				const uint8_t* end = ptr + sz;
+				nodecpp::string name;
+				nodecpp::string value;
+				bool fieldSeen = false;
+				size_t listSize = 0;
+				tooLarge = false;
+				auto emit = [&]() {
+					fieldSeen = true;
+					if ( tooLarge )
+						return;
+					listSize += name.size() + value.size() + Hpack::entryOverhead;
+					if ( maxListSize && listSize > maxListSize )
+						tooLarge = true;
+					else
+						onHeader( name, value );
+				};
+				while ( ptr != end )
+				{
+					uint8_t b = *ptr;
+					uint64_t idx;
+					if ( b & 0x80 ) // indexed
+					{
+						if ( !Hpack::decodeInt( ptr, end, 7, idx ) )
+							return false;
+						if ( tooLarge ) // the index is still to be valid
+						{
+							if ( idx == 0 || ( idx > Hpack::staticTableSize && table.getDynamic( (size_t)idx ) == nullptr ) )
+								return false;
+							fieldSeen = true;
+							continue;
+						}
+						if ( !lookup( idx, name, value, true ) )
+							return false;
+						emit();
+						continue;
+					}
+					if ( ( b & 0xE0 ) == 0x20 ) // dynamic table size update; allowed at the beginning of a block only
+					{
+						if ( fieldSeen || !Hpack::decodeInt( ptr, end, 5, idx ) || idx > maxTableSizeAllowed )
+							return false;
+						table.setMaxSize( (size_t)idx );
+						continue;
+					}
+					bool incremental = ( b & 0xC0 ) == 0x40;
+					if ( !Hpack::decodeInt( ptr, end, incremental ? 6 : 4, idx ) ) // literal: with incremental indexing, without indexing or never indexed
+						return false;
+					if ( idx )
+					{
+						nodecpp::string unused;
+						if ( !lookup( idx, name, unused, false ) )
+							return false;
+					}
+					else if ( !Hpack::decodeString( ptr, end, name ) )
+						return false;
+					if ( !Hpack::decodeString( ptr, end, value ) )
+						return false;
+					if ( incremental )
+						table.add( name, value );
+					emit();
+				}
+				return true;
+			}
+
+		private:
+			bool lookup( uint64_t idx, nodecpp::string& name, nodecpp::string& value, bool withValue )
+			{
+				if ( idx == 0 )
+					return false;
+				if ( idx <= Hpack::staticTableSize )
+				{
+					auto& e = Hpack::staticEntry( (size_t)idx );
+					name = e.first;
+					if ( withValue )
+						value = e.second;
+					return true;
+				}
+				auto e = table.getDynamic( (size_t)idx );
+				if ( e == nullptr )
+					return false;
+				name = e->first;
+				if ( withValue )
+					value = e->second;
+				return true;
+			}
+		};
+
+		// strings are not Huffman-coded (that would save ~20% of header bytes at a cost of CPU);
+		// fields likely to repeat across responses (e.g. content-type or server) are added to the dynamic table
+		class HpackEncoder
+		{
+			HpackDynamicTable table;
+			size_t pendingSizeUpdate = (size_t)(-1); // to be sent at the beginning of the next block
+			static constexpr size_t maxTableSize = 4096; // we need not more, even if the peer allows
+			static constexpr size_t maxValueSizeToIndex = 128;
+
+		public:
+			void setPeerMaxTableSize( size_t sz ) // SETTINGS_HEADER_TABLE_SIZE of the peer
+			{
+				size_t newSize = sz < maxTableSize ? sz : maxTableSize;
+				if ( newSize != table.getMaxSize() )
+				{
+					table.setMaxSize( newSize );
+					pendingSizeUpdate = newSize;
+				}
+			}
+
+			void beginBlock( Buffer& out )
+			{
+				if ( pendingSizeUpdate != (size_t)(-1) )
+				{
+					Hpack::encodeInt( pendingSizeUpdate, 5, 0x20, out );
+					pendingSizeUpdate = (size_t)(-1);
+				}
+			}
+
+			void encodeStatus( unsigned status, Buffer& out )
+			{
+				switch ( status ) // fully indexed in the static table
+				{
+					case 200: out.appendUint8( (int8_t)( 0x80 | 8 ) ); return;
+					case 204: out.appendUint8( (int8_t)( 0x80 | 9 ) ); return;
+					case 206: out.appendUint8( (int8_t)( 0x80 | 10 ) ); return;
+					case 304: out.appendUint8( (int8_t)( 0x80 | 11 ) ); return;
+					case 400: out.appendUint8( (int8_t)( 0x80 | 12 ) ); return;
+					case 404: out.appendUint8( (int8_t)( 0x80 | 13 ) ); return;
+					case 500: out.appendUint8( (int8_t)( 0x80 | 14 ) ); return;
+					default: break;
+				}
+				char buff[4] = { (char)( '0' + status / 100 % 10 ), (char)( '0' + status / 10 % 10 ), (char)( '0' + status % 10 ), 0 };
+				Hpack::encodeInt( 8, 4, 0, out ); // literal without indexing, name ':status'
+				Hpack::encodeString( std::string_view( buff, 3 ), out );
+			}
+
+			// name must be in lower case
+			void encode( std::string_view name, std::string_view value, Buffer& out )
+			{
+				size_t idx = table.find( name, value );
+				if ( idx )
+				{
+					Hpack::encodeInt( idx, 7, 0x80, out );
+					return;
+				}
+				size_t nameIdx = Hpack::findStaticName( name );
+				if ( value.size() <= maxValueSizeToIndex && isWorthIndexing( name ) )
+				{
+					Hpack::encodeInt( nameIdx, 6, 0x40, out );
+					table.add( name, value );
+				}
+				else
+					Hpack::encodeInt( nameIdx, 4, 0, out );
+				if ( nameIdx == 0 )
+					Hpack::encodeString( name, out );
+				Hpack::encodeString( value, out );
+			}
+
+		private:
+			static bool isWorthIndexing( std::string_view name ) // values of these change from response to response or are sensitive
+			{
+				return !( name == "content-length" || name == "date" || name == "etag" || name == "last-modified" || name == "set-cookie" ||
+					name == "content-range" || name == "location" || name == "expires" || name == "age" );
+			}
+		};
+
+	} //namespace net
+
+} //namespace nodecpp
+
+#endif //HPACK_H
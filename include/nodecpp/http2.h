@@ -0,0 +1,1571 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HTTP2_H
+#define HTTP2_H
+
+#include "http_server_common.h"
+#include "http_socket_at_server.h"
+#include "hpack.h"
+
+#include <string_view>
+#include <exception>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef NODECPP_NO_COROUTINES
+
+namespace nodecpp {
+
+	namespace net {
+
+		namespace internal_usage_only {
+
+#ifdef _MSC_VER
+			inline int64_t h2FileRead( int fd, uint64_t offset, void* buff, size_t sz ) // bytes read; -1 on error
+			{
+				if ( ::_lseeki64( fd, (__int64)offset, SEEK_SET ) < 0 )
+					return -1;
+				return ::_read( fd, buff, (unsigned int)sz );
+			}
+#else
+			inline int64_t h2FileRead( int fd, uint64_t offset, void* buff, size_t sz ) { return ::pread( fd, buff, sz, (off_t)offset ); }
+#endif
+
+			inline
+			bool base64UrlDecode( std::string_view in, Buffer& out ) // trailing padding, if any, is ignored
+			{
+				uint32_t acc = 0;
+				size_t bits = 0;
+				for ( char c : in )
+				{
+					uint32_t v;
+					if ( c >= 'A' && c <= 'Z' )
+						v = c - 'A';
+					else if ( c >= 'a' && c <= 'z' )
+						v = c - 'a' + 26;
+					else if ( c >= '0' && c <= '9' )
+						v = c - '0' + 52;
+					else if ( c == '-' )
+						v = 62;
+					else if ( c == '_' )
+						v = 63;
+					else if ( c == '=' )
+						break;
+					else
+						return false;
+					acc = ( acc << 6 ) | v;
+					bits += 6;
+					if ( bits >= 8 )
+					{
+						bits -= 8;
+						out.appendUint8( (int8_t)( ( acc >> bits ) & 0xFF ) );
+					}
+				}
+				return true;
+			}
+
+		} // namespace internal_usage_only
+
+		enum class Http2Error : uint32_t { noError = 0x0, protocolError = 0x1, internalError = 0x2, flowControlError = 0x3, settingsTimeout = 0x4, streamClosed = 0x5,
+			frameSizeError = 0x6, refusedStream = 0x7, cancel = 0x8, compressionError = 0x9, connectError = 0xa, enhanceYourCalm = 0xb, inadequateSecurity = 0xc, http11Required = 0xd };
+
+		class Http2Session; // forward declaration
+
+		// state of a single stream; objects are pooled per connection and are reused together with their request/response pairs
+		class Http2Stream
+		{
+			friend class Http2Session;
+			friend class IncomingHttpMessageAtServer;
+			friend class HttpServerResponse;
+
+			Http2Session* session = nullptr;
+			uint32_t id = 0;
+			nodecpp::safememory::owning_ptr<IncomingHttpMessageAtServer> request;
+			nodecpp::safememory::owning_ptr<HttpServerResponse> response;
+			bool active = false; // otherwise, is in the pool
+
+			// receiving
+			Buffer recvData; // DATA payload not yet taken by the handler
+			Buffer heldData; // returned by a_nextBodyChunk() and not yet released
+			int64_t recvWindow = 0;
+			size_t recvConsumed = 0; // taken by the handler, but not yet announced to the peer by WINDOW_UPDATE
+			bool recvEnded = false; // END_STREAM is received
+			awaitable_handle_t ahd_recv = nullptr;
+
+			// sending
+			Buffer headerBlock;
+			bool headersPending = false;
+			bool headersEndStream = false; // response has no body
+			Buffer out; // DATA payload to be sent
+			size_t outOffset = 0; // bytes of out already sent
+			Buffer trailerBlock;
+			bool trailersPending = false;
+			bool endStreamPending = false; // END_STREAM goes with the last DATA frame (or with trailers, or with headers)
+			bool endStreamSent = false;
+			int64_t sendWindow = 0;
+			bool queued = false; // is in Http2Session::ready
+			awaitable_handle_t ahd_drain = nullptr;
+
+			bool responseDone = false; // response is finalized by the handler
+			bool reset = false; // RST_STREAM is sent or received (or the connection is lost); nothing is sent or received since then
+
+			size_t outPending() const { return out.size() - outOffset; }
+			bool hasOutput() const { return headersPending || outPending() || ( endStreamPending && !endStreamSent ); }
+
+			void clear()
+			{
+				id = 0;
+				recvData.clear();
+				heldData.clear();
+				recvWindow = 0;
+				recvConsumed = 0;
+				recvEnded = false;
+				headerBlock.clear();
+				headersPending = false;
+				headersEndStream = false;
+				out.clear();
+				outOffset = 0;
+				trailerBlock.clear();
+				trailersPending = false;
+				endStreamPending = false;
+				endStreamSent = false;
+				sendWindow = 0;
+				queued = false;
+				responseDone = false;
+				reset = false;
+			}
+
+		public:
+			Http2Stream() {}
+			Http2Stream(const Http2Stream&) = delete;
+			Http2Stream& operator = (const Http2Stream&) = delete;
+		};
+
+		/*
+			HTTP/2 connection over cleartext TCP (h2c; RFC 7540), entered either with prior knowledge (the connection starts with the client preface)
+			or by 'Upgrade: h2c' of the first HTTP/1.1 request (see HttpServerBase::enableHttp2()).
+			Each stream is served by an IncomingHttpMessageAtServer/HttpServerResponse pair, the same as an HTTP/1 request, so handlers work unchanged.
+			Frames are parsed right from the socket's read buffer. Output of all streams and control frames produced within a loop iteration
+			is sent by a single gather write; headers of DATA frames are the only bytes added to response bodies on their way out.
+			Streams having something to send are served round-robin, a quantum at a time, within stream and connection flow-control windows.
+			Request bodies are flow-controlled per stream: the window is replenished as the handler consumes the body.
+			Not supported: server push, priorities (received ones are ignored), and Huffman coding of sent headers.
+		*/
+		class Http2Session
+		{
+			friend class HttpSocketBase;
+			friend class IncomingHttpMessageAtServer;
+			friend class HttpServerResponse;
+
+		public:
+			static constexpr char preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+			static constexpr size_t prefaceSize = sizeof( preface ) - 1;
+			static constexpr size_t frameHeaderSize = 9;
+			static constexpr size_t maxFrameSize = 0x4000; // SETTINGS_MAX_FRAME_SIZE of ours (default; not announced)
+			static constexpr uint32_t maxConcurrentStreams = 100;
+			static constexpr uint32_t streamWindowSize = 0x40000; // per stream; bounds memory taken by not yet consumed request bodies
+			static constexpr uint32_t connectionWindowSize = 0x1000000;
+			static constexpr size_t maxHeaderBlockSize = 0x10000; // HEADERS with CONTINUATION frames
+			static constexpr uint32_t maxHeaderListSize = 0x10000; // SETTINGS_MAX_HEADER_LIST_SIZE of ours; decoded size of a header block
+			static constexpr uint32_t maxAbortedStreamsPerSecond = 100; // streams reset by the peer or refused by us; beyond that, the peer is cut off ('rapid reset')
+			static constexpr size_t streamBufferLimit = 0x10000; // writers of a stream wait till less than this is waiting to be sent
+			static constexpr size_t quantum = 0x4000; // of DATA sent from a stream per round of the scheduler
+			static constexpr size_t maxBytesPerFlush = 0x40000;
+			static constexpr size_t maxFramesPerFlush = 256;
+
+			enum FrameType : uint8_t { data = 0x0, headers = 0x1, priority = 0x2, rstStream = 0x3, settings = 0x4, pushPromise = 0x5, ping = 0x6, goaway = 0x7, windowUpdate = 0x8, continuation = 0x9 };
+			enum FrameFlags : uint8_t { endStream = 0x1, ack = 0x1, endHeaders = 0x4, padded = 0x8, priorityFlag = 0x20 };
+
+		private:
+			HttpSocketBase& sock;
+			nodecpp::safememory::soft_ptr<HttpSocketBase> sockPtr;
+			nodecpp::safememory::soft_ptr<HttpServerBase> server;
+			nodecpp::safememory::soft_this_ptr<Http2Session> myThis;
+
+			HpackDecoder decoder;
+			HpackEncoder encoder;
+			nodecpp::vector<std::pair<nodecpp::string, nodecpp::string>> fields; // of a header block being processed; reused
+
+			nodecpp::map<uint32_t, Http2Stream*> streams; // active ones
+			nodecpp::vector<nodecpp::safememory::owning_ptr<Http2Stream>> pool;
+			nodecpp::vector<Http2Stream*> freeStreams;
+			uint32_t lastStreamId = 0; // the highest one opened by the peer
+			uint64_t abortedStreamsSince = 0; // start of the current one-second period
+			uint32_t abortedStreams = 0; // within the period
+
+			// settings of the peer
+			uint32_t peerInitialWindowSize = 0xFFFF;
+			uint32_t peerMaxFrameSize = 0x4000;
+
+			int64_t connSendWindow = 0xFFFF;
+			int64_t connRecvWindow = 0xFFFF;
+			size_t connRecvConsumed = 0; // not yet announced to the peer by WINDOW_UPDATE
+
+			// header block being received (HEADERS followed by CONTINUATION frames)
+			Buffer headerBlockIn;
+			uint32_t headerBlockStream = 0; // 0, if none
+			bool headerBlockEndStream = false;
+			bool headerBlockMalformed = false;
+
+			Buffer scratch; // for frames wrapped around the end of socket's read buffer
+
+			// output
+			Buffer ctrlOut; // control frames to be sent
+			Buffer ctrlSending;
+			nodecpp::vector<Http2Stream*> ready; // streams having something to send (see Http2Stream::hasOutput()); served from readyHead on
+			size_t readyHead = 0;
+			nodecpp::vector<BufferView> segs;
+			uint8_t frameHeaders[maxFramesPerFlush][frameHeaderSize];
+			size_t framesInFlush = 0;
+			nodecpp::vector<Http2Stream*> flushed; // streams that took part in the current flush
+			bool flushScheduled = false;
+			bool flushInProgress = false;
+
+			bool closed = false; // GOAWAY is sent due to a connection error; nothing else is to be received
+			bool goawayReceived = false; // no new streams are accepted
+			bool dead = false; // the connection is no longer usable; remaining streams are being finalized by their handlers
+			awaitable_handle_t ahd_quiesced = nullptr;
+
+			auto a_recv( Http2Stream& s ) {
+
+				struct recv_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					Http2Stream& s;
+
+					recv_awaiter(Http2Stream& s_) : s( s_ ) {}
+
+					recv_awaiter(const recv_awaiter &) = delete;
+					recv_awaiter &operator = (const recv_awaiter &) = delete;
+
+					~recv_awaiter() {}
+
+					bool await_ready() {
+						return s.recvData.size() || s.recvEnded || s.reset;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						s.ahd_recv = awaiting;
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+						if ( s.recvData.empty() && !s.recvEnded ) // reset
+							throw Error();
+					}
+				};
+				return recv_awaiter(s);
+			}
+
+			auto a_drained( Http2Stream& s ) {
+
+				struct drain_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					Http2Stream& s;
+
+					drain_awaiter(Http2Stream& s_) : s( s_ ) {}
+
+					drain_awaiter(const drain_awaiter &) = delete;
+					drain_awaiter &operator = (const drain_awaiter &) = delete;
+
+					~drain_awaiter() {}
+
+					bool await_ready() {
+						return s.outPending() < streamBufferLimit || s.reset;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						s.ahd_drain = awaiting;
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {} // if reset meanwhile, whatever is written further is dropped
+				};
+				return drain_awaiter(s);
+			}
+
+			auto a_quiesced() {
+
+				struct quiesced_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					Http2Session& session;
+
+					quiesced_awaiter(Http2Session& session_) : session( session_ ) {}
+
+					quiesced_awaiter(const quiesced_awaiter &) = delete;
+					quiesced_awaiter &operator = (const quiesced_awaiter &) = delete;
+
+					~quiesced_awaiter() {}
+
+					bool await_ready() {
+						return session.isQuiesced();
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						session.ahd_quiesced = awaiting;
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {}
+				};
+				return quiesced_awaiter(*this);
+			}
+
+		public:
+			Http2Session( HttpSocketBase& sock_, nodecpp::safememory::soft_ptr<HttpSocketBase> sockPtr_, nodecpp::safememory::soft_ptr<HttpServerBase> server_ ) : sock( sock_ ), sockPtr( sockPtr_ ), server( server_ ) {}
+			Http2Session(const Http2Session&) = delete;
+			Http2Session& operator = (const Http2Session&) = delete;
+
+			static bool isPreface( const CircularByteBuffer::AvailableDataDescriptor& d ) // as much of it as is available
+			{
+				size_t sz1 = d.sz1 < prefaceSize ? d.sz1 : prefaceSize;
+				size_t sz2 = d.sz2 < prefaceSize - sz1 ? d.sz2 : prefaceSize - sz1;
+				return sz1 && memcmp( d.ptr1, preface, sz1 ) == 0 && ( sz2 == 0 || memcmp( d.ptr2, preface + sz1, sz2 ) == 0 );
+			}
+
+			// reads and processes frames till the connection is closed; returns once all streams are finalized by their handlers
+			nodecpp::handler_ret_type run( IncomingHttpMessageAtServer* upgraded )
+			{
+				queueSettings();
+				decoder.setMaxListSize( maxHeaderListSize );
+				if ( upgraded != nullptr )
+					startUpgraded( *upgraded );
+				try
+				{
+					CircularByteBuffer::AvailableDataDescriptor d;
+					if ( !closed )
+					{
+						updateDeadline( true );
+						co_await sock.a_dataAvailable( d, prefaceSize );
+						if ( d.sz1 + d.sz2 < prefaceSize || !isPreface( d ) )
+							connectionError( Http2Error::protocolError );
+						else
+							sock.dataForCommandProcessing.readBuffer.skip_data( prefaceSize );
+					}
+					while ( !closed )
+					{
+						updateDeadline( sock.dataForCommandProcessing.readBuffer.used_size() != 0 );
+						co_await sock.a_dataAvailable( d, frameHeaderSize );
+						if ( d.sz1 + d.sz2 < frameHeaderSize ) // no more data
+							break;
+						uint8_t hdr[frameHeaderSize];
+						copyFrom( d, 0, hdr, frameHeaderSize );
+						size_t len = ( (size_t)hdr[0] << 16 ) | ( (size_t)hdr[1] << 8 ) | hdr[2];
+						if ( len > maxFrameSize )
+						{
+							connectionError( Http2Error::frameSizeError );
+							break;
+						}
+						if ( d.sz1 + d.sz2 < frameHeaderSize + len )
+						{
+							updateDeadline( true );
+							co_await sock.a_dataAvailable( d, frameHeaderSize + len );
+							if ( d.sz1 + d.sz2 < frameHeaderSize + len )
+								break;
+						}
+						const uint8_t* payload;
+						if ( d.sz1 >= frameHeaderSize + len )
+							payload = d.ptr1 + frameHeaderSize;
+						else
+						{
+							scratch.clear();
+							if ( scratch.capacity() < maxFrameSize )
+								scratch = Buffer( maxFrameSize );
+							scratch.set_size( len );
+							copyFrom( d, frameHeaderSize, scratch.begin(), len );
+							payload = scratch.begin();
+						}
+						uint32_t streamId = read32( hdr + 5 ) & 0x7FFFFFFF;
+						bool ok = processFrame( hdr[3], hdr[4], streamId, payload, len );
+						sock.dataForCommandProcessing.readBuffer.skip_data( frameHeaderSize + len );
+						if ( sock.deadlineKind == HttpSocketBase::DeadlineKind::headers ) // the next frame gets its own time
+							sock.clearDeadline();
+						if ( !ok )
+							break;
+					}
+				}
+				catch (...) {} // the connection is lost
+				onConnectionEnded();
+				co_await a_quiesced();
+				CO_RETURN;
+			}
+
+			void onIdleDeadline() { connectionError( Http2Error::noError ); } // GOAWAY, then the connection is ended
+
+		private:
+			static uint32_t read32( const uint8_t* p ) { return ( (uint32_t)p[0] << 24 ) | ( (uint32_t)p[1] << 16 ) | ( (uint32_t)p[2] << 8 ) | p[3]; }
+
+			static void copyFrom( const CircularByteBuffer::AvailableDataDescriptor& d, size_t offset, uint8_t* to, size_t sz )
+			{
+				if ( offset < d.sz1 )
+				{
+					size_t n = d.sz1 - offset < sz ? d.sz1 - offset : sz;
+					memcpy( to, d.ptr1 + offset, n );
+					to += n;
+					sz -= n;
+					offset = 0;
+				}
+				else
+					offset -= d.sz1;
+				if ( sz )
+					memcpy( to, d.ptr2 + offset, sz );
+			}
+
+			static void appendFrameHeader( uint8_t* h, size_t len, uint8_t type, uint8_t flags, uint32_t streamId )
+			{
+				h[0] = (uint8_t)( len >> 16 );
+				h[1] = (uint8_t)( len >> 8 );
+				h[2] = (uint8_t)len;
+				h[3] = type;
+				h[4] = flags;
+				h[5] = (uint8_t)( streamId >> 24 );
+				h[6] = (uint8_t)( streamId >> 16 );
+				h[7] = (uint8_t)( streamId >> 8 );
+				h[8] = (uint8_t)streamId;
+			}
+
+			void queueControl( uint8_t type, uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t len )
+			{
+				uint8_t h[frameHeaderSize];
+				appendFrameHeader( h, len, type, flags, streamId );
+				ctrlOut.append( h, frameHeaderSize );
+				if ( len )
+					ctrlOut.append( payload, len );
+				scheduleFlush();
+			}
+
+			void queueSettings()
+			{
+				uint8_t p[18] = { 0, 3, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 6, 0, 0, 0, 0 }; // MAX_CONCURRENT_STREAMS, INITIAL_WINDOW_SIZE and MAX_HEADER_LIST_SIZE
+				for ( size_t i=0; i<4; ++i )
+				{
+					p[2 + i] = (uint8_t)( maxConcurrentStreams >> ( 24 - 8 * i ) );
+					p[8 + i] = (uint8_t)( streamWindowSize >> ( 24 - 8 * i ) );
+					p[14 + i] = (uint8_t)( maxHeaderListSize >> ( 24 - 8 * i ) );
+				}
+				queueControl( FrameType::settings, 0, 0, p, sizeof( p ) );
+				queueWindowUpdate( 0, connectionWindowSize - connRecvWindow );
+				connRecvWindow = connectionWindowSize;
+			}
+
+			void queueWindowUpdate( uint32_t streamId, uint32_t increment )
+			{
+				uint8_t p[4] = { (uint8_t)( increment >> 24 ), (uint8_t)( increment >> 16 ), (uint8_t)( increment >> 8 ), (uint8_t)increment };
+				queueControl( FrameType::windowUpdate, 0, streamId, p, sizeof( p ) );
+			}
+
+			void queueRstStream( uint32_t streamId, Http2Error code )
+			{
+				uint32_t c = (uint32_t)code;
+				uint8_t p[4] = { (uint8_t)( c >> 24 ), (uint8_t)( c >> 16 ), (uint8_t)( c >> 8 ), (uint8_t)c };
+				queueControl( FrameType::rstStream, 0, streamId, p, sizeof( p ) );
+			}
+
+			bool connectionError( Http2Error code ) // GOAWAY is sent right away, and the connection is ended; always returns false
+			{
+				if ( closed )
+					return false;
+				closed = true;
+				uint32_t c = (uint32_t)code;
+				uint8_t p[8] = { (uint8_t)( lastStreamId >> 24 ), (uint8_t)( lastStreamId >> 16 ), (uint8_t)( lastStreamId >> 8 ), (uint8_t)lastStreamId,
+					(uint8_t)( c >> 24 ), (uint8_t)( c >> 16 ), (uint8_t)( c >> 8 ), (uint8_t)c };
+				uint8_t h[frameHeaderSize];
+				appendFrameHeader( h, sizeof( p ), FrameType::goaway, 0, 0 );
+				Buffer b( frameHeaderSize + sizeof( p ) );
+				b.append( h, frameHeaderSize );
+				b.append( p, sizeof( p ) );
+				sock.write( b ); // after whatever is being sent
+				sock.end();
+				return false;
+			}
+
+			// see HttpServerBase::ConnectionLimits: idleTimeoutMs applies while no stream is open, and headersTimeoutMs to receiving a frame once it is started
+			void updateDeadline( bool partialFrame )
+			{
+				HttpSocketBase::DeadlineKind kind = partialFrame ? HttpSocketBase::DeadlineKind::headers : ( streams.empty() ? HttpSocketBase::DeadlineKind::idle : HttpSocketBase::DeadlineKind::none );
+				if ( kind == sock.deadlineKind ) // already running; not to be extended
+					return;
+				if ( kind == HttpSocketBase::DeadlineKind::none )
+					sock.clearDeadline();
+				else
+					sock.setDeadline( *server, kind );
+			}
+
+			bool onStreamAborted() // by the peer, or refused by us; false, if the peer does that too often (the connection is closed then)
+			{
+				uint64_t now = nodecpp::time::now();
+				if ( now - abortedStreamsSince >= 1000 )
+				{
+					abortedStreamsSince = now;
+					abortedStreams = 0;
+				}
+				if ( ++abortedStreams <= maxAbortedStreamsPerSecond )
+					return true;
+				nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"HTTP/2: more than {} streams per second reset by the peer or refused; closing the connection", maxAbortedStreamsPerSecond );
+				return connectionError( Http2Error::enhanceYourCalm );
+			}
+
+			// streams
+
+			Http2Stream* acquireStream( uint32_t id )
+			{
+				Http2Stream* s;
+				if ( freeStreams.empty() )
+				{
+					pool.push_back( nodecpp::safememory::make_owning<Http2Stream>() );
+					s = &*(pool.back());
+					s->session = this;
+					HttpSocketBase::initRequestResponsePair( s->request, s->response, sockPtr );
+					s->request->h2stream = s;
+					s->response->h2stream = s;
+				}
+				else
+				{
+					s = freeStreams.back();
+					freeStreams.pop_back();
+				}
+				s->id = id;
+				s->active = true;
+				s->recvWindow = streamWindowSize;
+				s->sendWindow = peerInitialWindowSize;
+				streams.insert( std::make_pair( id, s ) );
+				if ( sock.deadlineKind == HttpSocketBase::DeadlineKind::idle )
+					sock.clearDeadline();
+				return s;
+			}
+
+			void releaseStream( Http2Stream& s )
+			{
+				if ( s.queued )
+					for ( size_t i=readyHead; i<ready.size(); ++i )
+						if ( ready[i] == &s )
+							ready[i] = nullptr;
+				streams.erase( s.id );
+				s.active = false;
+				s.request->clear();
+				s.response->clear();
+				s.clear();
+				freeStreams.push_back( &s );
+				if ( streams.empty() && !dead && sock.deadlineKind == HttpSocketBase::DeadlineKind::none )
+					updateDeadline( false );
+				checkQuiesced();
+			}
+
+			void maybeRelease( Http2Stream& s ) // once the response is finalized and sent
+			{
+				if ( !s.active || !s.responseDone )
+					return;
+				if ( !s.reset && !dead )
+				{
+					if ( !s.endStreamSent )
+						return;
+					if ( !s.recvEnded ) // the rest of the request is not needed (RFC 7540, 8.1)
+					{
+						queueRstStream( s.id, Http2Error::noError );
+						s.reset = true;
+					}
+				}
+				releaseStream( s );
+			}
+
+			void wakeRecv( Http2Stream& s, bool withException )
+			{
+				if ( s.ahd_recv != nullptr )
+				{
+					auto hr = s.ahd_recv;
+					s.ahd_recv = nullptr;
+					if ( withException )
+						nodecpp::setException(hr, std::exception()); // TODO: switch to our exceptions ASAP!
+					hr();
+				}
+			}
+
+			void wakeDrain( Http2Stream& s )
+			{
+				if ( s.ahd_drain != nullptr )
+				{
+					auto hr = s.ahd_drain;
+					s.ahd_drain = nullptr;
+					hr();
+				}
+			}
+
+			void abortStream( Http2Stream& s ) // nothing is sent or received anymore; the handler is let know by an exception (if reading) or by its writes being dropped
+			{
+				s.reset = true;
+				s.headersPending = false;
+				s.trailersPending = false;
+				s.endStreamPending = false;
+				s.out.clear();
+				s.outOffset = 0;
+				wakeRecv( s, true );
+				wakeDrain( s );
+				maybeRelease( s ); // NOTE: the handler, if resumed, might have finalized the response already
+			}
+
+			bool resetStream( uint32_t streamId, Http2Error code ) // stream error; always returns true
+			{
+				queueRstStream( streamId, code );
+				auto f = streams.find( streamId );
+				if ( f != streams.end() )
+					abortStream( *(f->second) );
+				return true;
+			}
+
+			void onConnectionEnded()
+			{
+				dead = true;
+				closed = true;
+				nodecpp::vector<Http2Stream*> active;
+				for ( auto& s : streams )
+					active.push_back( s.second );
+				for ( auto s : active )
+					if ( s->active )
+						abortStream( *s );
+				checkQuiesced();
+			}
+
+			bool isQuiesced() const { return dead && streams.empty() && !flushScheduled && !flushInProgress; }
+
+			void checkQuiesced()
+			{
+				if ( ahd_quiesced != nullptr && isQuiesced() )
+				{
+					auto hr = ahd_quiesced;
+					ahd_quiesced = nullptr;
+					hr();
+				}
+			}
+
+			// receiving
+
+			bool processFrame( uint8_t type, uint8_t flags, uint32_t streamId, const uint8_t* p, size_t len ) // false, if the connection is to be closed
+			{
+				if ( headerBlockStream != 0 && type != FrameType::continuation )
+					return connectionError( Http2Error::protocolError );
+				switch ( type )
+				{
+					case FrameType::data:
+						return onData( flags, streamId, p, len );
+					case FrameType::headers:
+						return onHeaders( flags, streamId, p, len );
+					case FrameType::continuation:
+						if ( headerBlockStream == 0 || streamId != headerBlockStream )
+							return connectionError( Http2Error::protocolError );
+						if ( headerBlockIn.size() + len > maxHeaderBlockSize )
+							return connectionError( Http2Error::enhanceYourCalm );
+						headerBlockIn.append( p, len );
+						if ( flags & FrameFlags::endHeaders )
+						{
+							headerBlockStream = 0;
+							return onHeaderBlock( streamId, headerBlockEndStream, headerBlockMalformed, headerBlockIn.begin(), headerBlockIn.size() );
+						}
+						return true;
+					case FrameType::priority:
+						if ( streamId == 0 )
+							return connectionError( Http2Error::protocolError );
+						if ( len != 5 )
+							return resetStream( streamId, Http2Error::frameSizeError );
+						return true;
+					case FrameType::rstStream:
+					{
+						if ( streamId == 0 || streamId > lastStreamId ) // the latter is idle
+							return connectionError( Http2Error::protocolError );
+						if ( len != 4 )
+							return connectionError( Http2Error::frameSizeError );
+						auto f = streams.find( streamId );
+						if ( f == streams.end() )
+							return true;
+						abortStream( *(f->second) );
+						return onStreamAborted();
+					}
+					case FrameType::settings:
+						if ( streamId != 0 )
+							return connectionError( Http2Error::protocolError );
+						if ( flags & FrameFlags::ack )
+							return len == 0 || connectionError( Http2Error::frameSizeError );
+						if ( len % 6 )
+							return connectionError( Http2Error::frameSizeError );
+						if ( !applySettings( p, len ) )
+							return false;
+						queueControl( FrameType::settings, FrameFlags::ack, 0, nullptr, 0 );
+						return true;
+					case FrameType::pushPromise: // clients do not push
+						return connectionError( Http2Error::protocolError );
+					case FrameType::ping:
+						if ( streamId != 0 )
+							return connectionError( Http2Error::protocolError );
+						if ( len != 8 )
+							return connectionError( Http2Error::frameSizeError );
+						if ( !( flags & FrameFlags::ack ) )
+							queueControl( FrameType::ping, FrameFlags::ack, 0, p, len );
+						return true;
+					case FrameType::goaway:
+						if ( streamId != 0 )
+							return connectionError( Http2Error::protocolError );
+						goawayReceived = true; // streams in progress are completed; the peer closes the connection when done
+						return true;
+					case FrameType::windowUpdate:
+						return onWindowUpdate( streamId, p, len );
+					default: // unknown frame types are ignored
+						return true;
+				}
+			}
+
+			bool applySettings( const uint8_t* p, size_t len ) // false on a connection error
+			{
+				for ( size_t i=0; i+6<=len; i+=6 )
+				{
+					uint16_t id = (uint16_t)( ( p[i] << 8 ) | p[i + 1] );
+					uint32_t val = read32( p + i + 2 );
+					switch ( id )
+					{
+						case 0x1: // HEADER_TABLE_SIZE
+							encoder.setPeerMaxTableSize( val );
+							break;
+						case 0x2: // ENABLE_PUSH
+							if ( val > 1 )
+								return connectionError( Http2Error::protocolError );
+							break;
+						case 0x4: // INITIAL_WINDOW_SIZE; applies to all streams (RFC 7540, 6.9.2)
+						{
+							if ( val > 0x7FFFFFFF )
+								return connectionError( Http2Error::flowControlError );
+							int64_t delta = (int64_t)val - (int64_t)peerInitialWindowSize;
+							peerInitialWindowSize = val;
+							for ( auto& f : streams )
+							{
+								Http2Stream& s = *(f.second);
+								s.sendWindow += delta;
+								if ( s.sendWindow > 0x7FFFFFFF )
+									return connectionError( Http2Error::flowControlError );
+								if ( delta > 0 && s.hasOutput() )
+									enqueue( s );
+							}
+							break;
+						}
+						case 0x5: // MAX_FRAME_SIZE
+							if ( val < 0x4000 || val > 0xFFFFFF )
+								return connectionError( Http2Error::protocolError );
+							peerMaxFrameSize = val;
+							break;
+						default: // MAX_CONCURRENT_STREAMS and MAX_HEADER_LIST_SIZE of the peer are of no use for us, as we do not push and do not send requests
+							break;
+					}
+				}
+				return true;
+			}
+
+			bool onWindowUpdate( uint32_t streamId, const uint8_t* p, size_t len )
+			{
+				if ( len != 4 )
+					return connectionError( Http2Error::frameSizeError );
+				uint32_t increment = read32( p ) & 0x7FFFFFFF;
+				if ( streamId == 0 )
+				{
+					if ( increment == 0 )
+						return connectionError( Http2Error::protocolError );
+					connSendWindow += increment;
+					if ( connSendWindow > 0x7FFFFFFF )
+						return connectionError( Http2Error::flowControlError );
+					if ( readyHead < ready.size() )
+						scheduleFlush();
+					return true;
+				}
+				auto f = streams.find( streamId );
+				if ( f == streams.end() )
+					return streamId <= lastStreamId || connectionError( Http2Error::protocolError ); // ignored for closed streams
+				Http2Stream& s = *(f->second);
+				if ( increment == 0 )
+					return resetStream( streamId, Http2Error::protocolError );
+				s.sendWindow += increment;
+				if ( s.sendWindow > 0x7FFFFFFF )
+					return resetStream( streamId, Http2Error::flowControlError );
+				if ( s.hasOutput() )
+					enqueue( s );
+				return true;
+			}
+
+			bool onHeaders( uint8_t flags, uint32_t streamId, const uint8_t* p, size_t len )
+			{
+				if ( streamId == 0 || ( streamId & 1 ) == 0 )
+					return connectionError( Http2Error::protocolError );
+				size_t pad = 0;
+				if ( flags & FrameFlags::padded )
+				{
+					if ( len < 1 )
+						return connectionError( Http2Error::frameSizeError );
+					pad = p[0];
+					++p;
+					--len;
+				}
+				bool malformed = false;
+				if ( flags & FrameFlags::priorityFlag ) // ignored, except for validation
+				{
+					if ( len < 5 )
+						return connectionError( Http2Error::frameSizeError );
+					malformed = ( read32( p ) & 0x7FFFFFFF ) == streamId; // depends on itself
+					p += 5;
+					len -= 5;
+				}
+				if ( pad > len )
+					return connectionError( Http2Error::protocolError );
+				len -= pad;
+				bool endOfStream = ( flags & FrameFlags::endStream ) != 0;
+				if ( flags & FrameFlags::endHeaders )
+					return onHeaderBlock( streamId, endOfStream, malformed, p, len );
+				headerBlockIn.clear();
+				headerBlockIn.append( p, len );
+				headerBlockStream = streamId;
+				headerBlockEndStream = endOfStream;
+				headerBlockMalformed = malformed;
+				return true;
+			}
+
+			bool onHeaderBlock( uint32_t streamId, bool endOfStream, bool malformed, const uint8_t* block, size_t sz )
+			{
+				fields.clear();
+				bool tooLarge = false;
+				if ( !decoder.decode( block, sz, tooLarge, [this]( const nodecpp::string& name, const nodecpp::string& value ) { fields.push_back( std::make_pair( name, value ) ); } ) )
+					return connectionError( Http2Error::compressionError ); // HPACK state is broken
+				if ( malformed || tooLarge ) // HPACK state is fine, so it is a stream error
+				{
+					if ( streamId > lastStreamId )
+						lastStreamId = streamId;
+					if ( tooLarge )
+						fields.clear();
+					resetStream( streamId, tooLarge ? Http2Error::enhanceYourCalm : Http2Error::protocolError );
+					return !tooLarge || onStreamAborted();
+				}
+				auto f = streams.find( streamId );
+				if ( f != streams.end() )
+					return onTrailers( *(f->second), endOfStream );
+				if ( streamId <= lastStreamId ) // closed (e.g. reset by us, while the peer has been sending it)
+					return true;
+				lastStreamId = streamId;
+				if ( goawayReceived )
+					return true;
+				if ( streams.size() >= maxConcurrentStreams )
+				{
+					resetStream( streamId, Http2Error::refusedStream );
+					return onStreamAborted();
+				}
+				Http2Stream& s = *acquireStream( streamId );
+				if ( !s.request->h2Fill( fields, endOfStream ) ) // malformed (RFC 7540, 8.1.2.6)
+				{
+					s.responseDone = true; // no handler is involved
+					return resetStream( streamId, Http2Error::protocolError );
+				}
+				s.recvEnded = endOfStream;
+				server->onNewRequest( s.request, s.response );
+				return true;
+			}
+
+			bool onTrailers( Http2Stream& s, bool endOfStream )
+			{
+				if ( s.recvEnded )
+					return resetStream( s.id, Http2Error::streamClosed );
+				if ( !endOfStream )
+					return resetStream( s.id, Http2Error::protocolError );
+				for ( auto& f : fields )
+					if ( f.first.empty() || f.first[0] == ':' )
+						return resetStream( s.id, Http2Error::protocolError );
+				if ( s.reset )
+					return true;
+				for ( auto& f : fields )
+					s.request->trailers.insert( f );
+				s.recvEnded = true;
+				if ( s.responseDone )
+					maybeRelease( s );
+				else
+					wakeRecv( s, false );
+				return true;
+			}
+
+			bool onData( uint8_t flags, uint32_t streamId, const uint8_t* p, size_t len )
+			{
+				if ( streamId == 0 )
+					return connectionError( Http2Error::protocolError );
+				// connection window is replenished regardless of what happens to the data; streams' windows bound memory in use
+				connRecvWindow -= len;
+				if ( connRecvWindow < 0 )
+					return connectionError( Http2Error::flowControlError );
+				connRecvConsumed += len;
+				if ( connRecvConsumed >= connectionWindowSize / 2 )
+				{
+					queueWindowUpdate( 0, (uint32_t)connRecvConsumed );
+					connRecvWindow += connRecvConsumed;
+					connRecvConsumed = 0;
+				}
+				size_t pad = 0;
+				if ( flags & FrameFlags::padded )
+				{
+					if ( len < 1 || p[0] >= len )
+						return connectionError( Http2Error::protocolError );
+					pad = (size_t)p[0] + 1; // including the length itself
+				}
+				auto f = streams.find( streamId );
+				if ( f == streams.end() )
+					return streamId <= lastStreamId || connectionError( Http2Error::protocolError ); // ignored for closed streams
+				Http2Stream& s = *(f->second);
+				if ( s.recvEnded )
+					return resetStream( streamId, Http2Error::streamClosed );
+				if ( s.reset )
+					return true;
+				if ( (int64_t)len > s.recvWindow )
+					return resetStream( streamId, Http2Error::flowControlError );
+				s.recvWindow -= len;
+				creditStream( s, pad );
+				s.recvEnded = ( flags & FrameFlags::endStream ) != 0;
+				if ( s.responseDone ) // nobody is interested
+				{
+					creditStream( s, len - pad );
+					maybeRelease( s );
+					return true;
+				}
+				s.recvData.append( p + ( pad ? 1 : 0 ), len - pad );
+				wakeRecv( s, false );
+				return true;
+			}
+
+			void creditStream( Http2Stream& s, size_t consumed ) // request body is consumed by the handler
+			{
+				if ( s.reset || s.recvEnded || dead )
+					return;
+				s.recvConsumed += consumed;
+				if ( s.recvConsumed >= streamWindowSize / 2 )
+				{
+					queueWindowUpdate( s.id, (uint32_t)s.recvConsumed );
+					s.recvWindow += s.recvConsumed;
+					s.recvConsumed = 0;
+				}
+			}
+
+			// sending
+
+			void enqueue( Http2Stream& s )
+			{
+				if ( !s.queued )
+				{
+					s.queued = true;
+					ready.push_back( &s );
+				}
+				scheduleFlush();
+			}
+
+			void queueHeaders( Http2Stream& s, Buffer&& block, bool endOfStream )
+			{
+				if ( s.reset || dead )
+					return;
+				s.headerBlock = std::move( block );
+				s.headersPending = true;
+				s.headersEndStream = endOfStream;
+				s.endStreamPending = endOfStream;
+				enqueue( s );
+			}
+
+			void queueData( Http2Stream& s, BufferView b, bool endOfStream )
+			{
+				if ( s.reset || dead )
+					return;
+				if ( b.size() )
+					s.out.append( b.begin(), b.size() );
+				if ( endOfStream )
+					s.endStreamPending = true;
+				if ( s.hasOutput() )
+					enqueue( s );
+			}
+
+			void queueTrailers( Http2Stream& s, Buffer&& block )
+			{
+				if ( s.reset || dead )
+					return;
+				s.trailerBlock = std::move( block );
+				s.trailersPending = true;
+				s.endStreamPending = true;
+				enqueue( s );
+			}
+
+			void onResponseFinalized( Http2Stream& s )
+			{
+				s.responseDone = true;
+				if ( s.heldData.size() || s.recvData.size() )
+				{
+					s.heldData.clear();
+					s.recvData.clear();
+				}
+				maybeRelease( s );
+			}
+
+			void scheduleFlush()
+			{
+				if ( flushScheduled || dead )
+					return;
+				flushScheduled = true;
+				nodecpp::safememory::soft_ptr<Http2Session> me = myThis.getSoftPtr<Http2Session>(this);
+				nodecpp::setInmediate( [me]() { me->flush(); } );
+			}
+
+			uint8_t* nextFrameHeader( size_t len, uint8_t type, uint8_t flags, uint32_t streamId )
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, framesInFlush < maxFramesPerFlush );
+				uint8_t* h = frameHeaders[framesInFlush++];
+				appendFrameHeader( h, len, type, flags, streamId );
+				segs.push_back( BufferView( h, frameHeaderSize ) );
+				return h;
+			}
+
+			void emitHeaderBlock( Http2Stream& s, const Buffer& block, bool endOfStream ) // HEADERS followed by CONTINUATION frames, if necessary
+			{
+				size_t offset = 0;
+				do
+				{
+					size_t sz = block.size() - offset < peerMaxFrameSize ? block.size() - offset : peerMaxFrameSize;
+					uint8_t flags = ( offset + sz == block.size() ) ? FrameFlags::endHeaders : 0;
+					if ( offset == 0 && endOfStream )
+						flags |= FrameFlags::endStream;
+					nextFrameHeader( sz, offset == 0 ? FrameType::headers : FrameType::continuation, flags, s.id );
+					if ( sz )
+						segs.push_back( BufferView( block.begin() + offset, sz ) );
+					offset += sz;
+				}
+				while ( offset < block.size() );
+			}
+
+			size_t framesNeeded( const Http2Stream& s ) const // at most, to serve s once
+			{
+				size_t ret = quantum / peerMaxFrameSize + 2;
+				if ( s.headersPending )
+					ret += s.headerBlock.size() / peerMaxFrameSize + 1;
+				if ( s.trailersPending )
+					ret += s.trailerBlock.size() / peerMaxFrameSize + 1;
+				return ret;
+			}
+
+			bool serveStream( Http2Stream& s, size_t& budget ) // adds frames of s to segs; returns true if any
+			{
+				size_t framesBefore = framesInFlush;
+				if ( s.headersPending )
+				{
+					emitHeaderBlock( s, s.headerBlock, s.headersEndStream );
+					s.headersPending = false;
+					if ( s.headersEndStream )
+						s.endStreamSent = true;
+				}
+				size_t toSend = s.outPending();
+				if ( toSend > quantum )
+					toSend = quantum;
+				if ( toSend > budget )
+					toSend = budget;
+				if ( s.sendWindow < (int64_t)toSend )
+					toSend = s.sendWindow > 0 ? (size_t)s.sendWindow : 0;
+				if ( connSendWindow < (int64_t)toSend )
+					toSend = connSendWindow > 0 ? (size_t)connSendWindow : 0;
+				while ( toSend )
+				{
+					size_t sz = toSend < peerMaxFrameSize ? toSend : peerMaxFrameSize;
+					bool last = sz == s.outPending() && s.endStreamPending && !s.trailersPending;
+					nextFrameHeader( sz, FrameType::data, last ? FrameFlags::endStream : 0, s.id );
+					segs.push_back( BufferView( s.out.begin() + s.outOffset, sz ) );
+					s.outOffset += sz;
+					s.sendWindow -= sz;
+					connSendWindow -= sz;
+					budget -= sz;
+					toSend -= sz;
+					if ( last )
+						s.endStreamSent = true;
+				}
+				if ( s.outPending() == 0 && s.endStreamPending && !s.endStreamSent )
+				{
+					if ( s.trailersPending )
+					{
+						emitHeaderBlock( s, s.trailerBlock, true );
+						s.trailersPending = false;
+					}
+					else
+						nextFrameHeader( 0, FrameType::data, FrameFlags::endStream, s.id );
+					s.endStreamSent = true;
+				}
+				return framesInFlush != framesBefore;
+			}
+
+			void compactOutput( Http2Stream& s )
+			{
+				if ( s.outOffset == s.out.size() )
+				{
+					s.out.clear();
+					s.outOffset = 0;
+				}
+				else if ( s.outOffset >= streamBufferLimit )
+				{
+					Buffer rest( s.outPending() );
+					rest.append( s.out.begin() + s.outOffset, s.outPending() );
+					s.out = std::move( rest );
+					s.outOffset = 0;
+				}
+			}
+
+			nodecpp::handler_ret_type flush()
+			{
+				flushScheduled = false;
+				if ( flushInProgress ) // will be picked up by the running one
+					CO_RETURN;
+				if ( dead )
+				{
+					checkQuiesced();
+					CO_RETURN;
+				}
+				flushInProgress = true;
+				for (;;)
+				{
+					segs.clear();
+					flushed.clear();
+					framesInFlush = 0;
+					std::swap( ctrlOut, ctrlSending );
+					if ( ctrlSending.size() )
+						segs.push_back( BufferView( ctrlSending ) );
+
+					// round-robin over streams having something to send; those blocked by their own window leave the queue till WINDOW_UPDATE
+					size_t budget = maxBytesPerFlush;
+					bool progress = true;
+					while ( progress && budget && readyHead < ready.size() )
+					{
+						progress = false;
+						size_t roundEnd = ready.size();
+						while ( readyHead < roundEnd && budget )
+						{
+							Http2Stream* s = ready[readyHead];
+							if ( s == nullptr )
+							{
+								++readyHead;
+								continue;
+							}
+							if ( framesInFlush + framesNeeded( *s ) > maxFramesPerFlush )
+							{
+								budget = 0; // the rest goes with the next write
+								break;
+							}
+							++readyHead;
+							s->queued = false;
+							if ( s->reset )
+								continue;
+							if ( serveStream( *s, budget ) )
+							{
+								progress = true;
+								flushed.push_back( s );
+							}
+							if ( s->headersPending || s->trailersPending || ( s->endStreamPending && !s->endStreamSent && s->outPending() == 0 ) ||
+								( s->outPending() && s->sendWindow > 0 ) )
+							{
+								s->queued = true;
+								ready.push_back( s );
+							}
+						}
+					}
+					if ( readyHead == ready.size() )
+					{
+						ready.clear();
+						readyHead = 0;
+					}
+					else if ( readyHead > maxConcurrentStreams )
+					{
+						ready.erase( ready.begin(), ready.begin() + readyHead );
+						readyHead = 0;
+					}
+					if ( segs.empty() )
+						break;
+
+					try {
+						co_await sock.a_writevCopyingRest( segs.data(), segs.size() ); // streams' output may grow meanwhile
+					}
+					catch(...) {
+						flushInProgress = false;
+						checkQuiesced();
+						CO_RETURN; // reading part learns about that on its own
+					}
+					ctrlSending.clear();
+					for ( auto s : flushed )
+					{
+						if ( !s->active )
+							continue;
+						compactOutput( *s );
+						if ( s->outPending() < streamBufferLimit )
+							wakeDrain( *s );
+						maybeRelease( *s );
+					}
+					if ( dead )
+						break;
+				}
+				flushInProgress = false;
+				checkQuiesced();
+				CO_RETURN;
+			}
+
+			void startUpgraded( IncomingHttpMessageAtServer& upgraded ) // the request of 'Upgrade: h2c' becomes stream 1 (RFC 7540, 3.2)
+			{
+				const nodecpp::string* settings = upgraded.getHeader( "http2-settings" );
+				Buffer payload;
+				if ( settings == nullptr || !internal_usage_only::base64UrlDecode( std::string_view( *settings ), payload ) || payload.size() % 6 )
+				{
+					connectionError( Http2Error::protocolError );
+					return;
+				}
+				if ( !applySettings( payload.begin(), payload.size() ) ) // not acknowledged, as not sent as a frame
+					return;
+				lastStreamId = 1;
+				Http2Stream& s = *acquireStream( 1 );
+				s.request->h2FromUpgraded( upgraded );
+				s.recvEnded = true;
+				server->onNewRequest( s.request, s.response );
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		inline
+		nodecpp::handler_ret_type HttpSocketBase::runHttp2( IncomingHttpMessageAtServer* upgraded )
+		{
+			clearDeadline(); // HTTP/1 deadlines are not applicable anymore; the session sets its own (see Http2Session::updateDeadline())
+			dataForCommandProcessing.readBuffer.reserve( Http2Session::frameHeaderSize + Http2Session::maxFrameSize );
+			auto server = nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket);
+			nodecpp::safememory::owning_ptr<Http2Session> session = nodecpp::safememory::make_owning<Http2Session>( *this, myThis.getSoftPtr<HttpSocketBase>(this), server );
+			h2session = &*session;
+			co_await session->run( upgraded );
+			h2session = nullptr;
+			clearDeadline();
+			CO_RETURN;
+		}
+
+		inline
+		void HttpSocketBase::h2OnIdleDeadline()
+		{
+			h2session->onIdleDeadline();
+		}
+
+		inline
+		bool HttpSocketBase::isHttp2Preface( const CircularByteBuffer::AvailableDataDescriptor& d )
+		{
+			return Http2Session::isPreface( d );
+		}
+
+		inline
+		bool IncomingHttpMessageAtServer::h2Fill( const nodecpp::vector<std::pair<nodecpp::string, nodecpp::string>>& fields, bool endOfStream )
+		{
+			bool regularSeen = false;
+			bool schemeSeen = false;
+			const nodecpp::string* authority = nullptr;
+			for ( auto& f : fields )
+			{
+				const nodecpp::string& name = f.first;
+				if ( name.empty() )
+					return false;
+				if ( name[0] == ':' ) // pseudo-headers go first, each once
+				{
+					if ( regularSeen )
+						return false;
+					if ( name == ":method" && method.name.empty() )
+						method.name = f.second;
+					else if ( name == ":path" && method.url.empty() )
+						method.url = f.second;
+					else if ( name == ":scheme" && !schemeSeen )
+						schemeSeen = true;
+					else if ( name == ":authority" && authority == nullptr )
+						authority = &(f.second);
+					else
+						return false;
+					continue;
+				}
+				regularSeen = true;
+				for ( char c : name )
+					if ( c >= 'A' && c <= 'Z' )
+						return false;
+				if ( name == "connection" || name == "keep-alive" || name == "proxy-connection" || name == "transfer-encoding" || name == "upgrade" ||
+					( name == "te" && f.second != "trailers" ) )
+					return false;
+				if ( name == "cookie" ) // may be split into several fields (RFC 7540, 8.1.2.5)
+				{
+					auto c = header.find( name );
+					if ( c != header.end() )
+					{
+						c->second.append( "; " );
+						c->second.append( f.second );
+						continue;
+					}
+				}
+				header.insert( f );
+			}
+			if ( method.name.empty() || ( method.name != "CONNECT" && ( method.url.empty() || !schemeSeen ) ) )
+				return false;
+			if ( authority != nullptr && header.find( "host" ) == header.end() )
+				header.insert( std::make_pair( nodecpp::string( "host" ), *authority ) );
+			method.version = "2.0";
+			parseContentLength();
+			readStatus = endOfStream ? ReadStatus::completed : ReadStatus::in_body;
+			return true;
+		}
+
+		inline
+		void IncomingHttpMessageAtServer::h2FromUpgraded( IncomingHttpMessageAtServer& upgraded )
+		{
+			*this = std::move( upgraded );
+			upgraded.clear();
+			header.erase( "connection" );
+			header.erase( "upgrade" );
+			header.erase( "http2-settings" );
+			method.version = "2.0";
+			readStatus = ReadStatus::completed;
+		}
+
+		inline
+		nodecpp::handler_ret_type IncomingHttpMessageAtServer::h2ReadBody( Buffer& b )
+		{
+			Http2Stream& s = *h2stream;
+			h2ReleaseBodyChunk();
+			b.clear();
+			if ( readStatus != ReadStatus::in_body )
+				CO_RETURN;
+			co_await s.session->a_recv( s );
+			std::swap( b, s.recvData ); // s.recvData gets b's (cleared) storage
+			bodyBytesRetrieved += b.size();
+			s.session->creditStream( s, b.size() );
+			h2CheckBodyCompleted();
+			CO_RETURN;
+		}
+
+		inline
+		::nodecpp::awaitable<bool> IncomingHttpMessageAtServer::h2NextBodyChunk( BufferView& chunk )
+		{
+			Http2Stream& s = *h2stream;
+			h2ReleaseBodyChunk();
+			chunk = BufferView();
+			if ( readStatus != ReadStatus::in_body )
+				CO_RETURN false;
+			co_await s.session->a_recv( s );
+			if ( s.recvData.empty() ) // ended
+			{
+				h2CheckBodyCompleted();
+				CO_RETURN false;
+			}
+			std::swap( s.heldData, s.recvData );
+			chunk = BufferView( s.heldData );
+			bodyBytesRetrieved += chunk.size();
+			CO_RETURN true;
+		}
+
+		inline
+		void IncomingHttpMessageAtServer::h2ReleaseBodyChunk()
+		{
+			Http2Stream& s = *h2stream;
+			if ( s.heldData.size() )
+			{
+				s.session->creditStream( s, s.heldData.size() ); // peer may send more
+				s.heldData.clear();
+			}
+			h2CheckBodyCompleted();
+		}
+
+		inline
+		void IncomingHttpMessageAtServer::h2CheckBodyCompleted()
+		{
+			if ( readStatus == ReadStatus::in_body && h2stream->recvEnded && h2stream->recvData.empty() && h2stream->heldData.empty() )
+				readStatus = ReadStatus::completed;
+		}
+
+		inline
+		void HttpServerResponse::h2EncodeField( std::string_view name, std::string_view value, Buffer& block )
+		{
+			nodecpp::string lowerName( name.data(), name.size() );
+			makeLower( lowerName );
+			if ( lowerName == "connection" || lowerName == "keep-alive" || lowerName == "proxy-connection" || lowerName == "transfer-encoding" || lowerName == "upgrade" )
+				return; // connection-specific (RFC 7540, 8.1.2.2)
+			h2stream->session->encoder.encode( lowerName, value, block );
+		}
+
+		inline
+		void HttpServerResponse::h2EncodeLines( const nodecpp::string& lines, size_t pos, Buffer& block ) // 'Key: value' lines separated by CRLF, starting at pos
+		{
+			while ( pos < lines.size() )
+			{
+				size_t eol = lines.find( "\r\n", pos );
+				if ( eol == nodecpp::string::npos )
+					eol = lines.size();
+				size_t colon = lines.find( ':', pos );
+				if ( colon != nodecpp::string::npos && colon < eol && colon > pos )
+				{
+					size_t valueStart = lines.find_first_not_of( " \t", colon + 1 );
+					if ( valueStart == nodecpp::string::npos || valueStart > eol )
+						valueStart = eol;
+					h2EncodeField( std::string_view( lines.c_str() + pos, colon - pos ), std::string_view( lines.c_str() + valueStart, eol - valueStart ), block );
+				}
+				pos = eol + 2;
+			}
+		}
+
+		inline
+		void HttpServerResponse::h2SerializeHeaders( Buffer& block, bool withLength, size_t length )
+		{
+			HpackEncoder& encoder = h2stream->session->encoder;
+			encoder.beginBlock( block );
+			// replyStatus is 'HTTP/x.y code [message]', possibly followed by header lines (see writeHead())
+			unsigned status = 200;
+			size_t eol = replyStatus.find( "\r\n" );
+			if ( eol == nodecpp::string::npos )
+				eol = replyStatus.size();
+			size_t sp = replyStatus.find( ' ' );
+			if ( sp != nodecpp::string::npos && sp < eol )
+			{
+				unsigned code = (unsigned)::atoi( replyStatus.c_str() + sp + 1 );
+				if ( code >= 100 && code <= 999 )
+					status = code;
+			}
+			encoder.encodeStatus( status, block );
+			h2EncodeLines( replyStatus, eol + 2, block );
+			for ( auto& h : header )
+				h2EncodeField( std::string_view( h.first ), std::string_view( h.second ), block );
+			if ( withLength && status >= 200 && status != 204 )
+			{
+				nodecpp::string len = format( "{}", length );
+				encoder.encode( "content-length", std::string_view( len ), block );
+			}
+			header.clear();
+		}
+
+		inline
+		void HttpServerResponse::h2WriteHeaders()
+		{
+			if ( writeStatus != WriteStatus::notyet )
+				return;
+			Buffer block;
+			h2SerializeHeaders( block, false, 0 );
+			h2stream->session->queueHeaders( *h2stream, std::move( block ), false );
+			writeStatus = WriteStatus::hdr_flushed;
+		}
+
+		inline
+		void HttpServerResponse::h2QueueEnd( BufferView b )
+		{
+			Http2Stream& s = *h2stream;
+			s.session->queueData( s, b, trailers.empty() );
+			if ( trailers.size() )
+			{
+				Buffer block;
+				s.session->encoder.beginBlock( block );
+				h2EncodeLines( trailers, 0, block );
+				s.session->queueTrailers( s, std::move( block ) );
+			}
+		}
+
+		inline
+		nodecpp::handler_ret_type HttpServerResponse::h2WriteBodyPart( BufferView b, bool isLast )
+		{
+			Http2Stream& s = *h2stream;
+			h2WriteHeaders();
+			if ( isLast )
+				h2QueueEnd( b );
+			else
+				s.session->queueData( s, b, false );
+			writeStatus = WriteStatus::in_body;
+			co_await s.session->a_drained( s ); // till not too much is waiting to be sent for this stream
+			CO_RETURN;
+		}
+
+		inline
+		void HttpServerResponse::h2End( BufferView b )
+		{
+			Http2Stream& s = *h2stream;
+			if ( writeStatus == WriteStatus::notyet )
+			{
+				Buffer block;
+				h2SerializeHeaders( block, true, b.size() );
+				bool noBody = b.empty() && trailers.empty();
+				s.session->queueHeaders( s, std::move( block ), noBody );
+				if ( !noBody )
+					h2QueueEnd( b );
+			}
+			else
+				h2QueueEnd( b );
+			writeStatus = WriteStatus::completed;
+			finalize();
+		}
+
+		inline
+		nodecpp::handler_ret_type HttpServerResponse::h2EndWithFile( int fd, uint64_t offset, size_t size, bool headersOnly )
+		{
+			Http2Stream& s = *h2stream;
+			Buffer block;
+			h2SerializeHeaders( block, true, size );
+			bool noBody = headersOnly || size == 0;
+			s.session->queueHeaders( s, std::move( block ), noBody );
+			writeStatus = WriteStatus::in_body;
+			if ( !noBody )
+			{
+				uint8_t chunk[Http2Session::maxFrameSize]; // file is read by parts as they are sent
+				while ( size && !s.reset )
+				{
+					size_t toRead = size < sizeof( chunk ) ? size : sizeof( chunk );
+					int64_t rd = internal_usage_only::h2FileRead( fd, offset, chunk, toRead );
+					if ( rd <= 0 ) // promised Content-Length cannot be met
+					{
+						s.session->resetStream( s.id, Http2Error::internalError );
+						break;
+					}
+					offset += rd;
+					size -= (size_t)rd;
+					s.session->queueData( s, BufferView( chunk, (size_t)rd ), size == 0 );
+					co_await s.session->a_drained( s );
+				}
+			}
+			writeStatus = WriteStatus::completed;
+			finalize();
+			CO_RETURN;
+		}
+
+		inline
+		void HttpServerResponse::h2Finalize()
+		{
+			myRequest->h2ReleaseBodyChunk();
+			h2stream->session->onResponseFinalized( *h2stream ); // the pair is cleared once the stream is released
+		}
+
+	} //namespace net
+} //namespace nodecpp
+
+#endif // NODECPP_NO_COROUTINES
+
+#endif // HTTP2_H
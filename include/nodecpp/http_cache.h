@@ -0,0 +1,412 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+#include "common.h"
+#include "net_common.h"
+#include "timers.h"
+
+#include <string_view>
+#include <algorithm>
+
+namespace nodecpp {
+
+	namespace net {
+
+		class IncomingHttpMessageAtServer; // forward declaration
+		class HttpServerResponse; // forward declaration
+		class HttpSocketBase; // forward declaration
+
+		/*
+			Micro-cache of fully serialized responses to GET requests (see HttpServerBase::enableResponseCache()).
+			Key is made of method, HTTP version, URL (without fragment, with query items sorted) and values of selected request headers.
+			Entries live for ttlMs and are evicted in LRU order to keep total size within maxBytes; an entry being sent
+			is kept alive (retired) till all its users are done. While a response for a key is being produced, requests
+			for the same key wait for it instead of invoking the handler (request coalescing).
+			Only '200' keep-alive responses completed with a single end() call and having no Set-Cookie and
+			no 'Cache-Control: no-store/no-cache/private' are cached; hop-by-hop Connection and Keep-Alive headers are not stored.
+			Responses varying by request headers other than keyHeaders (including 'Vary: *') are not cached, as the key would not tell them apart.
+			Requests with credentials (Authorization or Cookie headers) are served from the cache, and their responses are cached,
+			only if the response is explicitly shared ('Cache-Control: public' or 's-maxage'); otherwise they bypass the cache.
+			Waiters of a connection are removed when the connection is destroyed (see removeWaitersOf()).
+		*/
+		class HttpResponseCache
+		{
+		public:
+			struct Options
+			{
+				size_t ttlMs = 1000;
+				size_t maxBytes = 16 * 1024 * 1024;
+				size_t maxEntryBytes = 1024 * 1024;
+				nodecpp::vector<nodecpp::string> keyHeaders; // lower-case names of request headers to be a part of the key (e.g. "accept-encoding")
+			};
+
+			struct Waiter
+			{
+				nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request;
+				nodecpp::safememory::soft_ptr<HttpServerResponse> response;
+				const HttpSocketBase* socket = nullptr; // owner of request and response; for identification only
+			};
+
+			struct Entry
+			{
+				nodecpp::string key;
+				nodecpp::Buffer bytes; // serialized headers and body
+				size_t expiresAt = 0;
+				size_t users = 0; // responses being sent from bytes
+				bool ready = false; // false while the response is being produced
+				bool credentialed = false; // is being produced for a request with credentials
+				bool shared = false; // may be served to requests with credentials
+				Entry* lruPrev = nullptr; // towards more recently used
+				Entry* lruNext = nullptr;
+				nodecpp::vector<Waiter> waiters; // requests for the same key arrived while !ready
+			};
+
+			enum class LookupResult { hit, pending, miss, bypass };
+
+		private:
+			Options options;
+			bool enabled = false;
+			nodecpp::map<nodecpp::string, nodecpp::safememory::owning_ptr<Entry>> entries;
+			nodecpp::vector<nodecpp::safememory::owning_ptr<Entry>> retired; // removed, but still being sent
+			Entry* lruHead = nullptr; // most recently used
+			Entry* lruTail = nullptr;
+			size_t totalBytes = 0;
+			nodecpp::string keyBuff; // key of a request being looked up; reused
+
+			void lruUnlink( Entry* e )
+			{
+				( e->lruPrev ? e->lruPrev->lruNext : lruHead ) = e->lruNext;
+				( e->lruNext ? e->lruNext->lruPrev : lruTail ) = e->lruPrev;
+				e->lruPrev = e->lruNext = nullptr;
+			}
+
+			void lruPushFront( Entry* e )
+			{
+				e->lruPrev = nullptr;
+				e->lruNext = lruHead;
+				( lruHead ? lruHead->lruPrev : lruTail ) = e;
+				lruHead = e;
+			}
+
+			void remove( nodecpp::map<nodecpp::string, nodecpp::safememory::owning_ptr<Entry>>::iterator it )
+			{
+				nodecpp::safememory::owning_ptr<Entry> e = std::move( it->second );
+				entries.erase( it );
+				if ( e->ready )
+				{
+					lruUnlink( &*e );
+					totalBytes -= e->bytes.size();
+				}
+				if ( e->users )
+					retired.push_back( std::move( e ) );
+			}
+
+			void sweepRetired()
+			{
+				for ( size_t i=0; i<retired.size(); )
+					if ( retired[i]->users == 0 )
+					{
+						retired[i] = std::move( retired.back() );
+						retired.pop_back();
+					}
+					else
+						++i;
+			}
+
+			static bool startsWithNoCase( std::string_view s, std::string_view lowerPrefix )
+			{
+				if ( s.size() < lowerPrefix.size() )
+					return false;
+				for ( size_t i=0; i<lowerPrefix.size(); ++i )
+					if ( ( s[i] | ( s[i] >= 'A' && s[i] <= 'Z' ? 0x20 : 0 ) ) != lowerPrefix[i] )
+						return false;
+				return true;
+			}
+
+			static bool containsNoCase( std::string_view hay, std::string_view lowerNeedle )
+			{
+				for ( size_t i=0; i + lowerNeedle.size() <= hay.size(); ++i )
+				{
+					size_t j = 0;
+					while ( j < lowerNeedle.size() && ( hay[i+j] | ( hay[i+j] >= 'A' && hay[i+j] <= 'Z' ? 0x20 : 0 ) ) == lowerNeedle[j] )
+						++j;
+					if ( j == lowerNeedle.size() )
+						return true;
+				}
+				return false;
+			}
+
+			// calls f for each item of a comma-separated header value, with whitespace trimmed; stops if f returns false
+			template<class F>
+			static bool forEachListItem( std::string_view value, F f )
+			{
+				while ( value.size() )
+				{
+					size_t comma = value.find( ',' );
+					std::string_view item = value.substr( 0, comma );
+					while ( item.size() && ( item.front() == ' ' || item.front() == '\t' ) )
+						item.remove_prefix( 1 );
+					while ( item.size() && ( item.back() == ' ' || item.back() == '\t' || item.back() == '\r' || item.back() == '\n' ) )
+						item.remove_suffix( 1 );
+					if ( item.size() && !f( item ) )
+						return false;
+					if ( comma == std::string_view::npos )
+						break;
+					value.remove_prefix( comma + 1 );
+				}
+				return true;
+			}
+
+			static bool equalsNoCase( std::string_view s, std::string_view lower ) { return s.size() == lower.size() && startsWithNoCase( s, lower ); }
+
+			// calls f for each line of serialized headers after the status line (without LF)
+			template<class F>
+			static void forEachHeaderLine( std::string_view hdrs, F f )
+			{
+				size_t eol = hdrs.find( '\n' ); // status line
+				while ( eol != std::string_view::npos )
+				{
+					hdrs.remove_prefix( eol + 1 );
+					eol = hdrs.find( '\n' );
+					f( hdrs.substr( 0, eol ) );
+				}
+			}
+
+			// 'Cache-Control: public' or 's-maxage' (RFC 9111, 3.5)
+			static bool isExplicitlyShared( std::string_view hdrs )
+			{
+				bool shared = false;
+				forEachHeaderLine( hdrs, [&shared]( std::string_view line ) {
+					if ( startsWithNoCase( line, "cache-control:" ) )
+						forEachListItem( line.substr( 14 ), [&shared]( std::string_view item ) {
+							if ( equalsNoCase( item, "public" ) || startsWithNoCase( item, "s-maxage" ) )
+								shared = true;
+							return !shared;
+						} );
+				} );
+				return shared;
+			}
+
+		public:
+			HttpResponseCache() {}
+			HttpResponseCache(const HttpResponseCache&) = delete;
+			HttpResponseCache& operator = (const HttpResponseCache&) = delete;
+
+			void enable( Options options_ ) { options = std::move( options_ ); enabled = true; }
+			bool isEnabled() const { return enabled; }
+			const Options& getOptions() const { return options; }
+
+			// key is built with startKey() and a number of appendKeyPart() calls (one per Options::keyHeaders), then lookup() is called
+			void startKey( std::string_view method, std::string_view version, std::string_view url )
+			{
+				keyBuff.assign( method.data(), method.size() );
+				keyBuff.push_back( ' ' );
+				keyBuff.append( version.data(), version.size() );
+				keyBuff.push_back( ' ' );
+				size_t hash = url.find( '#' );
+				if ( hash != std::string_view::npos )
+					url = url.substr( 0, hash );
+				size_t q = url.find( '?' );
+				keyBuff.append( url.data(), q == std::string_view::npos ? url.size() : q );
+				if ( q == std::string_view::npos )
+					return;
+				constexpr size_t maxItems = 32;
+				std::string_view items[maxItems];
+				size_t cnt = 0;
+				std::string_view query = url.substr( q + 1 );
+				while ( query.size() )
+				{
+					size_t amp = query.find( '&' );
+					std::string_view item = query.substr( 0, amp );
+					if ( item.size() )
+					{
+						if ( cnt == maxItems ) // too many to normalize; kept as is
+						{
+							keyBuff.append( url.data() + q, url.size() - q );
+							return;
+						}
+						items[cnt++] = item;
+					}
+					if ( amp == std::string_view::npos )
+						break;
+					query.remove_prefix( amp + 1 );
+				}
+				std::sort( items, items + cnt );
+				for ( size_t i=0; i<cnt; ++i )
+				{
+					keyBuff.push_back( i ? '&' : '?' );
+					keyBuff.append( items[i].data(), items[i].size() );
+				}
+			}
+
+			void appendKeyPart( std::string_view part )
+			{
+				keyBuff.push_back( '\n' );
+				keyBuff.append( part.data(), part.size() );
+			}
+
+			// on miss, a not-ready entry is created; the caller is then expected to call either complete() or abandon() for it;
+			// on bypass (only for requests with credentials), the request is to be processed without the cache
+			LookupResult lookup( nodecpp::safememory::soft_ptr<Entry>& entry, bool credentialed = false )
+			{
+				if ( retired.size() )
+					sweepRetired();
+				auto f = entries.find( keyBuff );
+				if ( f != entries.end() )
+				{
+					if ( !f->second->ready )
+					{
+						if ( credentialed ) // whether what is being produced may be shared is not known yet
+							return LookupResult::bypass;
+						entry = f->second;
+						return LookupResult::pending;
+					}
+					if ( nodecpp::time::now() < f->second->expiresAt )
+					{
+						if ( credentialed && !f->second->shared )
+							return LookupResult::bypass;
+						lruUnlink( &*(f->second) );
+						lruPushFront( &*(f->second) );
+						entry = f->second;
+						return LookupResult::hit;
+					}
+					remove( f );
+				}
+				nodecpp::safememory::owning_ptr<Entry> e = nodecpp::safememory::make_owning<Entry>();
+				e->key = keyBuff;
+				e->credentialed = credentialed;
+				auto ins = entries.insert( std::make_pair( keyBuff, std::move( e ) ) );
+				entry = ins.first->second;
+				return LookupResult::miss;
+			}
+
+			void addWaiter( nodecpp::safememory::soft_ptr<Entry> entry, nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response, const HttpSocketBase* socket )
+			{
+				Waiter w;
+				w.request = request;
+				w.response = response;
+				w.socket = socket;
+				entry->waiters.push_back( std::move( w ) );
+			}
+
+			// to be called before request and response objects of a socket are destroyed; returns the number of removed waiters
+			size_t removeWaitersOf( const HttpSocketBase* socket )
+			{
+				size_t removed = 0;
+				for ( auto& e : entries )
+				{
+					if ( e.second->ready )
+						continue;
+					auto& waiters = e.second->waiters;
+					for ( size_t i=0; i<waiters.size(); )
+						if ( waiters[i].socket == socket )
+						{
+							waiters.erase( waiters.begin() + i );
+							++removed;
+						}
+						else
+							++i;
+				}
+				return removed;
+			}
+
+			// serialized headers as produced by HttpServerResponse; credentialed is of the request the response is for
+			bool isCacheable( BufferView headers, size_t bodySize, bool credentialed ) const
+			{
+				if ( headers.size() + bodySize > options.maxEntryBytes )
+					return false;
+				std::string_view hdrs( reinterpret_cast<const char*>( headers.begin() ), headers.size() );
+				size_t sp = hdrs.find( ' ' );
+				if ( hdrs.substr( 0, 5 ) != "HTTP/" || sp == std::string_view::npos || hdrs.substr( sp + 1, 4 ) != "200 " )
+					return false;
+				if ( containsNoCase( hdrs, "\nset-cookie:" ) )
+					return false;
+				if ( containsNoCase( hdrs, "\ncache-control:" ) && ( containsNoCase( hdrs, "no-store" ) || containsNoCase( hdrs, "no-cache" ) || containsNoCase( hdrs, "private" ) ) )
+					return false; // NOTE: conservative: these words anywhere in headers disable caching
+				if ( credentialed && !isExplicitlyShared( hdrs ) )
+					return false;
+				bool keyed = true; // by what the response varies is a part of the key
+				forEachHeaderLine( hdrs, [this, &keyed]( std::string_view line ) {
+					if ( keyed && startsWithNoCase( line, "vary:" ) )
+						keyed = forEachListItem( line.substr( 5 ), [this]( std::string_view name ) {
+							for ( auto& keyHeader : options.keyHeaders )
+								if ( equalsNoCase( name, keyHeader ) )
+									return true;
+							return false; // including '*'
+						} );
+				} );
+				return keyed;
+			}
+
+			// makes entry ready; waiters are moved to waiters_ and are to be served from entry
+			void complete( nodecpp::safememory::soft_ptr<Entry> entry, BufferView headers, BufferView body, nodecpp::vector<Waiter>& waiters_ )
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, !entry->ready ); 
+				entry->bytes = nodecpp::Buffer( headers.size() + body.size() );
+				std::string_view hdrs( reinterpret_cast<const char*>( headers.begin() ), headers.size() );
+				while ( hdrs.size() ) // hop-by-hop headers describe the connection the response was produced for, not the response
+				{
+					size_t eol = hdrs.find( '\n' );
+					std::string_view line = hdrs.substr( 0, eol == std::string_view::npos ? hdrs.size() : eol + 1 );
+					if ( !startsWithNoCase( line, "connection:" ) && !startsWithNoCase( line, "keep-alive:" ) )
+						entry->bytes.append( line.data(), line.size() );
+					hdrs.remove_prefix( line.size() );
+				}
+				entry->bytes.append( body.begin(), body.size() );
+				entry->expiresAt = nodecpp::time::now() + options.ttlMs;
+				entry->shared = isExplicitlyShared( std::string_view( reinterpret_cast<const char*>( headers.begin() ), headers.size() ) );
+				entry->ready = true;
+				waiters_ = std::move( entry->waiters );
+				entry->waiters.clear();
+				lruPushFront( &*entry );
+				totalBytes += entry->bytes.size();
+				while ( totalBytes > options.maxBytes && lruTail != &*entry )
+					remove( entries.find( lruTail->key ) );
+			}
+
+			// removes not-ready entry; waiters are moved to waiters_ and are to be processed without cache
+			void abandon( nodecpp::safememory::soft_ptr<Entry> entry, nodecpp::vector<Waiter>& waiters_ )
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, !entry->ready ); 
+				waiters_ = std::move( entry->waiters );
+				entry->waiters.clear();
+				auto f = entries.find( entry->key );
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, f != entries.end() ); 
+				remove( f );
+			}
+
+			size_t size() const { return entries.size(); }
+			size_t bytes() const { return totalBytes; }
+		};
+
+	} //namespace net
+} //namespace nodecpp
+
+#endif // HTTP_CACHE_H
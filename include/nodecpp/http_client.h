@@ -0,0 +1,762 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include "http_server_common.h"
+#include "timers.h"
+
+#include <exception>
+#include <cstdio>
+
+namespace nodecpp {
+
+	namespace net {
+
+		class HttpClient; // forward declaration
+		class HttpClientSocket; // forward declaration
+		class HttpClientResponse; // forward declaration
+
+		struct HttpClientRequest
+		{
+			nodecpp::string method = "GET";
+			nodecpp::string path = "/";
+			nodecpp::string host; // value of 'Host' header; "ip:port", if empty
+			nodecpp::vector<std::pair<nodecpp::string, nodecpp::string>> headers; // Host and Content-Length are added automatically
+			BufferView body; // must remain valid till a_request() returns
+			uint32_t timeoutMs = 0; // till the whole response is read; 0 means HttpClient::Options::requestTimeoutMs
+		};
+
+#ifndef NODECPP_NO_COROUTINES
+
+		// connections to a single ip:port
+		struct HttpClientOrigin
+		{
+			nodecpp::string ip;
+			uint16_t port = 0;
+			nodecpp::vector<nodecpp::safememory::owning_ptr<HttpClientSocket>> conns;
+			nodecpp::vector<awaitable_handle_t> slotWaiters; // requests waiting for a connection to become available
+
+			void purge(); // drops connections that can no longer be used and are not referred to by any response
+			void notifySlot();
+
+			auto a_slot() { 
+
+				struct slot_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					HttpClientOrigin& origin;
+
+					slot_awaiter(HttpClientOrigin& origin_) : origin( origin_ ) {}
+
+					slot_awaiter(const slot_awaiter &) = delete;
+					slot_awaiter &operator = (const slot_awaiter &) = delete;
+
+					~slot_awaiter() {}
+
+					bool await_ready() {
+						return false;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						origin.slotWaiters.push_back( awaiting );
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, myawaiting != nullptr ); 
+						if ( nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+					}
+				};
+				return slot_awaiter(*this);
+			}
+		};
+
+		// client side of a keep-alive connection; requests are written as soon as they are issued, and responses are read in the same order
+		class HttpClientSocket : public HttpSocketCommon
+		{
+			friend class HttpClient;
+			friend class HttpClientResponse;
+			friend struct HttpClientOrigin;
+
+			HttpClientOrigin* origin = nullptr; // origins live as long as the client, which outlives its connections
+			size_t nextSeq = 0; // assigned to the next request written
+			size_t readSeq = 0; // response to this request is (to be) read now
+			nodecpp::vector<uint64_t> deadlines; // of requests in flight, starting from readSeq; 0 means none
+			size_t attached = 0; // responses referring to this socket
+			size_t served = 0; // responses read completely
+			bool connectingNow = true;
+			bool pipelinable = true; // no non-idempotent request is in flight
+			bool broken = false; // no further request can be issued
+
+			struct ReadWaiter
+			{
+				size_t seq;
+				awaitable_handle_t h;
+			};
+			nodecpp::vector<ReadWaiter> readWaiters; // pipelined requests waiting for their responses to be at the head of the stream
+
+		public:
+			static constexpr uint8_t dispatchPolicy = SocketDispatch::awaitables;
+
+			HttpClientSocket() {}
+			virtual ~HttpClientSocket() {}
+
+			size_t inFlight() const { return nextSeq - readSeq; }
+			bool usable() const { return !broken && !connectingNow && dataForCommandProcessing.state == DataForCommandProcessing::State::Connected && !dataForCommandProcessing.remoteEnded; }
+
+		private:
+			auto a_turnToRead( size_t seq ) { 
+
+				struct turn_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					HttpClientSocket& socket;
+					size_t seq;
+
+					turn_awaiter(HttpClientSocket& socket_, size_t seq_) : socket( socket_ ), seq( seq_ ) {}
+
+					turn_awaiter(const turn_awaiter &) = delete;
+					turn_awaiter &operator = (const turn_awaiter &) = delete;
+
+					~turn_awaiter() {}
+
+					bool await_ready() {
+						return socket.readSeq == seq || socket.broken;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						socket.readWaiters.push_back( ReadWaiter{ seq, awaiting } );
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+						if ( socket.broken )
+							throw Error();
+					}
+				};
+				return turn_awaiter(*this, seq);
+			}
+
+			void onResponseRead( bool keepAlive )
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, inFlight() != 0 && !deadlines.empty() ); 
+				deadlines.erase( deadlines.begin() );
+				++readSeq;
+				++served;
+				if ( !keepAlive )
+				{
+					if ( inFlight() )
+						fail(); // pipelined requests will never be responded
+					else
+					{
+						broken = true;
+						if ( !destroyed() )
+							end();
+					}
+					return;
+				}
+				if ( inFlight() == 0 )
+				{
+					pipelinable = true;
+					return;
+				}
+				for ( size_t i=0; i<readWaiters.size(); ++i )
+					if ( readWaiters[i].seq == readSeq )
+					{
+						auto hr = readWaiters[i].h;
+						readWaiters.erase( readWaiters.begin() + i );
+						hr();
+						return;
+					}
+			}
+
+			// closes the connection; all requests in flight on it fail
+			void fail()
+			{
+				++attached; // to keep this alive while waiters are resumed
+				broken = true;
+				deadlines.clear();
+				if ( !destroyed() )
+					destroy();
+				auto waiters = std::move( readWaiters );
+				readWaiters.clear();
+				for ( auto& w : waiters )
+				{
+					nodecpp::setException(w.h, std::exception()); // TODO: switch to our exceptions ASAP!
+					w.h();
+				}
+				--attached;
+			}
+		};
+
+		// response to a request issued by HttpClient::a_request(); the body, if any, is read with a_readBody()
+		class HttpClientResponse : protected HttpMessageBase
+		{
+			friend class HttpClient;
+			friend class HttpClientSocket;
+
+			nodecpp::safememory::soft_ptr<HttpClientSocket> conn;
+
+			enum class BodyKind { none, length, chunked, untilClose };
+			BodyKind bodyKind = BodyKind::none;
+			int statusCode = 0;
+			nodecpp::string statusMessage;
+			nodecpp::string version;
+			header_t trailers;
+			ChunkedDecoder chunkedDecoder;
+			size_t bodyBytesRetrieved = 0;
+			bool keepAlive = false;
+			bool headStarted = false; // at least status line is received
+			bool completed = false;
+
+		public:
+			HttpClientResponse() {}
+			HttpClientResponse(const HttpClientResponse&) = delete;
+			HttpClientResponse& operator = (const HttpClientResponse&) = delete;
+			~HttpClientResponse() { detach( !completed ); } // connection with unread body cannot be reused
+
+			int getStatusCode() const { return statusCode; }
+			const nodecpp::string& getStatusMessage() const { return statusMessage; }
+			const nodecpp::string& getHttpVersion() const { return version; }
+			size_t getContentLength() const { return contentLength; }
+			bool isChunked() const { return bodyKind == BodyKind::chunked; }
+			bool isCompleted() const { return completed; }
+			const header_t& getHeaders() const { return header; }
+			const header_t& getTrailers() const { return trailers; } // available once the whole chunked body is read
+			const nodecpp::string* getHeader( const nodecpp::string& lowerCaseKey ) const
+			{
+				auto it = header.find( lowerCaseKey );
+				return it == header.end() ? nullptr : &(it->second);
+			}
+
+			// reads whatever part of the body is available (waiting for more, if nothing is there) into b; b is empty once the whole body is read
+			nodecpp::handler_ret_type a_readBody( Buffer& b )
+			{
+				b.clear();
+				if ( completed )
+					CO_RETURN;
+				if ( conn == nullptr || conn->broken )
+					throw Error();
+				std::exception_ptr readError;
+				bool done = false;
+				try
+				{
+					CircularByteBuffer::AvailableDataDescriptor d;
+					co_await conn->a_dataAvailable( d );
+					done = consumeBodyPart( d, b );
+				}
+				catch (...)
+				{
+					readError = std::current_exception();
+				}
+				if ( readError )
+				{
+					if ( bodyKind == BodyKind::untilClose && conn != nullptr && conn->dataForCommandProcessing.remoteEnded )
+						done = true; // end of body is marked by closing the connection
+					else
+					{
+						detach( true );
+						std::rethrow_exception( readError );
+					}
+				}
+				if ( done )
+					complete();
+				CO_RETURN;
+			}
+
+			nodecpp::handler_ret_type a_readAll( Buffer& b )
+			{
+				b.clear();
+				Buffer part;
+				for(;;)
+				{
+					co_await a_readBody( part );
+					if ( part.empty() )
+						break;
+					b.append( part );
+				}
+				CO_RETURN;
+			}
+
+		private:
+			void clear()
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, conn == nullptr ); 
+				header.clear();
+				trailers.clear();
+				contentLength = 0;
+				chunked = false;
+				chunkedDecoder.clear();
+				bodyKind = BodyKind::none;
+				statusCode = 0;
+				statusMessage.clear();
+				version.clear();
+				bodyBytesRetrieved = 0;
+				keepAlive = false;
+				headStarted = false;
+				completed = false;
+			}
+
+			void attach( nodecpp::safememory::soft_ptr<HttpClientSocket> c )
+			{
+				conn = c;
+				++(c->attached);
+			}
+
+			void detach( bool abandon )
+			{
+				if ( conn == nullptr )
+					return;
+				nodecpp::safememory::soft_ptr<HttpClientSocket> c = conn;
+				conn = nodecpp::safememory::soft_ptr<HttpClientSocket>();
+				if ( abandon && !c->broken )
+					c->fail();
+				--(c->attached);
+				if ( c->origin )
+					c->origin->notifySlot();
+			}
+
+			void complete()
+			{
+				completed = true;
+				conn->onResponseRead( keepAlive );
+				detach( false );
+			}
+
+			bool parseStatusLine( const nodecpp::string& line ) // "HTTP/1.1 200 OK\r\n"
+			{
+				if ( line.compare( 0, 5, "HTTP/" ) != 0 )
+					return false;
+				size_t sp = line.find( ' ', 5 );
+				if ( sp == nodecpp::string::npos || sp + 4 > line.size() )
+					return false;
+				version = line.substr( 5, sp - 5 );
+				statusCode = 0;
+				for ( size_t i=sp+1; i<sp+4; ++i )
+				{
+					if ( line[i] < '0' || line[i] > '9' )
+						return false;
+					statusCode = statusCode * 10 + line[i] - '0';
+				}
+				size_t msgStart = line.find_first_not_of( ' ', sp + 4 );
+				size_t msgEnd = line.find_last_not_of( "\r\n" );
+				statusMessage = msgStart == nodecpp::string::npos || msgEnd == nodecpp::string::npos || msgEnd < msgStart ? nodecpp::string() : line.substr( msgStart, msgEnd - msgStart + 1 );
+				return true;
+			}
+
+			nodecpp::handler_ret_type a_readHead( bool headRequest )
+			{
+				nodecpp::string line;
+				for(;;)
+				{
+					co_await conn->readLine( line );
+					if ( !parseStatusLine( line ) )
+						throw Error();
+					headStarted = true;
+					for(;;)
+					{
+						co_await conn->readLine( line );
+						HeaderLine r = parseHeaderLine( line );
+						if ( r == HeaderLine::end )
+							break;
+						if ( r == HeaderLine::malformed )
+							throw Error();
+					}
+					if ( statusCode < 100 || statusCode >= 200 || statusCode == 101 )
+						break;
+					header.clear(); // interim response (like '100 Continue') is skipped
+					contentLength = 0;
+					chunked = false;
+				}
+
+				auto cs = header.find( "connection" );
+				nodecpp::string connection = cs == header.end() ? nodecpp::string() : cs->second;
+				makeLower( connection );
+				if ( version == "1.1" )
+					keepAlive = connection.find( "close" ) == nodecpp::string::npos;
+				else
+					keepAlive = connection.find( "keep-alive" ) != nodecpp::string::npos;
+
+				if ( headRequest || statusCode < 200 || statusCode == 204 || statusCode == 304 )
+					bodyKind = BodyKind::none;
+				else if ( chunked )
+					bodyKind = BodyKind::chunked;
+				else if ( header.find( "content-length" ) != header.end() )
+					bodyKind = contentLength ? BodyKind::length : BodyKind::none;
+				else
+				{
+					bodyKind = BodyKind::untilClose;
+					keepAlive = false;
+				}
+				if ( statusCode == 101 )
+					keepAlive = false; // the connection is not HTTP anymore
+
+				if ( bodyKind == BodyKind::none )
+					complete();
+				CO_RETURN;
+			}
+
+			// moves the body part available in d into b; returns true once the whole body is read
+			bool consumeBodyPart( const CircularByteBuffer::AvailableDataDescriptor& d, Buffer& b )
+			{
+				size_t consumed = 0;
+				if ( bodyKind == BodyKind::chunked )
+				{
+					auto onData = [&b]( const uint8_t* ptr, size_t sz ) { b.append( ptr, sz ); };
+					consumed = chunkedDecoder.feed( d.ptr1, d.sz1, onData, trailers );
+					if ( consumed == d.sz1 && d.ptr2 && d.sz2 )
+						consumed += chunkedDecoder.feed( d.ptr2, d.sz2, onData, trailers );
+					if ( chunkedDecoder.isError() )
+						throw Error();
+				}
+				else
+				{
+					size_t remaining = bodyKind == BodyKind::length ? contentLength - bodyBytesRetrieved : (size_t)(-1);
+					consumed = d.sz1 < remaining ? d.sz1 : remaining;
+					b.append( d.ptr1, consumed );
+					if ( consumed < remaining && d.ptr2 && d.sz2 )
+					{
+						size_t sz2 = d.sz2 < remaining - consumed ? d.sz2 : remaining - consumed;
+						b.append( d.ptr2, sz2 );
+						consumed += sz2;
+					}
+				}
+				conn->dataForCommandProcessing.readBuffer.skip_data( consumed );
+				bodyBytesRetrieved += b.size();
+				if ( bodyKind == BodyKind::chunked )
+					return chunkedDecoder.isDone();
+				return bodyKind == BodyKind::length && bodyBytesRetrieved == contentLength;
+			}
+		};
+
+		/*
+			Pool of keep-alive connections per origin (ip:port).
+			A request goes to an idle connection, if any, or to a new one, while there are less than maxConnectionsPerOrigin of them.
+			Otherwise, if pipelineDepth > 1, an idempotent request is pipelined to the least loaded connection with idempotent requests only;
+			or it waits till a connection is available. Idempotent requests that fail on a reused connection before
+			any response is received are retried once on another connection (the server may have closed an idle connection meanwhile).
+			Usage:
+				auto client = createHttpClient( opts );
+				HttpClientRequest req; req.path = "/index.html";
+				HttpClientResponse resp;
+				co_await client->a_request( "127.0.0.1", 2000, req, resp );
+				Buffer b;
+				co_await resp.a_readAll( b );
+			NOTE: the client must outlive its responses
+		*/
+		class HttpClient
+		{
+			friend class HttpClientResponse;
+
+		public:
+			struct Options
+			{
+				size_t maxConnectionsPerOrigin = 6;
+				size_t pipelineDepth = 1; // max requests in flight per connection; 1 means no pipelining
+				uint32_t connectTimeoutMs = 0; // 0 means no timeout
+				uint32_t requestTimeoutMs = 0; // for requests with no timeout of their own; 0 means no timeout
+			};
+
+			nodecpp::safememory::soft_this_ptr<HttpClient> myThis;
+
+		private:
+			Options options;
+			nodecpp::vector<nodecpp::safememory::owning_ptr<HttpClientOrigin>> origins; // a few, as a rule
+
+			// request timeouts are checked by a single timer ticking while there are requests with deadlines in flight
+			static constexpr uint32_t deadlineTickMs = 100;
+			nodecpp::Timeout deadlineTimer;
+			bool deadlineTimerCreated = false;
+			bool deadlineTimerArmed = false;
+
+		public:
+			HttpClient() {}
+			HttpClient( const Options& opts ) : options( opts ) {}
+			HttpClient(const HttpClient&) = delete;
+			HttpClient& operator = (const HttpClient&) = delete;
+			~HttpClient()
+			{
+				if ( deadlineTimerCreated )
+					nodecpp::clearTimeout( deadlineTimer );
+				for ( auto& origin : origins )
+					for ( auto& c : origin->conns )
+					{
+						c->origin = nullptr;
+						if ( !c->destroyed() )
+							c->destroy();
+					}
+			}
+
+			const Options& getOptions() const { return options; }
+
+			// writes the request and reads the response head; the body, if any, is then read via response
+			nodecpp::handler_ret_type a_request( const char* ip, uint16_t port, const HttpClientRequest& req, HttpClientResponse& response );
+
+		private:
+			static bool isIdempotent( const nodecpp::string& method )
+			{
+				return method == "GET" || method == "HEAD" || method == "OPTIONS" || method == "TRACE" || method == "PUT" || method == "DELETE";
+			}
+
+			HttpClientOrigin& getOrigin( const char* ip, uint16_t port )
+			{
+				for ( auto& origin : origins )
+					if ( origin->port == port && origin->ip == ip )
+						return *origin;
+				origins.push_back( nodecpp::safememory::make_owning<HttpClientOrigin>() );
+				HttpClientOrigin& origin = *(origins.back());
+				origin.ip = ip;
+				origin.port = port;
+				return origin;
+			}
+
+			void serializeRequest( const HttpClientOrigin& origin, const HttpClientRequest& req, Buffer& b )
+			{
+				b.appendString( req.method );
+				b.append( " ", 1 );
+				b.appendString( req.path );
+				b.append( " HTTP/1.1\r\nHost: ", sizeof(" HTTP/1.1\r\nHost: ") - 1 );
+				if ( req.host.empty() )
+				{
+					b.appendString( origin.ip );
+					char portStr[8];
+					int sz = snprintf( portStr, sizeof(portStr), ":%u", (unsigned)(origin.port) );
+					b.append( portStr, sz );
+				}
+				else
+					b.appendString( req.host );
+				b.append( "\r\n", 2 );
+				for ( auto& h : req.headers )
+				{
+					b.appendString( h.first );
+					b.append( ": ", 2 );
+					b.appendString( h.second );
+					b.append( "\r\n", 2 );
+				}
+				if ( !req.body.empty() || !( req.method == "GET" || req.method == "HEAD" ) )
+				{
+					char clStr[48];
+					int sz = snprintf( clStr, sizeof(clStr), "Content-Length: %zu\r\n", req.body.size() );
+					b.append( clStr, sz );
+				}
+				b.append( "\r\n", 2 );
+				if ( !req.body.empty() )
+					b.append( req.body.begin(), req.body.size() ); // single write keeps pipelined requests from interleaving
+			}
+
+			nodecpp::handler_ret_type a_acquire( HttpClientOrigin& origin, bool pipelinable, HttpClientResponse& response, bool& reused );
+			void armDeadlineTimer();
+			void onDeadlineTick();
+		};
+
+		template<class ... Types>
+		static
+		nodecpp::safememory::owning_ptr<HttpClient> createHttpClient(Types&& ... args) {
+			return nodecpp::safememory::make_owning<HttpClient>(::std::forward<Types>(args)...);
+		}
+
+		inline
+		void HttpClientOrigin::purge()
+		{
+			for ( size_t i=0; i<conns.size(); )
+				if ( conns[i]->attached == 0 && !conns[i]->usable() && !conns[i]->connectingNow )
+				{
+					if ( i + 1 != conns.size() )
+						conns[i] = std::move( conns.back() );
+					conns.pop_back();
+				}
+				else
+					++i;
+		}
+
+		inline
+		void HttpClientOrigin::notifySlot()
+		{
+			if ( slotWaiters.empty() )
+				return;
+			auto hr = slotWaiters.front();
+			slotWaiters.erase( slotWaiters.begin() );
+			hr();
+		}
+
+		inline
+		nodecpp::handler_ret_type HttpClient::a_acquire( HttpClientOrigin& origin, bool pipelinable, HttpClientResponse& response, bool& reused )
+		{
+			for(;;)
+			{
+				origin.purge();
+				size_t best = (size_t)(-1);
+				for ( size_t i=0; i<origin.conns.size(); ++i )
+				{
+					auto& c = origin.conns[i];
+					if ( !c->usable() )
+						continue;
+					if ( c->inFlight() == 0 )
+					{
+						best = i;
+						break;
+					}
+					if ( pipelinable && c->pipelinable && c->inFlight() < options.pipelineDepth && ( best == (size_t)(-1) || c->inFlight() < origin.conns[best]->inFlight() ) )
+						best = i;
+				}
+				if ( best != (size_t)(-1) && ( origin.conns[best]->inFlight() == 0 || origin.conns.size() >= options.maxConnectionsPerOrigin ) )
+				{
+					reused = origin.conns[best]->served != 0;
+					response.attach( origin.conns[best] );
+					CO_RETURN;
+				}
+				if ( origin.conns.size() < options.maxConnectionsPerOrigin ) // a new connection is preferred to pipelining
+				{
+					origin.conns.push_back( createSocket<HttpClientSocket>() );
+					nodecpp::safememory::soft_ptr<HttpClientSocket> conn = origin.conns.back();
+					conn->origin = &origin;
+					response.attach( conn );
+					std::exception_ptr connectError;
+					try
+					{
+						if ( options.connectTimeoutMs )
+							co_await conn->a_connect( origin.port, origin.ip.c_str(), options.connectTimeoutMs );
+						else
+							co_await conn->a_connect( origin.port, origin.ip.c_str() );
+					}
+					catch (...)
+					{
+						connectError = std::current_exception();
+					}
+					conn->connectingNow = false;
+					if ( connectError )
+					{
+						response.detach( true );
+						std::rethrow_exception( connectError );
+					}
+					reused = false;
+					CO_RETURN;
+				}
+				co_await origin.a_slot();
+			}
+		}
+
+		inline
+		nodecpp::handler_ret_type HttpClient::a_request( const char* ip, uint16_t port, const HttpClientRequest& req, HttpClientResponse& response )
+		{
+			response.detach( !response.completed ); // if reused with the body of a previous response unread, its connection cannot be reused (as in ~HttpClientResponse())
+			response.clear();
+			HttpClientOrigin& origin = getOrigin( ip, port );
+			bool idempotent = isIdempotent( req.method );
+			bool headRequest = req.method == "HEAD";
+			Buffer requestBuff( 256 + req.body.size() );
+			serializeRequest( origin, req, requestBuff );
+			uint32_t timeoutMs = req.timeoutMs ? req.timeoutMs : options.requestTimeoutMs;
+			uint64_t deadline = timeoutMs ? nodecpp::time::now() + timeoutMs : 0;
+
+			for ( size_t attempt = 0; ; ++attempt )
+			{
+				bool reused = false;
+				co_await a_acquire( origin, idempotent, response, reused );
+				nodecpp::safememory::soft_ptr<HttpClientSocket> conn = response.conn;
+				size_t seq = conn->nextSeq++;
+				conn->deadlines.push_back( deadline );
+				if ( !idempotent )
+					conn->pipelinable = false;
+				if ( deadline )
+					armDeadlineTimer();
+				conn->write( requestBuff ); // what cannot be sent at once is buffered by the socket; on error the socket is closed, and reading fails
+
+				std::exception_ptr requestError;
+				try
+				{
+					co_await conn->a_turnToRead( seq );
+					co_await response.a_readHead( headRequest );
+				}
+				catch (...)
+				{
+					requestError = std::current_exception();
+				}
+				if ( !requestError )
+					CO_RETURN;
+				bool retry = reused && idempotent && attempt == 0 && !response.headStarted && ( deadline == 0 || nodecpp::time::now() < deadline );
+				response.detach( true );
+				if ( !retry )
+					std::rethrow_exception( requestError );
+				response.clear();
+			}
+		}
+
+		inline
+		void HttpClient::armDeadlineTimer()
+		{
+			if ( deadlineTimerArmed )
+				return;
+			if ( deadlineTimerCreated )
+				nodecpp::refreshTimeout( deadlineTimer );
+			else
+			{
+				nodecpp::safememory::soft_ptr<HttpClient> me = myThis.getSoftPtr<HttpClient>(this);
+				deadlineTimer = nodecpp::setTimeout( [me]() { me->onDeadlineTick(); }, deadlineTickMs );
+				deadlineTimerCreated = true;
+			}
+			deadlineTimerArmed = true;
+		}
+
+		inline
+		void HttpClient::onDeadlineTick()
+		{
+			deadlineTimerArmed = false;
+			uint64_t now = nodecpp::time::now();
+			bool pending = false;
+			nodecpp::vector<nodecpp::safememory::soft_ptr<HttpClientSocket>> expired;
+			for ( auto& origin : origins )
+				for ( auto& c : origin->conns )
+					for ( auto deadline : c->deadlines )
+						if ( deadline )
+						{
+							if ( deadline <= now )
+							{
+								expired.push_back( c );
+								break;
+							}
+							pending = true;
+						}
+			for ( auto& c : expired )
+				if ( !c->broken )
+					c->fail();
+			if ( pending )
+				armDeadlineTimer();
+		}
+
+#endif // NODECPP_NO_COROUTINES
+
+	} //namespace net
+
+} //namespace nodecpp
+
+#endif //HTTP_CLIENT_H
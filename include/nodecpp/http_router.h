@@ -0,0 +1,384 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include "common.h"
+#include "error.h"
+
+#include <string_view>
+#include <functional>
+
+namespace nodecpp {
+
+	namespace net {
+
+		class IncomingHttpMessageAtServer; // forward declaration
+		class HttpServerResponse; // forward declaration
+
+		// path parameters (':name' and '*name' segments) extracted by HttpRouter; values are views into request's URL
+		class HttpRouteParams
+		{
+		public:
+			static constexpr size_t maxParams = 16;
+
+		private:
+			struct Param
+			{
+				std::string_view name;
+				std::string_view value;
+			};
+			Param params[maxParams];
+			size_t count = 0;
+
+		public:
+			void clear() { count = 0; }
+			size_t size() const { return count; }
+			std::string_view nameAt( size_t i ) const { NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, i < count ); return params[i].name; }
+			std::string_view valueAt( size_t i ) const { NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, i < count ); return params[i].value; }
+			std::string_view get( std::string_view name ) const // empty, if not present
+			{
+				for ( size_t i=0; i<count; ++i )
+					if ( params[i].name == name )
+						return params[i].value;
+				return std::string_view();
+			}
+
+			// for HttpRouter
+			void push( std::string_view name, std::string_view value ) { NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, count < maxParams ); params[count].name = name; params[count].value = value; ++count; }
+			void pop() { NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, count != 0 ); --count; }
+		};
+
+		/*
+			Routes requests by method and path pattern. Pattern is a sequence of
+				- static text (e.g. '/api/v1/users'),
+				- ':name' segments matching a single non-empty path segment,
+				- a trailing '*name' (or just '*') matching the rest of the path (possibly empty).
+			For a given position static text takes precedence over a parameter, and a parameter over a wildcard.
+
+			Routes are added at startup, then build() compiles them into a compact radix tree (flat arrays);
+			matching does not allocate and reports parameters as views into the path being matched.
+		*/
+		class HttpRouter
+		{
+		public:
+			using HandlerT = std::function<nodecpp::handler_ret_type(nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer>, nodecpp::safememory::soft_ptr<HttpServerResponse>)>;
+			static constexpr size_t MethodCount = 9; // as in HttpMessageBase::MethodNames
+			static constexpr size_t anyMethod = MethodCount;
+
+		private:
+			static constexpr uint32_t none = (uint32_t)(-1);
+
+			// build-time representation
+			struct BuilderNode
+			{
+				nodecpp::map<char, uint32_t> children;
+				uint32_t paramChild = none;
+				nodecpp::string paramName;
+				uint32_t wildcardChild = none;
+				nodecpp::string wildcardName;
+				uint32_t handlers[MethodCount + 1];
+				BuilderNode() { for ( size_t i=0; i<=MethodCount; ++i ) handlers[i] = none; }
+			};
+			nodecpp::vector<BuilderNode> builderNodes;
+
+			// compiled representation
+			struct Node
+			{
+				uint32_t prefixOff = 0; // in chars
+				uint32_t prefixLen = 0;
+				uint32_t childrenOff = 0; // in childFirstChars/childIdxs
+				uint32_t childrenCnt = 0;
+				uint32_t paramChild = none;
+				uint32_t wildcardChild = none;
+				uint32_t nameOff = 0; // name of a parameter this node (as paramChild or wildcardChild) stands for
+				uint32_t nameLen = 0;
+				uint32_t handlersOff = none; // in handlerTable; MethodCount + 1 entries
+			};
+			nodecpp::vector<Node> nodes;
+			nodecpp::string chars;
+			nodecpp::vector<char> childFirstChars; // sorted within each node
+			nodecpp::vector<uint32_t> childIdxs;
+			nodecpp::vector<uint32_t> handlerTable;
+			nodecpp::vector<HandlerT> handlers;
+			bool built = false;
+
+			static constexpr const char* methodNames[MethodCount] = { "GET", "HEAD", "POST", "PUT", "DELETE", "TRACE", "OPTIONS", "CONNECT", "PATCH" };
+
+			static size_t methodIdx( std::string_view method )
+			{
+				for ( size_t i=0; i<MethodCount; ++i )
+					if ( method == methodNames[i] )
+						return i;
+				return none;
+			}
+
+			uint32_t newBuilderNode() { builderNodes.emplace_back(); return (uint32_t)(builderNodes.size() - 1); }
+
+			uint32_t compile( uint32_t bIdx, const char* name, size_t nameLen )
+			{
+				uint32_t idx = (uint32_t)(nodes.size());
+				nodes.emplace_back();
+				nodes[idx].nameOff = (uint32_t)(chars.size());
+				nodes[idx].nameLen = (uint32_t)nameLen;
+				chars.append( name, nameLen );
+
+				// collapse a chain of static-only nodes into a prefix
+				nodes[idx].prefixOff = (uint32_t)(chars.size());
+				for (;;)
+				{
+					BuilderNode& bn = builderNodes[bIdx];
+					bool hasHandlers = false;
+					for ( size_t i=0; i<=MethodCount; ++i )
+						hasHandlers = hasHandlers || bn.handlers[i] != none;
+					if ( hasHandlers || bn.children.size() != 1 || bn.paramChild != none || bn.wildcardChild != none )
+						break;
+					chars.push_back( bn.children.begin()->first );
+					bIdx = bn.children.begin()->second;
+				}
+				nodes[idx].prefixLen = (uint32_t)(chars.size()) - nodes[idx].prefixOff;
+
+				BuilderNode& bn = builderNodes[bIdx];
+				for ( size_t i=0; i<=MethodCount; ++i )
+					if ( bn.handlers[i] != none )
+					{
+						nodes[idx].handlersOff = (uint32_t)(handlerTable.size());
+						for ( size_t j=0; j<=MethodCount; ++j )
+							handlerTable.push_back( bn.handlers[j] );
+						break;
+					}
+
+				// children are compiled first and then referred to from a contiguous range (builderNodes does not change while compiling)
+				nodecpp::vector<std::pair<char, uint32_t>> compiledChildren;
+				for ( auto& ch : bn.children ) // std::map keeps them sorted
+					compiledChildren.push_back( std::make_pair( ch.first, compile( ch.second, nullptr, 0 ) ) );
+				uint32_t paramChild = bn.paramChild != none ? compile( bn.paramChild, bn.paramName.c_str(), bn.paramName.size() ) : none;
+				uint32_t wildcardChild = bn.wildcardChild != none ? compile( bn.wildcardChild, bn.wildcardName.c_str(), bn.wildcardName.size() ) : none;
+
+				nodes[idx].childrenOff = (uint32_t)(childIdxs.size());
+				nodes[idx].childrenCnt = (uint32_t)(compiledChildren.size());
+				for ( auto& ch : compiledChildren )
+				{
+					childFirstChars.push_back( ch.first );
+					childIdxs.push_back( ch.second );
+				}
+				nodes[idx].paramChild = paramChild;
+				nodes[idx].wildcardChild = wildcardChild;
+				return idx;
+			}
+
+			uint32_t handlerAt( const Node& node, size_t mIdx ) const
+			{
+				if ( node.handlersOff == none )
+					return none;
+				uint32_t ret = handlerTable[node.handlersOff + mIdx];
+				return ret != none ? ret : handlerTable[node.handlersOff + anyMethod];
+			}
+
+			// for a static child, the first char of its prefix is stored in childFirstChars and is not repeated in chars
+			uint32_t matchNode( uint32_t idx, std::string_view path, size_t pos, size_t mIdx, HttpRouteParams& params ) const
+			{
+				const Node& node = nodes[idx];
+				if ( path.size() - pos < node.prefixLen || memcmp( path.data() + pos, chars.data() + node.prefixOff, node.prefixLen ) != 0 )
+					return none;
+				pos += node.prefixLen;
+				if ( pos == path.size() )
+				{
+					uint32_t h = handlerAt( node, mIdx );
+					if ( h != none )
+						return h;
+				}
+				else
+				{
+					const char* first = childFirstChars.data() + node.childrenOff;
+					const char* last = first + node.childrenCnt;
+					const char* found = std::lower_bound( first, last, path[pos] );
+					if ( found != last && *found == path[pos] )
+					{
+						uint32_t h = matchNode( childIdxs[node.childrenOff + (found - first)], path, pos + 1, mIdx, params );
+						if ( h != none )
+							return h;
+					}
+					if ( node.paramChild != none && path[pos] != '/' && params.size() < HttpRouteParams::maxParams )
+					{
+						size_t end = path.find( '/', pos );
+						if ( end == std::string_view::npos )
+							end = path.size();
+						const Node& paramNode = nodes[node.paramChild];
+						params.push( std::string_view( chars.data() + paramNode.nameOff, paramNode.nameLen ), path.substr( pos, end - pos ) );
+						uint32_t h = matchNode( node.paramChild, path, end, mIdx, params );
+						if ( h != none )
+							return h;
+						params.pop();
+					}
+				}
+				if ( node.wildcardChild != none && params.size() < HttpRouteParams::maxParams )
+				{
+					const Node& wcNode = nodes[node.wildcardChild];
+					uint32_t h = handlerAt( wcNode, mIdx );
+					if ( h != none )
+					{
+						params.push( std::string_view( chars.data() + wcNode.nameOff, wcNode.nameLen ), path.substr( pos ) );
+						return h;
+					}
+				}
+				return none;
+			}
+
+		public:
+			HttpRouter() { newBuilderNode(); }
+
+			// method is one of HTTP methods, or "*" for any method
+			void add( const char* method, const char* pattern, HandlerT handler )
+			{
+				size_t mIdx = strcmp( method, "*" ) == 0 ? anyMethod : methodIdx( method );
+				if ( mIdx == none || pattern == nullptr || pattern[0] != '/' )
+					throw Error();
+				uint32_t current = 0;
+				size_t paramCnt = 0;
+				const char* p = pattern;
+				while ( *p )
+				{
+					if ( ( *p == ':' || *p == '*' ) && p[-1] == '/' )
+					{
+						bool isWildcard = *p == '*';
+						const char* nameBegin = ++p;
+						while ( *p && *p != '/' )
+							++p;
+						nodecpp::string name( nameBegin, p - nameBegin );
+						if ( ++paramCnt > HttpRouteParams::maxParams )
+							throw Error();
+						if ( isWildcard )
+						{
+							if ( *p ) // wildcard is allowed only at the end
+								throw Error();
+							if ( builderNodes[current].wildcardChild == none )
+							{
+								uint32_t child = newBuilderNode();
+								builderNodes[current].wildcardChild = child;
+								builderNodes[current].wildcardName = name;
+							}
+							else if ( builderNodes[current].wildcardName != name )
+								throw Error(); // same position, different names
+							current = builderNodes[current].wildcardChild;
+						}
+						else
+						{
+							if ( name.empty() )
+								throw Error();
+							if ( builderNodes[current].paramChild == none )
+							{
+								uint32_t child = newBuilderNode();
+								builderNodes[current].paramChild = child;
+								builderNodes[current].paramName = name;
+							}
+							else if ( builderNodes[current].paramName != name )
+								throw Error(); // same position, different names
+							current = builderNodes[current].paramChild;
+						}
+						continue;
+					}
+					auto it = builderNodes[current].children.find( *p );
+					if ( it == builderNodes[current].children.end() )
+					{
+						uint32_t child = newBuilderNode();
+						builderNodes[current].children.insert( std::make_pair( *p, child ) );
+						current = child;
+					}
+					else
+						current = it->second;
+					++p;
+				}
+				if ( builderNodes[current].handlers[mIdx] != none )
+					throw Error(); // duplicate route
+				builderNodes[current].handlers[mIdx] = (uint32_t)(handlers.size());
+				handlers.push_back( std::move( handler ) );
+				built = false;
+			}
+
+			void get( const char* pattern, HandlerT handler ) { add( "GET", pattern, std::move( handler ) ); }
+			void post( const char* pattern, HandlerT handler ) { add( "POST", pattern, std::move( handler ) ); }
+			void put( const char* pattern, HandlerT handler ) { add( "PUT", pattern, std::move( handler ) ); }
+			void del( const char* pattern, HandlerT handler ) { add( "DELETE", pattern, std::move( handler ) ); }
+			void all( const char* pattern, HandlerT handler ) { add( "*", pattern, std::move( handler ) ); }
+
+			// to be called at startup, once all routes are added (called automatically otherwise, with the first request)
+			void build()
+			{
+				nodes.clear();
+				chars.clear();
+				childFirstChars.clear();
+				childIdxs.clear();
+				handlerTable.clear();
+				compile( 0, nullptr, 0 );
+				built = true;
+			}
+			bool isBuilt() const { return built; }
+			bool empty() const { return handlers.empty(); }
+
+			// path must not include query; returns nullptr if nothing matches
+			const HandlerT* match( std::string_view method, std::string_view path, HttpRouteParams& params ) const
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, built );
+				params.clear();
+				size_t mIdx = methodIdx( method );
+				if ( mIdx == none )
+					mIdx = anyMethod;
+				uint32_t h = matchNode( 0, path, 0, mIdx, params );
+				if ( h == none )
+				{
+					params.clear();
+					return nullptr;
+				}
+				return &(handlers[h]);
+			}
+
+			// for a path that match() has not matched with the request's method: comma-separated methods it would be matched with
+			// (for the 'Allow' header of '405 Method Not Allowed'); empty if none. Not on the hot path: runs a match per method.
+			nodecpp::string allowedMethods( std::string_view path ) const
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, built );
+				nodecpp::string ret;
+				HttpRouteParams params;
+				for ( size_t i=0; i<MethodCount; ++i )
+				{
+					params.clear();
+					if ( matchNode( 0, path, 0, i, params ) == none )
+						continue;
+					if ( !ret.empty() )
+						ret.append( ", " );
+					ret.append( methodNames[i] );
+				}
+				return ret;
+			}
+		};
+
+	} //namespace net
+} //namespace nodecpp
+
+#endif // HTTP_ROUTER_H
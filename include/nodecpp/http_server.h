@@ -30,6 +30,8 @@
 
 #include "http_server_common.h"
 #include "http_socket_at_server.h"
+#include "websocket.h"
+#include "http2.h"
 
 // NOTE: current implementation is anty-optimal; it's just a sketch of what could be in use
 
@@ -60,19 +62,22 @@ namespace nodecpp {
 			{
 				retServer->registerServer(retServer);
 			}
+			nodecpp::safememory::soft_ptr<ServerT> myServer = retServer;
 			if constexpr ( std::is_same< typename ServerT::DataParentType, void >::value )
 			{
 				using SocketT = HttpSocket< RequestT, void>;
-				retServer->setAcceptedSocketCreationRoutine( [](OpaqueSocketData& sdata) {
+				retServer->setAcceptedSocketCreationRoutine( [myServer](OpaqueSocketData& sdata) {
 						nodecpp::safememory::owning_ptr<SocketT> ret = nodecpp::safememory::make_owning<SocketT>();
+						ret->applyDispatchPolicy(&(*ret));
 						ret->registerMeAndAssignSocket(sdata);
+						ret->onAccepted(*myServer);
 						return ret;
 					} );
 			}
 			else
 			{
 				auto myDataParent = retServer->getDataParent();
-				retServer->setAcceptedSocketCreationRoutine( [myDataParent](OpaqueSocketData& sdata) {
+				retServer->setAcceptedSocketCreationRoutine( [myDataParent, myServer](OpaqueSocketData& sdata) {
 						using SocketT = HttpSocket<RequestT, typename ServerT::DataParentType>;
 						nodecpp::safememory::owning_ptr<SocketT> retSock;
 						if constexpr ( std::is_base_of< NodeBase, typename ServerT::DataParentType >::value )
@@ -83,7 +88,9 @@ namespace nodecpp {
 						{
 							retSock = nodecpp::safememory::make_owning<SocketT>();
 						}
+						retSock->applyDispatchPolicy(&(*retSock));
 						retSock->registerMeAndAssignSocket(sdata);
+						retSock->onAccepted(*myServer);
 						return retSock;
 					} );
 			}
@@ -30,6 +30,9 @@
 
 #include "common.h"
 #include "server_common.h"
+#include "http_router.h"
+#include "http_cache.h"
+#include "timers.h"
 
 #include <algorithm>
 #include <cctype>
@@ -49,12 +52,26 @@ namespace nodecpp {
 
 		class HttpServerBase : public nodecpp::net::ServerBase
 		{
+			friend class HttpServerResponse;
+			friend class HttpSocketBase;
+			friend class Http2Session;
+
 		public:
 			using NodeType = void;
 			using DataParentType = void;
 
 		public:
 			enum class Handler { IncomingRequest, Close, Error };
+
+			// 0 means 'no limit' for each of them
+			struct ConnectionLimits
+			{
+				uint32_t idleTimeoutMs = 0; // keep-alive connection with no request in progress is closed after that (and a new one with no first request, if headersTimeoutMs is 0)
+				uint32_t headersTimeoutMs = 0; // request line and headers must be received within that since the request's first byte (or since accepting a connection, for its first request)
+				uint32_t bodyTimeoutMs = 0; // whole request body must be received within that since headers
+				size_t maxRequestsPerConnection = 0; // response to the last one goes with 'Connection: close'
+			};
+
 //		private:
 			struct DataForHttpCommandProcessing
 			{
@@ -169,44 +186,69 @@ namespace nodecpp {
 				};
 				thread_local static UserHandlerClassPatterns<UserHandlersForDataCollecting> userHandlerClassPattern; // TODO: consider using thread-local allocator
 
+				// handlers are shared by all instances of a user class; the table is immutable once applied (see UserHandlerClassPatterns)
 				struct UserHandlers : public UserHandlersCommon
 				{
-					bool initialized = false;
-				public:
-					UserDefHandlersWithOptimizedStorage<UserHandlersCommon::userDefIncomingRequestHandlerFnT> userDefIncomingRequestHandlers;
-					UserDefHandlersWithOptimizedStorage<UserHandlersCommon::userDefCloseHandlerFnT> userDefCloseHandlers;
-					UserDefHandlersWithOptimizedStorage<UserHandlersCommon::userDefErrorHandlerFnT> userDefErrorHandlers;
+					const UserHandlersForDataCollecting* pattern = nullptr;
+					void* defaultObjPtr = nullptr; // object for handlers being members of the user class itself
 
-					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr)
+					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr_)
 					{
-						if ( initialized )
+						if ( pattern != nullptr )
 							return;
-						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr != nullptr);
-						userDefIncomingRequestHandlers.from(patternUH.userDefIncomingRequestHandlers, defaultObjPtr);
-						userDefCloseHandlers.from(patternUH.userDefCloseHandlers, defaultObjPtr);
-						userDefErrorHandlers.from(patternUH.userDefErrorHandlers, defaultObjPtr);
-						initialized = true;
+						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr_ != nullptr);
+						pattern = &patternUH;
+						defaultObjPtr = defaultObjPtr_;
 					}
 				};
 				UserHandlers userHandlers;
 
-				bool isIncomingRequesEventHandler() { return userHandlers.userDefIncomingRequestHandlers.willHandle(); }
-				void handleIncomingRequesEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response) { userHandlers.userDefIncomingRequestHandlers.execute(server, request, response); }
+				bool isIncomingRequesEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefIncomingRequestHandlers.willHandle(); }
+				void handleIncomingRequesEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response) { userHandlers.pattern->userDefIncomingRequestHandlers.execute(userHandlers.defaultObjPtr, server, request, response); }
 
-				bool isCloseEventHandler() { return userHandlers.userDefCloseHandlers.willHandle(); }
-				void handleCloseEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, bool hasError) { userHandlers.userDefCloseHandlers.execute(server, hasError); }
+				bool isCloseEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefCloseHandlers.willHandle(); }
+				void handleCloseEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, bool hasError) { userHandlers.pattern->userDefCloseHandlers.execute(userHandlers.defaultObjPtr, server, hasError); }
 
-				bool isErrorEventHandler() { return userHandlers.userDefErrorHandlers.willHandle(); }
-				void handleErrorEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, Error& e) { userHandlers.userDefErrorHandlers.execute(server, e); }
+				bool isErrorEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefErrorHandlers.willHandle(); }
+				void handleErrorEvent(nodecpp::safememory::soft_ptr<HttpServerBase> server, Error& e) { userHandlers.pattern->userDefErrorHandlers.execute(userHandlers.defaultObjPtr, server, e); }
 			};
 			DataForHttpCommandProcessing dataForHttpCommandProcessing;
 
+		private:
+			size_t pipelineDepth = 1; // max number of pipelined requests being processed at the same time per connection (rounded up to a power of 2)
+			size_t bodyReadWindow = 0; // max size of not yet consumed request body data buffered per connection; 0 means default size of socket's read buffer
+			HttpRouter router; // if a request matches any of its routes, the route's handler is called instead of 'request' handlers
+			HttpResponseCache responseCache; // consulted for GET requests before any handler, if enabled
+			bool http2Enabled = false; // see enableHttp2()
+			ConnectionLimits connectionLimits;
+
+			// per-connection deadlines (see HttpSocketBase::setDeadline()) are kept in a coarse timer wheel served by a single timer;
+			// a connection stays in its slot when its deadline is moved later and is re-slotted when the slot is reached
+			static constexpr size_t deadlineWheelSize = 256;
+			static constexpr uint32_t deadlineTickMs = 100;
+			nodecpp::vector<nodecpp::vector<HttpSocketBase*>> deadlineWheel; // HttpSocketBase removes itself when destroyed
+			uint64_t deadlineTick = 0; // last processed tick
+			size_t deadlineWheelCount = 0;
+			nodecpp::Timeout deadlineTimer;
+			bool deadlineTimerCreated = false;
+			bool deadlineTimerArmed = false;
+			void scheduleDeadline( HttpSocketBase* sock );
+			void unscheduleDeadline( HttpSocketBase* sock );
+			void onDeadlineTick();
+
+#ifndef NODECPP_NO_COROUTINES
+			void dispatchRequest( nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response );
+			// called by a response produced for a cache miss once it is serialized (or, if it is not cacheable, instead)
+			void cacheResponse( nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry, BufferView headers, BufferView body );
+			void dropCacheEntry( nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry );
+#endif // NODECPP_NO_COROUTINES
+
 		public:
 			HttpServerBase() {}
 			HttpServerBase(event::HttpRequest::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				eHttpRequest.on(std::move(cb));
 			}
-			virtual ~HttpServerBase() {}
+			virtual ~HttpServerBase();
 
 #ifndef NODECPP_NO_COROUTINES
 			struct awaitable_request_data
@@ -327,6 +369,24 @@ namespace nodecpp {
 				DataForHttpCommandProcessing::userHandlerClassPattern.getPatternForUpdate<UserClass>().template addHandler<handler, memmberFn, UserClass>();
 			}
 
+			// NOTE: affects connections accepted after the call
+			void setPipelineDepth( size_t depth ) { NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, depth != 0 ); pipelineDepth = depth; }
+			size_t getPipelineDepth() const { return pipelineDepth; }
+			void setBodyReadWindow( size_t bytes ) { bodyReadWindow = bytes; } // NOTE: affects connections accepted after the call
+			size_t getBodyReadWindow() const { return bodyReadWindow; }
+			// add routes at startup and, optionally, call getRouter().build() once done; e.g.
+			// server->getRouter().get( "/users/:id", [](auto request, auto response) -> nodecpp::handler_ret_type { ... request->getParam( "id" ) ... } );
+			HttpRouter& getRouter() { return router; }
+			// caches responses to GET requests (see HttpResponseCache for what is cached); call at startup
+			void enableResponseCache( HttpResponseCache::Options options ) { responseCache.enable( std::move( options ) ); }
+			const HttpResponseCache& getResponseCache() const { return responseCache; }
+			// connections starting with the HTTP/2 preface, or upgrading to h2c with their first request, are then served as HTTP/2 (see http2.h); call at startup
+			void enableHttp2( bool enable = true ) { http2Enabled = enable; }
+			bool isHttp2Enabled() const { return http2Enabled; }
+			// timeouts are applied to deadlines set after the call
+			void setConnectionLimits( ConnectionLimits limits ) { connectionLimits = limits; }
+			const ConnectionLimits& getConnectionLimits() const { return connectionLimits; }
+
 			EventEmitter<event::HttpRequest> eHttpRequest;
 			void on(nodecpp::string_literal name, event::HttpRequest::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				assert(name == event::HttpRequest::name);
@@ -357,6 +417,190 @@ namespace nodecpp {
 			virtual ~HttpServer() {}
 		};
 
+		// incremental decoder of 'Transfer-Encoding: chunked' body; framing may be split at any byte boundary between calls to feed()
+		class ChunkedDecoder
+		{
+		public:
+			enum State { chunk_size, chunk_ext, chunk_size_lf, chunk_data, chunk_data_cr, chunk_data_lf, trailer_line_start, trailer_line, trailer_lf, last_lf, done, error };
+			static constexpr size_t maxTrailerLineSize = 0x2000; // going beyond either is an error, so that memory held per request stays bounded
+			static constexpr size_t maxTrailersSize = 0x8000;
+
+		private:
+			State state = State::chunk_size;
+			size_t chunkSize = 0;
+			bool sizeDigitSeen = false;
+			nodecpp::string trailerLine;
+			size_t trailersSize = 0; // of all trailer lines so far, without line ends
+
+			static int hexValue( uint8_t ch )
+			{
+				if ( ch >= '0' && ch <= '9' ) return ch - '0';
+				if ( ch >= 'a' && ch <= 'f' ) return ch - 'a' + 10;
+				if ( ch >= 'A' && ch <= 'F' ) return ch - 'A' + 10;
+				return -1;
+			}
+
+			void onEndOfSizeLine()
+			{
+				if ( !sizeDigitSeen )
+					state = State::error;
+				else
+					state = chunkSize ? State::chunk_data : State::trailer_line_start;
+			}
+
+			void appendToTrailerLine( uint8_t ch )
+			{
+				if ( trailerLine.size() >= maxTrailerLineSize || trailersSize >= maxTrailersSize )
+				{
+					state = State::error;
+					return;
+				}
+				trailerLine.push_back( ch );
+				++trailersSize;
+			}
+
+			template<class TrailersT>
+			void commitTrailerLine( TrailersT& trailers )
+			{
+				size_t idx = trailerLine.find( ':' );
+				if ( idx == nodecpp::string::npos || idx == 0 )
+				{
+					state = State::error;
+					return;
+				}
+				nodecpp::string key = trailerLine.substr( 0, idx );
+				std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c){ return std::tolower(c); });
+				size_t valStart = trailerLine.find_first_not_of( " \t", idx + 1 );
+				size_t valEnd = trailerLine.find_last_not_of( " \t" );
+				trailers.insert( std::make_pair( key, valStart == nodecpp::string::npos || valEnd < valStart ? nodecpp::string() : trailerLine.substr( valStart, valEnd - valStart + 1 ) ) );
+				trailerLine.clear();
+			}
+
+		public:
+			void clear() { state = State::chunk_size; chunkSize = 0; sizeDigitSeen = false; trailerLine.clear(); trailersSize = 0; }
+			bool isDone() const { return state == State::done; }
+			bool isError() const { return state == State::error; }
+
+			// consumes up to sz bytes (stops right after the last trailer, leaving the rest untouched); returns the number of bytes consumed
+			// chunk payload is reported, without copying, as one or more calls onData(const uint8_t* ptr, size_t sz) for ranges of [ptr, ptr + sz)
+			// if stopAfterData is set, returns right after the first payload range is reported
+			template<class OnDataT, class TrailersT>
+			size_t feed( const uint8_t* ptr, size_t sz, OnDataT&& onData, TrailersT& trailers, bool stopAfterData = false )
+			{
+				size_t pos = 0;
+				while ( pos < sz && state != State::done && state != State::error )
+				{
+					if ( state == State::chunk_data )
+					{
+						size_t toReport = sz - pos < chunkSize ? sz - pos : chunkSize;
+						onData( ptr + pos, toReport );
+						pos += toReport;
+						chunkSize -= toReport;
+						if ( chunkSize == 0 )
+							state = State::chunk_data_cr;
+						if ( stopAfterData )
+							return pos;
+						continue;
+					}
+
+					uint8_t ch = ptr[pos++];
+					switch ( state )
+					{
+						case State::chunk_size:
+						{
+							int v = hexValue( ch );
+							if ( v >= 0 )
+							{
+								if ( chunkSize > ( SIZE_MAX >> 4 ) )
+									state = State::error;
+								chunkSize = ( chunkSize << 4 ) + v;
+								sizeDigitSeen = true;
+							}
+							else if ( ch == ';' || ch == ' ' || ch == '\t' )
+								state = State::chunk_ext;
+							else if ( ch == '\r' )
+								state = State::chunk_size_lf;
+							else if ( ch == '\n' )
+								onEndOfSizeLine();
+							else
+								state = State::error;
+							break;
+						}
+						case State::chunk_ext: // extensions are ignored
+							if ( ch == '\r' )
+								state = State::chunk_size_lf;
+							else if ( ch == '\n' )
+								onEndOfSizeLine();
+							break;
+						case State::chunk_size_lf:
+							if ( ch == '\n' )
+								onEndOfSizeLine();
+							else
+								state = State::error;
+							break;
+						case State::chunk_data_cr:
+							if ( ch == '\r' )
+								state = State::chunk_data_lf;
+							else if ( ch == '\n' )
+							{
+								sizeDigitSeen = false;
+								state = State::chunk_size;
+							}
+							else
+								state = State::error;
+							break;
+						case State::chunk_data_lf:
+							if ( ch == '\n' )
+							{
+								sizeDigitSeen = false;
+								state = State::chunk_size;
+							}
+							else
+								state = State::error;
+							break;
+						case State::trailer_line_start:
+							if ( ch == '\r' )
+								state = State::last_lf;
+							else if ( ch == '\n' )
+								state = State::done;
+							else
+							{
+								state = State::trailer_line;
+								appendToTrailerLine( ch );
+							}
+							break;
+						case State::trailer_line:
+							if ( ch == '\r' )
+								state = State::trailer_lf;
+							else if ( ch == '\n' )
+							{
+								state = State::trailer_line_start;
+								commitTrailerLine( trailers );
+							}
+							else
+								appendToTrailerLine( ch );
+							break;
+						case State::trailer_lf:
+							if ( ch == '\n' )
+							{
+								state = State::trailer_line_start;
+								commitTrailerLine( trailers );
+							}
+							else
+								state = State::error;
+							break;
+						case State::last_lf:
+							state = ch == '\n' ? State::done : State::error;
+							break;
+						default:
+							NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false, "unexpected state {}", (size_t)state ); 
+							break;
+					}
+				}
+				return pos;
+			}
+		};
+
 		class HttpMessageBase // TODO: candidate for being a part of lib
 		{
 			friend class HttpSocketBase;
@@ -382,6 +626,8 @@ namespace nodecpp {
 			ConnStatus connStatus = ConnStatus::keep_alive;
 
 			size_t contentLength = 0;
+			bool chunked = false; // Transfer-Encoding: chunked
+			bool framingMalformed = false; // Transfer-Encoding not ending with chunked, or with Content-Length as well (RFC 9112, 6.3); a request is then rejected
 
 			typedef nodecpp::map<nodecpp::string, nodecpp::string> header_t; // so far good for both directions
 			header_t header;
@@ -398,7 +644,50 @@ namespace nodecpp {
 				auto cl = header.find( "content-length" );
 				if ( cl != header.end() )
 					contentLength = ::atol( cl->second.c_str() ); // quick and dirty; TODO: revise
-				contentLength = 0;
+				else
+					contentLength = 0;
+			}
+
+			void parseTransferEncoding()
+			{
+				auto te = header.find( "transfer-encoding" );
+				if ( te != header.end() )
+				{
+					nodecpp::string val = te->second;
+					val = makeLower( val );
+					// NOTE: chunked, if present, must be the last one applied
+					size_t pos = val.rfind( "chunked" );
+					chunked = pos != nodecpp::string::npos && val.find_first_not_of( " \t", pos + sizeof("chunked") - 1 ) == nodecpp::string::npos;
+					framingMalformed = !chunked || header.find( "content-length" ) != header.end();
+				}
+				else
+				{
+					chunked = false;
+					framingMalformed = false;
+				}
+			}
+
+			enum class HeaderLine { entry, end, malformed };
+			// parses a line of headers (with its CRLF) into header; at the empty line ending headers, Content-Length and Transfer-Encoding are parsed
+			HeaderLine parseHeaderLine( const nodecpp::string& line )
+			{
+				size_t end = line.find_last_not_of(" \t\r\n" );
+				if ( end == nodecpp::string::npos )
+				{
+					if ( !( line.size() == 2 && line[0] == '\r' && line[1] == '\n' ) ) // last empty line
+						return HeaderLine::entry; // TODO: what should we do with this line of spaces? - just ignore or report a parsing error?
+					parseContentLength();
+					parseTransferEncoding();
+					return HeaderLine::end;
+				}
+				size_t start = line.find_first_not_of( " \t" );
+				size_t idx = line.find(':', start);
+				if ( idx >= end )
+					return HeaderLine::malformed;
+				size_t valStart = line.find_first_not_of( " \t", idx + 1 );
+				nodecpp::string key = line.substr( start, idx-start );
+				header.insert( std::make_pair( makeLower( key ), line.substr( valStart, end - valStart + 1 ) ));
+				return HeaderLine::entry;
 			}
 
 			void parseConnStatus()
@@ -418,6 +707,158 @@ namespace nodecpp {
 			}
 		};
 
+		// reading primitives shared by server- and client-side HTTP sockets
+		class HttpSocketCommon : public nodecpp::net::SocketBase
+		{
+		public:
+#ifndef NODECPP_NO_COROUTINES
+			auto a_readByte() { 
+
+				struct read_byte {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					SocketBase& socket;
+
+					read_byte(SocketBase& socket_) : socket( socket_ ) {
+					}
+
+					read_byte(const read_byte &) = delete;
+					read_byte &operator = (const read_byte &) = delete;
+	
+					~read_byte() {
+					}
+
+					bool await_ready() {
+						return !socket.dataForCommandProcessing.readBuffer.empty();
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						socket.dataForCommandProcessing.ahd_read.h = awaiting;
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+						return socket.dataForCommandProcessing.readBuffer.read_byte();
+					}
+				};
+				return read_byte(*this);
+			}
+
+			auto a_dataAvailable( CircularByteBuffer::AvailableDataDescriptor& d, size_t minBytes = 1 ) { 
+
+				struct data_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					SocketBase& socket;
+					CircularByteBuffer::AvailableDataDescriptor& d;
+					size_t minBytes;
+
+					data_awaiter(SocketBase& socket_, CircularByteBuffer::AvailableDataDescriptor& d_, size_t minBytes_) : socket( socket_ ), d( d_ ), minBytes(minBytes_) {
+					}
+
+					data_awaiter(const data_awaiter &) = delete;
+					data_awaiter &operator = (const data_awaiter &) = delete;
+	
+					~data_awaiter() {
+					}
+
+					bool await_ready() {
+						return socket.dataForCommandProcessing.readBuffer.used_size() && socket.dataForCommandProcessing.readBuffer.used_size() >= minBytes;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						socket.dataForCommandProcessing.ahd_read.min_bytes = minBytes;
+						nodecpp::setNoException(awaiting);
+						socket.dataForCommandProcessing.ahd_read.h = awaiting;
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+						socket.dataForCommandProcessing.readBuffer.get_available_data( d );
+					}
+				};
+				return data_awaiter(*this, d, minBytes);
+			}
+
+			auto a_dataAvailable( uint32_t period, CircularByteBuffer::AvailableDataDescriptor& d ) { 
+
+				struct data_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					SocketBase& socket;
+					CircularByteBuffer::AvailableDataDescriptor& d;
+					uint32_t period;
+					nodecpp::Timeout to;
+
+					data_awaiter(SocketBase& socket_, uint32_t period_, CircularByteBuffer::AvailableDataDescriptor& d_) : socket( socket_ ), d( d_ ), period( period_ ) {}
+
+					data_awaiter(const data_awaiter &) = delete;
+					data_awaiter &operator = (const data_awaiter &) = delete;
+	
+					~data_awaiter() {}
+
+					bool await_ready() {
+						return socket.dataForCommandProcessing.readBuffer.used_size() > 0;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						socket.dataForCommandProcessing.ahd_read.min_bytes = 1;
+						nodecpp::setNoException(awaiting);
+						socket.dataForCommandProcessing.ahd_read.h = awaiting;
+						myawaiting = awaiting;
+						to = nodecpp::setTimeoutForAction( awaiting, period );
+					}
+
+					auto await_resume() {
+						nodecpp::clearTimeout( to );
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+						socket.dataForCommandProcessing.readBuffer.get_available_data( d );
+					}
+				};
+				return data_awaiter(*this, period, d);
+			}
+
+			nodecpp::handler_ret_type readLine(nodecpp::string& line)
+			{
+				size_t pos = 0;
+				line.clear();
+				CircularByteBuffer::AvailableDataDescriptor d;
+				for(;;)
+				{
+					co_await a_dataAvailable( d );
+					for ( ; pos<d.sz1; ++pos )
+						if ( d.ptr1[pos] == '\n' )
+						{
+							line.append( (const char*)(d.ptr1), pos + 1 );
+							dataForCommandProcessing.readBuffer.skip_data( pos + 1 );
+							CO_RETURN;
+						}
+					line += nodecpp::string( (const char*)(d.ptr1), pos );
+					dataForCommandProcessing.readBuffer.skip_data( pos );
+					pos = 0;
+					if ( d.ptr2 && d.sz2 )
+					{
+						for ( ; pos<d.sz2; ++pos )
+							if ( d.ptr2[pos] == '\n' )
+							{
+								line += nodecpp::string( (const char*)(d.ptr2), pos + 1 );
+								dataForCommandProcessing.readBuffer.skip_data( pos + 1 );
+								CO_RETURN;
+							}
+						line += nodecpp::string( (const char*)(d.ptr2), pos );
+						dataForCommandProcessing.readBuffer.skip_data( pos );
+						pos = 0;
+					}
+				}
+
+				CO_RETURN;
+			}
+#endif // NODECPP_NO_COROUTINES
+		};
+
 	} //namespace net
 } //namespace nodecpp
 
@@ -45,11 +45,16 @@ namespace nodecpp {
 
 		class IncomingHttpMessageAtServer; // forward declaration
 		class HttpServerResponse; // forward declaration
+		class WebSocket; // forward declaration
+		class Http2Session; // forward declaration
+		class Http2Stream; // forward declaration
 
-        class HttpSocketBase : public nodecpp::net::SocketBase
+        class HttpSocketBase : public HttpSocketCommon
 		{
 			friend class IncomingHttpMessageAtServer;
 			friend class HttpServerResponse;
+			friend class HttpServerBase;
+			friend class Http2Session;
 
 			nodecpp::handler_ret_type getRequest( IncomingHttpMessageAtServer& message );
 			nodecpp::handler_ret_type getRequest2( IncomingHttpMessageAtServer& message );
@@ -59,12 +64,13 @@ namespace nodecpp {
 				nodecpp::safememory::owning_ptr<IncomingHttpMessageAtServer> request;
 				nodecpp::safememory::owning_ptr<HttpServerResponse> response;
 				bool active = false;
+				awaitable_handle_t ahd_turn = nullptr; // response is being written in parts and waits for all preceding responses to be sent
 			};
 
-			template<size_t sizeExp>
 			class RRQueue
 			{
 				RRPair* cbuff = nullptr;
+				size_t sizeExp = 0;
 				uint64_t head = 0;
 				uint64_t tail = 0;
 				size_t idxToStorageIdx(size_t idx ) { return idx & ((((size_t)1)<<sizeExp)-1); }
@@ -77,7 +83,8 @@ namespace nodecpp {
 						nodecpp::dealloc( cbuff, size );
 					}
 				}
-				void init( nodecpp::safememory::soft_ptr<HttpSocketBase> );
+				void init( nodecpp::safememory::soft_ptr<HttpSocketBase>, size_t depth );
+				bool isInitialized() const { return cbuff != nullptr; }
 				bool canPush() { return head - tail < ((uint64_t)1<<sizeExp); }
 				bool release( size_t idx )
 				{
@@ -93,21 +100,44 @@ namespace nodecpp {
 					}
 					return canPush();
 				}
-				RRPair& getHead() {
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, canPush() );
-					auto& ret = cbuff[idxToStorageIdx(head)];
-					ret.active = true;
-					ret.request->idx = head;
-					ret.response->idx = head;
-					++head;
-					return ret;
+				RRPair& getHead();
+				uint64_t getTail() const { return tail; }
+				uint64_t getHeadIdx() const { return head; }
+				RRPair& at( uint64_t idx ) {
+					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx >= tail && idx < head, "{} is out of [{}, {})", idx, tail, head );
+					return cbuff[idxToStorageIdx(idx)];
 				}
 			};
-			RRQueue<0> rrQueue;
-			bool release( size_t idx ) { return rrQueue.release( idx ); }
-
+			RRQueue rrQueue;
+			bool release( size_t idx );
+			static void initRequestResponsePair( nodecpp::safememory::owning_ptr<IncomingHttpMessageAtServer>& request, nodecpp::safememory::owning_ptr<HttpServerResponse>& response, nodecpp::safememory::soft_ptr<HttpSocketBase> socket );
+
+			// responses that are completed within the same loop iteration are sent by a single gather write (see flushCompletedResponses())
+			nodecpp::vector<BufferView> segmentsToFlush;
+			bool flushScheduled = false;
+			bool flushInProgress = false;
+			bool isTurnOf( size_t idx ) const { return idx == rrQueue.getTail() && !flushInProgress; }
+			void scheduleFlush();
+
+			bool bodyPending = false; // body of the last request is not yet read (and, therefore, we cannot parse the next one)
 			awaitable_handle_t ahd_continueGetting = nullptr;
 
+			// see HttpServerBase::ConnectionLimits
+			enum class DeadlineKind : uint8_t { none, idle, headers, body, closing };
+			DeadlineKind deadlineKind = DeadlineKind::none;
+			uint64_t deadline = 0; // as of nodecpp::time::now()
+			static constexpr uint64_t notInDeadlineWheel = (uint64_t)(-1);
+			uint64_t deadlineWheelTick = notInDeadlineWheel; // maintained by HttpServerBase
+			size_t deadlineWheelPos = 0;
+			size_t requestCount = 0;
+			Http2Session* h2session = nullptr; // while runHttp2() is in progress
+			void h2OnIdleDeadline(); // see http2.h
+			size_t cacheWaiters = 0; // responses waiting for a response cache entry (see HttpResponseCache::addWaiter())
+			bool waitingForRequest = false;
+			void setDeadline( HttpServerBase& server, DeadlineKind kind );
+			void clearDeadline() { deadlineKind = DeadlineKind::none; } // wheel entry, if any, is dropped lazily
+			void onDeadline();
+
 #ifndef NODECPP_NO_COROUTINES
 			auto a_continueGetting() { 
 
@@ -141,156 +171,54 @@ namespace nodecpp {
 				return continue_getting_awaiter(*this);
 			}
 
-			auto a_readByte() { 
+			auto a_turn( size_t idx ) { 
 
-				struct read_byte {
+				struct turn_awaiter {
 					std::experimental::coroutine_handle<> myawaiting = nullptr;
-					SocketBase& socket;
-
-					read_byte(SocketBase& socket_) : socket( socket_ ) {
-					}
-
-					read_byte(const read_byte &) = delete;
-					read_byte &operator = (const read_byte &) = delete;
-	
-					~read_byte() {
-					}
-
-					bool await_ready() {
-						return !socket.dataForCommandProcessing.readBuffer.empty();
-					}
-
-					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
-						nodecpp::setNoException(awaiting);
-						socket.dataForCommandProcessing.ahd_read.h = awaiting;
-						myawaiting = awaiting;
-					}
-
-					auto await_resume() {
-						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
-							throw nodecpp::getException(myawaiting);
-						return socket.dataForCommandProcessing.readBuffer.read_byte();
-					}
-				};
-				return read_byte(*this);
-			}
-
-			auto a_dataAvailable( CircularByteBuffer::AvailableDataDescriptor& d, size_t minBytes = 1 ) { 
-
-				struct data_awaiter {
-					std::experimental::coroutine_handle<> myawaiting = nullptr;
-					SocketBase& socket;
-					CircularByteBuffer::AvailableDataDescriptor& d;
-					size_t minBytes;
-
-					data_awaiter(SocketBase& socket_, CircularByteBuffer::AvailableDataDescriptor& d_, size_t minBytes_) : socket( socket_ ), d( d_ ), minBytes(minBytes_) {
-					}
-
-					data_awaiter(const data_awaiter &) = delete;
-					data_awaiter &operator = (const data_awaiter &) = delete;
-	
-					~data_awaiter() {
-					}
-
-					bool await_ready() {
-						return socket.dataForCommandProcessing.readBuffer.used_size() && socket.dataForCommandProcessing.readBuffer.used_size() >= minBytes;
-					}
-
-					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
-						socket.dataForCommandProcessing.ahd_read.min_bytes = minBytes;
-						nodecpp::setNoException(awaiting);
-						socket.dataForCommandProcessing.ahd_read.h = awaiting;
-						myawaiting = awaiting;
-					}
-
-					auto await_resume() {
-						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
-							throw nodecpp::getException(myawaiting);
-						socket.dataForCommandProcessing.readBuffer.get_available_data( d );
-					}
-				};
-				return data_awaiter(*this, d, minBytes);
-			}
-
-			auto a_dataAvailable( uint32_t period, CircularByteBuffer::AvailableDataDescriptor& d ) { 
+					HttpSocketBase& socket;
+					size_t idx;
 
-				struct data_awaiter {
-					std::experimental::coroutine_handle<> myawaiting = nullptr;
-					SocketBase& socket;
-					CircularByteBuffer::AvailableDataDescriptor& d;
-					uint32_t period;
-					nodecpp::Timeout to;
+					turn_awaiter(HttpSocketBase& socket_, size_t idx_) : socket( socket_ ), idx( idx_ ) {}
 
-					data_awaiter(SocketBase& socket_, uint32_t period_, CircularByteBuffer::AvailableDataDescriptor& d_) : socket( socket_ ), d( d_ ), period( period_ ) {}
+					turn_awaiter(const turn_awaiter &) = delete;
+					turn_awaiter &operator = (const turn_awaiter &) = delete;
 
-					data_awaiter(const data_awaiter &) = delete;
-					data_awaiter &operator = (const data_awaiter &) = delete;
-	
-					~data_awaiter() {}
+					~turn_awaiter() {}
 
 					bool await_ready() {
-						return socket.dataForCommandProcessing.readBuffer.used_size() > 0;
+						return socket.isTurnOf( idx );
 					}
 
 					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
-						socket.dataForCommandProcessing.ahd_read.min_bytes = 1;
 						nodecpp::setNoException(awaiting);
-						socket.dataForCommandProcessing.ahd_read.h = awaiting;
+						socket.rrQueue.at( idx ).ahd_turn = awaiting;
 						myawaiting = awaiting;
-						to = nodecpp::setTimeoutForAction( awaiting, period );
 					}
 
 					auto await_resume() {
-						nodecpp::clearTimeout( to );
 						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
 							throw nodecpp::getException(myawaiting);
-						socket.dataForCommandProcessing.readBuffer.get_available_data( d );
 					}
 				};
-				return data_awaiter(*this, period, d);
+				return turn_awaiter(*this, idx);
 			}
 
-			nodecpp::handler_ret_type readLine(nodecpp::string& line)
-			{
-				size_t pos = 0;
-				line.clear();
-				CircularByteBuffer::AvailableDataDescriptor d;
-				for(;;)
-				{
-					co_await a_dataAvailable( d );
-					for ( ; pos<d.sz1; ++pos )
-						if ( d.ptr1[pos] == '\n' )
-						{
-							line.append( (const char*)(d.ptr1), pos + 1 );
-							dataForCommandProcessing.readBuffer.skip_data( pos + 1 );
-							CO_RETURN;
-						}
-					line += nodecpp::string( (const char*)(d.ptr1), pos );
-					dataForCommandProcessing.readBuffer.skip_data( pos );
-					pos = 0;
-					if ( d.ptr2 && d.sz2 )
-					{
-						for ( ; pos<d.sz2; ++pos )
-							if ( d.ptr2[pos] == '\n' )
-							{
-								line += nodecpp::string( (const char*)(d.ptr2), pos + 1 );
-								dataForCommandProcessing.readBuffer.skip_data( pos + 1 );
-								CO_RETURN;
-							}
-						line += nodecpp::string( (const char*)(d.ptr2), pos );
-						dataForCommandProcessing.readBuffer.skip_data( pos );
-						pos = 0;
-					}
-				}
+			nodecpp::handler_ret_type flushCompletedResponses();
 
-				CO_RETURN;
-			}
+			// the rest of the connection is HTTP/2 (see http2.h); upgraded, if any, is the request of 'Upgrade: h2c' to be served as stream 1
+			nodecpp::handler_ret_type runHttp2( IncomingHttpMessageAtServer* upgraded );
+			static bool isHttp2Preface( const CircularByteBuffer::AvailableDataDescriptor& d );
 
 #endif // NODECPP_NO_COROUTINES
 
 		public:
+			static constexpr uint8_t dispatchPolicy = SocketDispatch::awaitables; // everything is driven by run()
+
 			HttpSocketBase();
-			virtual ~HttpSocketBase() {}
+			virtual ~HttpSocketBase();
+
+			// the first request is awaited since now; with no headers timeout, a connection that sends nothing is still subject to the idle one
+			void onAccepted( HttpServerBase& server );
 
 #ifndef NODECPP_NO_COROUTINES
 			nodecpp::handler_ret_type run()
@@ -299,16 +227,69 @@ namespace nodecpp {
 				{
 					// first test for continuation
 					CircularByteBuffer::AvailableDataDescriptor d;
+					if ( requestCount ) // for the first one, the deadline is set when accepted
+					{
+						if ( rrQueue.getTail() == rrQueue.getHeadIdx() )
+							setDeadline( *nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket), DeadlineKind::idle );
+						else
+							clearDeadline(); // set to 'idle' once all responses are sent (see release())
+					}
+					waitingForRequest = true;
 					co_await a_dataAvailable( d, 0 );
+					waitingForRequest = false;
 					if ( d.sz1 == 0 ) // no more data - no more requests
 						CO_RETURN;
 
+					if ( !rrQueue.isInitialized() ) // by now we know our server
+					{
+						auto server = nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket);
+						rrQueue.init( myThis.getSoftPtr<HttpSocketBase>(this), server->getPipelineDepth() );
+						dataForCommandProcessing.readBuffer.reserve( server->getBodyReadWindow() );
+					}
+					auto server = nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket);
+					if ( requestCount == 0 && server->isHttp2Enabled() && isHttp2Preface( d ) ) // prior knowledge (RFC 7540, 3.4)
+					{
+						co_await runHttp2( nullptr );
+						CO_RETURN;
+					}
+					if ( requestCount || deadlineKind == DeadlineKind::idle ) // the latter for the first request with no headers timeout (see onAccepted())
+						setDeadline( *server, DeadlineKind::headers );
+
 					// now we can reasonably expect a new request
 					auto& rrPair = rrQueue.getHead();
 					co_await getRequest( *(rrPair.request) );
+					if ( rrPair.request->framingMalformed ) // where the body ends is ambiguous, and so is where the next request starts (RFC 9112, 6.3)
+					{
+						clearDeadline();
+						++requestCount;
+						rrPair.response->closeAfterSent = true;
+						rrPair.response->writeHead( 400, "Bad Request" );
+						rrPair.response->end();
+						CO_RETURN;
+					}
+					bodyPending = isBodyPending( *(rrPair.request) ); // next request starts after the body of this one
+					if ( bodyPending )
+						setDeadline( *server, DeadlineKind::body ); // cleared in onBodyCompleted()
+					else
+						clearDeadline();
+					++requestCount;
+					if ( requestCount == 1 && !bodyPending && server->isHttp2Enabled() && rrPair.request->isH2cUpgrade() ) // RFC 7540, 3.2
+					{
+						Buffer switching;
+						switching.appendString( nodecpp::string( "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n" ) );
+						write( switching );
+						co_await runHttp2( &*(rrPair.request) );
+						CO_RETURN;
+					}
+					bool isLast = server->getConnectionLimits().maxRequestsPerConnection != 0 && requestCount >= server->getConnectionLimits().maxRequestsPerConnection;
+					bool isUpgrade = rrPair.request->isWebSocketUpgrade(); // what follows is not HTTP, if accepted
+					if ( isLast || isUpgrade )
+						rrPair.response->closeAfterSent = true; // cleared by a_acceptWebSocket()
 
-					nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket)->onNewRequest( rrPair.request, rrPair.response );
-					if ( rrQueue.canPush() )
+					server->onNewRequest( rrPair.request, rrPair.response );
+					if ( isLast || isUpgrade ) // connection is ended once the response is sent (unless upgraded)
+						CO_RETURN;
+					if ( canProceed() )
 						continue;
 					auto cg = a_continueGetting();
 					co_await cg;
@@ -316,9 +297,21 @@ namespace nodecpp {
 				CO_RETURN;
 			}
 
+			bool isBodyPending( IncomingHttpMessageAtServer& request );
+			bool canProceed() { return rrQueue.canPush() && !bodyPending; }
+
+			void onBodyCompleted()
+			{
+				bodyPending = false;
+				if ( deadlineKind == DeadlineKind::body )
+					clearDeadline();
+				resume(); // might have been paused while body chunks were being processed
+				proceedToNext();
+			}
+
 			void proceedToNext()
 			{
-				if ( rrQueue.canPush() && ahd_continueGetting != nullptr )
+				if ( canProceed() && ahd_continueGetting != nullptr )
 				{
 					auto hr = ahd_continueGetting;
 					ahd_continueGetting = nullptr;
@@ -335,6 +328,15 @@ namespace nodecpp {
 					ahd_continueGetting = nullptr;
 					hr();
 				}
+				if ( rrQueue.isInitialized() )
+					for ( uint64_t i=rrQueue.getTail(); i<rrQueue.getHeadIdx(); ++i )
+						if ( rrQueue.at( i ).ahd_turn != nullptr )
+						{
+							auto hr = rrQueue.at( i ).ahd_turn;
+							nodecpp::setException(hr, std::exception()); // TODO: switch to our exceptions ASAP!
+							rrQueue.at( i ).ahd_turn = nullptr;
+							hr();
+						}
 			}
 			::nodecpp::awaitable<char> skipSpaces(char ch);
 			::nodecpp::awaitable<char> readToken( char firstCh, nodecpp::string& str );
@@ -371,6 +373,9 @@ namespace nodecpp {
 		class IncomingHttpMessageAtServer : protected HttpMessageBase // TODO: candidate for being a part of lib
 		{
 			friend class HttpSocketBase;
+			friend class HttpServerBase;
+			friend class Http2Session;
+			friend class HttpServerResponse;
 
 		private:
 			struct Method // so far a struct
@@ -386,8 +391,20 @@ namespace nodecpp {
 			enum ReadStatus { noinit, in_hdr, in_body, completed };
 			ReadStatus readStatus = ReadStatus::noinit;
 			size_t bodyBytesRetrieved = 0;
+			ChunkedDecoder chunkedDecoder;
+			header_t trailers;
+			HttpRouteParams routeParams; // views into method.url; set by HttpServerBase::onNewRequest() if matched by server's router
+			Http2Stream* h2stream = nullptr; // set for the whole lifetime, if the message is a stream of an HTTP/2 connection (see http2.h)
 
 		private:
+			bool h2Fill( const nodecpp::vector<std::pair<nodecpp::string, nodecpp::string>>& fields, bool endOfStream ); // false, if malformed
+			void h2FromUpgraded( IncomingHttpMessageAtServer& upgraded );
+#ifndef NODECPP_NO_COROUTINES
+			nodecpp::handler_ret_type h2ReadBody( Buffer& b );
+			::nodecpp::awaitable<bool> h2NextBodyChunk( BufferView& chunk );
+#endif // NODECPP_NO_COROUTINES
+			void h2ReleaseBodyChunk();
+			void h2CheckBodyCompleted();
 
 		public:
 			IncomingHttpMessageAtServer() {}
@@ -400,6 +417,7 @@ namespace nodecpp {
 				readStatus = other.readStatus;
 				contentLength = other.contentLength;
 				other.readStatus = ReadStatus::noinit;
+				other.routeParams.clear();
 			}
 			IncomingHttpMessageAtServer& operator = (IncomingHttpMessageAtServer&& other)
 			{
@@ -409,6 +427,8 @@ namespace nodecpp {
 				other.readStatus = ReadStatus::noinit;
 				contentLength = other.contentLength;
 				other.contentLength = 0;
+				routeParams.clear(); // would refer to other's url
+				other.routeParams.clear();
 				return *this;
 			}
 			void clear() // TODO: ensure necessity (added for reuse purposes)
@@ -417,23 +437,152 @@ namespace nodecpp {
 				header.clear();
 				body.clear();
 				contentLength = 0;
+				chunked = false;
+				framingMalformed = false;
+				chunkedDecoder.clear();
+				trailers.clear();
+				routeParams.clear();
 				readStatus = ReadStatus::noinit;
 				bodyBytesRetrieved = 0;
+				heldChunkSize = 0;
+				bodyEndReached = false;
 			}
 #ifndef NODECPP_NO_COROUTINES
 			nodecpp::handler_ret_type a_readBody( Buffer& b )
 			{
+				if ( h2stream != nullptr )
+				{
+					co_await h2ReadBody( b );
+					CO_RETURN;
+				}
+				releaseBodyChunk();
+				sock->resume(); // in case a_nextBodyChunk() has been used before
+				if ( chunked )
+				{
+					co_await readChunkedBodyPart( b );
+					CO_RETURN;
+				}
 				if ( bodyBytesRetrieved < getContentLength() )
 				{
 					b.clear();
 					co_await sock->a_read( b, getContentLength() - bodyBytesRetrieved );
 					bodyBytesRetrieved += b.size();
 				}
-				if ( bodyBytesRetrieved == getContentLength() )
-					sock->proceedToNext();
+				if ( bodyBytesRetrieved == getContentLength() && readStatus != ReadStatus::completed )
+				{
+					readStatus = ReadStatus::completed;
+					sock->onBodyCompleted();
+				}
 
 				CO_RETURN;
 			}
+
+			// async iteration over body; returned chunk is a view into socket's read buffer which remains valid till the next call
+			// (or till response is ended). While the chunk is held, socket is paused, and the peer is slowed down by TCP flow control;
+			// that is, memory used for not yet consumed body is bounded by socket's read buffer (see HttpServerBase::setBodyReadWindow()).
+			// Usage: while ( co_await request->a_nextBodyChunk( chunk ) ) { /* process chunk */ }
+			// NOTE: iterate till false is returned; otherwise the connection will be closed once the response is ended
+			::nodecpp::awaitable<bool> a_nextBodyChunk( BufferView& chunk )
+			{
+				if ( h2stream != nullptr ) // flow control of the stream is used instead of pausing the socket
+					CO_RETURN co_await h2NextBodyChunk( chunk );
+				releaseBodyChunk();
+				chunk = BufferView();
+				while ( readStatus == ReadStatus::in_body )
+				{
+					size_t remaining = getContentLength() - bodyBytesRetrieved;
+					if ( !chunked && remaining == 0 )
+					{
+						bodyEndReached = true;
+						releaseBodyChunk();
+						break;
+					}
+					sock->resume();
+					CircularByteBuffer::AvailableDataDescriptor d;
+					co_await sock->a_dataAvailable( d );
+					if ( chunked )
+					{
+						const uint8_t* dataPtr = nullptr;
+						size_t dataSz = 0;
+						auto onData = [&dataPtr, &dataSz]( const uint8_t* ptr, size_t sz ) { dataPtr = ptr; dataSz = sz; };
+						size_t consumed = chunkedDecoder.feed( d.ptr1, d.sz1, onData, trailers, true );
+						if ( dataSz == 0 && consumed == d.sz1 && d.ptr2 && d.sz2 )
+							consumed += chunkedDecoder.feed( d.ptr2, d.sz2, onData, trailers, true );
+						if ( chunkedDecoder.isError() )
+							throw Error(); // TODO: report bad request
+						heldChunkSize = consumed; // framing preceding the payload (if any) is skipped together with it
+						bodyEndReached = chunkedDecoder.isDone();
+						if ( dataSz == 0 )
+						{
+							releaseBodyChunk();
+							continue;
+						}
+						chunk = BufferView( dataPtr, dataSz );
+					}
+					else
+					{
+						size_t sz = d.sz1 < remaining ? d.sz1 : remaining;
+						heldChunkSize = sz;
+						bodyEndReached = sz == remaining;
+						chunk = BufferView( d.ptr1, sz );
+					}
+					bodyBytesRetrieved += chunk.size();
+					sock->pause(); // till the chunk is released
+					CO_RETURN true;
+				}
+				CO_RETURN false;
+			}
+
+		private:
+			size_t heldChunkSize = 0; // bytes at the beginning of socket's read buffer that are viewed by a chunk returned by a_nextBodyChunk()
+			bool bodyEndReached = false;
+
+		public:
+			void releaseBodyChunk() // chunk returned by a_nextBodyChunk() is no longer used (called automatically by the next a_nextBodyChunk())
+			{
+				if ( h2stream != nullptr )
+				{
+					h2ReleaseBodyChunk();
+					return;
+				}
+				if ( heldChunkSize )
+				{
+					sock->dataForCommandProcessing.readBuffer.skip_data( heldChunkSize );
+					heldChunkSize = 0;
+				}
+				if ( bodyEndReached && readStatus == ReadStatus::in_body )
+				{
+					readStatus = ReadStatus::completed;
+					sock->onBodyCompleted();
+				}
+			}
+
+		private:
+			// decodes whatever is available in the read buffer (waiting for more, if nothing is there) into b
+			nodecpp::handler_ret_type readChunkedBodyPart( Buffer& b )
+			{
+				b.clear();
+				while ( b.empty() && readStatus == ReadStatus::in_body )
+				{
+					CircularByteBuffer::AvailableDataDescriptor d;
+					co_await sock->a_dataAvailable( d );
+					auto onData = [&b]( const uint8_t* ptr, size_t sz ) { b.append( ptr, sz ); };
+					size_t consumed = chunkedDecoder.feed( d.ptr1, d.sz1, onData, trailers );
+					if ( consumed == d.sz1 && d.ptr2 && d.sz2 )
+						consumed += chunkedDecoder.feed( d.ptr2, d.sz2, onData, trailers );
+					sock->dataForCommandProcessing.readBuffer.skip_data( consumed );
+					if ( chunkedDecoder.isError() )
+						throw Error(); // TODO: report bad request
+					if ( chunkedDecoder.isDone() )
+						readStatus = ReadStatus::completed;
+				}
+				bodyBytesRetrieved += b.size();
+				if ( readStatus == ReadStatus::completed )
+					sock->onBodyCompleted();
+				CO_RETURN;
+			}
+
+		public:
 #endif // NODECPP_NO_COROUTINES
 
 
@@ -475,31 +624,67 @@ namespace nodecpp {
 			bool parseHeaderEntry( const nodecpp::string& line )
 			{
 				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, readStatus == ReadStatus::in_hdr ); 
-				size_t end = line.find_last_not_of(" \t\r\n" );
-				if ( end == nodecpp::string::npos )
+				switch ( parseHeaderLine( line ) )
 				{
-					if ( !( line.size() == 2 && line[0] == '\r' && line[1] == '\n' ) ) // last empty line
-						return true; // TODO: what should we do with this line of spaces? - just ignore or report a parsing error?
-					parseContentLength();
-					readStatus = contentLength ? ReadStatus::in_body : ReadStatus::completed;
-					return false;
+					case HeaderLine::entry:
+						return true;
+					case HeaderLine::end:
+						readStatus = ( contentLength || chunked ) ? ReadStatus::in_body : ReadStatus::completed;
+						return false;
+					default:
+						return false;
 				}
-				size_t start = line.find_first_not_of( " \t" );
-				size_t idx = line.find(':', start);
-				if ( idx >= end )
-					return false;
-				size_t valStart = line.find_first_not_of( " \t", idx + 1 );
-				nodecpp::string key = line.substr( start, idx-start );
-				header.insert( std::make_pair( makeLower( key ), line.substr( valStart, end - valStart + 1 ) ));
-				return true;
 			}
 
 			const nodecpp::string& getMethod() { return method.name; }
 			const nodecpp::string& getUrl() { return method.url; }
 			const nodecpp::string& getHttpVersion() { return method.version; }
+			bool isHttp2() const { return h2stream != nullptr; } // the version is then "2.0"
 
 			size_t getContentLength() const { return contentLength; }
+			bool isChunked() const { return chunked; }
+			bool isBodyCompleted() const { return readStatus == ReadStatus::completed; }
+			const nodecpp::string* getHeader( const nodecpp::string& lowerCaseKey ) const // nullptr, if not present
+			{
+				auto f = header.find( lowerCaseKey );
+				return f != header.end() ? &(f->second) : nullptr;
+			}
+			const header_t& getTrailers() const { return trailers; } // available once the whole chunked body is read
+
+			// handshake of RFC 6455; if so, HttpSocketBase reads no further requests on this connection (see HttpServerResponse::a_acceptWebSocket())
+			bool isWebSocketUpgrade() const
+			{
+				if ( method.name != "GET" || h2stream != nullptr )
+					return false;
+				auto version = header.find( "sec-websocket-version" );
+				return hasHeaderToken( "upgrade", "websocket" ) && hasHeaderToken( "connection", "upgrade" ) &&
+					header.find( "sec-websocket-key" ) != header.end() && version != header.end() && version->second == "13";
+			}
+
+			// 'Upgrade: h2c' of RFC 7540, 3.2; if the first request on a connection and HTTP/2 is enabled (see HttpServerBase::enableHttp2()),
+			// it is served as stream 1 of the HTTP/2 connection the socket is switched to
+			bool isH2cUpgrade() const
+			{
+				return h2stream == nullptr && hasHeaderToken( "upgrade", "h2c" ) && hasHeaderToken( "connection", "http2-settings" ) &&
+					header.find( "http2-settings" ) != header.end();
+			}
 
+			const HttpRouteParams& getRouteParams() const { return routeParams; }
+			std::string_view getParam( std::string_view name ) const { return routeParams.get( name ); } // empty, if not present
+			UrlQueryView getQuery() const { return UrlQueryView( method.url ); } // views into the URL; valid while the request is
+
+		private:
+			bool hasHeaderToken( const char* key, const char* token ) const
+			{
+				auto f = header.find( key );
+				if ( f == header.end() )
+					return false;
+				nodecpp::string val = f->second;
+				std::transform(val.begin(), val.end(), val.begin(), [](unsigned char c){ return std::tolower(c); });
+				return val.find( token ) != nodecpp::string::npos;
+			}
+
+		public:
 			void dbgTrace()
 			{
 				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "   [->] {} {} HTTP/{}", method.name, method.url, method.version );
@@ -514,6 +699,7 @@ namespace nodecpp {
 		{
 			friend class HttpSocketBase;
 			friend class RRQueue;
+			friend class Http2Session;
 			Buffer headerBuff;
 
 		private:
@@ -523,11 +709,16 @@ namespace nodecpp {
 			size_t contentLength = 0;
 			nodecpp::Buffer body;
 			ConnStatus connStatus = ConnStatus::keep_alive;
-			enum WriteStatus { notyet, hdr_serialized, hdr_flushed, in_body, completed };
+			enum WriteStatus { notyet, hdr_serialized, hdr_flushed, in_body, completed }; // completed: fully serialized to headerBuff/body and waits for HttpSocketBase to send it
 			WriteStatus writeStatus = WriteStatus::notyet;
 
 			nodecpp::string replyStatus;
+			nodecpp::string trailers; // serialized; for chunked responses only
+			nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> cacheEntry; // set by HttpServerBase if this response is to be cached
+			bool closeAfterSent = false; // set by HttpSocketBase for the last request allowed per connection
+			Http2Stream* h2stream = nullptr; // set for the whole lifetime, if the response is to a stream of an HTTP/2 connection (see http2.h)
 			//size_t bodyBytesWritten = 0;
+			static constexpr size_t maxBodySizeToBatch = 0x4000; // larger bodies are sent without copying if nothing is waiting ahead of them
 
 		private:
 			nodecpp::handler_ret_type serializeHeaders()
@@ -537,6 +728,8 @@ namespace nodecpp {
 				if ( replyStatus.size() ) // NOTE: this makes sense only if no headers were added via writeHeader()
 					headerBuff.appendString( replyStatus );
 				headerBuff.append( "\r\n", 2 );
+				if ( closeAfterSent )
+					header[ "Connection" ] = "close";
 				for ( auto h: header )
 				{
 					headerBuff.appendString( h.first );
@@ -580,8 +773,19 @@ namespace nodecpp {
 				header.clear();
 				body.clear();
 				headerBuff.clear();
+				trailers.clear();
 				contentLength = 0;
+				chunked = false;
 				writeStatus = WriteStatus::notyet;
+				closeAfterSent = false;
+#ifndef NODECPP_NO_COROUTINES
+				if ( cacheEntry != nullptr ) // completed in a way other than a single end() call
+				{
+					auto entry = cacheEntry;
+					cacheEntry = nullptr;
+					nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>( sock->myServerSocket )->dropCacheEntry( entry );
+				}
+#endif // NODECPP_NO_COROUTINES
 			}
 
 			void dbgTrace()
@@ -687,10 +891,19 @@ namespace nodecpp {
 #ifndef NODECPP_NO_COROUTINES
 			nodecpp::handler_ret_type flushHeaders()
 			{
+				if ( h2stream != nullptr )
+				{
+					h2WriteHeaders();
+					CO_RETURN;
+				}
 				if ( writeStatus == WriteStatus::notyet )
+				{
+					prepareForStreaming();
 					serializeHeaders();
+				}
 				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::hdr_serialized ); 
 				try {
+					co_await sock->a_turn( idx ); // responses to pipelined requests go out in order
 					co_await sock->a_write( headerBuff );
 					headerBuff.clear();
 					writeStatus = WriteStatus::hdr_flushed;
@@ -707,19 +920,79 @@ namespace nodecpp {
 
 			nodecpp::handler_ret_type writeBodyPart(Buffer& b)
 			{
+				co_await writeBodyPart( BufferView( b ) );
+				CO_RETURN;
+			}
+
+			nodecpp::handler_ret_type writeBodyPart(BufferView b)
+			{
+				co_await writeBodyPart( b, false );
+				CO_RETURN;
+			}
+
+		private:
+			static size_t serializeChunkSize( char* buff, size_t sz ) // buff must accommodate at least 2 * sizeof(size_t) + 2 chars
+			{
+				size_t ln = 0;
+				do { ++ln; } while ( ln < 2 * sizeof(size_t) && ( sz >> ( 4 * ln ) ) );
+				for ( size_t i=0; i<ln; ++i, sz >>= 4 )
+					buff[ln - 1 - i] = "0123456789abcdef"[sz & 0xF];
+				buff[ln] = '\r';
+				buff[ln + 1] = '\n';
+				return ln + 2;
+			}
+
+			void prepareForStreaming() // body is written in parts and its size is not known in advance
+			{
+				if ( myRequest->getHttpVersion() == "1.0" )
+					connStatus = ConnStatus::close; // body is delimited by closing connection
+				else
+				{
+					chunked = true;
+					header.insert( std::make_pair( "Transfer-Encoding", "chunked" ) );
+				}
+			}
+
+			// NOTE: in chunked mode payload is framed by separate segments of a gather write; it is never copied and must remain intact till completion
+			nodecpp::handler_ret_type writeBodyPart(BufferView b, bool isLast)
+			{
+				if ( h2stream != nullptr )
+				{
+					co_await h2WriteBodyPart( b, isLast );
+					CO_RETURN;
+				}
 				if ( writeStatus == WriteStatus::notyet )
+				{
+					prepareForStreaming();
 					serializeHeaders();
-				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::hdr_serialized || writeStatus == WriteStatus::hdr_flushed ); 
+				}
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::hdr_serialized || writeStatus == WriteStatus::hdr_flushed || writeStatus == WriteStatus::in_body ); 
 				try {
+					co_await sock->a_turn( idx ); // responses to pipelined requests go out in order
+					BufferView segs[6];
+					size_t cnt = 0;
+					char chunkHeader[24];
 					if ( writeStatus == WriteStatus::hdr_serialized )
+						segs[cnt++] = BufferView( headerBuff ); // headers and the first body part go as segments of a single gather write
+					if ( !chunked )
+						segs[cnt++] = b;
+					else
 					{
-						headerBuff.append( b );
-						co_await sock->a_write( headerBuff );
-						headerBuff.clear();
-						writeStatus = WriteStatus::hdr_flushed;
+						if ( b.size() ) // NOTE: empty chunk would mean the end of body
+						{
+							segs[cnt++] = BufferView( chunkHeader, serializeChunkSize( chunkHeader, b.size() ) );
+							segs[cnt++] = b;
+							segs[cnt++] = BufferView( "\r\n", 2 );
+						}
+						if ( isLast )
+						{
+							segs[cnt++] = BufferView( "0\r\n", 3 );
+							segs[cnt++] = BufferView( trailers.c_str(), trailers.size() );
+							segs[cnt++] = BufferView( "\r\n", 2 );
+						}
 					}
-					else
-						co_await sock->a_write( b );
+					co_await sock->a_writev( segs, cnt );
+					headerBuff.clear();
 					writeStatus = WriteStatus::in_body;
 				} 
 				catch(...) {
@@ -732,77 +1005,210 @@ namespace nodecpp {
 				CO_RETURN;
 			}
 
+		public:
+			// throws if either contains CR or LF, which would let it inject lines of its own (e.g. when taken from a request)
+			void addTrailer( nodecpp::string key, nodecpp::string value ) // sent after the body of a chunked response
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus != WriteStatus::completed ); 
+				if ( key.empty() || key.find_first_of( "\r\n" ) != nodecpp::string::npos || value.find_first_of( "\r\n" ) != nodecpp::string::npos )
+					throw Error();
+				trailers.append( key );
+				trailers.append( ": " );
+				trailers.append( value );
+				trailers.append( "\r\n" );
+			}
+
 			NODECPP_NO_AWAIT
 			nodecpp::handler_ret_type end(Buffer& b)
 			{
-				if ( writeStatus != WriteStatus::in_body )
-				{
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::notyet ); 
-					header.insert( std::make_pair( "Content-Length", format( "{}", b.size() ) ) );
-				}
-//dbgTrace();
-				co_await writeBodyPart(b);
+				co_await end( BufferView( b ) );
+				CO_RETURN;
+			}
 
-				myRequest->clear();
-				if ( connStatus != ConnStatus::keep_alive )
+			// NOTE: a small body, or one that waits for responses ahead of it, is copied; otherwise, it is sent right from data viewed by b, which then
+			//       must remain intact till end() completes
+			NODECPP_NO_AWAIT
+			nodecpp::handler_ret_type end(BufferView b)
+			{
+				if ( h2stream != nullptr )
 				{
-					sock->end();
-					clear();
+					h2End( b );
 					CO_RETURN;
 				}
-
-				clear();
-				sock->release( idx );
-				sock->proceedToNext();
+				if ( writeStatus == WriteStatus::notyet )
+				{
+					header.insert( std::make_pair( "Content-Length", format( "{}", b.size() ) ) );
+					serializeHeaders();
+					if ( cacheEntry != nullptr )
+						captureForCache( b );
+					if ( b.size() <= maxBodySizeToBatch || !sock->isTurnOf( idx ) )
+					{
+						// to be sent together with other responses completed within this loop iteration (see HttpSocketBase::flushCompletedResponses())
+						body.append( b.begin(), b.size() );
+						writeStatus = WriteStatus::completed;
+						sock->scheduleFlush();
+						CO_RETURN;
+					}
+				}
+//dbgTrace();
+				co_await writeBodyPart( b, true );
+				finalize();
 				CO_RETURN;
 			}
 
 			NODECPP_NO_AWAIT
 			nodecpp::handler_ret_type end(const char* s)
 			{
-				// TODO: potentially, quite temporary implementation
-				size_t ln = strlen( s );
-				Buffer b( ln );
-				b.append( s, ln );
-				co_await end( b );
+				co_await end( BufferView( s, strlen( s ) ) );
 				CO_RETURN;
 			}
 
 			NODECPP_NO_AWAIT
 			nodecpp::handler_ret_type end(nodecpp::string s)
 			{
-				// TODO: potentially, quite temporary implementation
-				Buffer b;
-				b.appendString( s );
-				co_await end( b );
+				// s is a part of the coroutine frame and therefore outlives the write
+				co_await end( BufferView( s.c_str(), s.size() ) );
+				CO_RETURN;
 			}
 
 			NODECPP_NO_AWAIT
 			nodecpp::handler_ret_type end(nodecpp::string_literal s)
 			{
-				// TODO: potentially, quite temporary implementation
-				Buffer b;
-				b.appendString( s );
-				co_await end( b );
+				co_await end( BufferView( s.c_str(), strlen( s.c_str() ) ) );
+				CO_RETURN;
 			}
 
+			// body is sent directly from file fd (with sendfile(), where available), which must remain open till completion;
+			// if headersOnly (e.g. for HEAD requests), Content-Length is still of size, but the body is not sent
 			NODECPP_NO_AWAIT
-			nodecpp::handler_ret_type end()
+			nodecpp::handler_ret_type endWithFile( int fd, uint64_t offset, size_t size, bool headersOnly = false )
 			{
-				if ( writeStatus != WriteStatus::hdr_flushed )
-					co_await flushHeaders();
-				myRequest->clear();
-				if ( connStatus != ConnStatus::keep_alive )
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::notyet ); 
+				if ( h2stream != nullptr ) // file is read by parts as they are sent
 				{
+					co_await h2EndWithFile( fd, offset, size, headersOnly );
+					CO_RETURN;
+				}
+				header.insert( std::make_pair( "Content-Length", format( "{}", size ) ) );
+				serializeHeaders();
+				try {
+					co_await sock->a_turn( idx ); // responses to pipelined requests go out in order
+					co_await sock->a_write( headerBuff );
+					headerBuff.clear();
+					writeStatus = WriteStatus::in_body;
+					if ( size && !headersOnly )
+						co_await sock->a_sendFile( fd, offset, size );
+				} 
+				catch(...) {
 					sock->end();
 					clear();
+					sock->release( idx );
+					sock->proceedToNext();
+					CO_RETURN;
+				}
+				finalize();
+				CO_RETURN;
+			}
+
+			NODECPP_NO_AWAIT
+			nodecpp::handler_ret_type end()
+			{
+				if ( h2stream != nullptr )
+				{
+					h2End( BufferView() );
+					CO_RETURN;
+				}
+				if ( writeStatus == WriteStatus::notyet )
+				{
+					header.insert( std::make_pair( "Content-Length", "0" ) );
+					serializeHeaders();
+					if ( cacheEntry != nullptr )
+						captureForCache( BufferView() );
+				}
+				if ( writeStatus == WriteStatus::hdr_serialized && !chunked ) // nothing has been sent yet
+				{
+					writeStatus = WriteStatus::completed;
+					sock->scheduleFlush();
 					CO_RETURN;
 				}
 //dbgTrace();
+				if ( chunked )
+					co_await writeBodyPart( BufferView(), true ); // last chunk and trailers
+				finalize();
+				CO_RETURN;
+			}
+
+			// completes the upgrade requested by request->isWebSocketUpgrade() with '101 Switching Protocols' and hands the connection over to ws
+			// (see websocket.h); to decline, respond as usual (the connection is then closed)
+			nodecpp::handler_ret_type a_acceptWebSocket( WebSocket& ws, const char* protocol = nullptr );
+
+			// sends a response serialized earlier (e.g. cached), as is
+			NODECPP_NO_AWAIT
+			nodecpp::handler_ret_type endWithCached( nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry )
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::notyet && entry->ready ); 
+				++(entry->users); // entry stays alive till sent, even if evicted meanwhile
+				try {
+					co_await sock->a_turn( idx ); // responses to pipelined requests go out in order
+					BufferView bytes( entry->bytes );
+					co_await sock->a_writev( &bytes, 1 );
+					writeStatus = WriteStatus::in_body;
+				} 
+				catch(...) {
+					--(entry->users);
+					sock->end();
+					clear();
+					sock->release( idx );
+					sock->proceedToNext();
+					CO_RETURN;
+				}
+				--(entry->users);
+				finalize();
+				CO_RETURN;
+			}
+
+		private:
+			void captureForCache( BufferView body )
+			{
+				auto entry = cacheEntry;
+				cacheEntry = nullptr;
+				auto server = nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>( sock->myServerSocket );
+				if ( connStatus == ConnStatus::keep_alive )
+					server->cacheResponse( entry, BufferView( headerBuff ), body );
+				else
+					server->dropCacheEntry( entry );
+			}
+
+			// HTTP/2 counterparts of the above (see http2.h)
+			void h2EncodeField( std::string_view name, std::string_view value, Buffer& block );
+			void h2EncodeLines( const nodecpp::string& lines, size_t pos, Buffer& block );
+			void h2SerializeHeaders( Buffer& block, bool withLength, size_t length );
+			void h2WriteHeaders();
+			void h2QueueEnd( BufferView b );
+			nodecpp::handler_ret_type h2WriteBodyPart( BufferView b, bool isLast );
+			void h2End( BufferView b );
+			nodecpp::handler_ret_type h2EndWithFile( int fd, uint64_t offset, size_t size, bool headersOnly );
+			void h2Finalize();
+
+			void finalize()
+			{
+				if ( h2stream != nullptr )
+				{
+					h2Finalize();
+					return;
+				}
+				myRequest->releaseBodyChunk();
+				bool bodyUnread = !myRequest->isBodyCompleted(); // we cannot find where the next request starts
+				myRequest->clear();
+				if ( connStatus != ConnStatus::keep_alive || bodyUnread || closeAfterSent )
+				{
+					sock->end();
+					clear();
+					return;
+				}
 				clear();
 				sock->release( idx );
 				sock->proceedToNext();
-				CO_RETURN;
 			}
 #endif // NODECPP_NO_COROUTINES
 		};
@@ -811,6 +1217,88 @@ namespace nodecpp {
 		void HttpServerBase::onNewRequest( nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response )
 		{
 //printf( "entering onNewRequest()  %s\n", ahd_request.h == nullptr ? "ahd_request.h is nullptr" : "" );
+			if ( responseCache.isEnabled() && request->getMethod() == "GET" && !response->closeAfterSent && !request->isHttp2() ) // cached bytes are HTTP/1
+			{
+				responseCache.startKey( request->getMethod(), request->getHttpVersion(), request->getUrl() );
+				for ( auto& name : responseCache.getOptions().keyHeaders )
+				{
+					const nodecpp::string* value = request->getHeader( name );
+					responseCache.appendKeyPart( value != nullptr ? std::string_view( *value ) : std::string_view() );
+				}
+				bool credentialed = request->getHeader( "authorization" ) != nullptr || request->getHeader( "cookie" ) != nullptr;
+				nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry;
+				switch ( responseCache.lookup( entry, credentialed ) )
+				{
+					case HttpResponseCache::LookupResult::hit:
+						response->endWithCached( entry );
+						return;
+					case HttpResponseCache::LookupResult::pending:
+						responseCache.addWaiter( entry, request, response, &*(response->sock) );
+						++(response->sock->cacheWaiters);
+						return;
+					case HttpResponseCache::LookupResult::miss:
+						response->cacheEntry = entry;
+						break;
+					case HttpResponseCache::LookupResult::bypass:
+						break;
+				}
+			}
+			dispatchRequest( request, response );
+		}
+
+		inline
+		void HttpServerBase::cacheResponse( nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry, BufferView headers, BufferView body )
+		{
+			if ( !responseCache.isCacheable( headers, body.size(), entry->credentialed ) )
+			{
+				dropCacheEntry( entry );
+				return;
+			}
+			nodecpp::vector<HttpResponseCache::Waiter> waiters;
+			responseCache.complete( entry, headers, body, waiters );
+			for ( auto& w : waiters )
+			{
+				--(w.response->sock->cacheWaiters);
+				w.response->endWithCached( entry );
+			}
+		}
+
+		inline
+		void HttpServerBase::dropCacheEntry( nodecpp::safememory::soft_ptr<HttpResponseCache::Entry> entry )
+		{
+			nodecpp::vector<HttpResponseCache::Waiter> waiters;
+			responseCache.abandon( entry, waiters );
+			for ( auto& w : waiters )
+			{
+				--(w.response->sock->cacheWaiters);
+				dispatchRequest( w.request, w.response ); // each of them is processed on its own
+			}
+		}
+
+		inline
+		void HttpServerBase::dispatchRequest( nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response )
+		{
+			if ( !router.empty() )
+			{
+				if ( !router.isBuilt() )
+					router.build();
+				const nodecpp::string& url = request->getUrl();
+				std::string_view path( url.c_str(), url.find_first_of( "?#" ) == nodecpp::string::npos ? url.size() : url.find_first_of( "?#" ) );
+				const HttpRouter::HandlerT* handler = router.match( request->getMethod().c_str(), path, request->routeParams );
+				if ( handler != nullptr )
+				{
+					(*handler)( request, response );
+					return;
+				}
+				nodecpp::string allowed = router.allowedMethods( path );
+				if ( !allowed.empty() ) // the path is routed, but not for this method
+				{
+					response->writeHead( 405, "Method Not Allowed" );
+					response->addHeader( "Allow", std::move( allowed ) );
+					response->end();
+					return;
+				}
+			}
 			if ( ahd_request.h != nullptr )
 			{
 				ahd_request.request = request;
@@ -990,7 +1478,8 @@ namespace nodecpp {
 			}
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::pedantic, message.readStatus == IncomingHttpMessageAtServer::ReadStatus::in_body, "indeed {}", message.readStatus );
 			message.parseContentLength();
-			message.readStatus = message.contentLength ? IncomingHttpMessageAtServer::ReadStatus::in_body : IncomingHttpMessageAtServer::ReadStatus::completed;
+			message.parseTransferEncoding();
+			message.readStatus = ( message.contentLength || message.chunked ) ? IncomingHttpMessageAtServer::ReadStatus::in_body : IncomingHttpMessageAtServer::ReadStatus::completed;
 			message.parseConnStatus();
 
 			CO_RETURN;
@@ -998,29 +1487,304 @@ namespace nodecpp {
 
 		inline
 		HttpSocketBase::HttpSocketBase() {
-			rrQueue.init( myThis.getSoftPtr<HttpSocketBase>(this) );
 			run(); // TODO: think about proper time for this call
 		}
 
-		template<size_t sizeExp>
-		void HttpSocketBase::RRQueue<sizeExp>::init( nodecpp::safememory::soft_ptr<HttpSocketBase> socket ) {
+		inline
+		HttpSocketBase::~HttpSocketBase() {
+			if ( deadlineWheelTick != notInDeadlineWheel )
+				nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket)->unscheduleDeadline( this );
+			if ( cacheWaiters ) // otherwise they would be served from an entry after requests and responses are gone
+				nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket)->responseCache.removeWaitersOf( this );
+		}
+
+		inline
+		void HttpSocketBase::onAccepted( HttpServerBase& server )
+		{
+			setDeadline( server, server.connectionLimits.headersTimeoutMs ? DeadlineKind::headers : DeadlineKind::idle );
+		}
+
+		inline
+		void HttpSocketBase::setDeadline( HttpServerBase& server, DeadlineKind kind )
+		{
+			uint32_t ms = 0;
+			switch ( kind )
+			{
+				case DeadlineKind::idle: ms = server.connectionLimits.idleTimeoutMs; break;
+				case DeadlineKind::headers: ms = server.connectionLimits.headersTimeoutMs; break;
+				case DeadlineKind::body: ms = server.connectionLimits.bodyTimeoutMs; break;
+				case DeadlineKind::closing: ms = server.connectionLimits.idleTimeoutMs ? server.connectionLimits.idleTimeoutMs : server.connectionLimits.headersTimeoutMs; break;
+				default: break;
+			}
+			if ( ms == 0 )
+			{
+				clearDeadline();
+				return;
+			}
+			deadlineKind = kind;
+			deadline = nodecpp::time::now() + ms;
+			server.scheduleDeadline( this );
+		}
+
+		inline
+		void HttpSocketBase::onDeadline()
+		{
+			DeadlineKind kind = deadlineKind;
+			clearDeadline();
+			if ( kind == DeadlineKind::idle ) // nothing is in progress; let the peer close it
+			{
+#ifndef NODECPP_NO_COROUTINES
+				if ( h2session != nullptr )
+					h2OnIdleDeadline(); // with GOAWAY
+				else
+#endif // NODECPP_NO_COROUTINES
+					end();
+				setDeadline( *nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket), DeadlineKind::closing );
+			}
+			else // headers or body are not received in time, or the peer does not close its side
+				destroy();
+		}
+
+		inline
+		HttpServerBase::~HttpServerBase()
+		{
+			if ( deadlineTimerCreated )
+				nodecpp::clearTimeout( deadlineTimer );
+			for ( auto& slot : deadlineWheel )
+				for ( auto sock : slot )
+					sock->deadlineWheelTick = HttpSocketBase::notInDeadlineWheel;
+		}
+
+		inline
+		void HttpServerBase::scheduleDeadline( HttpSocketBase* sock )
+		{
+			if ( deadlineWheelCount == 0 && !deadlineTimerArmed )
+				deadlineTick = nodecpp::time::now() / deadlineTickMs;
+			uint64_t tick = sock->deadline / deadlineTickMs + 1; // first tick processed not earlier than the deadline
+			if ( tick <= deadlineTick )
+				tick = deadlineTick + 1;
+			else if ( tick >= deadlineTick + deadlineWheelSize ) // farther than the wheel spans; re-slotted when reached
+				tick = deadlineTick + deadlineWheelSize - 1;
+			if ( sock->deadlineWheelTick != HttpSocketBase::notInDeadlineWheel )
+			{
+				if ( sock->deadlineWheelTick <= tick )
+					return; // will be checked no later than needed
+				unscheduleDeadline( sock );
+			}
+			if ( deadlineWheel.empty() )
+				deadlineWheel.resize( deadlineWheelSize );
+			auto& slot = deadlineWheel[ tick % deadlineWheelSize ];
+			sock->deadlineWheelTick = tick;
+			sock->deadlineWheelPos = slot.size();
+			slot.push_back( sock );
+			++deadlineWheelCount;
+			if ( !deadlineTimerArmed )
+			{
+				if ( deadlineTimerCreated )
+					nodecpp::refreshTimeout( deadlineTimer );
+				else
+				{
+					nodecpp::safememory::soft_ptr<HttpServerBase> me = myThis.getSoftPtr<HttpServerBase>(this);
+					deadlineTimer = nodecpp::setTimeout( [me]() { me->onDeadlineTick(); }, deadlineTickMs );
+					deadlineTimerCreated = true;
+				}
+				deadlineTimerArmed = true;
+			}
+		}
+
+		inline
+		void HttpServerBase::unscheduleDeadline( HttpSocketBase* sock )
+		{
+			auto& slot = deadlineWheel[ sock->deadlineWheelTick % deadlineWheelSize ];
+			size_t pos = sock->deadlineWheelPos;
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, pos < slot.size() && slot[pos] == sock ); 
+			if ( pos + 1 != slot.size() )
+			{
+				slot[pos] = slot.back();
+				slot[pos]->deadlineWheelPos = pos;
+			}
+			slot.pop_back();
+			sock->deadlineWheelTick = HttpSocketBase::notInDeadlineWheel;
+			--deadlineWheelCount;
+		}
+
+		inline
+		void HttpServerBase::onDeadlineTick()
+		{
+			deadlineTimerArmed = false;
+			uint64_t now = nodecpp::time::now();
+			uint64_t current = now / deadlineTickMs;
+			if ( current > deadlineTick + deadlineWheelSize ) // we are late by more than the whole wheel
+				deadlineTick = current - deadlineWheelSize;
+			nodecpp::vector<HttpSocketBase*> expired;
+			while ( deadlineTick < current )
+			{
+				++deadlineTick;
+				nodecpp::vector<HttpSocketBase*> due = std::move( deadlineWheel[ deadlineTick % deadlineWheelSize ] );
+				deadlineWheel[ deadlineTick % deadlineWheelSize ].clear();
+				deadlineWheelCount -= due.size();
+				for ( auto sock : due )
+				{
+					sock->deadlineWheelTick = HttpSocketBase::notInDeadlineWheel;
+					if ( sock->deadlineKind == HttpSocketBase::DeadlineKind::none )
+						continue;
+					if ( sock->deadline <= now )
+						expired.push_back( sock );
+					else
+						scheduleDeadline( sock );
+				}
+			}
+			for ( auto sock : expired )
+				sock->onDeadline();
+			if ( deadlineWheelCount && !deadlineTimerArmed )
+			{
+				nodecpp::refreshTimeout( deadlineTimer );
+				deadlineTimerArmed = true;
+			}
+		}
+
+		inline
+		bool HttpSocketBase::isBodyPending( IncomingHttpMessageAtServer& request )
+		{
+			return !request.isBodyCompleted();
+		}
+
+		inline
+		bool HttpSocketBase::release( size_t idx )
+		{
+			bool ret = rrQueue.release( idx );
+			if ( waitingForRequest && requestCount && rrQueue.getTail() == rrQueue.getHeadIdx() )
+				setDeadline( *nodecpp::safememory::soft_ptr_static_cast<HttpServerBase>(myServerSocket), DeadlineKind::idle );
+			if ( rrQueue.getTail() < rrQueue.getHeadIdx() && isTurnOf( rrQueue.getTail() ) )
+			{
+				auto& next = rrQueue.at( rrQueue.getTail() );
+				if ( next.ahd_turn != nullptr )
+				{
+					auto hr = next.ahd_turn;
+					next.ahd_turn = nullptr;
+					hr();
+				}
+#ifndef NODECPP_NO_COROUTINES
+				// a response completed while an earlier one was still being written waits for nothing but a flush
+				else if ( next.active && next.response->writeStatus == HttpServerResponse::WriteStatus::completed )
+					scheduleFlush();
+#endif // NODECPP_NO_COROUTINES
+			}
+			return ret;
+		}
+
+#ifndef NODECPP_NO_COROUTINES
+		inline
+		void HttpSocketBase::scheduleFlush()
+		{
+			if ( flushScheduled )
+				return;
+			flushScheduled = true;
+			nodecpp::safememory::soft_ptr<HttpSocketBase> me = myThis.getSoftPtr<HttpSocketBase>(this);
+			nodecpp::setInmediate( [me]() { me->flushCompletedResponses(); } );
+		}
+
+		inline
+		nodecpp::handler_ret_type HttpSocketBase::flushCompletedResponses()
+		{
+			flushScheduled = false;
+			if ( flushInProgress ) // will be picked up by the running one
+				CO_RETURN;
+			flushInProgress = true;
+			for (;;)
+			{
+				// collect responses that are ready to go, in order; we stop at the first one that is not (yet) completed
+				segmentsToFlush.clear();
+				uint64_t first = rrQueue.getTail();
+				uint64_t last = first;
+				bool closing = false;
+				for ( ; last<rrQueue.getHeadIdx() && !closing; ++last )
+				{
+					auto& rr = rrQueue.at( last );
+					if ( !rr.active || rr.response->writeStatus != HttpServerResponse::WriteStatus::completed )
+						break;
+					segmentsToFlush.push_back( BufferView( rr.response->headerBuff ) );
+					if ( rr.response->body.size() )
+						segmentsToFlush.push_back( BufferView( rr.response->body ) );
+					closing = rr.response->connStatus != HttpMessageBase::ConnStatus::keep_alive;
+				}
+				if ( last == first )
+					break;
+
+				try {
+					co_await a_writev( segmentsToFlush.data(), segmentsToFlush.size() );
+				} 
+				catch(...) {
+					// TODO: revise!!! (see also other write error processing at HttpServerResponse)
+					flushInProgress = false;
+					end();
+					CO_RETURN;
+				}
+
+				for ( uint64_t i=first; i<last; ++i )
+				{
+					auto& rr = rrQueue.at( i );
+					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, rr.response->idx == i, "{} vs. {}", rr.response->idx, i );
+					rr.request->releaseBodyChunk();
+					bool bodyUnread = !rr.request->isBodyCompleted(); // we cannot find where the next request starts
+					rr.request->clear();
+					if ( rr.response->connStatus != HttpMessageBase::ConnStatus::keep_alive || bodyUnread )
+					{
+						rr.response->clear();
+						flushInProgress = false;
+						end();
+						CO_RETURN;
+					}
+					rr.response->clear();
+					if ( i + 1 == last )
+						flushInProgress = false; // let the next response in line (if any) go on its own as soon as it is released
+					release( i );
+				}
+				flushInProgress = true;
+			}
+			flushInProgress = false;
+			proceedToNext();
+			CO_RETURN;
+		}
+#endif // NODECPP_NO_COROUTINES
+
+		inline
+		HttpSocketBase::RRPair& HttpSocketBase::RRQueue::getHead() {
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, canPush() );
+			auto& ret = cbuff[idxToStorageIdx(head)];
+			ret.active = true;
+			ret.request->idx = head;
+			ret.response->idx = head;
+			++head;
+			return ret;
+		}
+
+		inline
+		void HttpSocketBase::RRQueue::init( nodecpp::safememory::soft_ptr<HttpSocketBase> socket, size_t depth ) {
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, cbuff == nullptr );
+			sizeExp = 0;
+			while ( ((size_t)1 << sizeExp) < depth )
+				++sizeExp;
 			size_t size = ((size_t)1 << sizeExp);
 			cbuff = nodecpp::alloc<RRPair>( size ); // TODO: use nodecpp::a
 			//cbuff = new RRPair [size];
 			for ( size_t i=0; i<size; ++i )
-			{
-				cbuff[i].request = nodecpp::safememory::make_owning<IncomingHttpMessageAtServer>();
-				cbuff[i].response = nodecpp::safememory::make_owning<HttpServerResponse>();
-				nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> tmprq = (cbuff[i].request);
-				nodecpp::safememory::soft_ptr<HttpServerResponse> tmrsp = (cbuff[i].response);
-				cbuff[i].response->counterpart = nodecpp::safememory::soft_ptr_reinterpret_cast<HttpMessageBase>(tmprq);
-				cbuff[i].request->counterpart = nodecpp::safememory::soft_ptr_reinterpret_cast<HttpMessageBase>(tmrsp);
-				cbuff[i].request->sock = socket;
-				cbuff[i].response->sock = socket;
-				cbuff[i].response->myRequest = cbuff[i].request;
-			}
+				initRequestResponsePair( cbuff[i].request, cbuff[i].response, socket );
 		}	
 
+		inline
+		void HttpSocketBase::initRequestResponsePair( nodecpp::safememory::owning_ptr<IncomingHttpMessageAtServer>& request, nodecpp::safememory::owning_ptr<HttpServerResponse>& response, nodecpp::safememory::soft_ptr<HttpSocketBase> socket ) {
+			request = nodecpp::safememory::make_owning<IncomingHttpMessageAtServer>();
+			response = nodecpp::safememory::make_owning<HttpServerResponse>();
+			nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> tmprq = request;
+			nodecpp::safememory::soft_ptr<HttpServerResponse> tmrsp = response;
+			response->counterpart = nodecpp::safememory::soft_ptr_reinterpret_cast<HttpMessageBase>(tmprq);
+			request->counterpart = nodecpp::safememory::soft_ptr_reinterpret_cast<HttpMessageBase>(tmrsp);
+			request->sock = socket;
+			response->sock = socket;
+			response->myRequest = request;
+		}
+
 	} //namespace net
 } //namespace nodecpp
 
@@ -0,0 +1,635 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef HTTP_STATIC_H
+#define HTTP_STATIC_H
+
+#include "http_server.h"
+#include "timers.h"
+#include "offload.h"
+
+#include <string_view>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef NODECPP_NO_COROUTINES
+
+namespace nodecpp {
+
+	namespace net {
+
+		namespace internal_usage_only {
+
+			struct StaticFileStat
+			{
+				uint64_t size = 0;
+				int64_t mtime = 0;
+				uint64_t inode = 0;
+				bool isRegular = false;
+			};
+
+#ifdef _MSC_VER
+			inline int staticFileOpen( const char* path ) { return ::_open( path, _O_RDONLY | _O_BINARY ); }
+			inline void staticFileClose( int fd ) { ::_close( fd ); }
+			inline void staticFileStatFrom( const struct _stat64& st, StaticFileStat& ret )
+			{
+				ret.size = st.st_size;
+				ret.mtime = st.st_mtime;
+				ret.inode = st.st_ino;
+				ret.isRegular = ( st.st_mode & _S_IFMT ) == _S_IFREG;
+			}
+			inline bool staticFileStat( const char* path, StaticFileStat& ret )
+			{
+				struct _stat64 st;
+				if ( ::_stat64( path, &st ) != 0 )
+					return false;
+				staticFileStatFrom( st, ret );
+				return true;
+			}
+			inline bool staticFileFstat( int fd, StaticFileStat& ret )
+			{
+				struct _stat64 st;
+				if ( ::_fstat64( fd, &st ) != 0 )
+					return false;
+				staticFileStatFrom( st, ret );
+				return true;
+			}
+#else
+			inline int staticFileOpen( const char* path ) { return ::open( path, O_RDONLY | O_CLOEXEC ); }
+			inline void staticFileClose( int fd ) { ::close( fd ); }
+			inline void staticFileStatFrom( const struct stat& st, StaticFileStat& ret )
+			{
+				ret.size = st.st_size;
+				ret.mtime = st.st_mtime;
+				ret.inode = st.st_ino;
+				ret.isRegular = S_ISREG( st.st_mode );
+			}
+			inline bool staticFileStat( const char* path, StaticFileStat& ret )
+			{
+				struct stat st;
+				if ( ::stat( path, &st ) != 0 )
+					return false;
+				staticFileStatFrom( st, ret );
+				return true;
+			}
+			inline bool staticFileFstat( int fd, StaticFileStat& ret )
+			{
+				struct stat st;
+				if ( ::fstat( fd, &st ) != 0 )
+					return false;
+				staticFileStatFrom( st, ret );
+				return true;
+			}
+#endif
+
+			struct StaticFileProbe // result of blocking file system calls; trivially copyable to pass from an offload thread
+			{
+				int fd = -1;
+				StaticFileStat st;
+				bool ok = false; // a regular file (and fd is open, if requested)
+			};
+
+			inline StaticFileProbe staticFileProbe( const char* path, bool doOpen )
+			{
+				StaticFileProbe ret;
+				if ( !doOpen )
+				{
+					ret.ok = staticFileStat( path, ret.st ) && ret.st.isRegular;
+					return ret;
+				}
+				ret.fd = staticFileOpen( path );
+				if ( ret.fd < 0 )
+					return ret;
+				ret.ok = staticFileFstat( ret.fd, ret.st ) && ret.st.isRegular;
+				if ( !ret.ok )
+				{
+					staticFileClose( ret.fd );
+					ret.fd = -1;
+				}
+				return ret;
+			}
+
+			// parses HTTP-date in any of the formats of RFC 7231, 7.1.1.1 (IMF-fixdate, RFC 850, asctime); ret is seconds since the epoch
+			inline bool parseHttpDate( std::string_view s, int64_t& ret )
+			{
+				static const char* months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+				auto num = [&s]( size_t maxDigits, int& val ) {
+					size_t i = 0;
+					val = 0;
+					while ( i < maxDigits && i < s.size() && s[i] >= '0' && s[i] <= '9' )
+						val = val * 10 + ( s[i++] - '0' );
+					s.remove_prefix( i );
+					return i != 0;
+				};
+				auto skip = [&s]( char ch ) {
+					if ( s.empty() || s.front() != ch )
+						return false;
+					s.remove_prefix( 1 );
+					return true;
+				};
+				auto spaces = [&s]() {
+					while ( s.size() && s.front() == ' ' )
+						s.remove_prefix( 1 );
+				};
+				auto month = [&s]( int& val ) {
+					if ( s.size() < 3 )
+						return false;
+					for ( int i=0; i<12; ++i )
+						if ( s.substr( 0, 3 ) == months[i] )
+						{
+							val = i + 1;
+							s.remove_prefix( 3 );
+							return true;
+						}
+					return false;
+				};
+				auto hms = [&]( int& h, int& m, int& sec ) {
+					return num( 2, h ) && skip( ':' ) && num( 2, m ) && skip( ':' ) && num( 2, sec );
+				};
+
+				int day = 0, mon = 0, year = 0, h = 0, m = 0, sec = 0;
+				size_t wdayEnd = s.find_first_of( ", " );
+				if ( wdayEnd == std::string_view::npos )
+					return false;
+				bool comma = s[wdayEnd] == ',';
+				s.remove_prefix( wdayEnd + 1 );
+				spaces();
+				if ( comma && s.size() > 2 && s[2] == '-' ) // RFC 850: Sunday, 06-Nov-94 08:49:37 GMT
+				{
+					if ( !( num( 2, day ) && skip( '-' ) && month( mon ) && skip( '-' ) && num( 4, year ) ) )
+						return false;
+					if ( year < 100 ) // RFC 7231: a two-digit year more than 50 years in the future is in the past
+						year += year < 70 ? 2000 : 1900;
+					spaces();
+					if ( !hms( h, m, sec ) )
+						return false;
+				}
+				else if ( comma ) // IMF-fixdate: Sun, 06 Nov 1994 08:49:37 GMT
+				{
+					if ( !( num( 2, day ) && skip( ' ' ) && month( mon ) && skip( ' ' ) && num( 4, year ) && skip( ' ' ) && hms( h, m, sec ) ) )
+						return false;
+				}
+				else // asctime: Sun Nov  6 08:49:37 1994
+				{
+					if ( !month( mon ) )
+						return false;
+					spaces();
+					if ( !( num( 2, day ) && skip( ' ' ) && hms( h, m, sec ) && skip( ' ' ) && num( 4, year ) ) )
+						return false;
+				}
+				if ( day < 1 || day > 31 || h > 23 || m > 59 || sec > 60 )
+					return false;
+
+				// days from civil (proleptic Gregorian calendar)
+				int64_t y = year - ( mon <= 2 ? 1 : 0 );
+				int64_t era = ( y >= 0 ? y : y - 399 ) / 400;
+				int64_t yoe = y - era * 400;
+				int64_t doy = ( 153 * ( mon + ( mon > 2 ? -3 : 9 ) ) + 2 ) / 5 + day - 1;
+				int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+				int64_t days = era * 146097 + doe - 719468;
+				ret = days * 86400 + h * 3600 + m * 60 + sec;
+				return true;
+			}
+		} // namespace internal_usage_only
+
+		/*
+			Serves files under a root directory for GET and HEAD requests.
+			Open descriptors, their stat() data and pre-rendered response headers are cached per file and revalidated (by stat())
+			once in cacheTtlMs; bodies go directly from file to socket (see HttpServerResponse::endWithFile()).
+			Supports ETag/If-None-Match, Last-Modified/If-Modified-Since, and a single byte range (Range/If-Range);
+			requests for multiple ranges are answered with the whole file.
+			With NODECPP_ENABLE_CLUSTERING, open() and stat() are run at the offload pool (see offload.h), so that a slow disk
+			does not stall the loop; otherwise (or if the pool queue is full) they are called right away.
+
+			Usage: staticFiles.mount( server->getRouter(), "/assets" ); the instance must outlive the server.
+		*/
+		class HttpStaticFiles
+		{
+		public:
+			struct Options
+			{
+				nodecpp::string root = ".";
+				nodecpp::string indexFile = "index.html"; // served for paths ending with '/'
+				size_t cacheTtlMs = 1000;
+				size_t maxCachedFiles = 1024; // at least 1
+				int64_t maxAge = -1; // if non-negative, 'Cache-Control: max-age=<maxAge>' is added
+			};
+
+		private:
+			struct CachedFile
+			{
+				int fd = -1;
+				internal_usage_only::StaticFileStat st;
+				nodecpp::string etag;
+				nodecpp::string lastModified;
+				nodecpp::string headers; // rendered header lines (except Content-Length and Content-Range), each ending with CRLF
+				size_t checkedAt = 0;
+				size_t users = 0; // responses being sent from fd
+				bool stale = false; // removed from cache; to be closed as soon as not in use
+
+				CachedFile() {}
+				CachedFile(const CachedFile&) = delete;
+				CachedFile& operator = (const CachedFile&) = delete;
+				~CachedFile() { if ( fd >= 0 ) internal_usage_only::staticFileClose( fd ); }
+			};
+
+			Options options;
+			nodecpp::map<nodecpp::string, nodecpp::safememory::owning_ptr<CachedFile>> cache; // by path relative to root
+			nodecpp::vector<nodecpp::safememory::owning_ptr<CachedFile>> retired; // stale, but still in use
+
+			static const char* mimeType( std::string_view path )
+			{
+				static const struct { const char* ext; const char* type; } types[] = {
+					{ "html", "text/html; charset=utf-8" }, { "htm", "text/html; charset=utf-8" }, { "css", "text/css; charset=utf-8" },
+					{ "js", "application/javascript; charset=utf-8" }, { "mjs", "application/javascript; charset=utf-8" },
+					{ "json", "application/json" }, { "txt", "text/plain; charset=utf-8" }, { "xml", "application/xml" },
+					{ "svg", "image/svg+xml" }, { "png", "image/png" }, { "jpg", "image/jpeg" }, { "jpeg", "image/jpeg" },
+					{ "gif", "image/gif" }, { "webp", "image/webp" }, { "ico", "image/x-icon" }, { "woff", "font/woff" },
+					{ "woff2", "font/woff2" }, { "wasm", "application/wasm" }, { "pdf", "application/pdf" }, { "mp4", "video/mp4" },
+				};
+				size_t dot = path.find_last_of( "./" );
+				if ( dot == std::string_view::npos || path[dot] != '.' )
+					return "application/octet-stream";
+				std::string_view ext = path.substr( dot + 1 );
+				for ( auto& t : types )
+				{
+					size_t len = strlen( t.ext );
+					if ( len != ext.size() )
+						continue;
+					size_t i = 0;
+					while ( i < len && ( ext[i] | 0x20 ) == t.ext[i] )
+						++i;
+					if ( i == len )
+						return t.type;
+				}
+				return "application/octet-stream";
+			}
+
+			static nodecpp::string httpDate( int64_t t )
+			{
+				time_t tt = (time_t)t;
+				struct tm tm;
+#ifdef _MSC_VER
+				gmtime_s( &tm, &tt );
+#else
+				gmtime_r( &tt, &tm );
+#endif
+				char buff[64];
+				size_t sz = strftime( buff, sizeof(buff), "%a, %d %b %Y %H:%M:%S GMT", &tm );
+				return nodecpp::string( buff, sz );
+			}
+
+			// percent-decodes a path ('+' is kept as is); returns false for paths that may escape root
+			static bool decodePath( std::string_view raw, nodecpp::string& out )
+			{
+				out.clear();
+				for ( size_t i=0; i<raw.size(); ++i )
+				{
+					char ch = raw[i];
+					if ( ch == '%' && i + 2 < raw.size() && isxdigit( (unsigned char)raw[i+1] ) && isxdigit( (unsigned char)raw[i+2] ) )
+					{
+						char hex[3] = { raw[i+1], raw[i+2], 0 };
+						ch = (char)strtol( hex, nullptr, 16 );
+						i += 2;
+					}
+					if ( ch == 0 || ch == '\\' )
+						return false;
+					out.push_back( ch );
+				}
+				for ( size_t pos = 0; pos <= out.size(); ) // no '..' segments
+				{
+					size_t end = out.find( '/', pos );
+					if ( end == nodecpp::string::npos )
+						end = out.size();
+					if ( end - pos == 2 && out[pos] == '.' && out[pos+1] == '.' )
+						return false;
+					pos = end + 1;
+				}
+				return true;
+			}
+
+			static std::string_view trim( std::string_view s )
+			{
+				while ( s.size() && ( s.front() == ' ' || s.front() == '\t' ) )
+					s.remove_prefix( 1 );
+				while ( s.size() && ( s.back() == ' ' || s.back() == '\t' ) )
+					s.remove_suffix( 1 );
+				return s;
+			}
+
+			static bool etagMatches( std::string_view list, std::string_view etag ) // weak comparison, as required for If-None-Match
+			{
+				while ( list.size() )
+				{
+					size_t comma = list.find( ',' );
+					std::string_view tag = trim( list.substr( 0, comma ) );
+					if ( tag == "*" )
+						return true;
+					if ( tag.size() > 2 && tag[0] == 'W' && tag[1] == '/' )
+						tag.remove_prefix( 2 );
+					if ( tag == etag )
+						return true;
+					if ( comma == std::string_view::npos )
+						break;
+					list.remove_prefix( comma + 1 );
+				}
+				return false;
+			}
+
+			static bool parseNum( std::string_view s, uint64_t& ret )
+			{
+				if ( s.empty() || s.size() > 19 )
+					return false;
+				ret = 0;
+				for ( char ch : s )
+				{
+					if ( ch < '0' || ch > '9' )
+						return false;
+					ret = ret * 10 + ( ch - '0' );
+				}
+				return true;
+			}
+
+			enum class RangeResult { none, ok, unsatisfiable };
+			// single 'bytes=' range only; anything else is ignored (whole file is served)
+			static RangeResult parseRange( std::string_view hdr, uint64_t size, uint64_t& from, uint64_t& to )
+			{
+				hdr = trim( hdr );
+				if ( hdr.substr( 0, 6 ) != "bytes=" )
+					return RangeResult::none;
+				hdr = trim( hdr.substr( 6 ) );
+				size_t dash = hdr.find( '-' );
+				if ( dash == std::string_view::npos || hdr.find( ',' ) != std::string_view::npos )
+					return RangeResult::none;
+				std::string_view first = trim( hdr.substr( 0, dash ) );
+				std::string_view last = trim( hdr.substr( dash + 1 ) );
+				uint64_t a, b;
+				if ( first.empty() ) // suffix: last b bytes
+				{
+					if ( !parseNum( last, b ) )
+						return RangeResult::none;
+					if ( b == 0 || size == 0 )
+						return RangeResult::unsatisfiable;
+					from = b < size ? size - b : 0;
+					to = size - 1;
+					return RangeResult::ok;
+				}
+				if ( !parseNum( first, a ) )
+					return RangeResult::none;
+				if ( last.empty() )
+					b = UINT64_MAX;
+				else if ( !parseNum( last, b ) || b < a )
+					return RangeResult::none;
+				if ( a >= size )
+					return RangeResult::unsatisfiable;
+				from = a;
+				to = b < size ? b : size - 1;
+				return RangeResult::ok;
+			}
+
+			void release( nodecpp::safememory::soft_ptr<CachedFile> file )
+			{
+				if ( --(file->users) == 0 && file->stale )
+					for ( size_t i=0; i<retired.size(); ++i )
+						if ( retired[i]->fd == file->fd ) // open descriptors are unique
+						{
+							retired[i] = std::move( retired.back() );
+							retired.pop_back();
+							break;
+						}
+			}
+
+			void retire( nodecpp::safememory::owning_ptr<CachedFile>& file ) // file must have been removed from cache
+			{
+				if ( file->users == 0 )
+					return; // closed as file goes out of scope
+				file->stale = true;
+				retired.push_back( std::move( file ) );
+			}
+
+			void evictOne()
+			{
+				auto oldest = cache.begin();
+				for ( auto it = cache.begin(); it != cache.end(); ++it )
+					if ( it->second->checkedAt < oldest->second->checkedAt )
+						oldest = it;
+				nodecpp::safememory::owning_ptr<CachedFile> file = std::move( oldest->second );
+				cache.erase( oldest );
+				retire( file );
+			}
+
+			static ::nodecpp::awaitable<internal_usage_only::StaticFileProbe> a_probe( const nodecpp::string& fullPath, bool doOpen )
+			{
+#ifdef NODECPP_ENABLE_CLUSTERING
+				try {
+					internal_usage_only::StaticFileProbe ret = co_await nodecpp::offload( [path = fullPath, doOpen]() { return internal_usage_only::staticFileProbe( path.c_str(), doOpen ); } );
+					CO_RETURN ret;
+				}
+				catch ( Error& ) {} // the pool queue is full
+#endif
+				CO_RETURN internal_usage_only::staticFileProbe( fullPath.c_str(), doOpen );
+			}
+
+			nodecpp::safememory::owning_ptr<CachedFile> makeFile( const internal_usage_only::StaticFileProbe& probe, std::string_view relPath, size_t now )
+			{
+				nodecpp::safememory::owning_ptr<CachedFile> file = nodecpp::safememory::make_owning<CachedFile>();
+				file->fd = probe.fd;
+				file->st = probe.st;
+				file->checkedAt = now;
+				file->etag = nodecpp::format( "\"{:x}-{:x}\"", file->st.mtime, file->st.size );
+				file->lastModified = httpDate( file->st.mtime );
+				file->headers = nodecpp::format( "Content-Type: {}\r\nETag: {}\r\nLast-Modified: {}\r\nAccept-Ranges: bytes\r\n", mimeType( relPath ), file->etag, file->lastModified );
+				if ( options.maxAge >= 0 )
+					file->headers.append( nodecpp::format( "Cache-Control: max-age={}\r\n", options.maxAge ) );
+				return file;
+			}
+
+			// returns false if there is no such (regular) file; the cache may change while file system calls are awaited
+			::nodecpp::awaitable<bool> a_lookup( const nodecpp::string& relPath, nodecpp::safememory::soft_ptr<CachedFile>& ret )
+			{
+				nodecpp::string fullPath = options.root;
+				fullPath.append( relPath );
+				auto f = cache.find( relPath );
+				if ( f != cache.end() )
+				{
+					if ( nodecpp::time::now() - f->second->checkedAt < options.cacheTtlMs )
+					{
+						ret = f->second;
+						CO_RETURN true;
+					}
+					internal_usage_only::StaticFileProbe probe = co_await a_probe( fullPath, false );
+					size_t now = nodecpp::time::now();
+					f = cache.find( relPath );
+					if ( f != cache.end() )
+					{
+						bool refreshed = now - f->second->checkedAt < options.cacheTtlMs; // by another request meanwhile
+						if ( refreshed || ( probe.ok && probe.st.size == f->second->st.size && probe.st.mtime == f->second->st.mtime && probe.st.inode == f->second->st.inode ) )
+						{
+							if ( !refreshed )
+								f->second->checkedAt = now;
+							ret = f->second;
+							CO_RETURN true;
+						}
+						nodecpp::safememory::owning_ptr<CachedFile> file = std::move( f->second );
+						cache.erase( f );
+						retire( file );
+					}
+				}
+				internal_usage_only::StaticFileProbe probe = co_await a_probe( fullPath, true );
+				if ( !probe.ok )
+					CO_RETURN false;
+				size_t now = nodecpp::time::now();
+				nodecpp::safememory::owning_ptr<CachedFile> file = makeFile( probe, relPath, now );
+				f = cache.find( relPath );
+				if ( f != cache.end() ) // opened by another request meanwhile
+				{
+					nodecpp::safememory::owning_ptr<CachedFile> prev = std::move( f->second );
+					cache.erase( f );
+					retire( prev );
+				}
+				else if ( cache.size() >= options.maxCachedFiles && cache.size() )
+					evictOne();
+				auto ins = cache.insert( std::make_pair( relPath, std::move( file ) ) );
+				ret = ins.first->second;
+				CO_RETURN true;
+			}
+
+			nodecpp::handler_ret_type serve( nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response )
+			{
+				nodecpp::string relPath;
+				if ( !decodePath( request->getRouteParams().get( "path" ), relPath ) )
+				{
+					response->writeHead( 400, "Bad Request" );
+					response->end();
+					CO_RETURN;
+				}
+				relPath.insert( relPath.begin(), '/' );
+				if ( relPath.back() == '/' )
+					relPath.append( options.indexFile );
+
+				nodecpp::safememory::soft_ptr<CachedFile> file;
+				if ( !co_await a_lookup( relPath, file ) )
+				{
+					response->writeHead( 404, "Not Found" );
+					response->end();
+					CO_RETURN;
+				}
+				bool headersOnly = request->getMethod() == "HEAD";
+				const nodecpp::string& version = request->getHttpVersion();
+
+				const nodecpp::string* inm = request->getHeader( "if-none-match" );
+				const nodecpp::string* ims = inm == nullptr ? request->getHeader( "if-modified-since" ) : nullptr; // ignored if If-None-Match is present
+				int64_t imsTime = 0;
+				bool notModified = inm != nullptr ? etagMatches( *inm, file->etag ) : ( ims != nullptr && internal_usage_only::parseHttpDate( trim( *ims ), imsTime ) && file->st.mtime <= imsTime );
+				if ( notModified )
+				{
+					nodecpp::string status = nodecpp::format( "HTTP/{} 304 Not Modified\r\n", version );
+					status.append( file->headers );
+					status.erase( status.end() - 2, status.end() );
+					response->setStatus( std::move( status ) );
+					++(file->users);
+					co_await response->endWithFile( file->fd, 0, file->st.size, true ); // Content-Length of the full representation, no body
+					release( file );
+					CO_RETURN;
+				}
+
+				uint64_t from = 0, to = 0;
+				RangeResult range = RangeResult::none;
+				const nodecpp::string* rangeHdr = request->getHeader( "range" );
+				if ( rangeHdr != nullptr )
+				{
+					const nodecpp::string* ifRange = request->getHeader( "if-range" );
+					if ( ifRange == nullptr || trim( *ifRange ) == std::string_view( file->etag ) || trim( *ifRange ) == std::string_view( file->lastModified ) )
+						range = parseRange( *rangeHdr, file->st.size, from, to );
+				}
+
+				if ( range == RangeResult::unsatisfiable )
+				{
+					response->setStatus( nodecpp::format( "HTTP/{} 416 Range Not Satisfiable\r\nContent-Range: bytes */{}", version, file->st.size ) );
+					response->end();
+					CO_RETURN;
+				}
+
+				nodecpp::string status;
+				uint64_t count = file->st.size;
+				if ( range == RangeResult::ok )
+				{
+					count = to - from + 1;
+					status = nodecpp::format( "HTTP/{} 206 Partial Content\r\n", version );
+					status.append( file->headers );
+					status.append( nodecpp::format( "Content-Range: bytes {}-{}/{}", from, to, file->st.size ) );
+				}
+				else
+				{
+					status = nodecpp::format( "HTTP/{} 200 OK\r\n", version );
+					status.append( file->headers );
+					status.erase( status.end() - 2, status.end() );
+				}
+				response->setStatus( std::move( status ) );
+				++(file->users); // fd stays open till the response is sent, even if the file is evicted meanwhile
+				co_await response->endWithFile( file->fd, from, (size_t)count, headersOnly );
+				release( file );
+				CO_RETURN;
+			}
+
+		public:
+			HttpStaticFiles( Options options_ ) : options( std::move( options_ ) )
+			{
+				while ( options.root.size() && ( options.root.back() == '/' || options.root.back() == '\\' ) )
+					options.root.pop_back();
+			}
+			HttpStaticFiles(const HttpStaticFiles&) = delete;
+			HttpStaticFiles& operator = (const HttpStaticFiles&) = delete;
+
+			// adds GET and HEAD routes for '<prefix>/*'
+			void mount( HttpRouter& router, const char* prefix )
+			{
+				nodecpp::string pattern = prefix;
+				while ( pattern.size() && pattern.back() == '/' )
+					pattern.pop_back();
+				pattern.append( "/*path" );
+				auto handler = [this]( nodecpp::safememory::soft_ptr<IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<HttpServerResponse> response ) { return serve( request, response ); };
+				router.add( "GET", pattern.c_str(), handler );
+				router.add( "HEAD", pattern.c_str(), handler );
+			}
+
+			size_t cachedFileCount() const { return cache.size(); }
+		};
+
+	} //namespace net
+} //namespace nodecpp
+
+#endif // NODECPP_NO_COROUTINES
+
+#endif // HTTP_STATIC_H
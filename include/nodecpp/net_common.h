@@ -83,6 +83,24 @@ namespace nodecpp {
 			return cp;
 		}
 
+		// ownership transfer of the underlying memory (e.g. to another thread); the memory must eventually get back to a Buffer by adopt()
+		// at the thread that allocated it
+		uint8_t* release(size_t& sz, size_t& cp) {
+			sz = _size;
+			cp = _capacity;
+			_size = 0;
+			_capacity = 0;
+			return _data.release();
+		}
+		static Buffer adopt(uint8_t* dt, size_t sz, size_t cp) {
+			assert(sz <= cp);
+			Buffer b;
+			b._data.reset(dt);
+			b._size = sz;
+			b._capacity = cp;
+			return b;
+		}
+
 		void reserve(size_t sz) {
 			assert(_size == 0);
 			assert(_capacity == 0);
@@ -213,6 +231,24 @@ namespace nodecpp {
 		}
 	};
 
+	// non-owning view over a contiguous range of bytes; used to pass borrowed data (string literals, pre-built buffers, etc)
+	// to gather writes without copying. NOTE: viewed data is consumed (sent or copied to socket's own buffers) by the write call itself
+	class BufferView {
+	private:
+		const uint8_t* _data = nullptr;
+		size_t _size = 0;
+
+	public:
+		BufferView() {}
+		BufferView(const void* dt, size_t sz) : _data( reinterpret_cast<const uint8_t*>(dt) ), _size( sz ) {}
+		BufferView(const Buffer& b) : _data( b.begin() ), _size( b.size() ) {}
+
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		const uint8_t* begin() const { return _data; }
+		const uint8_t* end() const { return _data + _size; }
+	};
+
 	class CircularByteBuffer
 	{
 		std::unique_ptr<uint8_t[]> buff; // TODO: switch to using safe memory objects ASAP
@@ -222,9 +258,17 @@ namespace nodecpp {
 		uint8_t* end = nullptr;
 
 		bool resize_up_and_append( const uint8_t* data, size_t data_size) {
+			if ( !resize_up( used_size() + data_size ) )
+				return false;
+			memcpy( end, data, data_size );
+			end += data_size;
+
+			return true;
+		}
+
+		bool resize_up( size_t total_sz ) {
 			// TODO: introduce upper limit and make this call bool
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, buff != nullptr );
-			size_t total_sz = used_size() + data_size;
 			size_t new_size_exp = size_exp + 1;
 			while ( (((size_t)1) << new_size_exp) < total_sz + 1 )
 			{
@@ -254,9 +298,6 @@ namespace nodecpp {
 			begin = buff.get();
 			end = begin + sz;
 
-			memcpy( end, data, data_size );
-			end += data_size;
-
 			return true;
 		}
 
@@ -284,6 +325,11 @@ namespace nodecpp {
 		size_t remaining_capacity() const { return alloc_size() - 1 - used_size(); }
 		bool empty() const { return begin == end; }
 		size_t alloc_size() const { return ((size_t)1)<<size_exp; }
+		bool reserve( size_t capacity ) { // NOTE: may invalidate pointers
+			if ( alloc_size() - 1 >= capacity )
+				return true;
+			return resize_up( capacity );
+		}
 
 		// direct access to data
 		struct AvailableDataDescriptor
@@ -588,106 +634,15 @@ namespace nodecpp {
 			};
 			nodecpp::vector<HandlerInstance> handlers;
 
-			bool willHandle() { return handlers.size(); }
-			void from(const UserDefHandlersBase<FnT>& patternUH, void* defaultObjPtr)
-			{
-				NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, handlers.size() == 0);
-				handlers = patternUH.handlers;
-				for (size_t i = 0; i < handlers.size(); ++i)
-					if (handlers[i].object == nullptr)
-						handlers[i].object = defaultObjPtr;
-			}
-		};
-
-		template<class FnT>
-		struct UserDefHandlersWithOptimizedStorage
-		{
-			struct HandlerInstance
-			{
-				FnT handler = nullptr;
-				void *object = nullptr;
-			};
-			using HandlerInstanceVectorT = nodecpp::vector<HandlerInstance>;
-			enum Type { uninitialized, zero, one, two, many };
-			Type type = Type::uninitialized;
-			static constexpr size_t fixed_size = 2;
-			uint8_t basebytes[ sizeof( HandlerInstanceVectorT ) > sizeof( HandlerInstance ) * fixed_size ? sizeof( HandlerInstanceVectorT ) : sizeof( HandlerInstance ) * fixed_size ];
-			HandlerInstance* handlers_a() { return reinterpret_cast<HandlerInstance*>(basebytes); }
-			HandlerInstanceVectorT& handlers_v() { return *reinterpret_cast<HandlerInstanceVectorT*>(basebytes); }
-
-
-			bool willHandle() { 
-				return type != Type::uninitialized && type != Type::zero; 
-			}
-			void from(const UserDefHandlersBase<FnT>& patternUH, void* defaultObjPtr)
-			{
-				NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, type == Type::uninitialized);
-				if ( patternUH.handlers.size() == 0 )
-				{
-					type = Type::zero;
-					return;
-				}
-				else if ( patternUH.handlers.size() == 1 )
-				{
-					static_assert( fixed_size >= 1 );
-					type = Type::one;
-					handlers_a()[0].handler = patternUH.handlers[0].handler;
-					handlers_a()[0].object = patternUH.handlers[0].object != nullptr ? patternUH.handlers[0].object : defaultObjPtr;
-					return;
-				}
-				else if ( patternUH.handlers.size() == 2 )
-				{
-					static_assert( fixed_size >= 2 );
-					type = Type::two;
-					handlers_a()[0].handler = patternUH.handlers[0].handler;
-					handlers_a()[0].object = patternUH.handlers[0].object != nullptr ? patternUH.handlers[0].object : defaultObjPtr;
-					handlers_a()[1].handler = patternUH.handlers[1].handler;
-					handlers_a()[1].object = patternUH.handlers[1].object != nullptr ? patternUH.handlers[1].object : defaultObjPtr;
-					return;
-				}
-				else
-				{
-					static_assert( fixed_size <= 2 );
-					type = Type::many;
-					new(basebytes)HandlerInstanceVectorT();
-					handlers_v().resize( patternUH.handlers.size() );
-					for (size_t i = 0; i < handlers_v().size(); ++i)
-					{
-						handlers_v()[i].handler = patternUH.handlers[i].handler;
-						handlers_v()[i].object = patternUH.handlers[i].object != nullptr ? patternUH.handlers[i].object : defaultObjPtr;
-					}
-				}
-			}
+			bool willHandle() const { return handlers.size(); }
+			// handlers with no object are called for defaultObjPtr (normally, an instance of the user class)
 			template<class ... ARGS>
-			void execute(ARGS&& ... args) { 
-				NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, type != Type::uninitialized );
-				NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, type != Type::zero );
-				if ( type == Type::one )
-				{
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, handlers_a()[0].object != nullptr ); 
-					handlers_a()[0].handler(handlers_a()[0].object, ::std::forward<ARGS>(args)...);
-				}
-				else if ( type == Type::two )
+			void execute(void* defaultObjPtr, ARGS&& ... args) const {
+				for (auto& h : handlers)
 				{
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, handlers_a()[0].object != nullptr ); 
-					handlers_a()[0].handler(handlers_a()[0].object, ::std::forward<ARGS>(args)...);
-					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, handlers_a()[1].object != nullptr ); 
-					handlers_a()[1].handler(handlers_a()[1].object, ::std::forward<ARGS>(args)...);
-				}
-				else
-				{
-					NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, type == Type::many );
-					for (auto h : handlers_v()) 
-					{
-						NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, h.object != nullptr ); 
-						h.handler(h.object, ::std::forward<ARGS>(args)...);
-					}
-				}
-			}
-			~UserDefHandlersWithOptimizedStorage() {
-				if ( type == Type::many ) {
-					using myvectort = HandlerInstanceVectorT;
-					handlers_v().~myvectort();
+					void* object = h.object != nullptr ? h.object : defaultObjPtr;
+					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, object != nullptr ); 
+					h.handler(object, ::std::forward<ARGS>(args)...);
 				}
 			}
 		};
@@ -0,0 +1,237 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+#ifdef NODECPP_ENABLE_CLUSTERING
+
+#ifndef OFFLOAD_H
+#define OFFLOAD_H
+
+#include "cluster.h"
+#include <atomic>
+#include <exception>
+#include <optional>
+
+// Offload pool: a bounded set of threads for work that must not run at an event loop (CPU-heavy computations, blocking calls
+// like synchronous file reads or getaddrinfo()). co_await offload( fn ) runs fn at the pool and resumes the awaiting coroutine
+// at its own loop with fn's result or exception.
+// The pool is started at the first offload(); its size is taken from setOffloadPoolSize() or from command line arguments:
+//   offloadthreads=<N>   number of pool threads (default: a quarter of hardware threads, at least one)
+//   offloadqueue=<N>     max number of tasks waiting for a pool thread; offload() beyond it fails with an exception (default: 4096)
+//
+// Memory: with per-thread heaps (iibmalloc) memory may only be freed at the thread it is allocated at. Therefore fn is created
+// and destroyed at the awaiting thread, while its result is created and destroyed at the pool thread running it; the awaiting
+// coroutine gets a copy of the result made at its own thread (without iibmalloc, the result is moved instead). Exceptions are
+// passed as they are; exception objects may be released at either thread and should not own memory of per-thread heaps.
+// A coroutine may be destroyed while suspended in offload(): the task then still runs, but its result is discarded.
+
+namespace nodecpp
+{
+	enum class OffloadPriority { high, normal, low };
+	constexpr size_t offloadPriorityCount = 3;
+
+	struct OffloadTask // a unit of work queued to the offload pool
+	{
+		void (*run)( OffloadTask* self ) = nullptr; // called at a pool thread; the pool does not touch the task afterwards
+		uint64_t enqueuedAt = 0; // mks; set by the pool
+		size_t poolThread = 0; // set by the pool before calling 'run'
+		OffloadTask* next = nullptr; // for finalizeAtOffloadThread()
+	};
+
+	struct OffloadStats
+	{
+		size_t threads = 0;
+		size_t queued = 0; // waiting for a pool thread
+		size_t running = 0;
+		uint64_t completed = 0;
+		uint64_t rejected = 0; // because of queue overflow
+		uint64_t avgQueueLatencyUs = 0; // from offload() till start of running
+		uint64_t maxQueueLatencyUs = 0;
+		uint64_t avgRunTimeUs = 0;
+	};
+
+	void setOffloadPoolSize( size_t threadCnt, size_t maxQueued = 0 ); // to be called before the first offload(); 0 means default
+	OffloadStats getOffloadStats(); // thread-safe; values are read one by one and are not necessarily consistent with each other
+	bool submitOffloadTask( OffloadTask* task, OffloadPriority priority ); // thread-safe; false if the queue is full (the task is not taken then)
+	void finalizeAtOffloadThread( OffloadTask* task ); // thread-safe; task->run is called once more, at the pool thread that has run it (task->poolThread)
+
+	namespace internal_usage_only {
+
+		// shared by an offload_awaiter and the pool; allocated outside of the coroutine frame, which may be destroyed while the task runs
+		template<class FnT, class ResultT>
+		struct OffloadState : public OffloadTask
+		{
+			enum Stage { running, done, abandoned };
+			using ValueT = typename std::conditional<std::is_void<ResultT>::value, bool, ResultT>::type;
+
+			std::optional<FnT> fn; // created and destroyed at the home thread
+			std::optional<ValueT> result; // created and destroyed at the pool thread
+			std::exception_ptr exception;
+			ThreadID home;
+			std::experimental::coroutine_handle<> awaiting = nullptr;
+			std::atomic<int> stage = running;
+			bool frameGone = false; // the awaiting coroutine is destroyed; accessed at the home thread only
+
+			static OffloadState* create( FnT&& fn_, ThreadID home_, std::experimental::coroutine_handle<> awaiting_ )
+			{
+				nodecpp::safememory::stdallocator<OffloadState> alloc; // freed at another thread
+				OffloadState* state = alloc.allocate( 1 );
+				new(state) OffloadState;
+				state->fn.emplace( std::move( fn_ ) );
+				state->home = home_;
+				state->awaiting = awaiting_;
+				state->run = &runAtPool;
+				return state;
+			}
+
+			void destroy() // at the pool thread that has run it, if it has been run
+			{
+				this->~OffloadState();
+				nodecpp::safememory::stdallocator<OffloadState> alloc;
+				alloc.deallocate( this, 1 );
+			}
+
+			static void destroyAtPool( OffloadTask* self ) { static_cast<OffloadState*>( self )->destroy(); }
+
+			void release() // at the home thread, once done with the result
+			{
+				fn.reset();
+				run = &destroyAtPool;
+				finalizeAtOffloadThread( this );
+			}
+
+			static void runAtPool( OffloadTask* self )
+			{
+				OffloadState* me = static_cast<OffloadState*>( self );
+				try {
+					if constexpr ( std::is_void<ResultT>::value )
+					{
+						(*(me->fn))();
+						me->result.emplace( true );
+					}
+					else
+						me->result.emplace( (*(me->fn))() );
+				}
+				catch (...) {
+					me->exception = std::current_exception();
+				}
+				if ( me->stage.exchange( done ) == abandoned )
+				{
+					// the awaiting coroutine is gone: drop the result here; fn is to be destroyed at its own thread
+					me->result.reset();
+					me->exception = nullptr;
+					me->run = &destroyAtPool;
+					postToLoop( me->home, [me]() { me->release(); } );
+					return;
+				}
+				postToLoop( me->home, [me]() {
+					if ( me->frameGone )
+						me->release();
+					else
+						me->awaiting();
+				} );
+			}
+		};
+
+	} // namespace internal_usage_only
+
+#ifndef NODECPP_NO_COROUTINES
+	template<class F>
+	auto offload( F&& fn, OffloadPriority priority = OffloadPriority::normal )
+	{
+		using FnT = typename std::decay<F>::type;
+		using ResultT = decltype( std::declval<FnT&>()() );
+		using StateT = internal_usage_only::OffloadState<FnT, ResultT>;
+#ifdef NODECPP_USE_IIBMALLOC
+		static_assert( std::is_void<ResultT>::value || std::is_copy_constructible<ResultT>::value, "the result is copied to the awaiting thread (see above)" );
+#endif
+
+		struct offload_awaiter {
+			std::experimental::coroutine_handle<> myawaiting = nullptr;
+			FnT fn;
+			OffloadPriority priority;
+			StateT* state = nullptr; // while suspended
+			bool rejected = false;
+
+			offload_awaiter(F&& fn_, OffloadPriority priority_) : fn( std::forward<F>( fn_ ) ), priority( priority_ ) {}
+
+			offload_awaiter(const offload_awaiter &) = delete;
+			offload_awaiter &operator = (const offload_awaiter &) = delete;
+
+			~offload_awaiter() {
+				if ( state == nullptr )
+					return;
+				int expected = StateT::running;
+				if ( !state->stage.compare_exchange_strong( expected, StateT::abandoned ) ) // otherwise the pool takes care of it
+					state->frameGone = true; // resumption is already posted, and will release it instead
+			}
+
+			bool await_ready() {
+				return false;
+			}
+
+			bool await_suspend(std::experimental::coroutine_handle<> awaiting) {
+				nodecpp::setNoException(awaiting);
+				myawaiting = awaiting;
+				state = StateT::create( std::move( fn ), getThisThreadID(), awaiting );
+				if ( submitOffloadTask( state, priority ) )
+					return true;
+				state->fn.reset();
+				state->destroy(); // not run; nothing has been allocated at the pool
+				state = nullptr;
+				rejected = true;
+				return false; // resume right away
+			}
+
+			ResultT await_resume() {
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, myawaiting != nullptr ); 
+				if ( nodecpp::isException(myawaiting) )
+					throw nodecpp::getException(myawaiting);
+				if ( rejected )
+					throw Error();
+				StateT* done = state;
+				state = nullptr;
+				struct Releaser { StateT* s; ~Releaser() { s->release(); } } releaser{ done };
+				if ( done->exception )
+					std::rethrow_exception( done->exception );
+				if constexpr ( !std::is_void<ResultT>::value )
+				{
+#ifdef NODECPP_USE_IIBMALLOC
+					return ResultT( *(done->result) ); // copy at this thread; the original is freed at the pool thread
+#else
+					return std::move( *(done->result) );
+#endif
+				}
+			}
+		};
+		return offload_awaiter( std::forward<F>( fn ), priority );
+	}
+#endif // NODECPP_NO_COROUTINES
+
+} // namespace nodecpp
+
+#endif // OFFLOAD_H
+
+#endif // NODECPP_ENABLE_CLUSTERING
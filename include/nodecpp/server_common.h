@@ -36,6 +36,10 @@ namespace nodecpp {
 
 	namespace net {
 
+		// how a listener thread distributes accepted connections between workers (clustering); byLoad follows Cluster::setSchedulingPolicy(),
+		// the others send a client to the same worker as long as the set of workers is unchanged and that worker is not overloaded
+		enum class ConnectionDistribution : uint8_t { byLoad, byClientAddress, byClientAddressAndPort };
+
 		class ServerBase
 		{
 			friend class ::nodecpp::Cluster;
@@ -66,6 +70,7 @@ namespace nodecpp {
 				DataForCommandProcessing& operator=(DataForCommandProcessing&& other) = default;
 
 				Address localAddress;
+				ConnectionDistribution distribution = ConnectionDistribution::byLoad;
 
 				awaitable_handle_t ahd_listen = nullptr;
 				struct awaitable_connection_handle_data
@@ -216,40 +221,34 @@ namespace nodecpp {
 				};
 				thread_local static UserHandlerClassPatterns<UserHandlersForDataCollecting> userHandlerClassPattern; // TODO: consider using thread-local allocator
 
+				// handlers are shared by all instances of a user class; the table is immutable once applied (see UserHandlerClassPatterns)
 				struct UserHandlers : public UserHandlersCommon
 				{
-					bool initialized = false;
-				public:
-					UserDefHandlersWithOptimizedStorage<userDefListenHandlerFnT> userDefListenHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefConnectionHandlerFnT> userDefConnectionHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefCloseHandlerFnT> userDefCloseHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefErrorHandlerFnT> userDefErrorHandlers;
+					const UserHandlersForDataCollecting* pattern = nullptr;
+					void* defaultObjPtr = nullptr; // object for handlers being members of the user class itself
 
-					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr)
+					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr_)
 					{
-						if ( initialized )
+						if ( pattern != nullptr )
 							return;
-						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr != nullptr);
-						userDefListenHandlers.from(patternUH.userDefListenHandlers, defaultObjPtr);
-						userDefConnectionHandlers.from(patternUH.userDefConnectionHandlers, defaultObjPtr);
-						userDefCloseHandlers.from(patternUH.userDefCloseHandlers, defaultObjPtr);
-						userDefErrorHandlers.from(patternUH.userDefErrorHandlers, defaultObjPtr);
-						initialized = true;
+						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr_ != nullptr);
+						pattern = &patternUH;
+						defaultObjPtr = defaultObjPtr_;
 					}
 				};
 				UserHandlers userHandlers;
 
-				bool isListenEventHandler() { return userHandlers.userDefListenHandlers.willHandle(); }
-				void handleListenEvent(nodecpp::safememory::soft_ptr<ServerBase> server, size_t id, nodecpp::net::Address address) { userHandlers.userDefListenHandlers.execute(server, id, address); }
+				bool isListenEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefListenHandlers.willHandle(); }
+				void handleListenEvent(nodecpp::safememory::soft_ptr<ServerBase> server, size_t id, nodecpp::net::Address address) { userHandlers.pattern->userDefListenHandlers.execute(userHandlers.defaultObjPtr, server, id, address); }
 
-				bool isConnectionEventHandler() { return userHandlers.userDefConnectionHandlers.willHandle(); }
-				void handleConnectionEvent(nodecpp::safememory::soft_ptr<ServerBase> server, nodecpp::safememory::soft_ptr<net::SocketBase> socket) { userHandlers.userDefConnectionHandlers.execute(server, socket); }
+				bool isConnectionEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefConnectionHandlers.willHandle(); }
+				void handleConnectionEvent(nodecpp::safememory::soft_ptr<ServerBase> server, nodecpp::safememory::soft_ptr<net::SocketBase> socket) { userHandlers.pattern->userDefConnectionHandlers.execute(userHandlers.defaultObjPtr, server, socket); }
 
-				bool isCloseEventHandler() { return userHandlers.userDefCloseHandlers.willHandle(); }
-				void handleCloseEvent(nodecpp::safememory::soft_ptr<ServerBase> server, bool hasError) { userHandlers.userDefCloseHandlers.execute(server, hasError); }
+				bool isCloseEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefCloseHandlers.willHandle(); }
+				void handleCloseEvent(nodecpp::safememory::soft_ptr<ServerBase> server, bool hasError) { userHandlers.pattern->userDefCloseHandlers.execute(userHandlers.defaultObjPtr, server, hasError); }
 
-				bool isErrorEventHandler() { return userHandlers.userDefErrorHandlers.willHandle(); }
-				void handleErrorEvent(nodecpp::safememory::soft_ptr<ServerBase> server, Error& e) { userHandlers.userDefErrorHandlers.execute(server, e); }
+				bool isErrorEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefErrorHandlers.willHandle(); }
+				void handleErrorEvent(nodecpp::safememory::soft_ptr<ServerBase> server, Error& e) { userHandlers.pattern->userDefErrorHandlers.execute(userHandlers.defaultObjPtr, server, e); }
 			};
 			DataForCommandProcessing dataForCommandProcessing;
 
@@ -281,6 +280,7 @@ namespace nodecpp {
 				reportBeingDestructed();
 			}
 			void setAcceptedSocketCreationRoutine(acceptedSocketCreationRoutineType socketCreationCB) { acceptedSocketCreationRoutine = std::move( socketCreationCB ); }
+			void setConnectionDistribution(ConnectionDistribution distribution) { dataForCommandProcessing.distribution = distribution; } // effective if called before listen()
 			void internalCleanupBeforeClosing()
 			{
 				NODECPP_ASSERT( nodecpp::module_id, nodecpp::assert::AssertLevel::critical, getSockCount() == 0 ); 
@@ -757,7 +757,7 @@ namespace nodecpp {
 			{
 				retServer->setAcceptedSocketCreationRoutine( [](OpaqueSocketData& sdata) {
 						nodecpp::safememory::owning_ptr<SocketT> ret = nodecpp::safememory::make_owning<SocketT>();
-						ret->dataForCommandProcessing.userHandlers.from(SocketBase::DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying<SocketT>(), &(*ret));
+						ret->applyDispatchPolicy(&(*ret));
 						ret->registerMeAndAssignSocket(sdata);
 						return ret;
 					} );
@@ -775,7 +775,7 @@ namespace nodecpp {
 						{
 							retSock = nodecpp::safememory::make_owning<SocketT>();
 						}
-						retSock->dataForCommandProcessing.userHandlers.from(SocketBase::DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying<SocketT>(), &(*retSock));
+						retSock->applyDispatchPolicy(&(*retSock));
 						retSock->registerMeAndAssignSocket(sdata);
 						return retSock;
 					} );
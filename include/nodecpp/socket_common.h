@@ -38,6 +38,24 @@ namespace nodecpp {
 	namespace net {
 
 		class ServerBase; // forward declaration
+
+		// mechanisms used to deliver socket events to user code
+		struct SocketDispatch
+		{
+			static constexpr uint8_t awaitables = 0x1; // co_await on a_read(), a_connect(), etc.
+			static constexpr uint8_t handlers = 0x2; // member functions registered via SocketBase::addHandler<UserClass, ...>()
+			static constexpr uint8_t emitters = 0x4; // on()/once() with callbacks or SocketListener's
+			static constexpr uint8_t all = awaitables | handlers | emitters;
+		};
+
+		// A user socket class may restrict mechanisms it uses by declaring
+		//     static constexpr uint8_t dispatchPolicy = SocketDispatch::...;
+		// events of its sockets are then processed by a path of the socket manager compiled for that policy, with no checks for the rest
+		template<class SocketT, class = void>
+		struct SocketDispatchPolicy { static constexpr uint8_t value = SocketDispatch::all; };
+		template<class SocketT>
+		struct SocketDispatchPolicy<SocketT, std::void_t<decltype(SocketT::dispatchPolicy)>> { static constexpr uint8_t value = SocketT::dispatchPolicy; };
+
 		class SocketBase
 		{
 		public:
@@ -72,6 +90,10 @@ namespace nodecpp {
 				{
 					awaitable_handle_t h = nullptr;
 					Buffer b;
+					// a_writev() that has not been sent at once: segments stay borrowed till sent (offset is of all of them)
+					const BufferView* segs = nullptr;
+					size_t cnt = 0;
+					size_t offset = 0;
 				};
 
 				// NOTE: make sure all of them are addressed at forceResumeWithThrowing()
@@ -90,6 +112,11 @@ namespace nodecpp {
 
 				bool refed = false;
 
+				uint8_t dispatch = SocketDispatch::all; // see SocketDispatchPolicy; set once at creation
+
+				bool isHandlerDispatch() const { return dispatch & SocketDispatch::handlers; }
+				bool isEmitterDispatch() const { return dispatch & SocketDispatch::emitters; }
+
 				CircularByteBuffer writeBuffer = CircularByteBuffer( 12 );
 				CircularByteBuffer readBuffer = CircularByteBuffer( 12 );
 
@@ -328,57 +355,43 @@ namespace nodecpp {
 				};
 				thread_local static UserHandlerClassPatterns<UserHandlersForDataCollecting> userHandlerClassPattern; // TODO: consider using thread-local allocator
 
+				// handlers are shared by all instances of a user class; the table is immutable once applied (see UserHandlerClassPatterns)
 				struct UserHandlers : public UserHandlersCommon
 				{
-					bool initialized = false;
-
-					UserDefHandlersWithOptimizedStorage<userDefAcceptedHandlerFnT> userDefAcceptedHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefConnectHandlerFnT> userDefConnectHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefDataHandlerFnT> userDefDataHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefDrainHandlerFnT> userDefDrainHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefEndHandlerFnT> userDefEndHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefCloseHandlerFnT> userDefCloseHandlers;
-					UserDefHandlersWithOptimizedStorage<userDefErrorHandlerFnT> userDefErrorHandlers;
-
+					const UserHandlersForDataCollecting* pattern = nullptr;
+					void* defaultObjPtr = nullptr; // object for handlers being members of the user class itself
 
-					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr)
+					void from(const UserHandlersForDataCollecting& patternUH, void* defaultObjPtr_)
 					{
-						if ( initialized )
+						if ( pattern != nullptr )
 							return;
-						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr != nullptr);
-
-						userDefAcceptedHandlers.from(patternUH.userDefAcceptedHandlers, defaultObjPtr);
-						userDefConnectHandlers.from(patternUH.userDefConnectHandlers, defaultObjPtr);
-						userDefDataHandlers.from(patternUH.userDefDataHandlers, defaultObjPtr);
-						userDefDrainHandlers.from(patternUH.userDefDrainHandlers, defaultObjPtr);
-						userDefEndHandlers.from(patternUH.userDefEndHandlers, defaultObjPtr);
-						userDefCloseHandlers.from(patternUH.userDefCloseHandlers, defaultObjPtr);
-						userDefErrorHandlers.from(patternUH.userDefErrorHandlers, defaultObjPtr);
-						initialized = true;
+						NODECPP_ASSERT(nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, defaultObjPtr_ != nullptr);
+						pattern = &patternUH;
+						defaultObjPtr = defaultObjPtr_;
 					}
 				};
 				UserHandlers userHandlers;
 
-				bool isAcceptedEventHandler() { return userHandlers.userDefAcceptedHandlers.willHandle(); }
-				void handleAcceptedEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.userDefAcceptedHandlers.execute(socket); }
+				bool isAcceptedEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefAcceptedHandlers.willHandle(); }
+				void handleAcceptedEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.pattern->userDefAcceptedHandlers.execute(userHandlers.defaultObjPtr, socket); }
 
-				bool isConnectEventHandler() { return userHandlers.userDefConnectHandlers.willHandle(); }
-				void handleConnectEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.userDefConnectHandlers.execute(socket); }
+				bool isConnectEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefConnectHandlers.willHandle(); }
+				void handleConnectEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.pattern->userDefConnectHandlers.execute(userHandlers.defaultObjPtr, socket); }
 
-				bool isDataEventHandler() { return userHandlers.userDefDataHandlers.willHandle(); }
-				void handleDataEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, Buffer& buffer) { userHandlers.userDefDataHandlers.execute(socket, buffer); }
+				bool isDataEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefDataHandlers.willHandle(); }
+				void handleDataEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, Buffer& buffer) { userHandlers.pattern->userDefDataHandlers.execute(userHandlers.defaultObjPtr, socket, buffer); }
 
-				bool isDrainEventHandler() { return userHandlers.userDefDrainHandlers.willHandle(); }
-				void handleDrainEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.userDefDrainHandlers.execute(socket); }
+				bool isDrainEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefDrainHandlers.willHandle(); }
+				void handleDrainEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.pattern->userDefDrainHandlers.execute(userHandlers.defaultObjPtr, socket); }
 
-				bool isEndEventHandler() { return userHandlers.userDefEndHandlers.willHandle(); }
-				void handleEndEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.userDefEndHandlers.execute(socket); }
+				bool isEndEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefEndHandlers.willHandle(); }
+				void handleEndEvent(nodecpp::safememory::soft_ptr<SocketBase> socket) { userHandlers.pattern->userDefEndHandlers.execute(userHandlers.defaultObjPtr, socket); }
 
-				bool isCloseEventHandler() { return userHandlers.userDefCloseHandlers.willHandle(); }
-				void handleCloseEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, bool hasError) { userHandlers.userDefCloseHandlers.execute(socket, hasError); }
+				bool isCloseEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefCloseHandlers.willHandle(); }
+				void handleCloseEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, bool hasError) { userHandlers.pattern->userDefCloseHandlers.execute(userHandlers.defaultObjPtr, socket, hasError); }
 
-				bool isErrorEventHandler() { return userHandlers.userDefErrorHandlers.willHandle(); }
-				void handleErrorEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, Error& e) { userHandlers.userDefErrorHandlers.execute(socket, e); }
+				bool isErrorEventHandler() { return userHandlers.pattern != nullptr && userHandlers.pattern->userDefErrorHandlers.willHandle(); }
+				void handleErrorEvent(nodecpp::safememory::soft_ptr<SocketBase> socket, Error& e) { userHandlers.pattern->userDefErrorHandlers.execute(userHandlers.defaultObjPtr, socket, e); }
 			};
 			DataForCommandProcessing dataForCommandProcessing;
 
@@ -398,6 +411,18 @@ namespace nodecpp {
 			void registerMeAndAcquireSocket();
 			void registerMeAndAssignSocket(OpaqueSocketData& sdata);
 
+			// to be called once an instance of a user socket class is created; self is the same object as 'this'
+			template<class SocketT>
+			void applyDispatchPolicy(SocketT* self) {
+				static_assert( std::is_base_of< SocketBase, SocketT >::value );
+				static_assert( ( SocketDispatchPolicy<SocketT>::value & ~SocketDispatch::all ) == 0 );
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, static_cast<SocketBase*>(self) == this );
+				dataForCommandProcessing.dispatch = SocketDispatchPolicy<SocketT>::value;
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, dataForCommandProcessing.isEmitterDispatch() || !emitters, "emitters are not in socket's dispatch policy" );
+				if ( dataForCommandProcessing.isHandlerDispatch() )
+					dataForCommandProcessing.userHandlers.from(DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying<SocketT>(), self);
+			}
+
 		public:
 			//nodecpp::string _remoteAddress;
 			//nodecpp::string _remoteFamily;
@@ -450,6 +475,8 @@ namespace nodecpp {
 		private:
 			bool write(const uint8_t* data, uint32_t size);
 			bool write2(Buffer& b);
+			bool write2v(const BufferView* segs, size_t cnt, bool borrow);
+			bool sendFile(int fd, uint64_t& offset, size_t& count); // offset and count are advanced by what has been sent
 
 		public:
 			void connect(uint16_t port, const char* ip);
@@ -489,6 +516,7 @@ namespace nodecpp {
 					dataForCommandProcessing.ahd_read.h = nullptr;
 					hr();
 				}
+				dataForCommandProcessing.ahd_write.segs = nullptr; // not to be sent anymore
 				if ( dataForCommandProcessing.ahd_write.h != nullptr )
 				{
 					auto hr = dataForCommandProcessing.ahd_write.h;
@@ -708,6 +736,98 @@ namespace nodecpp {
 				return write_data_awaiter(*this, buff);
 			}
 
+			// gather write: segments are sent with a single syscall (where possible) and are not copied; what the kernel does not accept at once
+			// is sent from them as the socket becomes writable, so that segments, and data they view, must remain intact till completion
+			auto a_writev(const BufferView* segs, size_t cnt) { 
+
+				struct writev_data_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					SocketBase& socket;
+					const BufferView* segs;
+					size_t cnt;
+					BufferView pair[2];
+					bool borrow;
+					bool write_ok = false;
+
+					writev_data_awaiter(SocketBase& socket_, const BufferView* segs_, size_t cnt_, bool borrow_) : socket( socket_ ), segs( segs_ ), cnt( cnt_ ), borrow( borrow_ )  {}
+					writev_data_awaiter(SocketBase& socket_, BufferView b1, BufferView b2) : socket( socket_ ), segs( pair ), cnt( 2 ), borrow( true ) { pair[0] = b1; pair[1] = b2; } // pair is a part of the awaiter, which outlives the write
+
+					writev_data_awaiter(const writev_data_awaiter &) = delete;
+					writev_data_awaiter &operator = (const writev_data_awaiter &) = delete;
+	
+					~writev_data_awaiter() {}
+
+					bool await_ready() {
+						write_ok = socket.write2v( segs, cnt, borrow );
+						return write_ok; // false means waiting (incl. exceptional cases)
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, !write_ok ); // otherwise, why are we here?
+						nodecpp::setNoException(awaiting);
+						myawaiting = awaiting;
+						socket.dataForCommandProcessing.ahd_write.h = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+					}
+				};
+				return writev_data_awaiter(*this, segs, cnt, true);
+			}
+
+			// as a_writev(), but what the kernel does not accept at once is copied, so that segments may change as soon as it is called
+			auto a_writevCopyingRest(const BufferView* segs, size_t cnt) { 
+				using awaiter_type = decltype( a_writev( nullptr, 0 ) );
+				return awaiter_type(*this, segs, cnt, false);
+			}
+
+			auto a_write(BufferView b1, BufferView b2) { 
+				using awaiter_type = decltype( a_writev( nullptr, 0 ) );
+				return awaiter_type(*this, b1, b2);
+			}
+
+			// sends count bytes of file fd starting at offset (with sendfile(), where available) after whatever has been written before;
+			// fd must remain open till completion
+			nodecpp::handler_ret_type a_sendFile(int fd, uint64_t offset, size_t count) { 
+
+				struct writable_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					SocketBase& socket;
+
+					writable_awaiter(SocketBase& socket_) : socket( socket_ )  {}
+
+					writable_awaiter(const writable_awaiter &) = delete;
+					writable_awaiter &operator = (const writable_awaiter &) = delete;
+	
+					~writable_awaiter() {}
+
+					bool await_ready() {
+						return false;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						myawaiting = awaiting;
+						socket.dataForCommandProcessing.ahd_write.h = awaiting; // resumed once what has been written before is sent and socket can accept more
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+					}
+				};
+
+				while ( !sendFile( fd, offset, count ) )
+				{
+					if ( dataForCommandProcessing.state == DataForCommandProcessing::State::ErrorClosing || dataForCommandProcessing.state == DataForCommandProcessing::State::Closing || dataForCommandProcessing.state == DataForCommandProcessing::State::Closed )
+						throw Error();
+					co_await writable_awaiter( *this );
+				}
+				CO_RETURN;
+			}
+
 			auto a_drain() { 
 
 				struct drain_awaiter {
@@ -783,49 +903,68 @@ namespace nodecpp {
 
 			///////////////////////////////////////////////////////////////////
 		private:
-			class EventEmitterSupportingListeners<event::Close, SocketListener, &SocketListener::onClose> eClose;
-			class EventEmitterSupportingListeners<event::Connect, SocketListener, &SocketListener::onConnect> eConnect;
-			class EventEmitterSupportingListeners<event::Data, SocketListener, &SocketListener::onData> eData;
-			class EventEmitterSupportingListeners<event::Drain, SocketListener, &SocketListener::onDrain> eDrain;
-			class EventEmitterSupportingListeners<event::End, SocketListener, &SocketListener::onEnd> eEnd;
-			class EventEmitterSupportingListeners<event::Error, SocketListener, &SocketListener::onError> eError;
-			class EventEmitterSupportingListeners<event::Accepted, SocketListener, &SocketListener::onAccepted> eAccepted;
+			// allocated with the first subscription; sockets not using emitters (see SocketDispatchPolicy) do not pay for them
+			struct Emitters
+			{
+				class EventEmitterSupportingListeners<event::Close, SocketListener, &SocketListener::onClose> eClose;
+				class EventEmitterSupportingListeners<event::Connect, SocketListener, &SocketListener::onConnect> eConnect;
+				class EventEmitterSupportingListeners<event::Data, SocketListener, &SocketListener::onData> eData;
+				class EventEmitterSupportingListeners<event::Drain, SocketListener, &SocketListener::onDrain> eDrain;
+				class EventEmitterSupportingListeners<event::End, SocketListener, &SocketListener::onEnd> eEnd;
+				class EventEmitterSupportingListeners<event::Error, SocketListener, &SocketListener::onError> eError;
+				class EventEmitterSupportingListeners<event::Accepted, SocketListener, &SocketListener::onAccepted> eAccepted;
+
+				nodecpp::vector<nodecpp::safememory::owning_ptr<SocketListener>> ownedListeners;
+			};
+			nodecpp::safememory::owning_ptr<Emitters> emitters;
 
-			nodecpp::vector<nodecpp::safememory::owning_ptr<SocketListener>> ownedListeners;
+			Emitters& getEmitters() {
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, dataForCommandProcessing.isEmitterDispatch(), "emitters are not in socket's dispatch policy" );
+				if ( !emitters )
+					emitters = nodecpp::safememory::make_owning<Emitters>();
+				return *emitters;
+			}
 
 		public:
 			void emitClose(bool hadError) {
 				unref();
 				//this->dataForCommandProcessing.id = 0;
 				//handler may release, put virtual onClose first.
-				eClose.emit(hadError);
+				if ( emitters )
+					emitters->eClose.emit(hadError);
 			}
 
 			// not in node.js
 			void emitAccepted() {
-				eAccepted.emit();
+				if ( emitters )
+					emitters->eAccepted.emit();
 			}
 
 			void emitConnect() {
-				eConnect.emit();
+				if ( emitters )
+					emitters->eConnect.emit();
 			}
 
 			void emitData(const Buffer& buffer) {
 				_bytesRead += buffer.size();
-				eData.emit<const Buffer&>(buffer);
+				if ( emitters )
+					emitters->eData.emit<const Buffer&>(buffer);
 			}
 
 			void emitDrain() {
-				eDrain.emit();
+				if ( emitters )
+					emitters->eDrain.emit();
 			}
 
 			void emitEnd() {
-				eEnd.emit();
+				if ( emitters )
+					emitters->eEnd.emit();
 			}
 
 			void emitError(Error& err) {
 				//this->dataForCommandProcessing.id = 0;
-				eError.emit(err);
+				if ( emitters )
+					emitters->eError.emit(err);
 			}
 
 			void connect(uint16_t port, const char* ip, std::function<void()> cb) {
@@ -844,34 +983,34 @@ namespace nodecpp {
 
 
 			void on_( nodecpp::safememory::soft_ptr<SocketListener> l) {
-				eClose.on(l);
-				eConnect.on(l);
-				eData.on(l);
-				eDrain.on(l);
-				eError.on(l);
-				eEnd.on(l);
-				eAccepted.on(l);
+				getEmitters().eClose.on(l);
+				getEmitters().eConnect.on(l);
+				getEmitters().eData.on(l);
+				getEmitters().eDrain.on(l);
+				getEmitters().eError.on(l);
+				getEmitters().eEnd.on(l);
+				getEmitters().eAccepted.on(l);
 			}
 
 			void once_( nodecpp::safememory::soft_ptr<SocketListener> l) {
-				eClose.once(l);
-				eConnect.once(l);
-				eData.once(l);
-				eDrain.once(l);
-				eError.once(l);
-				eEnd.once(l);
-				eAccepted.once(l);
+				getEmitters().eClose.once(l);
+				getEmitters().eConnect.once(l);
+				getEmitters().eData.once(l);
+				getEmitters().eDrain.once(l);
+				getEmitters().eError.once(l);
+				getEmitters().eEnd.once(l);
+				getEmitters().eAccepted.once(l);
 			}
 
 			void on( nodecpp::safememory::owning_ptr<SocketListener> l) {
 				nodecpp::safememory::soft_ptr<SocketListener> sl( l );
-				ownedListeners.emplace_back( std::move( l ) );
+				getEmitters().ownedListeners.emplace_back( std::move( l ) );
 				on_( std::move(sl) );
 			}
 
 			void once( nodecpp::safememory::owning_ptr<SocketListener> l) {
 				nodecpp::safememory::soft_ptr<SocketListener> sl( l );
-				ownedListeners.emplace_back( std::move( l ) );
+				getEmitters().ownedListeners.emplace_back( std::move( l ) );
 				once_( std::move(sl) );
 			}
 
@@ -882,7 +1021,7 @@ namespace nodecpp {
 				static_assert( !std::is_same< event::Close::callback, event::End::callback >::value );
 				static_assert( !std::is_same< event::Close::callback, event::Error::callback >::value );
 				assert( name == string_literal(event::Close::name) );
-				eClose.on(std::move(cb));
+				getEmitters().eClose.on(std::move(cb));
 			}
 			void on( string_literal name, event::Data::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert( !std::is_same< event::Data::callback, event::Close::callback >::value );
@@ -891,7 +1030,7 @@ namespace nodecpp {
 				static_assert( !std::is_same< event::Data::callback, event::End::callback >::value );
 				static_assert( !std::is_same< event::Data::callback, event::Error::callback >::value );
 				assert( name == string_literal(event::Data::name) );
-				eData.on(std::move(cb));
+				getEmitters().eData.on(std::move(cb));
 			}
 			void on(string_literal name, event::Error::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert(!std::is_same< event::Error::callback, event::Close::callback >::value);
@@ -900,7 +1039,7 @@ namespace nodecpp {
 				static_assert(!std::is_same< event::Error::callback, event::End::callback >::value);
 				static_assert(!std::is_same< event::Error::callback, event::Data::callback >::value);
 				assert( name == string_literal(event::Error::name) );
-				eError.on(std::move(cb));
+				getEmitters().eError.on(std::move(cb));
 			}
 			void on( string_literal name, event::Connect::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert( !std::is_same< event::Connect::callback, event::Close::callback >::value );
@@ -909,13 +1048,13 @@ namespace nodecpp {
 				static_assert( std::is_same< event::Connect::callback, event::Drain::callback >::value );
 				static_assert( std::is_same< event::Connect::callback, event::End::callback >::value );
 				if ( name == string_literal(event::Drain::name) )
-					eDrain.on(std::move(cb));
+					getEmitters().eDrain.on(std::move(cb));
 				else if ( name == string_literal(event::Connect::name) )
-					eConnect.on(std::move(cb));
+					getEmitters().eConnect.on(std::move(cb));
 				else if ( name == string_literal(event::End::name) )
-					eEnd.on(std::move(cb));
+					getEmitters().eEnd.on(std::move(cb));
 				else if ( name == string_literal(event::Accepted::name) )
-					eAccepted.on(std::move(cb));
+					getEmitters().eAccepted.on(std::move(cb));
 				else
 					assert(false);
 			}
@@ -927,7 +1066,7 @@ namespace nodecpp {
 				static_assert( !std::is_same< event::Close::callback, event::End::callback >::value );
 				static_assert( !std::is_same< event::Close::callback, event::Error::callback >::value );
 				assert( name == string_literal(event::Close::name) );
-				eClose.once(std::move(cb));
+				getEmitters().eClose.once(std::move(cb));
 			}
 			void once( string_literal name, event::Data::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert( !std::is_same< event::Data::callback, event::Close::callback >::value );
@@ -936,7 +1075,7 @@ namespace nodecpp {
 				static_assert( !std::is_same< event::Data::callback, event::End::callback >::value );
 				static_assert( !std::is_same< event::Data::callback, event::Error::callback >::value );
 				assert( name == string_literal(event::Data::name) );
-				eData.once(std::move(cb));
+				getEmitters().eData.once(std::move(cb));
 			}
 			void once(string_literal name, event::Error::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert(!std::is_same< event::Error::callback, event::Close::callback >::value);
@@ -945,7 +1084,7 @@ namespace nodecpp {
 				static_assert(!std::is_same< event::Error::callback, event::End::callback >::value);
 				static_assert(!std::is_same< event::Error::callback, event::Data::callback >::value);
 				assert(name == string_literal(event::Error::name));
-				eError.once(std::move(cb));
+				getEmitters().eError.once(std::move(cb));
 			}
 			void once( string_literal name, event::Connect::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
 				static_assert( !std::is_same< event::Connect::callback, event::Close::callback >::value );
@@ -954,38 +1093,38 @@ namespace nodecpp {
 				static_assert( std::is_same< event::Connect::callback, event::Drain::callback >::value );
 				static_assert( std::is_same< event::Connect::callback, event::End::callback >::value );
 				if (name == string_literal(event::Drain::name))
-					eDrain.once(std::move(cb));
+					getEmitters().eDrain.once(std::move(cb));
 				else if (name == string_literal(event::Connect::name))
-					eConnect.once(std::move(cb));
+					getEmitters().eConnect.once(std::move(cb));
 				else if (name == string_literal(event::End::name))
-					eEnd.once(std::move(cb));
+					getEmitters().eEnd.once(std::move(cb));
 				else if (name == string_literal(event::Accepted::name))
-					eAccepted.once(std::move(cb));
+					getEmitters().eAccepted.once(std::move(cb));
 				else
 					assert(false);
 			}
 
 			template<class EV>
 			void on( EV, typename EV::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
-				if constexpr ( std::is_same< EV, event::Close >::value ) { eClose.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Connect >::value ) { eConnect.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Data >::value ) { eData.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Drain >::value ) { eDrain.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::End >::value ) { eEnd.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Error >::value ) { eError.on(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Accepted >::value ) { eAccepted.on(std::move(cb)); }
+				if constexpr ( std::is_same< EV, event::Close >::value ) { getEmitters().eClose.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Connect >::value ) { getEmitters().eConnect.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Data >::value ) { getEmitters().eData.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Drain >::value ) { getEmitters().eDrain.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::End >::value ) { getEmitters().eEnd.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Error >::value ) { getEmitters().eError.on(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Accepted >::value ) { getEmitters().eAccepted.on(std::move(cb)); }
 				else assert(false);
 			}
 
 			template<class EV>
 			void once( EV, typename EV::callback cb NODECPP_MAY_EXTEND_TO_THIS) {
-				if constexpr ( std::is_same< EV, event::Close >::value ) { eClose.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Connect >::value ) { eConnect.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Data >::value ) { eData.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Drain >::value ) { eDrain.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::End >::value ) { eEnd.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Error >::value ) { eError.once(std::move(cb)); }
-				else if constexpr ( std::is_same< EV, event::Accepted >::value ) { eAccepted.once(std::move(cb)); }
+				if constexpr ( std::is_same< EV, event::Close >::value ) { getEmitters().eClose.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Connect >::value ) { getEmitters().eConnect.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Data >::value ) { getEmitters().eData.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Drain >::value ) { getEmitters().eDrain.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::End >::value ) { getEmitters().eEnd.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Error >::value ) { getEmitters().eError.once(std::move(cb)); }
+				else if constexpr ( std::is_same< EV, event::Accepted >::value ) { getEmitters().eAccepted.once(std::move(cb)); }
 				else assert(false);
 			}
 
@@ -1034,8 +1173,8 @@ namespace nodecpp {
 			nodecpp::safememory::owning_ptr<SocketT> createSocket(Types&& ... args) {
 			static_assert( std::is_base_of< SocketBase, SocketT >::value );
 			nodecpp::safememory::owning_ptr<SocketT> ret = nodecpp::safememory::make_owning<SocketT>(::std::forward<Types>(args)...);
+			ret->applyDispatchPolicy(&(*ret));
 			ret->registerMeAndAcquireSocket();
-			ret->dataForCommandProcessing.userHandlers.from(SocketBase::DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying<SocketT>(), &(*ret));
 			return ret;
 		}
 
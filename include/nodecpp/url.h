@@ -32,8 +32,187 @@
 
 #include "common.h"
 
+#include <string_view>
+#include <cstring>
+
 namespace nodecpp {
 
+	/*
+		Zero-allocation query string parser: items are views into the URL being parsed (which must outlive the parser),
+		keys and values are kept percent-encoded and may be decoded on demand (see decode()).
+		Lookups compare a key being searched for against a still encoded key, optionally case-insensitively.
+	*/
+	class UrlQueryView
+	{
+		std::string_view query; // between '?' and '#', if any
+
+		static constexpr int hexVal( char ch )
+		{
+			return ch >= '0' && ch <= '9' ? ch - '0' : ( ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 : ( ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : -1 ) );
+		}
+		static constexpr char toLower( char ch ) { return ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch; }
+
+		// decodes a character at raw[pos] advancing pos
+		static char decodeNext( std::string_view raw, size_t& pos )
+		{
+			char ch = raw[pos++];
+			if ( ch == '+' )
+				return ' ';
+			if ( ch == '%' && pos + 1 < raw.size() )
+			{
+				int hi = hexVal( raw[pos] );
+				int lo = hexVal( raw[pos + 1] );
+				if ( hi >= 0 && lo >= 0 )
+				{
+					pos += 2;
+					return (char)( ( hi << 4 ) | lo );
+				}
+			}
+			return ch; // malformed escapes are kept as is
+		}
+
+	public:
+		struct Item
+		{
+			std::string_view key; // percent-encoded
+			std::string_view value; // percent-encoded; empty if there is no '='
+		};
+
+		UrlQueryView() {}
+		explicit UrlQueryView( std::string_view url ) { parse( url ); }
+
+		void parse( std::string_view url )
+		{
+			size_t start = url.find( '?' );
+			if ( start == std::string_view::npos )
+			{
+				query = std::string_view();
+				return;
+			}
+			++start;
+			size_t end = url.find( '#', start );
+			query = url.substr( start, end == std::string_view::npos ? std::string_view::npos : end - start );
+		}
+		std::string_view getQuery() const { return query; }
+		bool empty() const { return query.empty(); }
+
+		// calls f(const Item&) for each item in order of appearance; items with empty key (e.g. in 'a=1&&b=2') are skipped
+		template<class F>
+		void forEach( F f ) const
+		{
+			size_t start = 0;
+			while ( start < query.size() )
+			{
+				size_t end = query.find( '&', start );
+				if ( end == std::string_view::npos )
+					end = query.size();
+				std::string_view segment = query.substr( start, end - start );
+				start = end + 1;
+				size_t eq = segment.find( '=' );
+				Item item;
+				item.key = segment.substr( 0, eq );
+				if ( eq != std::string_view::npos )
+					item.value = segment.substr( eq + 1 );
+				if ( !item.key.empty() )
+					f( item );
+			}
+		}
+
+		// first occurrence of key (as decoded)
+		bool get( std::string_view key, std::string_view& rawValue, bool caseInsensitive = false ) const
+		{
+			bool found = false;
+			forEach( [&]( const Item& item ) {
+				if ( !found && keyEquals( item.key, key, caseInsensitive ) )
+				{
+					rawValue = item.value;
+					found = true;
+				}
+			} );
+			return found;
+		}
+		bool has( std::string_view key, bool caseInsensitive = false ) const { std::string_view dummy; return get( key, dummy, caseInsensitive ); }
+		size_t count( std::string_view key, bool caseInsensitive = false ) const
+		{
+			size_t ret = 0;
+			forEach( [&]( const Item& item ) { ret += keyEquals( item.key, key, caseInsensitive ); } );
+			return ret;
+		}
+
+		// compares still encoded raw with already decoded key
+		static bool keyEquals( std::string_view raw, std::string_view key, bool caseInsensitive = false )
+		{
+			if ( raw.size() < key.size() ) // decoding never makes a string longer
+				return false;
+			size_t pos = 0;
+			size_t i = 0;
+			if ( !needsDecoding( raw ) )
+			{
+				if ( raw.size() != key.size() )
+					return false;
+				if ( !caseInsensitive )
+					return raw == key;
+				for ( ; i<key.size(); ++i )
+					if ( toLower( raw[i] ) != toLower( key[i] ) )
+						return false;
+				return true;
+			}
+			for ( ; pos<raw.size() && i<key.size(); ++i )
+			{
+				char ch = decodeNext( raw, pos );
+				if ( caseInsensitive ? toLower( ch ) != toLower( key[i] ) : ch != key[i] )
+					return false;
+			}
+			return pos == raw.size() && i == key.size();
+		}
+
+		// whether raw contains '%' or '+'; scanned a word at a time
+		static bool needsDecoding( std::string_view raw )
+		{
+			const char* p = raw.data();
+			size_t sz = raw.size();
+			constexpr uint64_t ones = 0x0101010101010101ULL;
+			constexpr uint64_t highs = 0x8080808080808080ULL;
+			for ( ; sz >= sizeof(uint64_t); p += sizeof(uint64_t), sz -= sizeof(uint64_t) )
+			{
+				uint64_t w;
+				memcpy( &w, p, sizeof(uint64_t) );
+				uint64_t pct = w ^ ( ones * '%' );
+				uint64_t plus = w ^ ( ones * '+' );
+				if ( ( ( ( pct - ones ) & ~pct ) | ( ( plus - ones ) & ~plus ) ) & highs ) // a zero byte in either
+					return true;
+			}
+			for ( ; sz; ++p, --sz )
+				if ( *p == '%' || *p == '+' )
+					return true;
+			return false;
+		}
+
+		// out must have room for raw.size() chars; returns size of decoded string
+		static size_t decode( std::string_view raw, char* out )
+		{
+			if ( raw.empty() )
+				return 0;
+			if ( !needsDecoding( raw ) )
+			{
+				memcpy( out, raw.data(), raw.size() );
+				return raw.size();
+			}
+			size_t pos = 0;
+			size_t outSz = 0;
+			while ( pos < raw.size() )
+				out[outSz++] = decodeNext( raw, pos );
+			return outSz;
+		}
+		static nodecpp::string decode( std::string_view raw )
+		{
+			nodecpp::string ret;
+			ret.resize( raw.size() );
+			ret.resize( decode( raw, &(ret[0]) ) );
+			return ret;
+		}
+	};
+
 	class UrlQueryItem{
 		nodecpp::vector<nodecpp::string> elems;
 		nodecpp::string none;
@@ -64,9 +243,11 @@ namespace nodecpp {
 		}
 	};
 
+	// convenience layer over UrlQueryView: decoded keys and values, with all values of a key collected
 	class UrlQuery
 	{
-		nodecpp::map<nodecpp::string, UrlQueryItem> parsed;
+		using MapT = ::std::map<nodecpp::string, UrlQueryItem, std::less<>, nodecpp::safememory::iiballocator<std::pair<const nodecpp::string, UrlQueryItem>>>; // std::less<> allows lookups without constructing a key
+		MapT parsed;
 		UrlQueryItem none;
 	public:
 		UrlQuery() {}
@@ -88,26 +269,15 @@ namespace nodecpp {
 				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ins.second );
 			}
 		}
-		const UrlQueryItem& operator [] ( const nodecpp::string& key ) {
+		const UrlQueryItem& operator [] ( std::string_view key ) {
 			auto f = parsed.find( key );
 			if ( f != parsed.end() )
 				return f->second;
 			return none;
 		}
-		const UrlQueryItem& operator [] ( const nodecpp::string_literal& key ) {
-			nodecpp::string s( key.c_str() );
-			auto f = parsed.find( s );
-			if ( f != parsed.end() )
-				return f->second;
-			return none;
-		}
-		const UrlQueryItem& operator [] ( const char* key ) {
-			nodecpp::string s( key );
-			auto f = parsed.find( s );
-			if ( f != parsed.end() )
-				return f->second;
-			return none;
-		}
+		const UrlQueryItem& operator [] ( const nodecpp::string& key ) { return operator [] ( std::string_view( key ) ); }
+		const UrlQueryItem& operator [] ( const nodecpp::string_literal& key ) { return operator [] ( std::string_view( key.c_str() ) ); }
+		const UrlQueryItem& operator [] ( const char* key ) { return operator [] ( std::string_view( key ) ); }
 	};
 
 	class Url {
@@ -115,61 +285,14 @@ namespace nodecpp {
 		static inline
 		void parseUrlQueryString(const nodecpp::string& url, UrlQuery& q )
 		{
-			size_t start = url.find_first_of( "?" );
-			if ( start == nodecpp::string::npos )
-				return;
-			++start;
-
-			for(;;)
-			{
-				size_t endEq = url.find_first_of( "=", start );
-				if ( endEq == nodecpp::string::npos )
-				{
-					q.add( url.substr( start, endEq-start ), "" );
-					break;
-				}
-				size_t endAmp = url.find_first_of( "&", endEq+ 1  );
-				if ( endAmp == nodecpp::string::npos )
-				{
-					q.add( url.substr( start, endEq-start ), url.substr( endEq + 1 ) );
-					break;
-				}
-				else
-				{
-					q.add( url.substr( start, endEq-start ), url.substr( endEq + 1, endAmp - endEq - 1 ) ) ;
-					start = endAmp + 1;
-				}
-			}
+			UrlQueryView view( url );
+			view.forEach( [&q]( const UrlQueryView::Item& item ) { q.add( UrlQueryView::decode( item.key ), UrlQueryView::decode( item.value ) ); } );
 		}
 		static inline
 		UrlQuery parseUrlQueryString(const nodecpp::string& url )
 		{
 			UrlQuery q;
-			size_t start = url.find_first_of( "?" );
-			if ( start == nodecpp::string::npos )
-				return q;
-			++start;
-
-			for(;;)
-			{
-				size_t endEq = url.find_first_of( "=", start );
-				if ( endEq == nodecpp::string::npos )
-				{
-					q.add( url.substr( start, endEq-start ), "" );
-					break;
-				}
-				size_t endAmp = url.find_first_of( "&", endEq+ 1  );
-				if ( endAmp == nodecpp::string::npos )
-				{
-					q.add( url.substr( start, endEq-start ), url.substr( endEq + 1 ) );
-					break;
-				}
-				else
-				{
-					q.add( url.substr( start, endEq-start ), url.substr( endEq + 1, endAmp - endEq - 1 ) ) ;
-					start = endAmp + 1;
-				}
-			}
+			parseUrlQueryString( url, q );
 			return q;
 		}
 	};
@@ -0,0 +1,578 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2019, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include "http_server_common.h"
+#include "http_socket_at_server.h"
+
+#include <exception>
+#include <cstring>
+
+namespace nodecpp {
+
+	namespace net {
+
+		namespace internal_usage_only {
+
+			inline
+			void sha1( const uint8_t* data, size_t sz, uint8_t digest[20] )
+			{
+				uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+				auto rol = []( uint32_t x, int n ) { return ( x << n ) | ( x >> ( 32 - n ) ); };
+				auto processBlock = [&h, &rol]( const uint8_t* block ) {
+					uint32_t w[80];
+					for ( int i=0; i<16; ++i )
+						w[i] = ( (uint32_t)(block[i*4]) << 24 ) | ( (uint32_t)(block[i*4+1]) << 16 ) | ( (uint32_t)(block[i*4+2]) << 8 ) | block[i*4+3];
+					for ( int i=16; i<80; ++i )
+						w[i] = rol( w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1 );
+					uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+					for ( int i=0; i<80; ++i )
+					{
+						uint32_t f, k;
+						if ( i < 20 ) { f = ( b & c ) | ( ~b & d ); k = 0x5A827999; }
+						else if ( i < 40 ) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+						else if ( i < 60 ) { f = ( b & c ) | ( b & d ) | ( c & d ); k = 0x8F1BBCDC; }
+						else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+						uint32_t tmp = rol( a, 5 ) + f + e + k + w[i];
+						e = d; d = c; c = rol( b, 30 ); b = a; a = tmp;
+					}
+					h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+				};
+				size_t i = 0;
+				for ( ; i + 64 <= sz; i += 64 )
+					processBlock( data + i );
+				uint8_t tail[128] = {};
+				size_t rest = sz - i;
+				memcpy( tail, data + i, rest );
+				tail[rest] = 0x80;
+				size_t tailSize = rest + 9 <= 64 ? 64 : 128;
+				uint64_t bits = (uint64_t)sz * 8;
+				for ( int j=0; j<8; ++j )
+					tail[tailSize - 1 - j] = (uint8_t)( bits >> ( j * 8 ) );
+				processBlock( tail );
+				if ( tailSize == 128 )
+					processBlock( tail + 64 );
+				for ( int j=0; j<5; ++j )
+				{
+					digest[j*4] = (uint8_t)( h[j] >> 24 );
+					digest[j*4+1] = (uint8_t)( h[j] >> 16 );
+					digest[j*4+2] = (uint8_t)( h[j] >> 8 );
+					digest[j*4+3] = (uint8_t)( h[j] );
+				}
+			}
+
+			inline
+			nodecpp::string base64( const uint8_t* data, size_t sz )
+			{
+				static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+				nodecpp::string ret;
+				ret.reserve( ( sz + 2 ) / 3 * 4 );
+				size_t i = 0;
+				for ( ; i + 3 <= sz; i += 3 )
+				{
+					uint32_t v = ( (uint32_t)(data[i]) << 16 ) | ( (uint32_t)(data[i+1]) << 8 ) | data[i+2];
+					ret += alphabet[ ( v >> 18 ) & 0x3f ];
+					ret += alphabet[ ( v >> 12 ) & 0x3f ];
+					ret += alphabet[ ( v >> 6 ) & 0x3f ];
+					ret += alphabet[ v & 0x3f ];
+				}
+				if ( i < sz )
+				{
+					uint32_t v = (uint32_t)(data[i]) << 16;
+					if ( i + 1 < sz )
+						v |= (uint32_t)(data[i+1]) << 8;
+					ret += alphabet[ ( v >> 18 ) & 0x3f ];
+					ret += alphabet[ ( v >> 12 ) & 0x3f ];
+					ret += i + 1 < sz ? alphabet[ ( v >> 6 ) & 0x3f ] : '=';
+					ret += '=';
+				}
+				return ret;
+			}
+
+			// XORs sz bytes at ptr with the masking key starting at key[keyPos]; keyPos is advanced accordingly.
+			// Eight bytes are processed at a time (the key pattern repeats within a word), which compilers further vectorize
+			inline
+			void wsUnmask( uint8_t* ptr, size_t sz, const uint8_t key[4], size_t& keyPos )
+			{
+				uint8_t pattern[8];
+				for ( size_t j=0; j<8; ++j )
+					pattern[j] = key[( keyPos + j ) & 3];
+				uint64_t mask;
+				memcpy( &mask, pattern, 8 );
+				size_t i = 0;
+				for ( ; i + 8 <= sz; i += 8 )
+				{
+					uint64_t w;
+					memcpy( &w, ptr + i, 8 );
+					w ^= mask;
+					memcpy( ptr + i, &w, 8 );
+				}
+				for ( ; i < sz; ++i )
+					ptr[i] ^= pattern[i & 7];
+				keyPos = ( keyPos + sz ) & 3;
+			}
+
+			// validates UTF-8 fed in parts (e.g. fragment by fragment), so that invalid text is detected as soon as it arrives
+			class Utf8Validator
+			{
+				uint32_t cp = 0; // code point being decoded
+				uint32_t minCp = 0; // below that, the sequence is overlong
+				uint8_t remaining = 0; // continuation bytes still expected
+
+			public:
+				void reset() { cp = 0; minCp = 0; remaining = 0; }
+				bool isComplete() const { return remaining == 0; } // no sequence is cut at the end of what is fed so far
+
+				bool feed( const uint8_t* ptr, size_t sz ) // false as soon as the text is invalid
+				{
+					for ( size_t i=0; i<sz; ++i )
+					{
+						uint8_t ch = ptr[i];
+						if ( remaining )
+						{
+							if ( ( ch & 0xC0 ) != 0x80 )
+								return false;
+							cp = ( cp << 6 ) | ( ch & 0x3F );
+							if ( --remaining == 0 && ( cp < minCp || cp > 0x10FFFF || ( cp >= 0xD800 && cp <= 0xDFFF ) ) ) // overlong, out of range, or a surrogate
+								return false;
+							continue;
+						}
+						if ( ch < 0x80 )
+							continue;
+						if ( ( ch & 0xE0 ) == 0xC0 ) { remaining = 1; cp = ch & 0x1F; minCp = 0x80; }
+						else if ( ( ch & 0xF0 ) == 0xE0 ) { remaining = 2; cp = ch & 0x0F; minCp = 0x800; }
+						else if ( ( ch & 0xF8 ) == 0xF0 ) { remaining = 3; cp = ch & 0x07; minCp = 0x10000; }
+						else
+							return false;
+					}
+					return true;
+				}
+			};
+
+			inline
+			bool isValidUtf8( const uint8_t* ptr, size_t sz )
+			{
+				Utf8Validator v;
+				return v.feed( ptr, sz ) && v.isComplete();
+			}
+
+		} // namespace internal_usage_only
+
+#ifndef NODECPP_NO_COROUTINES
+
+		/*
+			WebSocket (RFC 6455) connection over a socket upgraded from HTTP (see HttpServerResponse::a_acceptWebSocket()).
+			Frames are parsed right from the socket's read buffer; payload is unmasked while being moved into the message buffer.
+			Fragmented messages are reassembled; control frames are handled as they come (ping is answered by pong; close is confirmed).
+			Frames are sent by a gather write of the header and the payload, with no copying.
+			Usage (in a request handler):
+				if ( request->isWebSocketUpgrade() )
+				{
+					WebSocket ws;
+					co_await response->a_acceptWebSocket( ws );
+					Buffer msg;
+					WebSocket::Opcode opcode;
+					while ( co_await ws.a_readMessage( msg, opcode ) )
+						co_await ws.a_send( msg, opcode );
+				}
+		*/
+		class WebSocket
+		{
+			friend class HttpServerResponse;
+
+		public:
+			enum class Opcode : uint8_t { continuation = 0x0, text = 0x1, binary = 0x2, close = 0x8, ping = 0x9, pong = 0xA };
+			enum CloseCode : uint16_t { normal = 1000, goingAway = 1001, protocolError = 1002, unsupportedData = 1003, noStatus = 1005, abnormal = 1006, invalidPayload = 1007, policyViolation = 1008, tooBig = 1009, internalError = 1011 };
+
+			struct Options
+			{
+				size_t maxMessageSize = 0x1000000; // larger messages are rejected with 'tooBig'
+			};
+
+		private:
+			nodecpp::safememory::soft_ptr<HttpSocketBase> sock;
+			Options options;
+			bool closeSent = false;
+			bool closed = false;
+			uint16_t closeCode = 0;
+
+			bool sending = false;
+			nodecpp::vector<awaitable_handle_t> sendWaiters; // a_send() calls waiting for the previous ones to complete
+
+			auto a_sendTurn() { 
+
+				struct send_turn_awaiter {
+					std::experimental::coroutine_handle<> myawaiting = nullptr;
+					WebSocket& ws;
+
+					send_turn_awaiter(WebSocket& ws_) : ws( ws_ ) {}
+
+					send_turn_awaiter(const send_turn_awaiter &) = delete;
+					send_turn_awaiter &operator = (const send_turn_awaiter &) = delete;
+
+					~send_turn_awaiter() {}
+
+					bool await_ready() {
+						return !ws.sending;
+					}
+
+					void await_suspend(std::experimental::coroutine_handle<> awaiting) {
+						nodecpp::setNoException(awaiting);
+						ws.sendWaiters.push_back( awaiting );
+						myawaiting = awaiting;
+					}
+
+					auto await_resume() {
+						if ( myawaiting != nullptr && nodecpp::isException(myawaiting) )
+							throw nodecpp::getException(myawaiting);
+					}
+				};
+				return send_turn_awaiter(*this);
+			}
+
+		public:
+			WebSocket() {}
+			WebSocket( const Options& opts ) : options( opts ) {}
+			WebSocket(const WebSocket&) = delete;
+			WebSocket& operator = (const WebSocket&) = delete;
+
+			bool isOpen() const { return sock != nullptr && !closed && !closeSent; }
+			uint16_t getCloseCode() const { return closeCode; } // as received from the peer (or 'abnormal', if the connection is just lost)
+
+			// Sec-WebSocket-Accept for Sec-WebSocket-Key of the client
+			static nodecpp::string acceptKey( const nodecpp::string& key )
+			{
+				static constexpr char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+				nodecpp::string s = key;
+				s.append( guid, sizeof(guid) - 1 );
+				uint8_t digest[20];
+				internal_usage_only::sha1( (const uint8_t*)(s.c_str()), s.size(), digest );
+				return internal_usage_only::base64( digest, sizeof(digest) );
+			}
+
+			// reads the next complete text or binary message into msg; returns false once the connection is closed
+			::nodecpp::awaitable<bool> a_readMessage( Buffer& msg, Opcode& opcode )
+			{
+				msg.clear();
+				if ( sock == nullptr || closed )
+					CO_RETURN false;
+				bool inMessage = false;
+				Opcode msgOpcode = Opcode::binary;
+				internal_usage_only::Utf8Validator utf8;
+				bool lost = false;
+				try
+				{
+					for(;;)
+					{
+						// frame header: 2 bytes, then 0, 2 or 8 bytes of extended length, then 4 bytes of masking key
+						uint8_t hdr[14];
+						CircularByteBuffer::AvailableDataDescriptor d;
+						co_await sock->a_dataAvailable( d, 2 );
+						peek( d, hdr, 2 );
+						uint8_t len7 = hdr[1] & 0x7F;
+						size_t hdrSize = 2 + ( len7 == 126 ? 2 : ( len7 == 127 ? 8 : 0 ) ) + ( ( hdr[1] & 0x80 ) ? 4 : 0 );
+						if ( d.sz1 + d.sz2 < hdrSize )
+							co_await sock->a_dataAvailable( d, hdrSize );
+						peek( d, hdr, hdrSize );
+						sock->dataForCommandProcessing.readBuffer.skip_data( hdrSize );
+
+						bool fin = ( hdr[0] & 0x80 ) != 0;
+						Opcode op = (Opcode)( hdr[0] & 0x0F );
+						uint64_t len = len7;
+						if ( len7 == 126 )
+							len = ( (uint64_t)(hdr[2]) << 8 ) | hdr[3];
+						else if ( len7 == 127 )
+						{
+							len = 0;
+							for ( size_t i=2; i<10; ++i )
+								len = ( len << 8 ) | hdr[i];
+						}
+						bool isControl = ( hdr[0] & 0x08 ) != 0;
+						if ( ( hdr[0] & 0x70 ) || !( hdr[1] & 0x80 ) || // no extensions are negotiated; client frames must be masked
+							( isControl && ( !fin || len > 125 ) ) ||
+							!( op == Opcode::continuation || op == Opcode::text || op == Opcode::binary || op == Opcode::close || op == Opcode::ping || op == Opcode::pong ) ||
+							( op == Opcode::continuation && !inMessage ) || ( !isControl && op != Opcode::continuation && inMessage ) )
+						{
+							fail( CloseCode::protocolError );
+							CO_RETURN false;
+						}
+						const uint8_t* key = hdr + hdrSize - 4;
+
+						if ( isControl )
+						{
+							Buffer payload( 125 );
+							co_await readPayload( (size_t)len, key, payload );
+							if ( op == Opcode::ping )
+							{
+								if ( !closeSent )
+									sendControl( Opcode::pong, payload.begin(), payload.size() );
+							}
+							else if ( op == Opcode::close )
+							{
+								onClose( payload );
+								CO_RETURN false;
+							}
+							continue; // pong is ignored
+						}
+
+						if ( len > options.maxMessageSize - msg.size() )
+						{
+							fail( CloseCode::tooBig );
+							CO_RETURN false;
+						}
+						if ( !inMessage )
+						{
+							msgOpcode = op;
+							inMessage = true;
+							utf8.reset();
+						}
+						size_t prevSize = msg.size();
+						co_await readPayload( (size_t)len, key, msg );
+						if ( msgOpcode == Opcode::text && ( !utf8.feed( msg.begin() + prevSize, msg.size() - prevSize ) || ( fin && !utf8.isComplete() ) ) ) // fragment by fragment
+						{
+							fail( CloseCode::invalidPayload );
+							CO_RETURN false;
+						}
+						if ( !fin )
+							continue;
+						opcode = msgOpcode;
+						CO_RETURN true;
+					}
+				}
+				catch (...)
+				{
+					lost = true;
+				}
+				if ( lost )
+				{
+					closed = true;
+					if ( closeCode == 0 )
+						closeCode = CloseCode::abnormal;
+				}
+				CO_RETURN false;
+			}
+
+			// sends a single-frame message; concurrent calls are sent one after another
+			nodecpp::handler_ret_type a_send( BufferView payload, Opcode opcode = Opcode::binary )
+			{
+				if ( !isOpen() )
+					throw Error();
+				co_await a_sendTurn();
+				sending = true;
+				uint8_t hdr[10];
+				size_t hdrSize = makeHeader( hdr, opcode, payload.size() );
+				std::exception_ptr sendError;
+				try
+				{
+					co_await sock->a_write( BufferView( hdr, hdrSize ), payload );
+				}
+				catch (...)
+				{
+					sendError = std::current_exception();
+				}
+				sending = false;
+				if ( !sendWaiters.empty() )
+				{
+					auto hr = sendWaiters.front();
+					sendWaiters.erase( sendWaiters.begin() );
+					hr();
+				}
+				if ( sendError )
+					std::rethrow_exception( sendError );
+				CO_RETURN;
+			}
+
+			nodecpp::handler_ret_type a_send( const Buffer& payload, Opcode opcode = Opcode::binary ) { co_await a_send( BufferView( payload ), opcode ); CO_RETURN; }
+			nodecpp::handler_ret_type a_sendText( const nodecpp::string& text ) { co_await a_send( BufferView( text.c_str(), text.size() ), Opcode::text ); CO_RETURN; }
+
+			// starts closing handshake; a_readMessage() returns false once the peer confirms it
+			void close( uint16_t code = CloseCode::normal )
+			{
+				if ( sock == nullptr || closeSent || closed )
+					return;
+				uint8_t payload[2] = { (uint8_t)( code >> 8 ), (uint8_t)code };
+				sendControl( Opcode::close, payload, 2 );
+				closeSent = true;
+			}
+
+		private:
+			void attach( nodecpp::safememory::soft_ptr<HttpSocketBase> s ) { sock = s; }
+
+			static void peek( const CircularByteBuffer::AvailableDataDescriptor& d, uint8_t* buff, size_t sz )
+			{
+				size_t sz1 = d.sz1 < sz ? d.sz1 : sz;
+				memcpy( buff, d.ptr1, sz1 );
+				if ( sz1 < sz )
+					memcpy( buff + sz1, d.ptr2, sz - sz1 );
+			}
+
+			// moves len bytes of payload from the read buffer to out, unmasking them on the way
+			nodecpp::handler_ret_type readPayload( size_t len, const uint8_t* key, Buffer& out )
+			{
+				size_t keyPos = 0;
+				while ( len )
+				{
+					CircularByteBuffer::AvailableDataDescriptor d;
+					co_await sock->a_dataAvailable( d );
+					size_t consumed = 0;
+					const uint8_t* ptrs[2] = { d.ptr1, d.ptr2 };
+					size_t sizes[2] = { d.sz1, d.ptr2 ? d.sz2 : 0 };
+					for ( size_t i=0; i<2 && consumed < len; ++i )
+					{
+						size_t sz = sizes[i] < len - consumed ? sizes[i] : len - consumed;
+						size_t start = out.size();
+						out.append( ptrs[i], sz );
+						internal_usage_only::wsUnmask( out.begin() + start, sz, key, keyPos );
+						consumed += sz;
+					}
+					sock->dataForCommandProcessing.readBuffer.skip_data( consumed );
+					len -= consumed;
+				}
+				CO_RETURN;
+			}
+
+			static size_t makeHeader( uint8_t* hdr, Opcode opcode, size_t payloadSize ) // server frames are not masked
+			{
+				hdr[0] = 0x80 | (uint8_t)opcode;
+				if ( payloadSize < 126 )
+				{
+					hdr[1] = (uint8_t)payloadSize;
+					return 2;
+				}
+				if ( payloadSize <= 0xFFFF )
+				{
+					hdr[1] = 126;
+					hdr[2] = (uint8_t)( payloadSize >> 8 );
+					hdr[3] = (uint8_t)payloadSize;
+					return 4;
+				}
+				hdr[1] = 127;
+				for ( size_t i=0; i<8; ++i )
+					hdr[9 - i] = (uint8_t)( (uint64_t)payloadSize >> ( i * 8 ) );
+				return 10;
+			}
+
+			// control frames are small; they are copied into the socket's write buffer and go after whatever is being sent
+			void sendControl( Opcode opcode, const uint8_t* payload, size_t sz )
+			{
+				uint8_t hdr[10];
+				size_t hdrSize = makeHeader( hdr, opcode, sz );
+				Buffer b( hdrSize + sz );
+				b.append( hdr, hdrSize );
+				if ( sz )
+					b.append( payload, sz );
+				sock->write( b );
+			}
+
+			void onClose( const Buffer& payload )
+			{
+				uint16_t code = CloseCode::noStatus;
+				bool valid = payload.size() != 1;
+				if ( payload.size() >= 2 )
+				{
+					code = ( (uint16_t)(payload.begin()[0]) << 8 ) | payload.begin()[1];
+					valid = ( code >= 1000 && code <= 1003 ) || ( code >= 1007 && code <= 1011 ) || ( code >= 3000 && code <= 4999 );
+					if ( valid && !internal_usage_only::isValidUtf8( payload.begin() + 2, payload.size() - 2 ) )
+					{
+						fail( CloseCode::invalidPayload );
+						return;
+					}
+				}
+				if ( !valid )
+				{
+					fail( CloseCode::protocolError );
+					return;
+				}
+				closeCode = code;
+				if ( !closeSent )
+				{
+					uint8_t reply[2] = { (uint8_t)( code >> 8 ), (uint8_t)code };
+					sendControl( Opcode::close, reply, code == CloseCode::noStatus ? 0 : 2 );
+					closeSent = true;
+				}
+				closed = true;
+				sock->end();
+			}
+
+			void fail( uint16_t code )
+			{
+				if ( !closeSent )
+				{
+					uint8_t payload[2] = { (uint8_t)( code >> 8 ), (uint8_t)code };
+					sendControl( Opcode::close, payload, 2 );
+					closeSent = true;
+				}
+				closed = true;
+				if ( closeCode == 0 )
+					closeCode = code;
+				sock->end();
+			}
+		};
+
+		inline
+		nodecpp::handler_ret_type HttpServerResponse::a_acceptWebSocket( WebSocket& ws, const char* protocol )
+		{
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, writeStatus == WriteStatus::notyet ); 
+			const nodecpp::string* key = myRequest->getHeader( "sec-websocket-key" );
+			if ( key == nullptr || !myRequest->isWebSocketUpgrade() )
+				throw Error();
+			setStatus( "HTTP/1.1 101 Switching Protocols" );
+			header.insert( std::make_pair( "Upgrade", "websocket" ) );
+			header.insert( std::make_pair( "Connection", "Upgrade" ) );
+			header.insert( std::make_pair( "Sec-WebSocket-Accept", WebSocket::acceptKey( *key ) ) );
+			if ( protocol != nullptr )
+				header.insert( std::make_pair( "Sec-WebSocket-Protocol", protocol ) );
+			closeAfterSent = false; // set by HttpSocketBase in case the upgrade is declined
+			serializeHeaders();
+			bool ok = true;
+			try {
+				co_await sock->a_turn( idx ); // responses to pipelined requests go out in order
+				co_await sock->a_write( headerBuff );
+			}
+			catch(...) {
+				ok = false;
+			}
+			myRequest->clear();
+			clear();
+			if ( !ok )
+				sock->end();
+			sock->release( idx ); // HttpSocketBase has stopped reading requests on this connection
+			if ( !ok )
+				throw Error();
+			ws.attach( sock );
+			CO_RETURN;
+		}
+
+#endif // NODECPP_NO_COROUTINES
+
+	} //namespace net
+
+} //namespace nodecpp
+
+#endif //WEBSOCKET_H
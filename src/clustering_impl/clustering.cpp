@@ -30,11 +30,30 @@
 
 #include "clustering_impl.h"
 #include "../../include/nodecpp/cluster.h"
+#include "../../include/nodecpp/offload.h"
 #include "../infrastructure.h"
 #include "../tcp_socket/tcp_socket.h"
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#if defined _MSC_VER || defined __MINGW32__
+#include <windows.h>
+#elif defined __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MPOL_LOCAL
+#define MPOL_LOCAL 4 // <linux/mempolicy.h>
+#endif
+#endif
 
 
+// Queues of all threads are a single static array, so their pages land at whatever NUMA node first touches them
+// (normally the master thread's), not at the node of the thread reading them; pinning below does not move them.
 static InterThreadCommData threadQueues[MAX_THREADS];
 
 static InterThreadCommInitializer interThreadCommInitializer;
@@ -45,16 +64,57 @@ struct ThreadDescriptor
 };
 static thread_local ThreadDescriptor thisThreadDescriptor;
 void setThisThreadDescriptor(ThreadStartupData& startupData) { thisThreadDescriptor.threadID = startupData.threadCommID; }
+ThreadID getThisThreadID() { return thisThreadDescriptor.threadID; }
 
 thread_local size_t workerIdxInLoadCollector = (size_t)(-1);
 extern void decrementWorkerLoadCtr( size_t idx );
+void incrementThisWorkerLoadCtr() { incrementWorkerLoadCtr(workerIdxInLoadCollector); }
 void decrementThisWorkerLoadCtr() { decrementWorkerLoadCtr(workerIdxInLoadCollector); }
+void publishThisWorkerLoadMetrics( uint32_t loopLagUs, uint32_t busyPermille, uint64_t now )
+{
+	if ( workerIdxInLoadCollector == (size_t)(-1) )
+		return;
+	size_t queueDepth = threadQueues[thisThreadDescriptor.threadID.slotId].queue.approxSize();
+	publishWorkerLoadMetrics( workerIdxInLoadCollector, loopLagUs, busyPermille, queueDepth < UINT32_MAX ? (uint32_t)queueDepth : UINT32_MAX, now );
+}
+void setThisWorkerWaiting( bool waiting )
+{
+	if ( workerIdxInLoadCollector != (size_t)(-1) )
+		setWorkerWaiting( workerIdxInLoadCollector, waiting );
+}
 
 size_t popFrontFromThisThreadQueue( InterThreadMsg* messages, size_t count )
 {
 	return threadQueues[thisThreadDescriptor.threadID.slotId].queue.pop_front( messages, count );
 }
 
+bool acknowledgeThisThreadWakeup( uintptr_t readHandle )
+{
+	// reset first: a producer that finds wakeupPending cleared will signal again, and that signal must not be swallowed
+	bool ok = nodecpp::internal_usage_only::internal_reset_awaker( (SOCKET)readHandle );
+	threadQueues[thisThreadDescriptor.threadID.slotId].acknowledgeWakeup();
+	return ok;
+}
+
+bool postTaskToThread( PostedTask* task, ThreadID targetThreadId )
+{
+	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, targetThreadId.slotId < MAX_THREADS, "{} vs. {}", targetThreadId.slotId, MAX_THREADS );
+	auto pushed = threadQueues[ targetThreadId.slotId ].pushPostedTaskIfRunning( task, targetThreadId.reincarnation );
+	if ( !pushed.first )
+		return false;
+	if ( threadQueues[ targetThreadId.slotId ].requestWakeup() ) // otherwise the target is already awake and will take posted tasks
+	{
+		bool ok = nodecpp::internal_usage_only::internal_signal_awaker( (SOCKET)(pushed.second) );
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ok ); 
+	}
+	return true;
+}
+
+PostedTask* takeThisThreadPostedTasks()
+{
+	return threadQueues[thisThreadDescriptor.threadID.slotId].takePostedTasks();
+}
+
 void preinitThreadStartupData( ThreadStartupData& startupData )
 {
 	InterThreadCommPair commPair = interThreadCommInitializer.generateHandlePair();
@@ -71,13 +131,383 @@ void preinitThreadStartupData( ThreadStartupData& startupData )
 	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, startupData.threadCommID.slotId != ThreadID::InvalidSlotID ); 
 	startupData.readHandle = commPair.readHandle;
 	startupData.defaultLog = nodecpp::logging_impl::currentLog;
+	startupData.cpu = -1;
+}
+
+// Placement of worker and listener threads is configured by command line arguments:
+//   workercpus=<list>    CPUs to pin workers to, one CPU per worker in turn; "auto" means all CPUs available to the process
+//   listenercpus=<list>  CPUs to pin listener threads to, one CPU per listener in turn
+//   isolatelistener=1    listener CPUs are excluded from worker CPUs (both "auto" and an explicit list)
+// where <list> is comma-separated CPU numbers and ranges, e.g. 0,2,4-7
+// A pinned thread also gets node-local memory policy (Linux), so that its allocator arenas and buffers stay at its NUMA node.
+class ThreadPlacement
+{
+	bool configured = false;
+	nodecpp::stdvector<int> workerCpus;
+	nodecpp::stdvector<int> listenerCpus;
+	size_t workerCtr = 0;
+	size_t listenerCtr = 0;
+
+	static void parseCpuList( const char* list, nodecpp::stdvector<int>& cpus )
+	{
+		while ( *list )
+		{
+			char* end;
+			long first = strtol( list, &end, 10 );
+			if ( end == list )
+				break;
+			long last = first;
+			if ( *end == '-' )
+			{
+				list = end + 1;
+				last = strtol( list, &end, 10 );
+				if ( end == list )
+					last = first;
+			}
+			for ( long cpu = first; cpu <= last; ++cpu )
+				cpus.push_back( (int)cpu );
+			list = *end == ',' ? end + 1 : end;
+		}
+	}
+
+	static void getAvailableCpus( nodecpp::stdvector<int>& cpus )
+	{
+#if defined _MSC_VER || defined __MINGW32__
+		DWORD_PTR processMask, systemMask;
+		if ( GetProcessAffinityMask( GetCurrentProcess(), &processMask, &systemMask ) )
+			for ( int cpu = 0; cpu < (int)(sizeof(DWORD_PTR) * 8); ++cpu )
+				if ( processMask & ( ((DWORD_PTR)1) << cpu ) )
+					cpus.push_back( cpu );
+#elif defined __linux__
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		if ( sched_getaffinity( 0, sizeof(set), &set ) == 0 )
+			for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+				if ( CPU_ISSET( cpu, &set ) )
+					cpus.push_back( cpu );
+#endif
+	}
+
+	void configure()
+	{
+		configured = true;
+		bool autoWorkers = false;
+		bool isolateListener = false;
+		auto& argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 11 && argv[i].substr(0,11) == "workercpus=" )
+			{
+				if ( argv[i].substr(11) == "auto" )
+					autoWorkers = true;
+				else
+					parseCpuList( argv[i].c_str() + 11, workerCpus );
+			}
+			else if ( argv[i].size() > 13 && argv[i].substr(0,13) == "listenercpus=" )
+				parseCpuList( argv[i].c_str() + 13, listenerCpus );
+			else if ( argv[i].size() > 16 && argv[i].substr(0,16) == "isolatelistener=" )
+				isolateListener = atol( argv[i].c_str() + 16 ) != 0;
+		}
+		if ( autoWorkers )
+		{
+			workerCpus.clear();
+			getAvailableCpus( workerCpus );
+		}
+		if ( isolateListener && !workerCpus.empty() )
+		{
+			auto isListenerCpu = [this]( int cpu ) { return std::find( listenerCpus.begin(), listenerCpus.end(), cpu ) != listenerCpus.end(); };
+			workerCpus.erase( std::remove_if( workerCpus.begin(), workerCpus.end(), isListenerCpu ), workerCpus.end() );
+			if ( workerCpus.empty() )
+				nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"isolatelistener=1: all worker CPUs are listener CPUs; workers are not pinned" );
+		}
+	}
+
+	static int next( const nodecpp::stdvector<int>& cpus, size_t& ctr ) { return cpus.empty() ? -1 : cpus[ ctr++ % cpus.size() ]; }
+
+public:
+	int cpuForNewWorker() { if ( !configured ) configure(); return next( workerCpus, workerCtr ); }
+	int cpuForNewListener() { if ( !configured ) configure(); return next( listenerCpus, listenerCtr ); }
+};
+static ThreadPlacement threadPlacement;
+
+int getCpuForNewWorker() { return threadPlacement.cpuForNewWorker(); }
+int getCpuForNewListener() { return threadPlacement.cpuForNewListener(); }
+
+void applyThisThreadPlacement( int cpu )
+{
+	if ( cpu < 0 )
+		return;
+#if defined _MSC_VER || defined __MINGW32__
+	if ( cpu >= (int)(sizeof(DWORD_PTR) * 8) || SetThreadAffinityMask( GetCurrentThread(), ((DWORD_PTR)1) << cpu ) == 0 )
+		nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"failed to pin thread to CPU {}", cpu );
+#elif defined __linux__
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( cpu, &set );
+	if ( sched_setaffinity( 0, sizeof(set), &set ) != 0 ) // 0: the calling thread
+	{
+		nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"failed to pin thread to CPU {}, error {}", cpu, errno );
+		return;
+	}
+	// allocations of a pinned thread are to come from its own node regardless of the process-wide policy (e.g. interleave)
+	if ( syscall( SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0 ) != 0 )
+		nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"failed to set node-local memory policy, error {}", errno );
+#else
+	nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"pinning threads to CPUs is not supported on this platform (CPU {} requested)", cpu );
+#endif
+}
+
+// Offload pool (see offload.h). Each pool thread owns a queue with a lane per priority; tasks are spread over the queues
+// round-robin. A thread takes the highest priority task of its own queue, and only when the queue is empty steals the
+// highest priority task of the first non-empty queue of the others, so that a probe takes a single lock in a busy pool.
+// The pool is never destroyed, as its threads are detached like all other threads.
+// A task may also be handed back to the thread that has run it (finalizeAtOffloadThread()), so that memory allocated there
+// during the run is freed at the same thread; such tasks are collected in a lock-free list per thread.
+class OffloadPool
+{
+	struct alignas(64) TaskQueue
+	{
+		std::mutex mx;
+		std::deque<nodecpp::OffloadTask*, nodecpp::safememory::stdallocator<nodecpp::OffloadTask*>> lanes[nodecpp::offloadPriorityCount]; // may be touched by any thread
+		std::atomic<nodecpp::OffloadTask*> finalizing = nullptr; // pushed by any thread, drained by the owning thread
+	};
+
+	size_t threadCnt = 0;
+	size_t maxQueued = 0;
+	TaskQueue* queues = nullptr;
+	std::atomic<size_t> submitCtr = 0;
+
+	std::mutex idleMx;
+	std::condition_variable idleCv;
+
+	std::atomic<size_t> queued = 0;
+	std::atomic<size_t> running = 0;
+	std::atomic<uint64_t> completed = 0;
+	std::atomic<uint64_t> rejected = 0;
+	std::atomic<uint64_t> queueLatencySum = 0;
+	std::atomic<uint64_t> queueLatencyMax = 0;
+	std::atomic<uint64_t> runTimeSum = 0;
+
+	nodecpp::OffloadTask* popFrom( size_t queueIdx )
+	{
+		TaskQueue& q = queues[queueIdx];
+		std::unique_lock<std::mutex> lock( q.mx );
+		for ( size_t prio=0; prio<nodecpp::offloadPriorityCount; ++prio )
+			if ( !q.lanes[prio].empty() )
+			{
+				nodecpp::OffloadTask* task = q.lanes[prio].front();
+				q.lanes[prio].pop_front();
+				return task;
+			}
+		return nullptr;
+	}
+
+	nodecpp::OffloadTask* take( size_t ownIdx )
+	{
+		nodecpp::OffloadTask* task = popFrom( ownIdx );
+		for ( size_t i=1; task == nullptr && i<threadCnt && queued.load( std::memory_order_relaxed ) != 0; ++i )
+			task = popFrom( ( ownIdx + i ) % threadCnt );
+		return task;
+	}
+
+	void recordRun( uint64_t enqueuedAt, uint64_t startedAt, uint64_t finishedAt )
+	{
+		uint64_t latency = startedAt - enqueuedAt;
+		queueLatencySum.fetch_add( latency, std::memory_order_relaxed );
+		uint64_t prevMax = queueLatencyMax.load( std::memory_order_relaxed );
+		while ( latency > prevMax && !queueLatencyMax.compare_exchange_weak( prevMax, latency, std::memory_order_relaxed ) );
+		runTimeSum.fetch_add( finishedAt - startedAt, std::memory_order_relaxed );
+		completed.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	void runFinalizing( size_t idx )
+	{
+		nodecpp::OffloadTask* task = queues[idx].finalizing.exchange( nullptr, std::memory_order_acquire );
+		while ( task != nullptr )
+		{
+			nodecpp::OffloadTask* next = task->next;
+			task->run( task );
+			task = next;
+		}
+	}
+
+	void threadMain( size_t idx, nodecpp::log::Log* log )
+	{
+#ifdef NODECPP_USE_IIBMALLOC
+		g_AllocManager.initialize();
+#endif
+		nodecpp::logging_impl::currentLog = log;
+		for (;;)
+		{
+			runFinalizing( idx );
+			nodecpp::OffloadTask* task = take( idx );
+			if ( task == nullptr )
+			{
+				std::unique_lock<std::mutex> lock( idleMx );
+				idleCv.wait( lock, [this, idx]() { return queued.load( std::memory_order_acquire ) != 0 || queues[idx].finalizing.load( std::memory_order_relaxed ) != nullptr; } );
+				continue;
+			}
+			queued.fetch_sub( 1, std::memory_order_relaxed );
+			running.fetch_add( 1, std::memory_order_relaxed );
+			uint64_t enqueuedAt = task->enqueuedAt;
+			uint64_t startedAt = infraGetCurrentTime();
+			task->poolThread = idx;
+			task->run( task ); // the task is not to be touched after this point
+			recordRun( enqueuedAt, startedAt, infraGetCurrentTime() );
+			running.fetch_sub( 1, std::memory_order_relaxed );
+		}
+	}
+
+public:
+	OffloadPool( size_t threadCnt_, size_t maxQueued_ ) : threadCnt( threadCnt_ ), maxQueued( maxQueued_ )
+	{
+		queues = new TaskQueue[ threadCnt ];
+		for ( size_t i=0; i<threadCnt; ++i )
+		{
+			std::thread t( [this, i, log = nodecpp::logging_impl::currentLog]() { threadMain( i, log ); } );
+			t.detach();
+		}
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"offload pool started with {} threads, queue limit {}", threadCnt, maxQueued );
+	}
+
+	bool submit( nodecpp::OffloadTask* task, nodecpp::OffloadPriority priority )
+	{
+		if ( queued.fetch_add( 1, std::memory_order_relaxed ) >= maxQueued )
+		{
+			queued.fetch_sub( 1, std::memory_order_relaxed );
+			rejected.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+		task->enqueuedAt = infraGetCurrentTime();
+		TaskQueue& q = queues[ submitCtr.fetch_add( 1, std::memory_order_relaxed ) % threadCnt ];
+		{
+			std::unique_lock<std::mutex> lock( q.mx );
+			q.lanes[ (size_t)priority ].push_back( task );
+		}
+		{
+			std::unique_lock<std::mutex> lock( idleMx ); // so that a thread about to wait does not miss it
+		}
+		idleCv.notify_one();
+		return true;
+	}
+
+	void finalize( nodecpp::OffloadTask* task )
+	{
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, task->poolThread < threadCnt, "{} vs. {}", task->poolThread, threadCnt );
+		std::atomic<nodecpp::OffloadTask*>& head = queues[ task->poolThread ].finalizing;
+		nodecpp::OffloadTask* prev = head.load( std::memory_order_relaxed );
+		do {
+			task->next = prev;
+		} while ( !head.compare_exchange_weak( prev, task, std::memory_order_release, std::memory_order_relaxed ) );
+		if ( prev == nullptr ) // otherwise the thread is already notified
+		{
+			{
+				std::unique_lock<std::mutex> lock( idleMx );
+			}
+			idleCv.notify_all(); // the owning thread is not necessarily the one to be woken by notify_one()
+		}
+	}
+
+	nodecpp::OffloadStats getStats()
+	{
+		nodecpp::OffloadStats stats;
+		stats.threads = threadCnt;
+		stats.queued = queued.load( std::memory_order_relaxed );
+		stats.running = running.load( std::memory_order_relaxed );
+		stats.completed = completed.load( std::memory_order_relaxed );
+		stats.rejected = rejected.load( std::memory_order_relaxed );
+		if ( stats.completed != 0 )
+		{
+			stats.avgQueueLatencyUs = queueLatencySum.load( std::memory_order_relaxed ) / stats.completed;
+			stats.avgRunTimeUs = runTimeSum.load( std::memory_order_relaxed ) / stats.completed;
+		}
+		stats.maxQueueLatencyUs = queueLatencyMax.load( std::memory_order_relaxed );
+		return stats;
+	}
+};
+
+static std::mutex offloadPoolMx;
+static std::atomic<OffloadPool*> offloadPool = nullptr;
+static size_t offloadPoolThreadCnt = 0;
+static size_t offloadPoolMaxQueued = 0;
+
+static size_t parseOffloadArg( const nodecpp::stdstring& arg, size_t prefixSz, long maxVal ) // 0 if invalid (and the default is then used)
+{
+	const char* start = arg.c_str() + prefixSz;
+	char* end = nullptr;
+	errno = 0;
+	long val = strtol( start, &end, 10 );
+	if ( errno != 0 || end == start || *end != 0 || val <= 0 || val > maxVal )
+	{
+		nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"invalid value in \"{}\" (expected 1..{}); default is used", arg, maxVal );
+		return 0;
+	}
+	return (size_t)val;
+}
+
+static OffloadPool& getOffloadPool()
+{
+	OffloadPool* pool = offloadPool.load( std::memory_order_acquire );
+	if ( pool != nullptr )
+		return *pool;
+	std::unique_lock<std::mutex> lock( offloadPoolMx );
+	pool = offloadPool.load( std::memory_order_relaxed );
+	if ( pool == nullptr )
+	{
+		size_t threadCnt = offloadPoolThreadCnt;
+		size_t maxQueued = offloadPoolMaxQueued;
+		auto& argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( threadCnt == 0 && argv[i].size() > 15 && argv[i].substr(0,15) == "offloadthreads=" )
+				threadCnt = parseOffloadArg( argv[i], 15, 1024 );
+			else if ( maxQueued == 0 && argv[i].size() > 13 && argv[i].substr(0,13) == "offloadqueue=" )
+				maxQueued = parseOffloadArg( argv[i], 13, 1 << 24 );
+		}
+		if ( threadCnt == 0 ) // loop threads are busy themselves; a quarter of the hardware threads does not oversubscribe the machine
+			threadCnt = std::max( std::thread::hardware_concurrency() / 4, 1u );
+		if ( maxQueued == 0 )
+			maxQueued = 4096;
+		pool = new OffloadPool( threadCnt, maxQueued );
+		offloadPool.store( pool, std::memory_order_release );
+	}
+	return *pool;
+}
+
+namespace nodecpp
+{
+	void setOffloadPoolSize( size_t threadCnt, size_t maxQueued )
+	{
+		std::unique_lock<std::mutex> lock( offloadPoolMx );
+		if ( offloadPool.load( std::memory_order_relaxed ) != nullptr )
+		{
+			nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"offload pool is already started; setOffloadPoolSize() is ignored" );
+			return;
+		}
+		offloadPoolThreadCnt = threadCnt;
+		offloadPoolMaxQueued = maxQueued;
+	}
+
+	OffloadStats getOffloadStats()
+	{
+		OffloadPool* pool = offloadPool.load( std::memory_order_acquire );
+		return pool != nullptr ? pool->getStats() : OffloadStats();
+	}
+
+	bool submitOffloadTask( OffloadTask* task, OffloadPriority priority )
+	{
+		return getOffloadPool().submit( task, priority );
+	}
+
+	void finalizeAtOffloadThread( OffloadTask* task )
+	{
+		getOffloadPool().finalize( task );
+	}
 }
 	
 
 uintptr_t InterThreadCommInitializer::init()
 {
-	Ip4 ip4 = Ip4::parse( "127.0.01" );
-	myServerSocket = acquireSocketAndLetInterThreadCommServerListening( ip4, myServerPort, 128 );
 	auto commPair = interThreadCommInitializer.generateHandlePair();
 	threadQueues[0].setWriteHandleForFirstUse( commPair.writeHandle );
 	return commPair.readHandle;
@@ -85,6 +515,17 @@ uintptr_t InterThreadCommInitializer::init()
 
 InterThreadCommPair InterThreadCommInitializer::generateHandlePair()
 {
+	SOCKET readHandle, writeHandle;
+	if ( nodecpp::internal_usage_only::internal_make_awaker( readHandle, writeHandle ) )
+		return InterThreadCommPair({(uintptr_t)(readHandle), (uintptr_t)(writeHandle)});
+
+	// no eventfd or pollable pipe on this platform: use a loopback TCP connection
+	if ( !isInitialized_ )
+	{
+		Ip4 ip4 = Ip4::parse( "127.0.01" );
+		myServerSocket = acquireSocketAndLetInterThreadCommServerListening( ip4, myServerPort, 128 );
+		isInitialized_ = true;
+	}
 	auto res = acquireAndConnectSocketForInterThreadComm( myServerSocket, "127.0.01", myServerPort );
 	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, res.first.second == res.second.second ); 
 	return InterThreadCommPair({(uintptr_t)(res.first.first), (uintptr_t)(res.second.first)});
@@ -95,7 +536,7 @@ uintptr_t initInterThreadCommSystemAndGetReadHandleForMainThread()
 	return interThreadCommInitializer.init();
 }
 
-void sendInterThreadMsg(nodecpp::platform::internal_msg::InternalMsg&& msg, InterThreadMsgType msgType, ThreadID targetThreadId )
+bool sendInterThreadMsg(nodecpp::platform::internal_msg::InternalMsg&& msg, InterThreadMsgType msgType, ThreadID targetThreadId )
 {
 	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, targetThreadId.slotId < MAX_THREADS, "{} vs. {}", targetThreadId.slotId, MAX_THREADS );
 	auto writingMeans = threadQueues[ targetThreadId.slotId ].getWriteHandleAndReincarnation();
@@ -108,13 +549,14 @@ void sendInterThreadMsg(nodecpp::platform::internal_msg::InternalMsg&& msg, Inte
 	uint64_t reincarnation = writingMeans.second.first;
 	
 	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, reincarnation == targetThreadId.reincarnation, "for idx = {}: {} vs. {}", targetThreadId.slotId, reincarnation, targetThreadId.reincarnation ); 
-	threadQueues[ targetThreadId.slotId ].queue.push_back( InterThreadMsg( std::move( msg ), msgType, thisThreadDescriptor.threadID, targetThreadId ) );
-	// write a byte to writeHandle
-	uint8_t singleByte = 0x1;
-	size_t sentSize = 0;
-	auto ret = nodecpp::internal_usage_only::internal_send_packet( &singleByte, 1, writeHandle, sentSize );
-	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ret == COMMLAYER_RET_OK ); 
-	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sentSize == 1 ); 
+	if ( !threadQueues[ targetThreadId.slotId ].queue.push_back( InterThreadMsg( std::move( msg ), msgType, thisThreadDescriptor.threadID, targetThreadId ) ) )
+		return false; // rejected by queue overflow policy; the target is not notified
+	if ( threadQueues[ targetThreadId.slotId ].requestWakeup() ) // otherwise the target is already awake and will drain the queue
+	{
+		bool ok = nodecpp::internal_usage_only::internal_signal_awaker( (SOCKET)writeHandle );
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ok ); 
+	}
+	return true;
 }
 
 
@@ -156,6 +598,7 @@ namespace nodecpp
 		Worker worker;
 		worker.id_ = ++coreCtr; // TODO: assign an actual value
 		startupData->IdWithinGroup = worker.id_;
+		startupData->cpu = getCpuForNewWorker();
 		// run worker thread
 		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"about to start Worker thread with threadID = {} and WorkerID = {}...", threadIdx, worker.id_ );
 		std::thread t1( workerThreadMain, (void*)(startupData) );
@@ -172,6 +615,135 @@ namespace nodecpp
 		// TODO: ...
 	}
 
+	void returnForeignBufferToOwner( ThreadID owner, uint8_t* data, size_t size, size_t capacity )
+	{
+#ifdef NODECPP_USE_IIBMALLOC
+		if ( owner.slotId != getThisThreadID().slotId )
+		{
+			UserMsgHeader h;
+			memset( &h, 0, sizeof(h) );
+			h.kind = UserMsgHeader::BufferReturn;
+			h.bufferData = (uintptr_t)data;
+			h.bufferSize = size;
+			h.bufferCapacity = capacity;
+			nodecpp::platform::internal_msg::InternalMsg imsg;
+			imsg.append( &h, sizeof(h) );
+			if ( !sendInterThreadMsg( std::move( imsg ), InterThreadMsgType::UserDefined, owner ) )
+				nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"failed to return a buffer of {} bytes to thread {}; leaked", capacity, owner.slotId );
+			return;
+		}
+#endif // NODECPP_USE_IIBMALLOC
+		Buffer::adopt( data, size, capacity ); // freed right here
+	}
+
+	bool Cluster::sendUserMsg( ThreadID target, UserMsgHeader::Kind kind, uint32_t tag, uint64_t requestID, const void* data, size_t sz, Buffer* buffer )
+	{
+		UserMsgHeader h;
+		memset( &h, 0, sizeof(h) );
+		h.kind = kind;
+		h.tag = tag;
+		h.requestID = requestID;
+		Buffer large;
+		if ( buffer == nullptr && sz > maxInlinePayload )
+		{
+			large.append( data, sz );
+			buffer = &large;
+		}
+		if ( buffer != nullptr )
+			h.bufferData = (uintptr_t)( buffer->release( h.bufferSize, h.bufferCapacity ) );
+		else
+			h.inlineSize = sz;
+
+		nodecpp::platform::internal_msg::InternalMsg imsg;
+		imsg.append( &h, sizeof(h) );
+		if ( h.inlineSize )
+			imsg.append( data, h.inlineSize );
+		if ( sendInterThreadMsg( std::move( imsg ), InterThreadMsgType::UserDefined, target ) )
+			return true;
+		if ( h.bufferData )
+			Buffer::adopt( (uint8_t*)(h.bufferData), h.bufferSize, h.bufferCapacity ); // not sent; free it here
+		return false;
+	}
+
+	size_t Cluster::broadcastMessage( uint32_t tag, const void* data, size_t sz )
+	{
+		ThreadID ids[MAX_THREADS];
+		size_t cnt = getWorkerThreadIDs( ids, MAX_THREADS );
+		ThreadID me = getThisThreadID();
+		size_t sentCnt = 0;
+		for ( size_t i=0; i<cnt && i<MAX_THREADS; ++i )
+			if ( ids[i].slotId != me.slotId && sendUserMsg( ids[i], UserMsgHeader::Post, tag, 0, data, sz, nullptr ) )
+				++sentCnt;
+		return sentCnt;
+	}
+
+	void Cluster::onUserMessage( ThreadID source, nodecpp::platform::internal_msg::InternalMsg::ReadIter& riter )
+	{
+		size_t sz = riter.availableSize();
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( UserMsgHeader ) <= sz, "{} vs. {}", sizeof( UserMsgHeader ), sz ); 
+		UserMsgHeader h = *reinterpret_cast<const UserMsgHeader*>( riter.read( sizeof( UserMsgHeader ) ) );
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( UserMsgHeader ) + h.inlineSize <= sz, "{} vs. {}", sizeof( UserMsgHeader ) + h.inlineSize, sz ); 
+		const uint8_t* inlineData = h.inlineSize ? riter.read( h.inlineSize ) : nullptr;
+
+		if ( h.kind == UserMsgHeader::BufferReturn )
+		{
+			Buffer::adopt( (uint8_t*)(h.bufferData), h.bufferSize, h.bufferCapacity ); // back at its owner; freed right here
+			return;
+		}
+
+		WorkerMessage msg;
+		msg.source = source;
+		msg.tag = h.tag;
+		msg.requestID = h.kind == UserMsgHeader::Post ? 0 : h.requestID;
+		if ( h.bufferData )
+			msg.buffer = ForeignBuffer( source, (uint8_t*)(h.bufferData), h.bufferSize, h.bufferCapacity );
+
+		if ( h.kind == UserMsgHeader::ErrorReply )
+		{
+			auto it = pendingUserRequests.find( h.requestID );
+			if ( it == pendingUserRequests.end() )
+				return; // timed out already
+			PendingUserRequest pending = it->second;
+			pendingUserRequests.erase( it );
+			nodecpp::setException(pending.h, std::exception()); // TODO: switch to our exceptions ASAP!
+			pending.h();
+			return;
+		}
+
+		if ( h.kind == UserMsgHeader::Reply )
+		{
+			auto it = pendingUserRequests.find( h.requestID );
+			if ( it == pendingUserRequests.end() )
+			{
+				nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"reply to unknown request {} from thread {}; dropped", h.requestID, source.slotId );
+				return;
+			}
+			PendingUserRequest pending = it->second;
+			pendingUserRequests.erase( it );
+			WorkerMessage& response = *(pending.response);
+			response = std::move( msg );
+			if ( h.inlineSize )
+			{
+				response.ownedData.append( inlineData, h.inlineSize );
+				response.data = response.ownedData.begin();
+				response.size = h.inlineSize;
+			}
+			pending.h();
+			return;
+		}
+
+		msg.data = inlineData;
+		msg.size = h.inlineSize;
+		if ( userMsgHandler )
+			userMsgHandler( msg );
+		else
+		{
+			nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"message with tag {} from thread {} while no handler is set; dropped", h.tag, source.slotId );
+			if ( h.kind == UserMsgHeader::Request )
+				sendUserMsg( source, UserMsgHeader::ErrorReply, h.tag, h.requestID, nullptr, 0, nullptr ); // otherwise the requester waits until its timeout
+		}
+	}
+
 	void Cluster::AgentServer::registerServer() { 
 		nodecpp::safememory::soft_ptr<Cluster::AgentServer> myPtr = myThis.getSoftPtr<Cluster::AgentServer>(this);
 		::registerAgentServer(myPtr); 
@@ -209,6 +781,21 @@ namespace nodecpp
 				netServerManagerBase->addAcceptedSocket( msg->serverIdx, (SOCKET)(msg->socket), msg->ip, msg->uport );
 				break;
 			}
+			case InterThreadMsgType::ConnAcceptedBatch:
+			{
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( ConnAcceptedBatchEvMsg ) <= sz, "{} vs. {}", sizeof( ConnAcceptedBatchEvMsg ), sz ); 
+				const ConnAcceptedBatchEvMsg* msg = reinterpret_cast<const ConnAcceptedBatchEvMsg*>( riter.read( sizeof( ConnAcceptedBatchEvMsg ) ) );
+				size_t serverIdx = msg->serverIdx;
+				size_t count = msg->count;
+				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( ConnAcceptedBatchEvMsg ) + count * sizeof( AcceptedConnData ) <= sz, "{} vs. {}", sizeof( ConnAcceptedBatchEvMsg ) + count * sizeof( AcceptedConnData ), sz ); 
+				netServerManagerBase->reserveAcceptedSockets( count );
+				for ( size_t i=0; i<count; ++i )
+				{
+					const AcceptedConnData* conn = reinterpret_cast<const AcceptedConnData*>( riter.read( sizeof( AcceptedConnData ) ) );
+					netServerManagerBase->addAcceptedSocket( serverIdx, (SOCKET)(conn->socket), conn->ip, conn->uport );
+				}
+				break;
+			}
 			case InterThreadMsgType::ServerError:
 			{
 				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( ServerErrorEvMsg ) <= sz, "{} vs. {}", sizeof( ServerErrorEvMsg ), sz ); 
@@ -216,6 +803,9 @@ namespace nodecpp
 				// TODO: ...
 				break;
 			}
+			case InterThreadMsgType::UserDefined:
+				cluster.onUserMessage( requestingThreadId, riter );
+				break;
 			case InterThreadMsgType::ServerClosedNotification:
 			{
 				NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sizeof( ServerCloseNotificationMsg ) <= sz, "{} vs. {}", sizeof( ServerCloseNotificationMsg ), sz ); 
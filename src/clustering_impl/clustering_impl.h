@@ -42,10 +42,17 @@ struct ThreadStartupData
 	uintptr_t readHandle;
 	nodecpp::log::Log* defaultLog = nullptr;
 	size_t IdWithinGroup;
+	int cpu; // to pin the thread to; -1 if not pinned
 };
 
 void preinitThreadStartupData( ThreadStartupData& startupData );
+int getCpuForNewWorker(); // master thread only; -1 if workers are not pinned
+int getCpuForNewListener(); // master thread only; -1 if listeners are not pinned
+void applyThisThreadPlacement( int cpu ); // to be called first thing at a new thread, so that its memory is then allocated at its NUMA node
+void incrementThisWorkerLoadCtr(); // for connections accepted by a worker itself (NODECPP_ACCEPT_IN_WORKERS)
 void decrementThisWorkerLoadCtr();
+void publishThisWorkerLoadMetrics( uint32_t loopLagUs, uint32_t busyPermille, uint64_t now ); // no-op at non-worker threads
+void setThisWorkerWaiting( bool waiting ); // no-op at non-worker threads
 
 #endif // NODECPP_ENABLE_CLUSTERING
 
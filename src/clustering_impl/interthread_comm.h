@@ -42,7 +42,7 @@ struct ThreadID
 	uint64_t reincarnation = InvalidReincarnation;
 };
 
-enum class InterThreadMsgType { UserDefined, ThreadStarted, ThreadTerminate, ServerListening, ConnAccepted, ServerError, ServerCloseRequest, ServerClosedNotification, RequestToListeningThread, Undefined };
+enum class InterThreadMsgType { UserDefined, ThreadStarted, ThreadTerminate, ServerListening, ConnAccepted, ConnAcceptedBatch, ServerError, ServerCloseRequest, ServerClosedNotification, RequestToListeningThread, Undefined };
 
 extern thread_local size_t workerIdxInLoadCollector;
 
@@ -63,10 +63,28 @@ struct InterThreadMsg
 	InterThreadMsg& operator = ( InterThreadMsg&& other ) = default;
 };
 
+struct PostedTask // a callable posted to a thread's loop from any thread (see nodecpp::postToLoop())
+{
+	PostedTask* next = nullptr;
+	void (*fn)( PostedTask* self, bool invoke ) = nullptr; // invokes (if requested) and destroys
+};
+
 uintptr_t initInterThreadCommSystemAndGetReadHandleForMainThread();
-void sendInterThreadMsg(nodecpp::platform::internal_msg::InternalMsg&& msg, InterThreadMsgType msgType, ThreadID threadId );
+bool sendInterThreadMsg(nodecpp::platform::internal_msg::InternalMsg&& msg, InterThreadMsgType msgType, ThreadID threadId ); // false if rejected by the target queue
 void setThisThreadDescriptor(ThreadStartupData& startupData);
-size_t popFrontFromThisThreadQueue( InterThreadMsg* messages, size_t count );
+size_t popFrontFromThisThreadQueue( InterThreadMsg* messages, size_t count ); // non-blocking; returns number of messages popped
+bool acknowledgeThisThreadWakeup( uintptr_t readHandle ); // to be called on awaker readiness before draining the queue
+bool postTaskToThread( PostedTask* task, ThreadID threadId ); // thread-safe; false if the target is not running (the task is not taken then)
+PostedTask* takeThisThreadPostedTasks(); // all posted so far, in posting order
+inline void destroyPostedTasks( PostedTask* tasks ) // without invoking them
+{
+	while ( tasks != nullptr )
+	{
+		PostedTask* next = tasks->next;
+		tasks->fn( tasks, false );
+		tasks = next;
+	}
+}
 
 struct ListenerThreadDescriptor
 {
@@ -74,11 +92,34 @@ struct ListenerThreadDescriptor
 };
 std::pair<const ListenerThreadDescriptor*, size_t> getListeners();
 
+// metrics published by each worker from its event loop (see WorkerLoopLoadMeter) and used to select a worker for a new connection.
+// A worker publishes once in workerLoadPublishPeriodUs, but only when its loop goes through a wait; metrics older than
+// workerLoadStaleAfterUs are therefore adjusted by the reader: a worker waiting all this time is idle, and one not waiting
+// is stuck in a single long iteration (see WorkerLoad::metricsAt())
+constexpr uint64_t workerLoadPublishPeriodUs = 10000;
+constexpr uint64_t workerLoadStaleAfterUs = 3 * workerLoadPublishPeriodUs;
+struct WorkerLoadMetrics
+{
+	size_t connections = 0;
+	uint32_t loopLagUs = 0; // longest non-waiting part of a loop iteration within the last publishing period
+	uint32_t busyPermille = 0; // share of time not spent waiting for events within the last publishing period
+	uint32_t queueDepth = 0; // inter-thread messages pending at the moment of publishing
+};
+using WorkerCostFn = uint64_t (*)( const WorkerLoadMetrics& metrics ); // lesser is better
+enum class WorkerSelectionPolicy { leastConnections, powerOfTwoChoices };
+void setWorkerSelectionPolicy( WorkerSelectionPolicy policy, WorkerCostFn costFn ); // costFn is used by powerOfTwoChoices; nullptr means default
+
 size_t addWorkerEntryForLoadTracking( ThreadID id );
 void incrementWorkerLoadCtr( size_t idx );
 void decrementWorkerLoadCtr( size_t idx );
+void publishWorkerLoadMetrics( size_t idx, uint32_t loopLagUs, uint32_t busyPermille, uint32_t queueDepth, uint64_t now );
+void setWorkerWaiting( size_t idx, bool waiting );
 ThreadID getLeastLoadedWorkerAndIncrementLoad();
+void getLeastLoadedWorkersAndIncrementLoad( ThreadID* ids, size_t count );
+ThreadID getStickyWorkerAndIncrementLoad( uint64_t clientKey ); // the same client goes to the same worker unless it is overloaded
 void createListenerThread();
+ThreadID getThisThreadID();
+size_t getWorkerThreadIDs( ThreadID* ids, size_t maxCount ); // returns the number of workers (may be more than maxCount)
 
 #endif // NODECPP_ENABLE_CLUSTERING
 #endif // INTERTHREAD_COMM_H
\ No newline at end of file
@@ -33,154 +33,163 @@
 
 #include <thread>
 #include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <deque>
 #include "interthread_comm.h"
 
 
-template<class T, size_t maxsz_bits>
-class CircularBuffer {
-	static constexpr size_t bufsz = 1 << maxsz_bits;
-	static constexpr size_t maxsz = bufsz - 1;
-	//-1 to make sure that head==tail always means 'empty'
-	static constexpr size_t mask = maxsz;
-	size_t head = 0;
-	size_t tail = 0;
-	alignas(T) uint8_t buffer[bufsz * sizeof(T)];
-	//Having buffer as T[bufsz] is possible 
-	//  IF we'll replace placement move constructors with move assignments
-	//  AND drop explicit destructor calls
-	//However, it will require T to have a default constructor,
-	//  so at the moment I prefer to deal with pure buffers
-	//  and to have the only requirement that T is move-constructible
+enum class QueueOverflowPolicy { spill, reject, spin };
+
+// Bounded lock-free multi-producer/single-consumer queue (sequence-stamped ring).
+// Producers never wait for the consumer: when the ring is full, push_back() acts according to OverflowPolicy:
+//   spill  - message goes to a mutex-protected overflow list, which is drained by the consumer once the ring is empty
+//   reject - push_back() returns false
+//   spin   - retries up to spinLimit times yielding in between, then returns false
+// Per-producer FIFO order is preserved in all cases (while anything is spilled, all producers keep spilling).
+// The consumer never blocks either: a slot that is claimed by a producer but not yet published ends the current drain;
+// the producer wakes the consumer up again after publishing (see sendInterThreadMsg()).
+template <class T, size_t capacity, QueueOverflowPolicy policy = QueueOverflowPolicy::spill, size_t spinLimit = 1024>
+class MPSCBoundedQueue {
+	static_assert( capacity >= 2 && ( capacity & ( capacity - 1 ) ) == 0, "capacity must be a power of 2" );
+	static constexpr size_t mask = capacity - 1;
+	static constexpr size_t cacheLineSize = 64;
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		alignas(T) uint8_t storage[sizeof(T)];
+		T* item() { return reinterpret_cast<T*>(storage); }
+	};
+
+	alignas(cacheLineSize) std::atomic<size_t> enqueuePos{0}; // shared by producers
+	alignas(cacheLineSize) size_t dequeuePos = 0; // owned by the consumer
+	alignas(cacheLineSize) Cell cells[capacity];
+
+	alignas(cacheLineSize) std::mutex spillMx;
+	std::deque<T> spill; // spillMx-protected
+	std::atomic<size_t> spillSize{0};
 
-public:
-	using value_type = T;
-public:
-	size_t size() {
-		return head - tail +
-			(((size_t)(head >= tail) - (size_t)1) & bufsz);
-		//trickery to avoid pipeline stalls via arithmetic
-		//supposedly equivalent to:
-		//if(head >= tail)
-		//  return head - tail;
-		//else
-		//  return head + bufsz - tail;
-	}
-
-	bool is_full() { return size() == maxsz; }
+	//stats:
+	std::atomic<size_t> nspills{0};
+	std::atomic<size_t> nrejects{0};
 
-	void push_back(T&& t) {
-		assert(size() < maxsz);
-		new(tbuffer(head)) T(std::move(t));
-		head = (head + 1) & mask;
+	bool tryPushToRing( T& it ) {
+		size_t pos = enqueuePos.load( std::memory_order_relaxed );
+		for (;;)
+		{
+			Cell& cell = cells[pos & mask];
+			size_t seq = cell.sequence.load( std::memory_order_acquire );
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if ( dif == 0 )
+			{
+				if ( enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+				{
+					new(cell.item()) T(std::move(it));
+					cell.sequence.store( pos + 1, std::memory_order_release );
+					return true;
+				}
+			}
+			else if ( dif < 0 )
+				return false; // full
+			else
+				pos = enqueuePos.load( std::memory_order_relaxed );
+		}
 	}
 
-	T pop_front() {
-		assert(size() > 0);
-		T* ttail = tbuffer(tail);
-		T ret = std::move(*ttail);
-		ttail->~T();
-		tail = (tail + 1) & mask;
-		return ret;
+	bool tryPopFromRing( T& out ) {
+		Cell& cell = cells[dequeuePos & mask];
+		if ( cell.sequence.load( std::memory_order_acquire ) != dequeuePos + 1 )
+			return false; // empty, or the slot is claimed but not yet published
+		out = std::move(*(cell.item()));
+		cell.item()->~T();
+		cell.sequence.store( dequeuePos + capacity, std::memory_order_release );
+		++dequeuePos;
+		return true;
 	}
 
-private:
-	T* tbuffer(size_t idx) {
-		return reinterpret_cast<T*>(buffer + (idx * sizeof(T)));
+	bool tryPopFromSpill( T& out ) {
+		// spilled messages of any producer come after all of its messages in the ring, so the ring must be fully drained first
+		if ( spillSize.load( std::memory_order_acquire ) == 0 || enqueuePos.load( std::memory_order_acquire ) != dequeuePos )
+			return false;
+		std::unique_lock<std::mutex> lock(spillMx);
+		if ( spill.empty() )
+			return false;
+		out = std::move(spill.front());
+		spill.pop_front();
+		spillSize.fetch_sub( 1, std::memory_order_release );
+		return true;
 	}
-};
-
-template <class FixedSizeCollection>
-class MWSRFixedSizeQueueWithFlowControl {
-private:
-	std::mutex mx;
-	std::condition_variable waitrd;
-	std::condition_variable waitwr;
-	FixedSizeCollection coll;
-	bool killflag = false;
-
-	//stats:
-	int nfulls = 0;
-	size_t hwmsize = 0;//high watermark on queue size
 
 public:
-	using T = typename FixedSizeCollection::value_type;
-
-	MWSRFixedSizeQueueWithFlowControl() {}
-	MWSRFixedSizeQueueWithFlowControl( const MWSRFixedSizeQueueWithFlowControl& ) = delete;
-	MWSRFixedSizeQueueWithFlowControl& operator = ( const MWSRFixedSizeQueueWithFlowControl& ) = delete;
-	MWSRFixedSizeQueueWithFlowControl( MWSRFixedSizeQueueWithFlowControl&& ) = delete;
-	MWSRFixedSizeQueueWithFlowControl& operator = ( MWSRFixedSizeQueueWithFlowControl&& ) = delete;
-	void push_back(T&& it) {
-		//if the queue is full, BLOCKS until some space is freed
-		{//creating scope for lock
-			std::unique_lock<std::mutex> lock(mx);
-			while (coll.is_full() && !killflag) {
-				waitwr.wait(lock);
-				++nfulls;
-				//this will also count spurious wakeups,
-				//  but they're supposedly rare
-			}
-
-			if (killflag)
-				return;
-			assert(!coll.is_full());
-			coll.push_back(std::move(it));
-			size_t sz = coll.size();
-			hwmsize = std::max(hwmsize, sz);
-		}//unlocking mx
+	using value_type = T;
 
-		waitrd.notify_one();
+	MPSCBoundedQueue() {
+		for ( size_t i=0; i<capacity; ++i )
+			cells[i].sequence.store( i, std::memory_order_relaxed );
+	}
+	MPSCBoundedQueue( const MPSCBoundedQueue& ) = delete;
+	MPSCBoundedQueue& operator = ( const MPSCBoundedQueue& ) = delete;
+	MPSCBoundedQueue( MPSCBoundedQueue&& ) = delete;
+	MPSCBoundedQueue& operator = ( MPSCBoundedQueue&& ) = delete;
+	~MPSCBoundedQueue() {
+		T dummy;
+		while ( tryPopFromRing( dummy ) )
+			;
 	}
 
-	std::pair<bool, T> pop_front() {
-		std::unique_lock<std::mutex> lock(mx);
-		while (coll.size() == 0 && !killflag) {
-			waitrd.wait(lock);
+	// never blocks on the consumer; returns false if the message has been rejected (and therefore not enqueued)
+	bool push_back(T&& it) {
+		if constexpr ( policy == QueueOverflowPolicy::spill )
+		{
+			if ( spillSize.load( std::memory_order_relaxed ) == 0 && tryPushToRing( it ) )
+				return true;
+			std::unique_lock<std::mutex> lock(spillMx);
+			spill.push_back( std::move(it) );
+			spillSize.fetch_add( 1, std::memory_order_release );
+			nspills.fetch_add( 1, std::memory_order_relaxed );
+			return true;
 		}
-		if (killflag)
-			return std::pair<bool, T>(false, T());
-
-		assert(coll.size() > 0);
-//		T ret = std::move(coll.front());
-//		coll.pop_front();
-		T ret = std::move(coll.pop_front());
-		lock.unlock();
-		waitwr.notify_one();
+		else
+		{
+			if ( tryPushToRing( it ) )
+				return true;
+			if constexpr ( policy == QueueOverflowPolicy::spin )
+			{
+				for ( size_t i=0; i<spinLimit; ++i )
+				{
+					std::this_thread::yield();
+					if ( tryPushToRing( it ) )
+						return true;
+				}
+			}
+			nrejects.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+	}
 
-		return std::pair<bool, T>(true, std::move(ret));
+	// consumer side; never blocks, returns false if nothing is available right now
+	bool try_pop_front( T& out ) {
+		return tryPopFromRing( out ) || tryPopFromSpill( out );
 	}
 
+	// consumer side; returns the number of messages actually popped (up to count)
 	size_t pop_front( T* messages, size_t count ) {
-		std::unique_lock<std::mutex> lock(mx);
-		while (coll.size() == 0 && !killflag) {
-			waitrd.wait(lock);
-		}
-		if (killflag)
-			return 0;
-
-		assert(coll.size() > 0);
-		size_t sz2move = count <= coll.size() ? count : coll.size();
-		for ( size_t i=0; i<sz2move; ++i )
-			messages[i] = std::move(coll.pop_front());
-		lock.unlock();
-		waitwr.notify_one();
-
-		return sz2move;
+		size_t i = 0;
+		while ( i < count && try_pop_front( messages[i] ) )
+			++i;
+		return i;
 	}
 
-	void kill() {
-		{//creating scope for lock
-			std::unique_lock<std::mutex> lock(mx);
-			killflag = true;
-		}//unlocking mx
-
-		waitrd.notify_all();
-		waitwr.notify_all();
+	// consumer side; messages currently in the ring and in the spill
+	size_t approxSize() const {
+		return enqueuePos.load( std::memory_order_relaxed ) - dequeuePos + spillSize.load( std::memory_order_relaxed );
 	}
+
+	size_t spilledCount() const { return nspills.load( std::memory_order_relaxed ); }
+	size_t rejectedCount() const { return nrejects.load( std::memory_order_relaxed ); }
 };
 
-using MsgQueue = MWSRFixedSizeQueueWithFlowControl<CircularBuffer<InterThreadMsg, 4>>; // TODO: revise the second param value
+using MsgQueue = MPSCBoundedQueue<InterThreadMsg, 64, QueueOverflowPolicy::spill>;
 
 class InterThreadCommData
 {
@@ -199,14 +208,53 @@ public:
 	InterThreadCommData& operator = ( InterThreadCommData&& ) = delete;
 
 	MsgQueue queue;
+	std::atomic<bool> wakeupPending{false}; // set by the first producer after the consumer's last wake-up; further producers don't write to the awaker
+
+	// producer side, after a successful push: returns true if the awaker is to be signalled
+	bool requestWakeup() { return !wakeupPending.exchange( true, std::memory_order_acq_rel ); }
+	// consumer side, after resetting the awaker and before draining the queue
+	void acknowledgeWakeup() { wakeupPending.exchange( false, std::memory_order_acq_rel ); }
+
+	// tasks posted from arbitrary threads form a lock-free stack; the consumer takes all of them at once
+	std::atomic<PostedTask*> postedTasks{nullptr};
+	void pushPostedTask( PostedTask* task ) {
+		PostedTask* head = postedTasks.load( std::memory_order_relaxed );
+		do {
+			task->next = head;
+		} while ( !postedTasks.compare_exchange_weak( head, task, std::memory_order_release, std::memory_order_relaxed ) );
+	}
+	// pushes only if the given incarnation is running; checked under the same lock as setTerminating() so that no task is pushed
+	// after the terminating thread has destroyed the remaining ones
+	std::pair<bool, uintptr_t> pushPostedTaskIfRunning( PostedTask* task, uint64_t reincarnation_ ) {
+		std::unique_lock<std::mutex> lock(mx);
+		if ( status == Status::terminating || status == Status::unused || reincarnation != reincarnation_ )
+			return std::make_pair( false, (uintptr_t)(-1) );
+		pushPostedTask( task );
+		return std::make_pair( true, writeHandle );
+	}
+	PostedTask* takePostedTasks() {
+		PostedTask* head = postedTasks.exchange( nullptr, std::memory_order_acquire );
+		PostedTask* reversed = nullptr; // into posting order
+		while ( head != nullptr )
+		{
+			PostedTask* next = head->next;
+			head->next = reversed;
+			reversed = head;
+			head = next;
+		}
+		return reversed;
+	}
 	std::pair<bool, std::pair<uint64_t, uintptr_t>> getWriteHandleAndReincarnation() {
 		std::unique_lock<std::mutex> lock(mx);
 		return std::make_pair(status != Status::terminating && status != Status::unused, std::make_pair(reincarnation, writeHandle));
 	}
-	void setTerminating() {
-		std::unique_lock<std::mutex> lock(mx);
-		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, status == Status::running, "indeed: {}", status ); 
-		status = Status::terminating;
+	void setTerminating() { // tasks posted but not yet taken are destroyed without being called
+		{
+			std::unique_lock<std::mutex> lock(mx);
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, status == Status::running, "indeed: {}", status ); 
+			status = Status::terminating;
+		}
+		destroyPostedTasks( postedTasks.exchange( nullptr, std::memory_order_acquire ) );
 	}
 	void setUnused( uintptr_t writeHandle_ ) {
 		std::unique_lock<std::mutex> lock(mx);
@@ -218,6 +266,7 @@ public:
 		{
 			++reincarnation;
 			writeHandle = writeHandle_;
+			wakeupPending.store( false, std::memory_order_relaxed ); // new awaker, nothing signalled yet
 			status = Status::acquired;
 			return std::make_pair( true, reincarnation );
 		}
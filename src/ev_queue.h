@@ -38,6 +38,7 @@
 class EvQueue
 {
 	nodecpp::vector<std::function<void()>> evQueue;
+	nodecpp::vector<std::function<void()>> beingEmitted; // kept as a member to reuse its capacity
 
 	static constexpr bool DBG_SYNC = false;//for easier debug only
 public:
@@ -65,11 +66,13 @@ public:
 	void emit() noexcept
 	{
 		//TODO: verify if exceptions may reach here from user code
-		for (auto& current : evQueue)
+		// NOTE: handlers may add new events; those are emitted by the next call
+		beingEmitted.swap( evQueue );
+		for (auto& current : beingEmitted)
 		{
 			emit(current);
 		}
-		evQueue.clear();
+		beingEmitted.clear();
 	}
 
 	static
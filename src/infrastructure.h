@@ -146,6 +146,53 @@ uint64_t infraGetCurrentTime();
 
 #include "clustering_impl/interthread_comm.h"
 
+#ifdef NODECPP_ENABLE_CLUSTERING
+// measures how busy this thread's event loop is and periodically publishes it for selecting workers for new connections (see WorkerLoad);
+// metrics are published both before and after waits, so that a long wait is accounted as soon as it ends, and the reader is let know
+// whether the loop is waiting, so that it can tell an idle worker from a stuck one while no fresh metrics come (see WorkerLoadMetrics)
+class WorkerLoopLoadMeter
+{
+	static constexpr uint64_t publishPeriod = workerLoadPublishPeriodUs; // mks
+	uint64_t windowStart = 0;
+	uint64_t waitStart = 0;
+	uint64_t lastWaitEnd = 0;
+	uint64_t waitInWindow = 0;
+	uint64_t maxBusyStretch = 0;
+
+	void maybePublish( uint64_t now )
+	{
+		uint64_t elapsed = now - windowStart;
+		if ( elapsed < publishPeriod )
+			return;
+		uint64_t busy = elapsed > waitInWindow ? elapsed - waitInWindow : 0;
+		publishThisWorkerLoadMetrics( maxBusyStretch < UINT32_MAX ? (uint32_t)maxBusyStretch : UINT32_MAX, (uint32_t)( busy * 1000 / elapsed ), now );
+		windowStart = now;
+		waitInWindow = 0;
+		maxBusyStretch = 0;
+	}
+
+public:
+	void onWaitStart( uint64_t now )
+	{
+		if ( lastWaitEnd == 0 )
+			windowStart = lastWaitEnd = now;
+		uint64_t busyStretch = now - lastWaitEnd; // an event that became ready right after the previous wait has been waiting for that long
+		if ( maxBusyStretch < busyStretch )
+			maxBusyStretch = busyStretch;
+		maybePublish( now );
+		waitStart = now;
+		setThisWorkerWaiting( true );
+	}
+	void onWaitEnd( uint64_t now )
+	{
+		setThisWorkerWaiting( false );
+		waitInWindow += now - waitStart;
+		lastWaitEnd = now;
+		maybePublish( now );
+	}
+};
+#endif // NODECPP_ENABLE_CLUSTERING
+
 class Infrastructure
 {
 	template<class Node> 
@@ -155,6 +202,37 @@ class Infrastructure
 	NetSockets ioSockets;
 	NetSocketManager netSocket;
 	NetServerManager netServer;
+#ifdef NODECPP_ENABLE_CLUSTERING
+	WorkerLoopLoadMeter loadMeter;
+	PostedTask* postedTasksHead = nullptr; // taken from this thread's posted tasks on awaker readiness; run in the immediate phase
+	PostedTask* postedTasksTail = nullptr;
+
+	void appendPostedTasks( PostedTask* tasks )
+	{
+		if ( tasks == nullptr )
+			return;
+		if ( postedTasksTail != nullptr )
+			postedTasksTail->next = tasks;
+		else
+			postedTasksHead = tasks;
+		while ( tasks->next != nullptr )
+			tasks = tasks->next;
+		postedTasksTail = tasks;
+	}
+
+	void runPostedTasks()
+	{
+		// if a task throws, the rest of the batch is destroyed without being called rather than leaked
+		struct Remainder { PostedTask* tasks; ~Remainder() { destroyPostedTasks( tasks ); } } rest{ postedTasksHead };
+		postedTasksHead = postedTasksTail = nullptr;
+		while ( rest.tasks != nullptr )
+		{
+			PostedTask* task = rest.tasks;
+			rest.tasks = task->next;
+			task->fn( task, true );
+		}
+	}
+#endif // NODECPP_ENABLE_CLUSTERING
 	TimeoutManager timeout;
 	EvQueue inmediateQueue;
 
@@ -209,6 +287,10 @@ extern thread_local size_t waitTime;
 size_t now1 = infraGetCurrentTime();
 		auto ret = ioSockets.wait( timeoutToUse );
 waitTime += infraGetCurrentTime() - now1;
+#elif defined NODECPP_ENABLE_CLUSTERING
+		loadMeter.onWaitStart( now );
+		auto ret = ioSockets.wait( timeoutToUse );
+		loadMeter.onWaitEnd( infraGetCurrentTime() );
 #else
 		auto ret = ioSockets.wait( timeoutToUse );
 #endif
@@ -273,17 +355,15 @@ if ( pollRetMax < retval )
 					if ((revents & POLLIN) != 0)
 					{
 						static constexpr size_t maxMsgCnt = 8;
-						uint8_t recvBuffer[maxMsgCnt];
-						size_t actaulFromSock = 0;
-						bool res = OSLayer::infraGetPacketBytes(recvBuffer, maxMsgCnt, actaulFromSock, ioSockets.getAwakerSockSocket());
+						bool res = acknowledgeThisThreadWakeup( ioSockets.getAwakerSockSocket() );
 						if (res)
 						{
-							NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actaulFromSock <= maxMsgCnt, "{} vs. {}", actaulFromSock, maxMsgCnt );
 							InterThreadMsg thq[maxMsgCnt];
-							size_t actualFromQueue = popFrontFromThisThreadQueue( thq, actaulFromSock );
-							NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actualFromQueue == actaulFromSock, "{} vs. {}", actualFromQueue, actaulFromSock );
-							for ( size_t i=0; i<actualFromQueue; ++i )
-								getCluster().onInterthreadMessage( thq[i] );
+							size_t actualFromQueue;
+							while ( ( actualFromQueue = popFrontFromThisThreadQueue( thq, maxMsgCnt ) ) != 0 ) // whole queue, regardless of how many times the awaker was signalled
+								for ( size_t i=0; i<actualFromQueue; ++i )
+									getCluster().onInterthreadMessage( thq[i] );
+							appendPostedTasks( takeThisThreadPostedTasks() );
 						}
 						else
 						{
@@ -297,17 +377,15 @@ if ( pollRetMax < retval )
 					if ((revents & POLLIN) != 0)
 					{
 						static constexpr size_t maxMsgCnt = 8;
-						uint8_t recvBuffer[maxMsgCnt];
-						size_t actaulFromSock = 0;
-						bool res = OSLayer::infraGetPacketBytes(recvBuffer, maxMsgCnt, actaulFromSock, ioSockets.getAwakerSockSocket());
+						bool res = acknowledgeThisThreadWakeup( ioSockets.getAwakerSockSocket() );
 						if (res)
 						{
-							NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actaulFromSock <= maxMsgCnt, "{} vs. {}", actaulFromSock, maxMsgCnt );
 							InterThreadMsg thq[maxMsgCnt];
-							size_t actualFromQueue = popFrontFromThisThreadQueue( thq, actaulFromSock );
-							NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actualFromQueue == actaulFromSock, "{} vs. {}", actualFromQueue, actaulFromSock );
-							for ( size_t i=0; i<actualFromQueue; ++i )
-								getCluster().slaveProcessor.onInterthreadMessage( thq[i] );
+							size_t actualFromQueue;
+							while ( ( actualFromQueue = popFrontFromThisThreadQueue( thq, maxMsgCnt ) ) != 0 ) // whole queue, regardless of how many times the awaker was signalled
+								for ( size_t i=0; i<actualFromQueue; ++i )
+									getCluster().slaveProcessor.onInterthreadMessage( thq[i] );
+							appendPostedTasks( takeThisThreadPostedTasks() );
 						}
 						else
 						{
@@ -412,6 +490,9 @@ now2 = infraGetCurrentTime();
 #endif
 			queue.emit();
 			emitInmediates();
+#ifdef NODECPP_ENABLE_CLUSTERING
+			runPostedTasks();
+#endif // NODECPP_ENABLE_CLUSTERING
 
 			netSocket. infraGetCloseEvent(/*queue*/);
 			netSocket. infraProcessSockAcceptedEvents();
@@ -554,7 +635,11 @@ class Runnable : public RunnableBase
 			nodecpp::postinitThreadClusterObject();
 			if ( isMaster )
 			{
+#ifdef NODECPP_ACCEPT_IN_WORKERS
+				size_t listenerCnt = 0; // workers accept on their own; listener threads are only created if requested explicitly
+#else
 				size_t listenerCnt = 1;
+#endif // NODECPP_ACCEPT_IN_WORKERS
 				auto argv = getArgv();
 				for ( size_t i=1; i<argv.size(); ++i )
 				{
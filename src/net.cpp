@@ -64,6 +64,19 @@ bool SocketBase::write2(Buffer& b)
 	_bytesWritten += b.size();
 	return netSocketManagerBase->appWrite2(dataForCommandProcessing, b);
 }
+bool SocketBase::write2v(const BufferView* segs, size_t cnt, bool borrow)
+{
+	for ( size_t i=0; i<cnt; ++i )
+		_bytesWritten += segs[i].size();
+	return netSocketManagerBase->appWrite2v(dataForCommandProcessing, segs, cnt, borrow);
+}
+bool SocketBase::sendFile(int fd, uint64_t& offset, size_t& count)
+{
+	size_t countBefore = count;
+	bool ret = netSocketManagerBase->appSendFile(dataForCommandProcessing, fd, offset, count);
+	_bytesWritten += countBefore - count;
+	return ret;
+}
 void SocketBase::registerMeAndAcquireSocket() {
 	nodecpp::safememory::soft_ptr<SocketBase> p = myThis.getSoftPtr<SocketBase>(this);
 	registerWithInfraAndAcquireSocket(p);
@@ -77,7 +90,8 @@ SocketBase& SocketBase::setNoDelay(bool noDelay) { OSLayer::appSetNoDelay(dataFo
 SocketBase& SocketBase::setKeepAlive(bool enable) { OSLayer::appSetKeepAlive(dataForCommandProcessing, enable); return *this; }
 
 void SocketBase::connect(uint16_t port, const char* ip) {
-	dataForCommandProcessing.userHandlers.from(SocketBase::DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying( std::type_index(typeid(*this))), this);
+	if ( dataForCommandProcessing.isHandlerDispatch() )
+		dataForCommandProcessing.userHandlers.from(SocketBase::DataForCommandProcessing::userHandlerClassPattern.getPatternForApplying( std::type_index(typeid(*this))), this);
 	connectSocket(this, ip, port);
 }
 
@@ -121,7 +135,7 @@ void ServerBase::closingProcedure()
 }
 
 void ServerBase::close() {
-#ifndef NODECPP_ENABLE_CLUSTERING
+#if !defined NODECPP_ENABLE_CLUSTERING || defined NODECPP_ACCEPT_IN_WORKERS
 	closingProcedure();
 #else
 	getCluster().acceptRequestForServerCloseAtSlave(dataForCommandProcessing.index);
@@ -30,6 +30,8 @@
 #include "listener_thread_impl.h"
 #include "../clustering_impl/clustering_impl.h"
 
+extern uint64_t infraGetCurrentTime();
+
 class Listeners
 {
 	ListenerThreadDescriptor listeners[MAX_THREADS];
@@ -75,19 +77,89 @@ std::pair<const ListenerThreadDescriptor*, size_t> getListeners() { return liste
 class WorkerLoad
 {
 private:
-	std::mutex mx;
-	size_t usedSlotCnt;
-	struct Worker
+	std::mutex mx; // protects adding workers and 'current'; load counters and metrics are atomics updated without it
+	std::atomic<size_t> usedSlotCnt{0};
+	struct alignas(64) Worker // each worker publishes to its own cache line
 	{
-		size_t load = 0;
+		std::atomic<size_t> load{0};
+		std::atomic<uint32_t> loopLagUs{0};
+		std::atomic<uint32_t> busyPermille{0};
+		std::atomic<uint32_t> queueDepth{0};
+		std::atomic<uint64_t> publishedAt{0}; // mks; 0 if nothing is published yet
+		std::atomic<bool> waiting{false}; // the worker's loop is waiting for events
 		ThreadID id;
 	};
 	static constexpr size_t workerMax = MAX_THREADS; // to awoid dyn allocation
 	Worker workers[MAX_THREADS];
-	size_t totalLoadCtr = 0;
+	std::atomic<size_t> totalLoadCtr{0};
 
 	size_t current = 0;
 
+	std::atomic<WorkerSelectionPolicy> policy{WorkerSelectionPolicy::leastConnections};
+	std::atomic<WorkerCostFn> costFn{defaultCost};
+
+	static uint64_t defaultCost( const WorkerLoadMetrics& m )
+	{
+		// busy fraction (in 5% steps) dominates; loop lag (in 256 mks steps) and then queue depth refine it; connection count is always
+		// up to date and thus breaks ties between metric refreshes; each term is clamped to its own bit field, so that a large value
+		// of a minor term never outweighs a major one
+		uint64_t busy = ( m.busyPermille < 1000 ? m.busyPermille : 1000 ) / 50;
+		uint64_t lag = m.loopLagUs / 256 < 0xFFFF ? m.loopLagUs / 256 : 0xFFFF;
+		uint64_t queue = m.queueDepth < 0xFFFF ? m.queueDepth : 0xFFFF;
+		uint64_t conns = m.connections < 0xFFFF ? m.connections : 0xFFFF;
+		return ( busy << 48 ) | ( lag << 32 ) | ( queue << 16 ) | conns;
+	}
+
+	static uint64_t nextRandom() // xorshift; quality is of little importance here
+	{
+		static thread_local uint64_t state = 0;
+		if ( state == 0 )
+			state = ( (uint64_t)(uintptr_t)(&state) * 0x9E3779B97F4A7C15ULL ) | 1;
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+	// bounded-load consistent hashing: a worker is not given more than (1 + epsilon) times the average number of connections
+	static constexpr size_t loadBoundPercent = 125;
+	static constexpr uint32_t overloadedBusyPermille = 950;
+	size_t boundedLoad( size_t usedSlotCnt ) const
+	{
+		size_t average = totalLoadCtr.load( std::memory_order_relaxed ) / usedSlotCnt + 1;
+		return average * loadBoundPercent / 100 + 1;
+	}
+	bool isOverloaded( size_t idx, size_t loadBound, uint64_t now ) const // busy share is taken with staleness accounted (see metricsAt())
+	{
+		return workers[idx].load.load( std::memory_order_relaxed ) >= loadBound || metricsAt( idx, now ).busyPermille >= overloadedBusyPermille;
+	}
+
+	WorkerLoadMetrics metricsAt( size_t idx, uint64_t now ) const
+	{
+		WorkerLoadMetrics m;
+		m.connections = workers[idx].load.load( std::memory_order_relaxed );
+		m.loopLagUs = workers[idx].loopLagUs.load( std::memory_order_relaxed );
+		m.busyPermille = workers[idx].busyPermille.load( std::memory_order_relaxed );
+		m.queueDepth = workers[idx].queueDepth.load( std::memory_order_relaxed );
+		uint64_t publishedAt = workers[idx].publishedAt.load( std::memory_order_relaxed );
+		if ( publishedAt != 0 && now > publishedAt && now - publishedAt > workerLoadStaleAfterUs ) // see WorkerLoadMetrics
+		{
+			if ( workers[idx].waiting.load( std::memory_order_relaxed ) )
+			{
+				m.loopLagUs = 0;
+				m.busyPermille = 0;
+				m.queueDepth = 0; // a message would have woken it up
+			}
+			else
+			{
+				uint64_t age = now - publishedAt;
+				m.loopLagUs = age < UINT32_MAX ? (uint32_t)age : UINT32_MAX;
+				m.busyPermille = 1000;
+			}
+		}
+		return m;
+	}
+
 	void _validate()
 	{
 		/*size_t sum = 0;
@@ -101,53 +173,89 @@ public:
 	{
 		size_t assignedIdx;
 		std::unique_lock<std::mutex> lock(mx);
-		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, usedSlotCnt < MAX_THREADS, "{} vs. {}", usedSlotCnt, MAX_THREADS );
-		workers[usedSlotCnt].id = id_;
-		assignedIdx = usedSlotCnt;
-		++usedSlotCnt;
+		size_t cnt = usedSlotCnt.load( std::memory_order_relaxed );
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, cnt < MAX_THREADS, "{} vs. {}", cnt, MAX_THREADS );
+		workers[cnt].id = id_;
+		assignedIdx = cnt;
+		usedSlotCnt.store( cnt + 1, std::memory_order_release ); // publishes workers[cnt].id to lock-free readers
 		lock.unlock();
 _validate();
 		return assignedIdx;
 	}
 
+	size_t getWorkerIDs( ThreadID* ids, size_t maxCount ) const
+	{
+		size_t usedSlotCnt = this->usedSlotCnt.load( std::memory_order_acquire );
+		for ( size_t i=0; i<usedSlotCnt && i<maxCount; ++i )
+			ids[i] = workers[i].id;
+		return usedSlotCnt;
+	}
+
+	void setPolicy( WorkerSelectionPolicy policy_, WorkerCostFn costFn_ )
+	{
+		costFn.store( costFn_ != nullptr ? costFn_ : defaultCost, std::memory_order_relaxed );
+		policy.store( policy_, std::memory_order_relaxed );
+	}
+
+	void incrementLoadCtr( size_t idx )
+	{
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx < usedSlotCnt.load( std::memory_order_relaxed ), "{} vs. {}", idx, usedSlotCnt.load( std::memory_order_relaxed ) ); 
+		workers[ idx ].load.fetch_add( 1, std::memory_order_relaxed );
+		totalLoadCtr.fetch_add( 1, std::memory_order_relaxed );
+_validate();
+	}
+
 	void decrementLoadCtr( size_t idx )
 	{
-		std::unique_lock<std::mutex> lock(mx);
-		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx < usedSlotCnt, "{} vs. {}", idx, usedSlotCnt ); 
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx < usedSlotCnt.load( std::memory_order_relaxed ), "{} vs. {}", idx, usedSlotCnt.load( std::memory_order_relaxed ) ); 
 _validate();
-		--( workers[ idx ].load );
-		--totalLoadCtr;
+		workers[ idx ].load.fetch_sub( 1, std::memory_order_relaxed );
+		totalLoadCtr.fetch_sub( 1, std::memory_order_relaxed );
 _validate();
 	}
 
-	ThreadID getCandidateAndIncrementLoad() // updates 'current'; current is always set to a valid value (if at all possible)
+	void publishMetrics( size_t idx, uint32_t loopLagUs, uint32_t busyPermille, uint32_t queueDepth, uint64_t now ) // called by the worker itself
+	{
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx < usedSlotCnt.load( std::memory_order_relaxed ), "{} vs. {}", idx, usedSlotCnt.load( std::memory_order_relaxed ) ); 
+		workers[ idx ].loopLagUs.store( loopLagUs, std::memory_order_relaxed );
+		workers[ idx ].busyPermille.store( busyPermille, std::memory_order_relaxed );
+		workers[ idx ].queueDepth.store( queueDepth, std::memory_order_relaxed );
+		workers[ idx ].publishedAt.store( now, std::memory_order_relaxed );
+	}
+
+	void setWaiting( size_t idx, bool waiting ) // called by the worker itself, around each wait of its loop
+	{
+		workers[ idx ].waiting.store( waiting, std::memory_order_relaxed );
+	}
+
+private:
+	ThreadID _getCandidateAndIncrementLoad() // mx must be locked; updates 'current'; current is always set to a valid value (if at all possible)
 	{
-		std::unique_lock<std::mutex> lock(mx);
 //		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, usedSlotCnt != 0 ); 
 _validate();
+		size_t usedSlotCnt = this->usedSlotCnt.load( std::memory_order_acquire );
 		if ( usedSlotCnt )
 		{
+			size_t totalLoadCtr = this->totalLoadCtr.load( std::memory_order_relaxed );
 			size_t comparisonBase = (totalLoadCtr << 32) + (totalLoadCtr << 28) / usedSlotCnt + 1;
 			size_t presentCurrent = current;
 			++current;
 			for ( ; current < usedSlotCnt; ++current )
-				if ( (workers[current].load << 32) < comparisonBase )
+				if ( (workers[current].load.load( std::memory_order_relaxed ) << 32) < comparisonBase )
 				{
-					++( workers[current].load );
-					++totalLoadCtr;
-_validate();
+					incrementLoadCtr( current );
 					return workers[current].id;
 				}
-			for ( current=0; current <= presentCurrent; ++current )
-				if ( (workers[current].load << 32) < comparisonBase )
+			for ( current=0; current <= presentCurrent && current < usedSlotCnt; ++current )
+				if ( (workers[current].load.load( std::memory_order_relaxed ) << 32) < comparisonBase )
 				{
-					++( workers[current].load );
-					++totalLoadCtr;
-_validate();
+					incrementLoadCtr( current );
 					return workers[current].id;
 				}
-			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false, "failed to find a candidate out of {} used slots", usedSlotCnt ); 
-			return ThreadID();
+			// counters are updated concurrently, so the scan may miss; fall back to the next one in turn
+			current = ( presentCurrent + 1 ) % usedSlotCnt;
+			incrementLoadCtr( current );
+			return workers[current].id;
 		}
 		else
 		{
@@ -155,12 +263,107 @@ _validate();
 			return ThreadID();
 		}
 	}
+
+	ThreadID _getCandidateOfTwoAndIncrementLoad() // lock-free
+	{
+		size_t usedSlotCnt = this->usedSlotCnt.load( std::memory_order_acquire );
+		if ( usedSlotCnt == 0 )
+		{
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false, "failed to find a candidate: no used slots" ); 
+			return ThreadID();
+		}
+		size_t idx = 0;
+		if ( usedSlotCnt > 1 )
+		{
+			uint64_t rnd = nextRandom();
+			size_t first = rnd % usedSlotCnt;
+			size_t second = ( first + 1 + ( rnd >> 32 ) % ( usedSlotCnt - 1 ) ) % usedSlotCnt; // distinct from the first one
+			WorkerCostFn cost = costFn.load( std::memory_order_relaxed );
+			uint64_t now = infraGetCurrentTime();
+			idx = cost( metricsAt( second, now ) ) < cost( metricsAt( first, now ) ) ? second : first;
+		}
+		incrementLoadCtr( idx );
+		return workers[idx].id;
+	}
+
+	static uint64_t rendezvousScore( uint64_t clientKey, size_t slotId ) // splitmix64 finalizer over the (client, worker) pair
+	{
+		uint64_t x = clientKey ^ ( (uint64_t)(slotId) * 0x9E3779B97F4A7C15ULL );
+		x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+		x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+		return x ^ ( x >> 31 );
+	}
+
+public:
+	// rendezvous (highest random weight) hashing: a client goes to the worker with the highest score for it, which only changes for clients
+	// of a worker being added or removed; workers above the load bound (see isOverloaded()) are skipped, that is, a client falls back to its
+	// next-ranked worker, which is again the same one while the overload lasts; lock-free
+	ThreadID getStickyCandidateAndIncrementLoad( uint64_t clientKey )
+	{
+		size_t usedSlotCnt = this->usedSlotCnt.load( std::memory_order_acquire );
+		if ( usedSlotCnt == 0 )
+		{
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, false, "failed to find a candidate: no used slots" ); 
+			return ThreadID();
+		}
+		size_t loadBound = boundedLoad( usedSlotCnt );
+		uint64_t now = infraGetCurrentTime();
+		size_t best = 0;
+		size_t bestAvailable = usedSlotCnt;
+		uint64_t bestScore = 0;
+		uint64_t bestAvailableScore = 0;
+		for ( size_t i=0; i<usedSlotCnt; ++i )
+		{
+			uint64_t score = rendezvousScore( clientKey, workers[i].id.slotId );
+			if ( i == 0 || score > bestScore )
+			{
+				best = i;
+				bestScore = score;
+			}
+			if ( ( bestAvailable == usedSlotCnt || score > bestAvailableScore ) && !isOverloaded( i, loadBound, now ) )
+			{
+				bestAvailable = i;
+				bestAvailableScore = score;
+			}
+		}
+		size_t idx = bestAvailable != usedSlotCnt ? bestAvailable : best; // if all are overloaded, there is no better place than the owner
+		incrementLoadCtr( idx );
+		return workers[idx].id;
+	}
+
+	ThreadID getCandidateAndIncrementLoad()
+	{
+		if ( policy.load( std::memory_order_relaxed ) == WorkerSelectionPolicy::powerOfTwoChoices )
+			return _getCandidateOfTwoAndIncrementLoad();
+		std::unique_lock<std::mutex> lock(mx);
+		return _getCandidateAndIncrementLoad();
+	}
+
+	void getCandidatesAndIncrementLoad( ThreadID* ids, size_t count ) // same as above for a batch of connections, under a single lock (if any)
+	{
+		if ( policy.load( std::memory_order_relaxed ) == WorkerSelectionPolicy::powerOfTwoChoices )
+		{
+			for ( size_t i=0; i<count; ++i )
+				ids[i] = _getCandidateOfTwoAndIncrementLoad();
+			return;
+		}
+		std::unique_lock<std::mutex> lock(mx);
+		for ( size_t i=0; i<count; ++i )
+			ids[i] = _getCandidateAndIncrementLoad();
+	}
 };
 static WorkerLoad workerLoad;
 
 size_t addWorkerEntryForLoadTracking( ThreadID id ) { return workerLoad.addWorker( id ); }
+void incrementWorkerLoadCtr( size_t idx ) { workerLoad.incrementLoadCtr( idx ); }
 void decrementWorkerLoadCtr( size_t idx ) { workerLoad.decrementLoadCtr( idx ); }
+void publishWorkerLoadMetrics( size_t idx, uint32_t loopLagUs, uint32_t busyPermille, uint32_t queueDepth, uint64_t now ) { workerLoad.publishMetrics( idx, loopLagUs, busyPermille, queueDepth, now ); }
+void setWorkerWaiting( size_t idx, bool waiting ) { workerLoad.setWaiting( idx, waiting ); }
+void setWorkerSelectionPolicy( WorkerSelectionPolicy policy, WorkerCostFn costFn ) { workerLoad.setPolicy( policy, costFn ); }
+ThreadID getStickyWorkerAndIncrementLoad( uint64_t clientKey ) { return workerLoad.getStickyCandidateAndIncrementLoad( clientKey ); }
+size_t getWorkerThreadIDs( ThreadID* ids, size_t maxCount ) { return workerLoad.getWorkerIDs( ids, maxCount ); }
 ThreadID getLeastLoadedWorkerAndIncrementLoad() { return workerLoad.getCandidateAndIncrementLoad(); }
+void getLeastLoadedWorkersAndIncrementLoad( ThreadID* ids, size_t count ) { workerLoad.getCandidatesAndIncrementLoad( ids, count ); }
 
 thread_local ListenerThreadWorker listenerThreadWorker;
 thread_local NetServerManagerForListenerThread netServerManagerBaseForListenerThread;
@@ -172,6 +375,7 @@ void listenerThreadMain( void* pdata )
 	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sd->threadCommID.slotId != 0 ); 
 	ThreadStartupData startupData = *sd;
 	nodecpp::stddealloc( sd, 1 );
+	applyThisThreadPlacement( startupData.cpu );
 	setThisThreadDescriptor( startupData );
 #ifdef NODECPP_USE_IIBMALLOC
 	g_AllocManager.initialize();
@@ -189,6 +393,7 @@ void createListenerThread()
 	ThreadStartupData* startupData = nodecpp::stdalloc<ThreadStartupData>(1);
 	preinitThreadStartupData( *startupData );
 	startupData->IdWithinGroup = listeners.add( startupData->threadCommID );
+	startupData->cpu = getCpuForNewListener();
 	size_t threadIdx = startupData->threadCommID.slotId;
 	nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"about to start Listener thread with threadID = {} and listenerID = {}...", threadIdx, startupData->IdWithinGroup );
 	std::thread t1( listenerThreadMain, (void*)(startupData) );
@@ -210,7 +415,7 @@ void ListenerThreadWorker::processInterthreadRequest( ThreadID requestingThreadI
 			switch ( msg->type )
 			{
 				case RequestToListenerThread::Type::AddServerSocket:
-					listenerThreadWorker.createAgentServerWithExistingSocket( msg->entryIndex, msg->socket, msg->ip, msg->port.getHost() );
+					listenerThreadWorker.createAgentServerWithExistingSocket( msg->entryIndex, msg->socket, msg->ip, msg->port.getHost(), msg->distribution );
 					break;
 				case RequestToListenerThread::Type::CreateSharedServerSocket:
 					// for some internal details see
@@ -219,7 +424,7 @@ void ListenerThreadWorker::processInterthreadRequest( ThreadID requestingThreadI
 					// https://stackoverflow.com/questions/14388706/how-do-so-reuseaddr-and-so-reuseport-differ
 					// https://docs.microsoft.com/en-us/windows/win32/winsock/using-so-reuseaddr-and-so-exclusiveaddruse?redirectedfrom=MSDN
 nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "processing CreateSharedServerSocket request (for thread id: {}), entryIndex = {:x}, ip = {} port: {}", requestingThreadId.slotId, msg->entryIndex, msg->ip.toStr(), msg->port.toStr() );
-					listenerThreadWorker.createAgentServerWithSharedSocket( msg->entryIndex, msg->ip, msg->port.getHost(), msg->backlog );
+					listenerThreadWorker.createAgentServerWithSharedSocket( msg->entryIndex, msg->ip, msg->port.getHost(), msg->backlog, msg->distribution );
 					break;
 			}
 			// TODO: ...
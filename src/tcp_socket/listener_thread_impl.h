@@ -57,6 +57,19 @@ private:
 		sendInterThreadMsg( std::move( imsg ), InterThreadMsgType::ConnAccepted, targetThreadId );
 	}
 
+	static void sendConnAcceptedBatchEv( ThreadID targetThreadId, size_t internalID, const AcceptedConnData* conns, size_t count )
+	{
+		ConnAcceptedBatchEvMsg msg;
+		msg.requestID = 0; // TODO:
+		msg.serverIdx = internalID;
+		msg.count = count;
+
+		nodecpp::platform::internal_msg::InternalMsg imsg;
+		imsg.append( &msg, sizeof(msg) );
+		imsg.append( conns, sizeof(AcceptedConnData) * count );
+		sendInterThreadMsg( std::move( imsg ), InterThreadMsgType::ConnAcceptedBatch, targetThreadId );
+	}
+
 	static void sendServerErrorEv( ThreadID targetThreadId, Error e )
 	{
 		ServerErrorEvMsg msg;
@@ -103,6 +116,14 @@ public:
 	class AgentServer
 	{
 		friend class ListenerThreadWorker;
+	public:
+#ifdef NODECPP_MAX_ACCEPT_BATCH
+		static constexpr size_t maxAcceptBatch = NODECPP_MAX_ACCEPT_BATCH; // 1 means no batching (as with test/samples/benchmarks/accept_burst)
+#else
+		static constexpr size_t maxAcceptBatch = 64; // keeps a batch message well under a page
+#endif // NODECPP_MAX_ACCEPT_BATCH
+		static_assert( maxAcceptBatch != 0, "at least one connection is accepted per readiness event" );
+	private:
 		size_t entryIndexAtSlave; // temporary solution TODO: further elaboration!!!
 		/*struct SlaveServerData
 		{
@@ -133,9 +154,23 @@ public:
 			DataForCommandProcessing& operator=(DataForCommandProcessing&& other) = default;
 
 			net::Address localAddress;
+			net::ConnectionDistribution distribution = net::ConnectionDistribution::byLoad;
 		};
 		DataForCommandProcessing dataForCommandProcessing;
 
+		uint64_t clientKey( Ip4 remoteIp, Port remotePort ) const {
+			uint64_t key = remoteIp.getNetwork();
+			if ( dataForCommandProcessing.distribution == net::ConnectionDistribution::byClientAddressAndPort )
+				key |= ( (uint64_t)(remotePort.getNetwork()) << 32 );
+			return key;
+		}
+
+		ThreadID selectWorkerAndIncrementLoad( Ip4 remoteIp, Port remotePort ) {
+			if ( dataForCommandProcessing.distribution == net::ConnectionDistribution::byLoad )
+				return getLeastLoadedWorkerAndIncrementLoad();
+			return getStickyWorkerAndIncrementLoad( clientKey( remoteIp, remotePort ) );
+		}
+
 	public:
 		void onListening() { 
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"clustering Agent server: onListening()!");
@@ -148,11 +183,46 @@ public:
 			nextStep = nextStep % socketsToSlaves.size();
 			sendConnAcceptedEv( socketsToSlaves[nextStep].targetThreadId, socketsToSlaves[nextStep].entryIndex, socket, remoteIp, remotePort ); // TODO-ITC: upgrade
 			++nextStep;*/
-			ThreadID id = getLeastLoadedWorkerAndIncrementLoad();
+			ThreadID id = selectWorkerAndIncrementLoad( remoteIp, remotePort );
 			//nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"listener thread: accepted connection is being sent to thread id {}", id.slotId);
 			sendConnAcceptedEv( id, entryIndexAtSlave, socket, remoteIp, remotePort );
 			// TODO: assert is good
 		}
+		void onConnections(AcceptedConnData* conns, size_t count) { 
+			// workers are selected for the whole batch under a single lock; then connections going to the same worker are sent in a single message
+			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, count != 0 && count <= maxAcceptBatch, "{} vs. {}", count, maxAcceptBatch ); 
+			if ( count == 1 )
+			{
+				Ip4 remoteIp = conns[0].ip;
+				Port remotePort = conns[0].uport;
+				onConnection( conns[0].socket, remoteIp, remotePort );
+				return;
+			}
+			ThreadID ids[maxAcceptBatch];
+			if ( dataForCommandProcessing.distribution == net::ConnectionDistribution::byLoad )
+				getLeastLoadedWorkersAndIncrementLoad( ids, count );
+			else
+				for ( size_t i=0; i<count; ++i )
+					ids[i] = getStickyWorkerAndIncrementLoad( clientKey( conns[i].ip, conns[i].uport ) );
+			AcceptedConnData group[maxAcceptBatch];
+			bool sent[maxAcceptBatch] = {};
+			for ( size_t i=0; i<count; ++i )
+			{
+				if ( sent[i] )
+					continue;
+				size_t groupSz = 0;
+				for ( size_t j=i; j<count; ++j )
+					if ( !sent[j] && ids[j].slotId == ids[i].slotId )
+					{
+						group[groupSz++] = conns[j];
+						sent[j] = true;
+					}
+				if ( groupSz == 1 )
+					sendConnAcceptedEv( ids[i], entryIndexAtSlave, group[0].socket, group[0].ip, group[0].uport );
+				else
+					sendConnAcceptedBatchEv( ids[i], entryIndexAtSlave, group, groupSz );
+			}
+		}
 		void onError( nodecpp::Error& e ) { 
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"clustering Agent server: onError()!");
 			/*for ( auto& slaveData : socketsToSlaves )
@@ -191,12 +261,13 @@ public:
 private:
 	nodecpp::vector<nodecpp::safememory::owning_ptr<AgentServer>> agentServers;
 
-	nodecpp::safememory::soft_ptr<AgentServer> createAgentServerWithSharedSocket(size_t entryIndex, nodecpp::Ip4 ip, uint16_t port, int backlog) {
+	nodecpp::safememory::soft_ptr<AgentServer> createAgentServerWithSharedSocket(size_t entryIndex, nodecpp::Ip4 ip, uint16_t port, int backlog, net::ConnectionDistribution distribution) {
 		nodecpp::safememory::owning_ptr<AgentServer> newServer = nodecpp::safememory::make_owning<AgentServer>();
 		nodecpp::safememory::soft_ptr<AgentServer> ret = newServer;
 		newServer->entryIndexAtSlave = entryIndex;
 		newServer->dataForCommandProcessing.localAddress.ip = ip;
 		newServer->dataForCommandProcessing.localAddress.port = port;
+		newServer->dataForCommandProcessing.distribution = distribution;
 		newServer->acquireSharedServerSocketAndStartListening(backlog);
 		for ( size_t i=0; i<agentServers.size(); ++i )
 			if ( agentServers[i] == nullptr )
@@ -208,12 +279,13 @@ private:
 		return ret;
 	}
 
-	nodecpp::safememory::soft_ptr<AgentServer> createAgentServerWithExistingSocket( size_t entryIndex, SOCKET sock, nodecpp::Ip4 ip, uint16_t port ) {
+	nodecpp::safememory::soft_ptr<AgentServer> createAgentServerWithExistingSocket( size_t entryIndex, SOCKET sock, nodecpp::Ip4 ip, uint16_t port, net::ConnectionDistribution distribution ) {
 		nodecpp::safememory::owning_ptr<AgentServer> newServer = nodecpp::safememory::make_owning<AgentServer>();
 		nodecpp::safememory::soft_ptr<AgentServer> ret = newServer;
 		newServer->entryIndexAtSlave = entryIndex;
 		newServer->dataForCommandProcessing.localAddress.ip = ip;
 		newServer->dataForCommandProcessing.localAddress.port = port;
+		newServer->dataForCommandProcessing.distribution = distribution;
 		newServer->addServerSocketAndStartListening(sock);
 		for ( size_t i=0; i<agentServers.size(); ++i )
 			if ( agentServers[i] == nullptr )
@@ -537,13 +609,23 @@ private:
 		else if ((revents & POLLIN) != 0)
 		{
 //!!//			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"POLLIN event at {}", current.getServerSocketData()->osSocket);
-			OpaqueSocketData osd( false );
-			Ip4 remoteIp;
-			Port remotePort;
-			if ( !getAcceptedSockData(current.getAgentServerData()->osSocket, osd, remoteIp, remotePort) )
-				return;
-			SOCKET osSocket = osd.s.release();
-			current.getAgentServer()->onConnection( osSocket, remoteIp, remotePort );
+			// drain the accept queue (up to a bound) so that a burst of connections is handed off in a few messages
+			AcceptedConnData conns[ListenerThreadWorker::AgentServer::maxAcceptBatch];
+			size_t count = 0;
+			while ( count < ListenerThreadWorker::AgentServer::maxAcceptBatch )
+			{
+				OpaqueSocketData osd( false );
+				Ip4 remoteIp;
+				Port remotePort;
+				if ( !getAcceptedSockData(current.getAgentServerData()->osSocket, osd, remoteIp, remotePort) )
+					break;
+				conns[count].socket = osd.s.release();
+				conns[count].ip = remoteIp;
+				conns[count].uport = remotePort;
+				++count;
+			}
+			if ( count )
+				current.getAgentServer()->onConnections( conns, count );
 		}
 		else if (revents != 0)
 		{
@@ -625,17 +707,14 @@ waitTime += infraGetCurrentTime() - now1;
 						if ((revents & POLLIN) != 0)
 						{
 							static constexpr size_t maxMsgCnt = 8;
-							uint8_t recvBuffer[maxMsgCnt];
-							size_t actaulFromSock = 0;
-							bool res = OSLayer::infraGetPacketBytes(recvBuffer, maxMsgCnt, actaulFromSock, ioSockets.getAwakerSockSocket());
+							bool res = acknowledgeThisThreadWakeup( ioSockets.getAwakerSockSocket() );
 							if (res)
 							{
-								NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actaulFromSock <= maxMsgCnt, "{} vs. {}", actaulFromSock, maxMsgCnt );
 								InterThreadMsg thq[maxMsgCnt];
-								size_t actualFromQueue = popFrontFromThisThreadQueue( thq, actaulFromSock );
-								NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, actualFromQueue == actaulFromSock, "{} vs. {}", actualFromQueue, actaulFromSock );
-								for ( size_t i=0; i<actualFromQueue; ++i )
-									listenerThreadWorker.onInterthreadMessage( thq[i] );
+								size_t actualFromQueue;
+								while ( ( actualFromQueue = popFrontFromThisThreadQueue( thq, maxMsgCnt ) ) != 0 ) // whole queue, regardless of how many times the awaker was signalled
+									for ( size_t i=0; i<actualFromQueue; ++i )
+										listenerThreadWorker.onInterthreadMessage( thq[i] );
 							}
 							else
 							{
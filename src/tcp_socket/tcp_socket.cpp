@@ -42,6 +42,7 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <stdio.h>
+#include <io.h> // for _read() in internal_send_file()
 
 #pragma comment(lib, "Ws2_32.lib")
 
@@ -63,6 +64,13 @@ typedef int ssize_t;
 #include <sys/time.h>
 #include <sys/types.h>
 #include <netinet/tcp.h>
+#include <sys/uio.h> // for iovec
+#include <fcntl.h> // for pipe-based awaker
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/eventfd.h>
+#include <sched.h> // for sched_getcpu()
+#endif
 
 #define CLOSE_SOCKET( x ) close( x )
 
@@ -393,7 +401,11 @@ namespace nodecpp
 			socklen_t sz = sizeof(struct ::sockaddr_in);
 			memset(&sa, 0, sz);
 
+#ifdef __linux__
+			SOCKET outSock = accept4(sock, (struct sockaddr *)&sa, &sz, SOCK_NONBLOCK | SOCK_CLOEXEC); // saves a separate FIONBIO ioctl per accepted socket
+#else
 			SOCKET outSock = accept(sock, (struct sockaddr *)&sa, &sz);
+#endif
 			if (INVALID_SOCKET == outSock)
 			{
 				int error = getSockError();
@@ -407,11 +419,13 @@ namespace nodecpp
 			port = Port::fromNetwork(sa.sin_port);
 //!!//			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"accept() new sock {} from {}:{}", outSock, ip.toStr(), port.toStr());
 
+#ifndef __linux__
 			if (!internal_async_socket(outSock))
 			{
 				internal_close(outSock);
 				return INVALID_SOCKET;
 			}
+#endif
 			return outSock;
 		}
 
@@ -482,6 +496,131 @@ writeTime += infraGetCurrentTime() - now1;
 			}
 		}
 
+		// the first offset bytes of segs (sent before) are skipped; sentSize does not include them
+		uint8_t internal_send_packet_v(const BufferView* segs, size_t cnt, size_t offset, SOCKET sock, size_t& sentSize)
+		{
+			constexpr size_t maxSegmentsPerCall = 64; // well below IOV_MAX on supported platforms
+			sentSize = 0;
+			while ( cnt && offset >= segs->size() )
+			{
+				offset -= segs->size();
+				++segs;
+				--cnt;
+			}
+			while ( cnt )
+			{
+				size_t batch = cnt < maxSegmentsPerCall ? cnt : maxSegmentsPerCall;
+				size_t batchSize = 0;
+#ifdef _MSC_VER
+				WSABUF bufs[maxSegmentsPerCall];
+				for ( size_t i=0; i<batch; ++i )
+				{
+					size_t skip = i == 0 ? offset : 0;
+					bufs[i].buf = const_cast<CHAR*>(reinterpret_cast<const CHAR*>(segs[i].begin() + skip));
+					bufs[i].len = (ULONG)(segs[i].size() - skip);
+					batchSize += segs[i].size() - skip;
+				}
+				DWORD sent = 0;
+#ifdef USE_TEMP_PERF_CTRS
+size_t now1 = infraGetCurrentTime();
+				int res = WSASend(sock, bufs, (DWORD)batch, &sent, 0, nullptr, nullptr);
+writeTime += infraGetCurrentTime() - now1;
+#else
+				int res = WSASend(sock, bufs, (DWORD)batch, &sent, 0, nullptr, nullptr);
+#endif // USE_TEMP_PERF_CTRS
+				ssize_t bytes_sent = res == 0 ? (ssize_t)sent : -1;
+#else
+				struct iovec iov[maxSegmentsPerCall];
+				for ( size_t i=0; i<batch; ++i )
+				{
+					size_t skip = i == 0 ? offset : 0;
+					iov[i].iov_base = const_cast<uint8_t*>(segs[i].begin() + skip);
+					iov[i].iov_len = segs[i].size() - skip;
+					batchSize += segs[i].size() - skip;
+				}
+				struct msghdr msg;
+				memset( &msg, 0, sizeof(msg) );
+				msg.msg_iov = iov;
+				msg.msg_iovlen = batch;
+#ifdef USE_TEMP_PERF_CTRS
+size_t now1 = infraGetCurrentTime();
+				ssize_t bytes_sent = sendmsg(sock, &msg, 0);
+writeTime += infraGetCurrentTime() - now1;
+#else
+				ssize_t bytes_sent = sendmsg(sock, &msg, 0);
+#endif // USE_TEMP_PERF_CTRS
+#endif // _MSC_VER
+
+				if (bytes_sent < 0)
+				{
+					int error = getSockError();
+					if (isErrorWouldBlock(error))
+						return COMMLAYER_RET_PENDING;
+					else
+					{
+//!!//						nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"internal_send_packet_v() on sock {} ERROR {}", sock, error);
+						return COMMLAYER_RET_FAILED;
+					}
+				}
+
+				sentSize += static_cast<size_t>(bytes_sent);
+				if ( static_cast<size_t>(bytes_sent) != batchSize )
+					return COMMLAYER_RET_PENDING;
+				segs += batch;
+				cnt -= batch;
+				offset = 0;
+			}
+			return COMMLAYER_RET_OK;
+		}
+
+		// sends up to count bytes of file fd starting at offset (both are advanced by what has been sent)
+		uint8_t internal_send_file(int fd, uint64_t& offset, size_t& count, SOCKET sock, size_t& sentSize)
+		{
+			sentSize = 0;
+			while ( count )
+			{
+#ifdef __linux__
+				off_t off = (off_t)offset;
+				ssize_t bytes_sent = sendfile(sock, fd, &off, count);
+				if ( bytes_sent == 0 ) // file got shorter than expected
+					return COMMLAYER_RET_FAILED;
+				size_t attempted = count;
+#else
+				// no zero-copy path here: through a buffer
+				uint8_t buff[0x10000];
+				size_t attempted = count < sizeof(buff) ? count : sizeof(buff);
+#ifdef _MSC_VER
+				if ( _lseeki64( fd, (__int64)offset, SEEK_SET ) < 0 )
+					return COMMLAYER_RET_FAILED;
+				int bytes_read = _read( fd, buff, (unsigned int)attempted );
+#else
+				ssize_t bytes_read = pread( fd, buff, attempted, (off_t)offset );
+#endif
+				if ( bytes_read <= 0 )
+					return COMMLAYER_RET_FAILED;
+				attempted = (size_t)bytes_read;
+				ssize_t bytes_sent = send(sock, reinterpret_cast<const char*>(buff), (int)attempted, 0);
+#endif // __linux__
+				if (bytes_sent < 0)
+				{
+					int error = getSockError();
+					if (isErrorWouldBlock(error))
+						return COMMLAYER_RET_PENDING;
+					else
+					{
+//!!//						nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"internal_send_file() on sock {} ERROR {}", sock, error);
+						return COMMLAYER_RET_FAILED;
+					}
+				}
+				sentSize += static_cast<size_t>(bytes_sent);
+				offset += static_cast<size_t>(bytes_sent);
+				count -= static_cast<size_t>(bytes_sent);
+				if ( static_cast<size_t>(bytes_sent) != attempted )
+					return COMMLAYER_RET_PENDING;
+			}
+			return COMMLAYER_RET_OK;
+		}
+
 		class internal_send_packet_object
 		{
 			SOCKET sock;
@@ -539,6 +678,91 @@ writeTime += infraGetCurrentTime() - now1;
 			uint8_t get_ret_value() const { return ret; }
 		};
 
+		// Binds a listening SO_REUSEPORT socket to the CPU the calling thread currently runs on (SO_INCOMING_CPU),
+		// so that the kernel prefers it for connections whose packets are processed at that CPU (Linux only)
+		bool internal_set_incoming_cpu(SOCKET sock)
+		{
+#if defined __linux__ && defined SO_INCOMING_CPU
+			int cpu = sched_getcpu();
+			if (cpu < 0 || 0 != setsockopt(sock, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)))
+			{
+				int error = getSockError();
+				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"setting SO_INCOMING_CPU on sock {} failed; error {}", sock, error);
+				return false;
+			}
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// Awaker: a pollable handle used by other threads to wake up this thread's loop.
+		// eventfd on Linux (readHandle == writeHandle), nonblocking pipe on other POSIX systems.
+		// Returns false if the platform has none (WSAPoll() does not accept pipes); callers fall back to a loopback TCP connection then.
+		bool internal_make_awaker(SOCKET& readHandle, SOCKET& writeHandle)
+		{
+#if defined _MSC_VER || defined __MINGW32__
+			return false;
+#elif defined __linux__
+			int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (fd < 0)
+			{
+				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"eventfd() failed with error {}", errno);
+				return false;
+			}
+			readHandle = fd;
+			writeHandle = fd;
+			return true;
+#else
+			int fds[2];
+			if (pipe(fds) != 0)
+			{
+				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"pipe() failed with error {}", errno);
+				return false;
+			}
+			for (int i = 0; i < 2; ++i)
+			{
+				fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL, 0) | O_NONBLOCK);
+				fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+			}
+			readHandle = fds[0];
+			writeHandle = fds[1];
+			return true;
+#endif
+		}
+
+		bool internal_signal_awaker(SOCKET writeHandle)
+		{
+#if defined __linux__
+			uint64_t one = 1;
+			ssize_t ret = ::write(writeHandle, &one, sizeof(one));
+#elif defined _MSC_VER || defined __MINGW32__
+			char one = 1;
+			ssize_t ret = send(writeHandle, &one, 1, 0);
+#else
+			uint8_t one = 1;
+			ssize_t ret = ::write(writeHandle, &one, 1);
+#endif
+			// a full pipe (or an overflowing eventfd counter) means the reader is going to be woken up anyway
+			return ret > 0 || isErrorWouldBlock(getSockError());
+		}
+
+		bool internal_reset_awaker(SOCKET readHandle)
+		{
+			for (;;)
+			{
+				uint8_t buff[64];
+#if defined _MSC_VER || defined __MINGW32__
+				ssize_t ret = recv(readHandle, (char*)buff, sizeof(buff), 0);
+#else
+				ssize_t ret = ::read(readHandle, buff, sizeof(buff)); // eventfd: reads (and zeroes) the counter at once
+#endif
+				if (ret > 0)
+					continue;
+				return ret < 0 && isErrorWouldBlock(getSockError());
+			}
+		}
+
 	} // internal_usage_only
 } // nodecpp
 
@@ -638,6 +862,44 @@ void OSLayer::appDestroy(net::SocketBase::DataForCommandProcessing& sockData)
 	closeSocket(sockData);
 }
 
+// what is left of a_writev() in progress is copied to writeBuffer (the rest of it follows what is there), so that whatever is written next goes after it
+static void copyBorrowedSegments(net::SocketBase::DataForCommandProcessing& sockData)
+{
+	auto& w = sockData.ahd_write;
+	if ( w.segs == nullptr )
+		return;
+	size_t offset = w.offset;
+	for ( size_t i=0; i<w.cnt; ++i )
+	{
+		if ( offset >= w.segs[i].size() )
+		{
+			offset -= w.segs[i].size();
+			continue;
+		}
+		sockData.writeBuffer.append(w.segs[i].begin() + offset, w.segs[i].size() - offset);
+		offset = 0;
+	}
+	w.segs = nullptr;
+	w.cnt = 0;
+	w.offset = 0;
+}
+
+// continues a_writev() that has not been sent at once; returns COMMLAYER_RET_OK once all is sent
+static uint8_t sendBorrowedSegments(net::SocketBase::DataForCommandProcessing& sockData)
+{
+	auto& w = sockData.ahd_write;
+	size_t sentSize = 0;
+	uint8_t res = internal_usage_only::internal_send_packet_v(w.segs, w.cnt, w.offset, sockData.osSocket, sentSize);
+	w.offset += sentSize;
+	if ( res != COMMLAYER_RET_PENDING )
+	{
+		w.segs = nullptr;
+		w.cnt = 0;
+		w.offset = 0;
+	}
+	return res;
+}
+
 void OSLayer::appEnd(net::SocketBase::DataForCommandProcessing& sockData)
 {
 	if (!sockData.isValid())
@@ -648,6 +910,7 @@ void OSLayer::appEnd(net::SocketBase::DataForCommandProcessing& sockData)
 
 //	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical,entry.state == net::SocketBase::DataForCommandProcessing::Connected);
 	
+	copyBorrowedSegments(sockData); // a_writev() in progress is completed before the end
 	if (sockData.writeBuffer.empty())
 	{
 //		entry.localEnded = true;
@@ -719,6 +982,7 @@ bool NetSocketManagerBase::appWrite(net::SocketBase::DataForCommandProcessing& s
 		return false;
 	}
 
+	copyBorrowedSegments(sockData); // if any, they go first
 	if (sockData.writeBuffer.used_size() == 0)
 	{
 		size_t sentSize = 0;
@@ -769,6 +1033,7 @@ bool NetSocketManagerBase::appWrite2(net::SocketBase::DataForCommandProcessing&
 		return false;
 	}
 
+	copyBorrowedSegments(sockData); // if any, they go first
 	if (sockData.writeBuffer.used_size() == 0)
 	{
 		size_t sentSize = 0;
@@ -809,6 +1074,99 @@ bool NetSocketManagerBase::appWrite2(net::SocketBase::DataForCommandProcessing&
 	}
 }
 
+bool NetSocketManagerBase::appWrite2v(net::SocketBase::DataForCommandProcessing& sockData, const BufferView* segs, size_t cnt, bool borrow )
+{
+	if (!sockData.isValid())
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"Unexpected StreamSocket {} on sendStreamSegment", sockData.index);
+		throw Error();
+	}
+
+	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sockData.ahd_write.h == nullptr || !nodecpp::isException(sockData.ahd_write.h) ); // should not be set yet
+	NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, sockData.ahd_write.segs == nullptr ); // a single a_writev() at a time
+
+	if (sockData.state == net::SocketBase::DataForCommandProcessing::LocalEnding || sockData.state == net::SocketBase::DataForCommandProcessing::LocalEnded)
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"StreamSocket {} already ended", sockData.index);
+		Error e;
+		OSLayer::errorCloseSocket(sockData, e);
+		return false;
+	}
+
+	size_t sentSize = 0;
+	if (sockData.writeBuffer.used_size() == 0)
+	{
+		uint8_t res = internal_usage_only::internal_send_packet_v(segs, cnt, 0, sockData.osSocket, sentSize);
+		if (res == COMMLAYER_RET_FAILED)
+		{
+			Error e;
+			OSLayer::errorCloseSocket(sockData, e);
+			return false;
+		}
+		else if (res == COMMLAYER_RET_OK)
+		{
+			return true;
+		}
+		ioSockets.setPollout( sockData.index );
+	}
+	else
+	{
+		size_t totalSize = 0;
+		for ( size_t i=0; i<cnt; ++i )
+			totalSize += segs[i].size();
+		if ( sockData.writeBuffer.remaining_capacity() >= totalSize ) // small enough to go with what is buffered already
+		{
+			for ( size_t i=0; i<cnt; ++i )
+				sockData.writeBuffer.append(segs[i].begin(), segs[i].size());
+			return true;
+		}
+	}
+
+	// the rest is sent right from segments as the socket becomes writable (after writeBuffer, if anything is there); see _infraProcessWriteEvent()
+	sockData.ahd_write.segs = segs;
+	sockData.ahd_write.cnt = cnt;
+	sockData.ahd_write.offset = sentSize;
+	if ( !borrow )
+		copyBorrowedSegments(sockData);
+	return false;
+}
+
+bool NetSocketManagerBase::appSendFile(net::SocketBase::DataForCommandProcessing& sockData, int fd, uint64_t& offset, size_t& count )
+{
+	if (!sockData.isValid())
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"Unexpected StreamSocket {} on sendStreamSegment", sockData.index);
+		throw Error();
+	}
+
+	if (sockData.state == net::SocketBase::DataForCommandProcessing::LocalEnding || sockData.state == net::SocketBase::DataForCommandProcessing::LocalEnded)
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"StreamSocket {} already ended", sockData.index);
+		Error e;
+		OSLayer::errorCloseSocket(sockData, e);
+		return false;
+	}
+
+	if (sockData.writeBuffer.used_size() != 0 || sockData.ahd_write.b.size() != 0 || sockData.ahd_write.segs != nullptr)
+		return false; // what has been written before goes first; we will be called again on drain
+
+	size_t sentSize = 0;
+	uint8_t res = internal_usage_only::internal_send_file(fd, offset, count, sockData.osSocket, sentSize);
+	if (res == COMMLAYER_RET_FAILED)
+	{
+		Error e;
+		OSLayer::errorCloseSocket(sockData, e);
+		return false;
+	}
+	else if (count == 0)
+		return true;
+	else
+	{
+		ioSockets.setPollout( sockData.index ); // see the case of empty writeBuffer at _infraProcessWriteEvent()
+		return false;
+	}
+}
+
 bool OSLayer::infraGetPacketBytes(Buffer& buff, SOCKET sock)
 {
 	size_t sz = 0;
@@ -903,7 +1261,21 @@ NetSocketManagerBase::ShouldEmit NetSocketManagerBase::_infraProcessWriteEvent(n
 				else if (sentSize == sockData.ahd_write.b.size())
 					sockData.ahd_write.b.clear();
 				else
+				{
+					sockData.ahd_write.b.popFront( sentSize );
 					all_done = false;
+				}
+			}
+
+			if ( all_done && sockData.ahd_write.segs != nullptr ) // a_writev() waiting for what has been buffered before
+			{
+				uint8_t res = sendBorrowedSegments(sockData);
+				if (res == COMMLAYER_RET_FAILED)
+				{
+					Error e;
+					OSLayer::errorCloseSocket(sockData, e); // the waiting one is resumed with an exception on closing
+				}
+				all_done = res == COMMLAYER_RET_OK;
 			}
 
 			if ( all_done )
@@ -940,8 +1312,22 @@ NetSocketManagerBase::ShouldEmit NetSocketManagerBase::_infraProcessWriteEvent(n
 //			entry.writeEvents = true;
 		}
 	}
-	else //ignore?
-		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical,false, "Not supported yet!");
+	else // nothing is buffered; we have been waiting for the socket to become writable (see appSendFile()), or a_writev() is in progress
+	{
+		if ( sockData.ahd_write.segs != nullptr )
+		{
+			uint8_t res = sendBorrowedSegments(sockData);
+			if (res == COMMLAYER_RET_FAILED)
+			{
+				Error e;
+				OSLayer::errorCloseSocket(sockData, e); // the waiting one is resumed with an exception on closing
+			}
+			if (res != COMMLAYER_RET_OK)
+				return ret; // the rest is sent as the socket becomes writable again
+		}
+		ioSockets.unsetPollout( sockData.index );
+		ret = EmitDrain;
+	}
 
 	return ret;
 }
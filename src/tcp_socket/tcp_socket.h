@@ -488,11 +488,13 @@ public:
 	}
 	void setSocketClosed( size_t idx ) {
 		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, idx >= reserved_capacity ); 
+		bool isServer;
 		if ( idx < ourSide.size() )
 		{
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ourSide[idx].isUsed() ); 
 			if ( ourSide[idx].isAssociated() )
 				--associatedCount;
+			isServer = ourSide[idx].getObjectType() == OpaqueEmitter::ObjectType::ServerSocket;
 			osSide[idx].fd = INVALID_SOCKET; 
 			ourSide[idx].setSocketClosed();
 		}
@@ -504,11 +506,12 @@ public:
 			NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, ourSideAccum[idx].isUsed() ); 
 			if ( ourSideAccum[idx].isAssociated() )
 				--associatedCount;
+			isServer = ourSideAccum[idx].getObjectType() == OpaqueEmitter::ObjectType::ServerSocket;
 			osSideAccum[idx].fd = INVALID_SOCKET; 
 			ourSideAccum[idx].setSocketClosed();
 		}
 #ifdef NODECPP_ENABLE_CLUSTERING
-		if ( cluster.isWorker() )
+		if ( cluster.isWorker() && !isServer ) // a worker's own listening socket (NODECPP_ACCEPT_IN_WORKERS) is not a part of its load
 			decrementThisWorkerLoadCtr();
 #endif // NODECPP_ENABLE_CLUSTERING
 	}
@@ -630,6 +633,8 @@ public:
 	}
 	bool appWrite(net::SocketBase::DataForCommandProcessing& sockData, const uint8_t* data, uint32_t size);
 	bool appWrite2(net::SocketBase::DataForCommandProcessing& sockData, Buffer& b );
+	bool appWrite2v(net::SocketBase::DataForCommandProcessing& sockData, const BufferView* segs, size_t cnt, bool borrow );
+	bool appSendFile(net::SocketBase::DataForCommandProcessing& sockData, int fd, uint64_t& offset, size_t& count );
 	bool getAcceptedSockData(SOCKET s, OpaqueSocketData& osd, Ip4& remoteIp, Port& remotePort )
 	{
 		SocketRiia newSock(internal_usage_only::internal_tcp_accept(remoteIp, remotePort, s));
@@ -673,10 +678,18 @@ public:
 	}
 	void appPause(size_t id) { 
 		auto& entry = appGetEntry(id);
-		entry.getClientSocketData()->paused = true; }
+		if ( entry.getClientSocketData()->paused )
+			return;
+		entry.getClientSocketData()->paused = true;
+		ioSockets.unsetPollin(id); // otherwise poll() keeps reporting data we are not going to read, and the peer is not slowed down
+	}
 	void appResume(size_t id) { 
 		auto& entry = appGetEntry(id);
+		if ( !entry.getClientSocketData()->paused )
+			return;
 		entry.getClientSocketData()->paused = false; 
+		if ( !entry.getClientSocketData()->remoteEnded )
+			ioSockets.setPollin(id);
 	}
 	void appReportBeingDestructed(size_t id) { 
 		/*auto& entry = appGetEntry(id);
@@ -786,6 +799,26 @@ sessionCreationtime += infraGetCurrentTime() - now;
 	}
 
 	void infraCheckPollFdSet(NetSocketEntry& current, short revents)
+	{
+		(this->*pollEventProcessor( current.getClientSocketData()->dispatch ))( current, revents );
+	}
+
+private:
+	// event processing is compiled per dispatch policy of the socket class (see net::SocketDispatchPolicy), with no checks for mechanisms it does not use
+	using PollEventProcessor = void (NetSocketManager::*)(NetSocketEntry&, short);
+
+	static PollEventProcessor pollEventProcessor( uint8_t dispatch )
+	{
+		static constexpr PollEventProcessor processors[] = {
+			&NetSocketManager::infraCheckPollFdSetFor<0>, &NetSocketManager::infraCheckPollFdSetFor<1>, &NetSocketManager::infraCheckPollFdSetFor<2>, &NetSocketManager::infraCheckPollFdSetFor<3>,
+			&NetSocketManager::infraCheckPollFdSetFor<4>, &NetSocketManager::infraCheckPollFdSetFor<5>, &NetSocketManager::infraCheckPollFdSetFor<6>, &NetSocketManager::infraCheckPollFdSetFor<7> };
+		static_assert( sizeof( processors ) / sizeof( processors[0] ) == net::SocketDispatch::all + 1 );
+		NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::pedantic, dispatch <= net::SocketDispatch::all );
+		return processors[dispatch];
+	}
+
+	template<uint8_t dispatch>
+	void infraCheckPollFdSetFor(NetSocketEntry& current, short revents)
 	{
 		if ((revents & (POLLERR | POLLNVAL)) != 0) // check errors first
 		{
@@ -810,19 +843,19 @@ sessionCreationtime += infraGetCurrentTime() - now;
 				if (!current.getClientSocketData()->paused)
 				{
 					//nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"POLLIN event at {}", begin[i].fd);
-					infraProcessReadEvent(current);
+					infraProcessReadEvent<dispatch>(current);
 				}
 			}
 			else if ((revents & POLLHUP) != 0)
 			{
 //!!//				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"POLLHUP event at {}", current.getClientSocketData()->osSocket);
-				infraProcessRemoteEnded(current);
+				infraProcessRemoteEnded<dispatch>(current);
 			}
 				
 			if ((revents & POLLOUT) != 0)
 			{
 //!!//				nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"POLLOUT event at {}", current.getClientSocketData()->osSocket);
-				infraProcessWriteEvent(current);
+				infraProcessWriteEvent<dispatch>(current);
 			}
 		}
 		//else if (revents != 0)
@@ -833,10 +866,10 @@ sessionCreationtime += infraGetCurrentTime() - now;
 		//}
 	}
 
-private:
+	template<uint8_t dispatch>
 	void infraProcessReadEvent(NetSocketEntry& entry)
 	{
-		auto hr = entry.getClientSocketData()->ahd_read.h;
+		auto hr = ( dispatch & net::SocketDispatch::awaitables ) ? entry.getClientSocketData()->ahd_read.h : nullptr;
 		if ( hr )
 		{
 			size_t required_min_sz = entry.getClientSocketData()->ahd_read.min_bytes;
@@ -877,7 +910,7 @@ private:
 						nodecpp::setException(hr, std::exception()); // TODO: switch to our exceptions ASAP!
 						hr();
 					}
-					infraProcessRemoteEnded(entry);
+					infraProcessRemoteEnded<dispatch>(entry);
 				}
 			}
 		}
@@ -889,15 +922,19 @@ private:
 			{
 				if (recvBuffer.size() != 0)
 				{
-					entry.getClientSocket()->emitData( recvBuffer);
-					if (entry.getClientSocketData()->isDataEventHandler())
-						entry.getClientSocketData()->handleDataEvent(entry.getClientSocket(), recvBuffer);
+					if constexpr ( ( dispatch & net::SocketDispatch::emitters ) != 0 )
+						entry.getClientSocket()->emitData( recvBuffer);
+					else
+						entry.getClientSocket()->_bytesRead += recvBuffer.size(); // as emitData() does
+					if constexpr ( ( dispatch & net::SocketDispatch::handlers ) != 0 )
+						if (entry.getClientSocketData()->isDataEventHandler())
+							entry.getClientSocketData()->handleDataEvent(entry.getClientSocket(), recvBuffer);
 					
 					NODECPP_ASSERT( nodecpp::module_id, ::nodecpp::assert::AssertLevel::critical, recvBuffer.capacity() == recvBufferCapacity );
 				}
 				else //if (!entry.remoteEnded)
 				{
-					infraProcessRemoteEnded(entry);
+					infraProcessRemoteEnded<dispatch>(entry);
 				}
 			}
 			else
@@ -909,6 +946,7 @@ private:
 		}
 	}
 
+	template<uint8_t dispatch>
 	void infraProcessRemoteEnded(NetSocketEntry& entry)
 	{
 		if (!entry.getClientSocketData()->remoteEnded)
@@ -916,9 +954,11 @@ private:
 			entry.getClientSocketData()->remoteEnded = true;
 			ioSockets.unsetPollin(entry.index); // if(!remoteEnded && !paused) events |= POLLIN;
 
-			entry.getClientSocket()->emitEnd();
-			if (entry.getClientSocketData()->isEndEventHandler())
-				entry.getClientSocketData()->handleEndEvent(entry.getClientSocket());
+			if constexpr ( ( dispatch & net::SocketDispatch::emitters ) != 0 )
+				entry.getClientSocket()->emitEnd();
+			if constexpr ( ( dispatch & net::SocketDispatch::handlers ) != 0 )
+				if (entry.getClientSocketData()->isEndEventHandler())
+					entry.getClientSocketData()->handleEndEvent(entry.getClientSocket());
 
 			if (entry.getClientSocketData()->state == net::SocketBase::DataForCommandProcessing::LocalEnded)
 			{
@@ -947,6 +987,7 @@ private:
 
 	}
 
+	template<uint8_t dispatch>
 	void infraProcessWriteEvent(NetSocketEntry& current)
 	{
 		NetSocketManagerBase::ShouldEmit status = this->_infraProcessWriteEvent(*current.getClientSocketData());
@@ -954,7 +995,7 @@ private:
 		{
 			case NetSocketManagerBase::ShouldEmit::EmitConnect:
 			{
-				auto hr = current.getClientSocketData()->ahd_connect;
+				auto hr = ( dispatch & net::SocketDispatch::awaitables ) ? current.getClientSocketData()->ahd_connect : nullptr;
 				if ( hr )
 				{
 					current.getClientSocketData()->ahd_connect = nullptr;
@@ -962,15 +1003,25 @@ private:
 				}
 				else
 				{
-					current.getClientSocket()->emitConnect();
-					if (current.getClientSocketData()->isConnectEventHandler())
-						current.getClientSocketData()->handleConnectEvent(current.getClientSocket());
+					if constexpr ( ( dispatch & net::SocketDispatch::emitters ) != 0 )
+						current.getClientSocket()->emitConnect();
+					if constexpr ( ( dispatch & net::SocketDispatch::handlers ) != 0 )
+						if (current.getClientSocketData()->isConnectEventHandler())
+							current.getClientSocketData()->handleConnectEvent(current.getClientSocket());
 				}
 				break;
 			}
 			case NetSocketManagerBase::ShouldEmit::EmitDrain:
 			{
-				auto hr = current.getClientSocketData()->ahd_drain;
+				auto hw = ( dispatch & net::SocketDispatch::awaitables ) ? current.getClientSocketData()->ahd_write.h : nullptr; // a_write()/a_writev()/a_sendFile() waiting for the rest to be sent
+				if ( hw )
+				{
+					current.getClientSocketData()->ahd_write.h = nullptr;
+					hw();
+					if ( !current.isUsed() || !current.getClientSocketData()->writeBuffer.empty() ) // not drained anymore
+						break;
+				}
+				auto hr = ( dispatch & net::SocketDispatch::awaitables ) ? current.getClientSocketData()->ahd_drain : nullptr;
 				if ( hr )
 				{
 					current.getClientSocketData()->ahd_drain = nullptr;
@@ -978,9 +1029,11 @@ private:
 				}
 				else // TODO: make sure we never have both cases in the same time
 				{
-					current.getClientSocket()->emitDrain();
-					if (current.getClientSocketData()->isDrainEventHandler())
-						current.getClientSocketData()->handleDrainEvent(current.getClientSocket());
+					if constexpr ( ( dispatch & net::SocketDispatch::emitters ) != 0 )
+						current.getClientSocket()->emitDrain();
+					if constexpr ( ( dispatch & net::SocketDispatch::handlers ) != 0 )
+						if (current.getClientSocketData()->isDrainEventHandler())
+							current.getClientSocketData()->handleDrainEvent(current.getClientSocket());
 				}
 				break;
 			}
@@ -1021,6 +1074,18 @@ protected:
 public:
 	NetServerManagerBase(NetSockets& ioSockets_ ) : ioSockets( ioSockets_) {}
 
+#ifdef NODECPP_ENABLE_CLUSTERING
+	// whether listening and accepting for a server of this thread is done elsewhere (by listener threads, see ListenerThreadWorker)
+	// With NODECPP_ACCEPT_IN_WORKERS each worker binds its own SO_REUSEPORT listener instead, and the kernel spreads incoming connections
+	static bool isServerDelegated() {
+#ifdef NODECPP_ACCEPT_IN_WORKERS
+		return false;
+#else
+		return getCluster().isWorker();
+#endif // NODECPP_ACCEPT_IN_WORKERS
+	}
+#endif // NODECPP_ENABLE_CLUSTERING
+
 	template<class DataForCommandProcessing>
 	void appClose(DataForCommandProcessing& serverData) {
 		size_t id = serverData.index;
@@ -1037,13 +1102,13 @@ public:
 
 		//pendingCloseEvents.emplace_back(entry.index, false); note: it will be finally closed only after all accepted connections are ended
 #else
-		auto& entry = getCluster().isMaster() ? appGetEntry(id) : ioSockets.slaveServerAt(id);
+		auto& entry = !isServerDelegated() ? appGetEntry(id) : ioSockets.slaveServerAt(id);
 		if (!entry.isUsed())
 		{
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id),"Unexpected id {} on NetServerManager::close", id);
 			return;
 		}
-		if ( getCluster().isMaster() )
+		if ( !isServerDelegated() )
 		{
 			internal_usage_only::internal_close(serverData.osSocket);
 			ioSockets.setSocketClosed( entry.index );
@@ -1075,9 +1140,13 @@ public:
 		ptr->dataForCommandProcessing.osSocket = s.release();
 		addServerEntry(ptr);
 #else
-		if ( getCluster().isMaster() )
+		if ( !isServerDelegated() )
 		{
+#ifdef NODECPP_ACCEPT_IN_WORKERS
+			SocketRiia s(internal_usage_only::internal_make_shared_tcp_socket()); // SO_REUSEPORT: all threads listen at the same port
+#else
 			SocketRiia s(internal_usage_only::internal_make_tcp_socket());
+#endif // NODECPP_ACCEPT_IN_WORKERS
 			if (!s)
 			{
 				throw Error();
@@ -1165,12 +1234,12 @@ public:
 	void appListen(DataForCommandProcessing& dataForCommandProcessing, nodecpp::Ip4 ip, uint16_t port, int backlog) { //TODO:CLUSTERING alt impl
 		Port myPort = Port::fromHost(port);
 #ifdef NODECPP_ENABLE_CLUSTERING
-		if ( getCluster().isWorker() )
+		if ( isServerDelegated() )
 		{
 			dataForCommandProcessing.localAddress.ip = ip;
 			dataForCommandProcessing.localAddress.port = port;
 			dataForCommandProcessing.localAddress.family = family;
-			getCluster().acceptRequestForListeningAtSlave( dataForCommandProcessing.index, ip, port, family, backlog );
+			getCluster().acceptRequestForListeningAtSlave( dataForCommandProcessing.index, ip, port, family, backlog, dataForCommandProcessing.distribution );
 			return;
 		}
 #endif // NODECPP_ENABLE_CLUSTERING
@@ -1183,6 +1252,10 @@ public:
 			if ( port == 0 )
 				throw Error();
 		}
+#if defined NODECPP_ACCEPT_IN_WORKERS && defined NODECPP_STEER_BY_INCOMING_CPU
+		// prefer connections whose packets are processed at the CPU this thread runs on (makes sense with pinned workers)
+		internal_usage_only::internal_set_incoming_cpu(dataForCommandProcessing.osSocket);
+#endif
 		if (!internal_usage_only::internal_listen_tcp_socket(dataForCommandProcessing.osSocket, backlog)) {
 			throw Error();
 		}
@@ -1215,7 +1288,7 @@ public:
 #ifndef NODECPP_ENABLE_CLUSTERING
 		ioSockets.setUnused(id); 
 #else
-		if ( getCluster().isMaster() )
+		if ( !isServerDelegated() )
 			ioSockets.setUnused(id); 
 		else
 			ioSockets.setSlaveServerUnused(id); 
@@ -1241,6 +1314,7 @@ public:
 		NODECPP_ASSERT( nodecpp::module_id, nodecpp::assert::AssertLevel::critical, getCluster().isWorker() ); 
 		acceptedSockets.push_back(AcceptedSocketData({serverIdx, socket, remoteIp, remotePort})); 
 	}
+	void reserveAcceptedSockets( size_t extraCnt ) { acceptedSockets.reserve( acceptedSockets.size() + extraCnt ); }
 	void addListeningServerEv( size_t serverIdx ) { 
 		NODECPP_ASSERT( nodecpp::module_id, nodecpp::assert::AssertLevel::critical, getCluster().isWorker() ); 
 		receivedListeningEvs.push_back(serverIdx);
@@ -1424,6 +1498,10 @@ private:
 		{
 			if ( !netSocketManagerBase->getAcceptedSockData(entry.getServerSocketData()->osSocket, osd, remoteIp, remotePort) )
 				return;
+#ifdef NODECPP_ACCEPT_IN_WORKERS
+			if ( getCluster().isWorker() )
+				incrementThisWorkerLoadCtr(); // balanced at NetSockets::setSocketClosed()
+#endif // NODECPP_ACCEPT_IN_WORKERS
 			consumeAcceptedSocket(entry, osd, remoteIp, remotePort);
 		}
 #else
@@ -178,8 +178,16 @@ namespace nodecpp
 		void internal_close(SOCKET sock);
 
 		uint8_t internal_send_packet(const uint8_t* data, size_t size, SOCKET sock, size_t& sentSize);
+		uint8_t internal_send_packet_v(const BufferView* segs, size_t cnt, size_t offset, SOCKET sock, size_t& sentSize);
+		uint8_t internal_send_file(int fd, uint64_t& offset, size_t& count, SOCKET sock, size_t& sentSize);
 
 		SOCKET internal_tcp_accept(Ip4& ip, Port& port, SOCKET sock);
+
+		bool internal_set_incoming_cpu(SOCKET sock);
+
+		bool internal_make_awaker(SOCKET& readHandle, SOCKET& writeHandle);
+		bool internal_signal_awaker(SOCKET writeHandle);
+		bool internal_reset_awaker(SOCKET readHandle);
 	} // internal_usage_only
 } // nodecpp
 
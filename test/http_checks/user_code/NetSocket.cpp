@@ -0,0 +1,7 @@
+// NetSocket.cpp : HTTP server checks
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<HttpChecksNode>> noname( "HttpChecksNode" );
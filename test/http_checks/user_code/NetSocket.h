@@ -0,0 +1,39 @@
+// NetSocket.h : checks of the HTTP server over loopback connections; see ../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+
+#include "exchange.h"
+#include "cache_privacy_checks.h"
+#include "framing_checks.h"
+#include "large_body_checks.h"
+#include "pipeline_order_checks.h"
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class HttpChecksNode : public NodeBase
+{
+public:
+	virtual nodecpp::handler_ret_type main()
+	{
+		// one after another, each with a server at a port of its own
+		co_await cache_privacy_checks::run( 2101 );
+		co_await pipeline_order_checks::run( 2102 );
+		co_await framing_checks::run( 2103 );
+		co_await large_body_checks::run( 2104 );
+
+		printf( "%zu checks, %zu failed\n", checkStats().total, checkStats().failed );
+		exit( checkStats().failed ? 1 : 0 ); // nothing else is to be run by the loop
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,92 @@
+// cache_privacy_checks.h : the response cache does not share responses to requests with credentials, nor ones varying by other headers
+
+#ifndef CACHE_PRIVACY_CHECKS_H
+#define CACHE_PRIVACY_CHECKS_H
+
+#include "exchange.h"
+
+namespace cache_privacy_checks {
+
+	using namespace http_checks;
+
+	inline nodecpp::handler_ret_type get( uint16_t port, const char* path, const char* extraHeaders, nodecpp::string& body )
+	{
+		ExchangeResult r;
+		co_await exchange( port, nodecpp::format( "GET {} HTTP/1.1\r\nHost: x\r\n{}\r\n", path, extraHeaders ), r, 100 );
+		body = bodyOf( r.received );
+		CO_RETURN;
+	}
+
+	inline nodecpp::handler_ret_type run( uint16_t port )
+	{
+		auto srv = nodecpp::net::createHttpServer<CheckServer>();
+		nodecpp::net::HttpResponseCache::Options options;
+		options.ttlMs = 60000;
+		options.keyHeaders.push_back( "accept-encoding" );
+		srv->enableResponseCache( std::move( options ) );
+		// each response is unique, so that a cached one is told from a new one
+		size_t counter = 0;
+		srv->getRouter().get( "/plain", [&counter](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->end( nodecpp::format( "{}", ++counter ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().get( "/public", [&counter](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}, {"Cache-Control", "public, max-age=60"}});
+			co_await response->end( nodecpp::format( "{}", ++counter ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().get( "/vary-any", [&counter](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}, {"Vary", "*"}});
+			co_await response->end( nodecpp::format( "{}", ++counter ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().get( "/vary-lang", [&counter](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}, {"Vary", "Accept-Encoding, Accept-Language"}});
+			co_await response->end( nodecpp::format( "{}", ++counter ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().get( "/vary-key", [&counter](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}, {"Vary", "Accept-Encoding"}});
+			co_await response->end( nodecpp::format( "{}", ++counter ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(port, "127.0.0.1", 16);
+
+		nodecpp::string a, b, c, d;
+
+		// a response to a request with a cookie is neither stored, nor is it served from a stored one
+		co_await get( port, "/plain", "Cookie: session=alice\r\n", a );
+		co_await get( port, "/plain", "", b );
+		co_await get( port, "/plain", "", c );
+		co_await get( port, "/plain", "Authorization: Bearer bob\r\n", d );
+		UNIT_CHECK( a.size() && b.size() && a != b );
+		UNIT_CHECK( b == c ); // the cache itself works
+		UNIT_CHECK( d.size() && d != c );
+
+		// explicitly shared responses are
+		co_await get( port, "/public", "Authorization: Bearer bob\r\n", a );
+		co_await get( port, "/public", "", b );
+		co_await get( port, "/public", "Cookie: session=alice\r\n", c );
+		UNIT_CHECK( a.size() && a == b && b == c );
+
+		// varying by headers that are not a part of the key
+		co_await get( port, "/vary-any", "", a );
+		co_await get( port, "/vary-any", "", b );
+		UNIT_CHECK( a.size() && b.size() && a != b );
+		co_await get( port, "/vary-lang", "Accept-Language: en\r\n", a );
+		co_await get( port, "/vary-lang", "Accept-Language: de\r\n", b );
+		UNIT_CHECK( a.size() && b.size() && a != b );
+		co_await get( port, "/vary-key", "Accept-Encoding: gzip\r\n", a );
+		co_await get( port, "/vary-key", "Accept-Encoding: gzip\r\n", b );
+		co_await get( port, "/vary-key", "Accept-Encoding: br\r\n", c );
+		UNIT_CHECK( a.size() && a == b && c != a );
+
+		srv->close();
+		CO_RETURN;
+	}
+
+} // namespace cache_privacy_checks
+
+#endif // CACHE_PRIVACY_CHECKS_H
@@ -0,0 +1,66 @@
+// exchange.h : helpers for HTTP server checks: a server to be set up by a check, and a raw client
+
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include "../../unit_checks/user_code/checks.h"
+
+namespace http_checks {
+
+	using CheckServer = nodecpp::net::HttpServer<void>;
+
+	struct ExchangeResult
+	{
+		nodecpp::string received;
+		bool closedByServer = false; // otherwise nothing came for idleMs, with the connection still open
+	};
+
+	// sends request (it may contain several pipelined ones) at a new connection to 127.0.0.1:port and collects whatever comes back
+	inline nodecpp::handler_ret_type exchange( uint16_t port, nodecpp::string request, ExchangeResult& result, uint32_t idleMs = 300 )
+	{
+		auto sock = nodecpp::net::createSocket();
+		Buffer part( 0x10000 );
+		result.received.clear();
+		result.closedByServer = false;
+		try
+		{
+			co_await sock->a_connect( port, "127.0.0.1" );
+			co_await sock->a_write( BufferView( request.c_str(), request.size() ), BufferView() );
+			for(;;)
+			{
+				co_await sock->a_read( idleMs, part );
+				result.received.append( (const char*)(part.begin()), part.size() );
+			}
+		}
+		catch (...)
+		{
+			result.closedByServer = sock->dataForCommandProcessing.remoteEnded;
+		}
+		sock->end();
+		CO_RETURN;
+	}
+
+	// position of what at or after pos; npos if pos is npos (so that calls can be chained to check order)
+	inline size_t findFrom( const nodecpp::string& s, const char* what, size_t pos = 0 )
+	{
+		return pos == nodecpp::string::npos ? nodecpp::string::npos : s.find( what, pos );
+	}
+
+	// body of a single response that is not chunked
+	inline nodecpp::string bodyOf( const nodecpp::string& s )
+	{
+		size_t end = s.find( "\r\n\r\n" );
+		return end == nodecpp::string::npos ? nodecpp::string() : s.substr( end + 4 );
+	}
+
+	inline size_t countOf( const nodecpp::string& s, const char* what )
+	{
+		size_t cnt = 0;
+		for ( size_t pos = s.find( what ); pos != nodecpp::string::npos; pos = s.find( what, pos + 1 ) )
+			++cnt;
+		return cnt;
+	}
+
+} // namespace http_checks
+
+#endif // EXCHANGE_H
@@ -0,0 +1,77 @@
+// framing_checks.h : requests whose body cannot be delimited unambiguously are refused with 400 and the connection is closed;
+// trailers of responses cannot inject lines of their own
+
+#ifndef FRAMING_CHECKS_H
+#define FRAMING_CHECKS_H
+
+#include "exchange.h"
+
+namespace framing_checks {
+
+	using namespace http_checks;
+
+	inline nodecpp::handler_ret_type run( uint16_t port )
+	{
+		auto srv = nodecpp::net::createHttpServer<CheckServer>();
+		// reads the whole body and reports its size
+		srv->getRouter().post( "/echo", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			size_t total = 0;
+			Buffer b( 0x1000 );
+			while ( !request->isBodyCompleted() )
+			{
+				co_await request->a_readBody( b );
+				total += b.size();
+			}
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->end( nodecpp::format( "size={};", total ) );
+			CO_RETURN;
+		} );
+		// chunked, with a trailer that is first attempted with a line of its own in the value
+		srv->getRouter().get( "/trailer", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			bool rejected = false;
+			try { response->addTrailer( "X-Checksum", "abc\r\nX-Injected: 1" ); } catch (nodecpp::Error&) { rejected = true; }
+			response->addTrailer( "X-Checksum", "abc" );
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->writeBodyPart( BufferView( rejected ? "rejected;" : "accepted;", 9 ) );
+			co_await response->end();
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(port, "127.0.0.1", 16);
+
+		ExchangeResult r;
+		// well-formed chunked body: accepted, connection is kept
+		co_await exchange( port, "POST /echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n", r );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 200" ) == 1 );
+		UNIT_CHECK( r.received.find( "size=5;" ) != nodecpp::string::npos );
+		UNIT_CHECK( !r.closedByServer );
+
+		// a coding other than chunked applied last: the body would be framed by Content-Length otherwise
+		co_await exchange( port, "POST /echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: gzip\r\nContent-Length: 5\r\n\r\nhello", r );
+		UNIT_CHECK( r.received.find( "HTTP/1.1 400" ) == 0 );
+		UNIT_CHECK( r.received.find( "Connection: close" ) != nodecpp::string::npos );
+		UNIT_CHECK( r.closedByServer );
+
+		// chunked, but with Content-Length as well; the second request is smuggled in, if the latter is honoured
+		co_await exchange( port, "POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\nPOST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 0\r\n\r\n", r );
+		UNIT_CHECK( r.received.find( "HTTP/1.1 400" ) == 0 );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 " ) == 1 );
+		UNIT_CHECK( r.closedByServer );
+
+		// a refused request pipelined after a good one: the latter is still responded to, and first
+		co_await exchange( port, "POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 2\r\n\r\nhiPOST /echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked, gzip\r\n\r\n", r );
+		UNIT_CHECK( findFrom( r.received, "HTTP/1.1 400", findFrom( r.received, "size=2;", r.received.find( "HTTP/1.1 200" ) ) ) != nodecpp::string::npos );
+		UNIT_CHECK( r.closedByServer );
+
+		co_await exchange( port, "GET /trailer HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( r.received.find( "rejected;" ) != nodecpp::string::npos );
+		UNIT_CHECK( r.received.find( "\r\n0\r\nX-Checksum: abc\r\n\r\n" ) != nodecpp::string::npos );
+		UNIT_CHECK( r.received.find( "X-Injected" ) == nodecpp::string::npos );
+
+		srv->close();
+		CO_RETURN;
+	}
+
+} // namespace framing_checks
+
+#endif // FRAMING_CHECKS_H
@@ -0,0 +1,69 @@
+// large_body_checks.h : bodies too large for the socket to accept at once are sent right from memory of the handler, completely and in order
+
+#ifndef LARGE_BODY_CHECKS_H
+#define LARGE_BODY_CHECKS_H
+
+#include "exchange.h"
+
+namespace large_body_checks {
+
+	using namespace http_checks;
+
+	inline nodecpp::string makeBody( size_t size ) // no period that is a power of 2, so that a misplaced part shows up
+	{
+		nodecpp::string s;
+		s.reserve( size );
+		for ( size_t i=0; i<size; ++i )
+			s.push_back( (char)( 'a' + i % 23 ) );
+		return s;
+	}
+
+	inline nodecpp::handler_ret_type run( uint16_t port )
+	{
+		static const nodecpp::string big = makeBody( 0x400000 );
+		auto srv = nodecpp::net::createHttpServer<CheckServer>();
+		srv->getRouter().get( "/big", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->end( BufferView( big.c_str(), big.size() ) );
+			CO_RETURN;
+		} );
+		// chunked, by large parts
+		srv->getRouter().get( "/parts", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			size_t half = big.size() / 2 + 1;
+			co_await response->writeBodyPart( BufferView( big.c_str(), half ) );
+			co_await response->writeBodyPart( BufferView( big.c_str() + half, big.size() - half ) );
+			co_await response->end();
+			CO_RETURN;
+		} );
+		srv->getRouter().get( "/quick", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->end( nodecpp::string_literal( "quick;" ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(port, "127.0.0.1", 16);
+
+		ExchangeResult r;
+		co_await exchange( port, "GET /big HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( bodyOf( r.received ) == big );
+		UNIT_CHECK( !r.closedByServer );
+
+		co_await exchange( port, "GET /parts HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		size_t half = big.size() / 2 + 1;
+		UNIT_CHECK( r.received.find( big.substr( 0, half ) ) != nodecpp::string::npos );
+		UNIT_CHECK( findFrom( r.received, "0\r\n\r\n", r.received.find( big.substr( half ) ) ) != nodecpp::string::npos );
+
+		// a small response pipelined after a large one goes after all of it
+		co_await exchange( port, "GET /big HTTP/1.1\r\nHost: x\r\n\r\nGET /quick HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 200" ) == 2 );
+		size_t bigAt = r.received.find( big );
+		UNIT_CHECK( bigAt != nodecpp::string::npos && findFrom( r.received, "quick;", bigAt + big.size() ) != nodecpp::string::npos );
+
+		srv->close();
+		CO_RETURN;
+	}
+
+} // namespace large_body_checks
+
+#endif // LARGE_BODY_CHECKS_H
@@ -0,0 +1,55 @@
+// pipeline_order_checks.h : responses to pipelined requests go out in order, also when a later one completes first
+
+#ifndef PIPELINE_ORDER_CHECKS_H
+#define PIPELINE_ORDER_CHECKS_H
+
+#include "exchange.h"
+
+namespace pipeline_order_checks {
+
+	using namespace http_checks;
+
+	inline nodecpp::handler_ret_type run( uint16_t port )
+	{
+		auto srv = nodecpp::net::createHttpServer<CheckServer>();
+		// written in parts, with a pause, so that responses to requests pipelined after it complete meanwhile
+		srv->getRouter().get( "/stream", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->writeBodyPart( BufferView( "part-1;", 7 ) );
+			co_await nodecpp::a_timeout( 50 );
+			co_await response->writeBodyPart( BufferView( "part-2;", 7 ) );
+			co_await response->end();
+			CO_RETURN;
+		} );
+		// small; completed at once and left for a batched flush
+		srv->getRouter().get( "/quick", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}});
+			co_await response->end( nodecpp::string_literal( "quick;" ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(port, "127.0.0.1", 16);
+
+		ExchangeResult r;
+		co_await exchange( port, "GET /stream HTTP/1.1\r\nHost: x\r\n\r\nGET /quick HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 200" ) == 2 );
+		UNIT_CHECK( findFrom( r.received, "quick;", findFrom( r.received, "0\r\n\r\n", findFrom( r.received, "part-2;", r.received.find( "part-1;" ) ) ) ) != nodecpp::string::npos );
+		UNIT_CHECK( !r.closedByServer );
+
+		// the streaming one is in the middle: the one before it is flushed, then it, then the one after it
+		co_await exchange( port, "GET /quick HTTP/1.1\r\nHost: x\r\n\r\nGET /stream HTTP/1.1\r\nHost: x\r\n\r\nGET /quick HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 200" ) == 3 );
+		UNIT_CHECK( findFrom( r.received, "quick;", findFrom( r.received, "part-2;", findFrom( r.received, "part-1;", r.received.find( "quick;" ) ) ) ) != nodecpp::string::npos );
+
+		// two streaming ones followed by two quick ones
+		co_await exchange( port, "GET /stream HTTP/1.1\r\nHost: x\r\n\r\nGET /stream HTTP/1.1\r\nHost: x\r\n\r\nGET /quick HTTP/1.1\r\nHost: x\r\n\r\nGET /quick HTTP/1.1\r\nHost: x\r\n\r\n", r );
+		UNIT_CHECK( countOf( r.received, "HTTP/1.1 200" ) == 4 );
+		UNIT_CHECK( countOf( r.received, "quick;" ) == 2 && r.received.find( "quick;" ) > r.received.rfind( "part-2;" ) );
+
+		srv->close();
+		CO_RETURN;
+	}
+
+} // namespace pipeline_order_checks
+
+#endif // PIPELINE_ORDER_CHECKS_H
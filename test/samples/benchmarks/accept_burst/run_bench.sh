@@ -0,0 +1,21 @@
+#!/bin/bash
+# usage: ./run_bench.sh [workers] [burst size] [bursts]
+# builds: ./build/build_clang.sh (batched accept), ./build/build_clang_nobatch.sh (one connection per listener wakeup)
+# and ./build/build_clang_client.sh; workers are pinned to CPUs 0..n-1, the client runs at the next CPU
+
+workers=${1:-4}
+burst=${2:-1000}
+bursts=${3:-100}
+ulimit -n 65536 # a whole burst is open at once at both sides
+
+for bin in server.bin server_nobatch.bin
+do
+	./build/$bin numcores=$workers workercpus=0-$((workers - 1)) > /dev/null &
+	pid=$!
+	sleep 1
+	echo "$bin, $workers workers, bursts of $burst connections"
+	taskset -c $workers ./build/client.bin client burst=$burst bursts=10 > /dev/null 2>&1 # warm-up
+	taskset -c $workers ./build/client.bin client burst=$burst bursts=$bursts | grep -E "^[0-9]+ bursts|^burst|^connect"
+	kill $pid
+	wait $pid 2>/dev/null
+done
@@ -0,0 +1,7 @@
+// NetSocket.cpp : accept burst benchmark (clustered server and its client)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,169 @@
+// NetSocket.h : accept burst benchmark (clustered server and its client); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	// client mode
+	nodecpp::string ip = "127.0.0.1";
+	uint16_t port = 2000;
+	nodecpp::string request;
+	size_t burstSize = 1000;
+	size_t burstCnt = 100;
+	size_t burstsDone = 0;
+	size_t connsRunning = 0;
+	size_t errors = 0;
+	std::vector<uint32_t> latenciesUs; // from connect() to the end of the response, per connection
+	std::vector<uint32_t> burstTimesUs; // from the first connect() to the end of the last response, per burst
+	std::chrono::steady_clock::time_point burstStart;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		bool client = false;
+		size_t coreCnt = 1;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i] == "client" )
+				client = true;
+			else if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+				coreCnt = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 6 && argv[i].substr(0,6) == "burst=" )
+				burstSize = atol(argv[i].c_str() + 6);
+			else if ( argv[i].size() > 7 && argv[i].substr(0,7) == "bursts=" )
+				burstCnt = atol(argv[i].c_str() + 7);
+			else if ( argv[i].size() > 3 && argv[i].substr(0,3) == "ip=" )
+				ip = argv[i].substr(3).c_str();
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "port=" )
+				port = (uint16_t)atol(argv[i].c_str() + 5);
+		}
+
+		if ( client )
+		{
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "client: {} bursts of {} connections to {}:{}", burstCnt, burstSize, ip, port );
+			request = nodecpp::format( "GET / HTTP/1.1\r\nHost: {}:{}\r\nConnection: close\r\n\r\n", ip, port );
+			latenciesUs.reserve( burstCnt * burstSize );
+			burstTimesUs.reserve( burstCnt );
+			startBurst();
+			CO_RETURN;
+		}
+
+#ifdef NODECPP_ENABLE_CLUSTERING
+		if ( getCluster().isMaster() ) 
+		{
+#ifdef NODECPP_MAX_ACCEPT_BATCH
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, up to {} connections accepted per listener wakeup", coreCnt, NODECPP_MAX_ACCEPT_BATCH );
+#else
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, default accept batching", coreCnt );
+#endif // NODECPP_MAX_ACCEPT_BATCH
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+#endif // NODECPP_ENABLE_CLUSTERING
+		{
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			srv->getRouter().get( "/", [](auto request, auto response) -> nodecpp::handler_ret_type {
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::string_literal( "Hello, world!\r\n" ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(port, "0.0.0.0", 5000); // the backlog is to hold a whole burst
+		}
+
+		CO_RETURN;
+	}
+
+	// all connections of a burst are started at once; the next burst is started when the last of them is done
+	void startBurst()
+	{
+		burstStart = std::chrono::steady_clock::now();
+		connsRunning = burstSize;
+		for ( size_t i=0; i<burstSize; ++i )
+			oneConnection();
+	}
+
+	nodecpp::handler_ret_type oneConnection()
+	{
+		auto sock = nodecpp::net::createSocket();
+		Buffer part( 0x1000 );
+		Buffer received;
+		auto connStart = std::chrono::steady_clock::now();
+		try
+		{
+			co_await sock->a_connect( port, ip.c_str() );
+			co_await sock->a_write( BufferView( request.c_str(), request.size() ), BufferView() );
+			for(;;)
+			{
+				co_await sock->a_read( part );
+				received.append( part );
+				std::string_view response( (const char*)(received.begin()), received.size() );
+				if ( response.find( "\r\n\r\nHello, world!\r\n" ) != std::string_view::npos )
+					break;
+			}
+			latenciesUs.push_back( (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - connStart ).count() );
+		}
+		catch (...)
+		{
+			++errors;
+		}
+		sock->end();
+		if ( --connsRunning == 0 )
+		{
+			burstTimesUs.push_back( (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - burstStart ).count() );
+			if ( ++burstsDone < burstCnt )
+				startBurst();
+			else
+				report();
+		}
+		CO_RETURN;
+	}
+
+	void report()
+	{
+		uint64_t totalUs = 0;
+		for ( auto t : burstTimesUs )
+			totalUs += t;
+		std::sort( latenciesUs.begin(), latenciesUs.end() );
+		std::sort( burstTimesUs.begin(), burstTimesUs.end() );
+		auto percentile = []( const std::vector<uint32_t>& v, double p ) { return v.empty() ? 0 : v[ (size_t)( p * ( v.size() - 1 ) ) ]; };
+		double cps = totalUs ? latenciesUs.size() * 1e6 / totalUs : 0;
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} bursts of {} connections ({} failed): {} connections/s", burstTimesUs.size(), burstSize, errors, cps );
+		printf( "%zu bursts of %zu connections, %zu failed: %.0f connections/s within bursts\n", burstTimesUs.size(), burstSize, errors, cps );
+		printf( "burst completion, us: p50 %u, p90 %u, p99 %u, max %u\n", percentile( burstTimesUs, 0.5 ), percentile( burstTimesUs, 0.9 ), percentile( burstTimesUs, 0.99 ), percentile( burstTimesUs, 1.0 ) );
+		printf( "connect to response, us: p50 %u, p90 %u, p99 %u, max %u\n", percentile( latenciesUs, 0.5 ), percentile( latenciesUs, 0.9 ), percentile( latenciesUs, 0.99 ), percentile( latenciesUs, 1.0 ) );
+		exit( errors ? 1 : 0 ); // nothing else is to be run by the loop
+	}
+};
+
+#endif // NET_SOCKET_H
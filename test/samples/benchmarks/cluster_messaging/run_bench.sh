@@ -0,0 +1,9 @@
+#!/bin/bash
+# usage: ./run_bench.sh [master CPU] [worker CPU]
+# the master thread and the only worker are run at the given CPUs (0 and 1 by default; try CPUs of different cores,
+# of SMT siblings and of different NUMA nodes); prints ping-pong latency and bulk transfer throughput
+
+mastercpu=${1:-0}
+workercpu=${2:-1}
+
+taskset -c $mastercpu,$workercpu ./build/cluster_messaging.bin workercpus=$workercpu > /dev/null
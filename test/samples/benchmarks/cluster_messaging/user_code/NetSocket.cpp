@@ -0,0 +1,7 @@
+// NetSocket.cpp : cluster messaging benchmark (clustered)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
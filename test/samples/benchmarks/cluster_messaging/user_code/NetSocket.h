@@ -0,0 +1,171 @@
+// NetSocket.h : cluster messaging benchmark (clustered); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/cluster.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+	enum Tag : uint32_t { Ready = 1, Ping, Bulk, Sync };
+
+	// master: runs measurements against the worker
+	size_t rounds = 100000;
+	size_t bulkBytes = (size_t)1 << 30;
+	size_t errors = 0;
+
+	// worker: what is received by Bulk posts
+	uint64_t bulkReceived = 0;
+	uint64_t bulkChecksum = 0;
+
+public:
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		if ( getCluster().isMaster() ) 
+		{
+			auto argv = getArgv();
+			for ( size_t i=1; i<argv.size(); ++i )
+			{
+				if ( argv[i].size() > 7 && argv[i].substr(0,7) == "rounds=" )
+					rounds = atol(argv[i].c_str() + 7);
+				else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "bulk=" ) // MB
+					bulkBytes = (size_t)atol(argv[i].c_str() + 5) << 20;
+			}
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} round trips per size, {} MB per bulk transfer", rounds, bulkBytes >> 20 );
+			getCluster().onMessage( [this]( WorkerMessage& msg ) {
+				if ( msg.tag == Ready )
+					run( msg.source );
+			} );
+			getCluster().fork();
+		}
+		else
+		{
+			getCluster().onMessage( [this]( WorkerMessage& msg ) {
+				switch ( msg.tag )
+				{
+					case Ping:
+						getCluster().reply( msg, msg.data, msg.size );
+						break;
+					case Bulk:
+					{
+						// read the payload as a consumer would (a word per cache line)
+						const uint8_t* data = msg.buffer.empty() ? msg.data : msg.buffer.begin();
+						size_t sz = msg.buffer.empty() ? msg.size : msg.buffer.size();
+						for ( size_t i=0; i+8<=sz; i+=64 )
+						{
+							uint64_t word;
+							memcpy( &word, data + i, 8 );
+							bulkChecksum += word;
+						}
+						bulkReceived += sz;
+						break; // msg.buffer, if any, goes back to its owner thread to be freed there
+					}
+					case Sync:
+						getCluster().reply( msg, &bulkReceived, sizeof(bulkReceived) );
+						break;
+				}
+			} );
+			getCluster().postMessage( ThreadID({0,0}), Ready, (uint32_t)0 );
+		}
+
+		CO_RETURN;
+	}
+
+	nodecpp::handler_ret_type run( ThreadID peer )
+	{
+		try
+		{
+			// round trip latency of a_request(), with inline payloads (the worker echoes them)
+			for ( size_t size : { (size_t)8, (size_t)256, Cluster::maxInlinePayload } )
+				co_await pingPong( peer, size );
+			// one-way throughput of posts: inline payloads up to maxInlinePayload, buffers passed by ownership transfer above it
+			for ( size_t size : { (size_t)1024, (size_t)0x10000, (size_t)0x100000 } )
+				co_await bulk( peer, size );
+		}
+		catch (...)
+		{
+			++errors;
+		}
+		exit( errors ? 1 : 0 ); // nothing else is to be run by the loop
+	}
+
+	nodecpp::handler_ret_type pingPong( ThreadID peer, size_t size )
+	{
+		std::vector<uint8_t> payload( size );
+		for ( size_t i=0; i<size; ++i )
+			payload[i] = (uint8_t)i;
+		std::vector<uint32_t> latenciesNs;
+		latenciesNs.reserve( rounds );
+		auto start = std::chrono::steady_clock::now();
+		for ( size_t i=0; i<rounds; ++i )
+		{
+			WorkerMessage response;
+			auto rqStart = std::chrono::steady_clock::now();
+			co_await getCluster().a_request( peer, Ping, payload.data(), size, response );
+			latenciesNs.push_back( (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - rqStart ).count() );
+			if ( response.size != size )
+				++errors;
+		}
+		uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		std::sort( latenciesNs.begin(), latenciesNs.end() );
+		auto percentile = [&latenciesNs]( double p ) { return latenciesNs.empty() ? 0 : latenciesNs[ (size_t)( p * ( latenciesNs.size() - 1 ) ) ]; };
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "ping-pong, {} bytes: {} round trips/s", size, rounds * 1e9 / ns );
+		printf( "ping-pong, %5zu bytes: %8.0f round trips/s; round trip, ns: p50 %u, p99 %u, p99.9 %u, max %u\n", size, rounds * 1e9 / ns, percentile( 0.5 ), percentile( 0.99 ), percentile( 0.999 ), percentile( 1.0 ) );
+		CO_RETURN;
+	}
+
+	nodecpp::handler_ret_type bulk( ThreadID peer, size_t size )
+	{
+		static constexpr size_t window = 64; // posts in flight before waiting for the worker to catch up
+		std::vector<uint8_t> pattern( size );
+		for ( size_t i=0; i<size; ++i )
+			pattern[i] = (uint8_t)( i * 31 );
+		size_t count = std::max( bulkBytes / size, (size_t)1 );
+		uint64_t receivedBefore = 0;
+		WorkerMessage response;
+		co_await getCluster().a_request( peer, Sync, nullptr, 0, response );
+		memcpy( &receivedBefore, response.data, sizeof(receivedBefore) );
+
+		auto start = std::chrono::steady_clock::now();
+		for ( size_t i=0; i<count; ++i )
+		{
+			bool sent;
+			if ( size <= Cluster::maxInlinePayload )
+				sent = getCluster().postMessage( peer, Bulk, pattern.data(), size );
+			else
+			{
+				Buffer b( size ); // as if produced right here; the worker reads it in place
+				b.append( pattern.data(), size );
+				sent = getCluster().postMessage( peer, Bulk, std::move( b ) );
+			}
+			if ( !sent )
+				++errors;
+			if ( ( i + 1 ) % window == 0 || i + 1 == count )
+				co_await getCluster().a_request( peer, Sync, nullptr, 0, response );
+		}
+		uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		uint64_t received = 0;
+		memcpy( &received, response.data, sizeof(received) );
+		if ( received - receivedBefore != count * size )
+			++errors;
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "bulk, {} bytes per message: {} MB/s", size, count * size * 1e3 / ns );
+		printf( "bulk, %7zu bytes per message (%s): %9.0f messages/s, %6.0f MB/s\n", size, size <= Cluster::maxInlinePayload ? "inline" : "hand-off", count * 1e9 / ns, count * size * 1e3 / ns );
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,25 @@
+#!/bin/bash
+# usage: ./run_bench.sh [max workers] [duration]
+# builds: ./build/build_clang.sh (listener thread) and ./build/build_clang_reuseport.sh (accept in workers)
+# workers are pinned to CPUs 0..n-1 and wrk is run at the CPUs left; every request comes at a new connection
+# ('Connection: close'), so requests per second reported by wrk are connections per second
+
+maxworkers=${1:-4}
+duration=${2:-10s}
+cpus=$(nproc)
+
+for bin in server.bin server_reuseport.bin
+do
+	workers=1
+	while [ $workers -le $maxworkers ] && [ $workers -lt $cpus ]
+	do
+		./build/$bin numcores=$workers workercpus=0-$((workers - 1)) > /dev/null &
+		pid=$!
+		sleep 1
+		echo "$bin, $workers workers"
+		taskset -c $workers-$((cpus - 1)) wrk -t$((cpus - workers)) -c64 -d$duration -H "Connection: close" http://127.0.0.1:2000/ | grep -E "^Requests/sec|Socket errors|Latency"
+		kill $pid
+		wait $pid 2>/dev/null
+		workers=$((workers * 2))
+	done
+done
@@ -0,0 +1,7 @@
+// NetSocket.cpp : connection rate benchmark (clustered server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
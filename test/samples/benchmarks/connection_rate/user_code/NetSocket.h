@@ -0,0 +1,71 @@
+// NetSocket.h : connection rate benchmark (clustered server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		if ( getCluster().isMaster() ) 
+		{
+			size_t coreCnt = 1;
+			auto argv = getArgv();
+			for ( size_t i=1; i<argv.size(); ++i )
+			{
+				if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+					coreCnt = atol(argv[i].c_str() + 9);
+			}
+#ifdef NODECPP_ACCEPT_IN_WORKERS
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, each accepting at its own SO_REUSEPORT listener", coreCnt );
+#else
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, connections accepted by the listener thread", coreCnt );
+#endif // NODECPP_ACCEPT_IN_WORKERS
+
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+		{
+			// a single tiny response per connection (clients send 'Connection: close'), so that accepting and handing off dominate
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			srv->getRouter().get( "/", [](auto request, auto response) -> nodecpp::handler_ret_type {
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::string_literal( "Hello, world!\r\n" ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(2000, "0.0.0.0", 5000);
+		}
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,7 @@
+// NetSocket.cpp : EventEmitter::emit() benchmark
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,79 @@
+// NetSocket.h : EventEmitter::emit() benchmark; see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/event.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+	static constexpr size_t rounds = 10000000;
+	size_t calls = 0;
+
+	template<class F>
+	uint64_t measure( F&& f )
+	{
+		auto start = std::chrono::steady_clock::now();
+		for ( size_t i=0; i<rounds; ++i )
+			f();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+	}
+
+	void report( const char* what, size_t listenerCnt, uint64_t ns )
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} with {} listener(s): {} ns per emit", what, listenerCnt, (double)ns / rounds );
+		printf( "%-28s %zu listener(s): %6.2f ns per emit\n", what, listenerCnt, (double)ns / rounds );
+	}
+
+public:
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		for ( size_t listenerCnt : { 1, 2, 8 } )
+		{
+			{
+				EventEmitter<event::Drain> emitter;
+				for ( size_t i=0; i<listenerCnt; ++i )
+					emitter.on( [this]() { ++calls; } );
+				report( "emit()", listenerCnt, measure( [&emitter]() { emitter.emit(); } ) );
+			}
+			{
+				EventEmitter<event::Close> emitter; // with an argument
+				for ( size_t i=0; i<listenerCnt; ++i )
+					emitter.on( [this]( bool hadError ) { calls += hadError ? 2 : 1; } );
+				bool hadError = false;
+				report( "emit(bool)", listenerCnt, measure( [&emitter, &hadError]() { emitter.emit( hadError ); } ) );
+			}
+			{
+				EventEmitter<event::Drain> emitter; // a 'once' listener re-registered at each emit, as with one-shot waits
+				for ( size_t i=1; i<listenerCnt; ++i )
+					emitter.on( [this]() { ++calls; } );
+				report( "once() + emit()", listenerCnt, measure( [this, &emitter]() { emitter.once( [this]() { ++calls; } ); emitter.emit(); } ) );
+			}
+			{
+				// reference: calling a copy of the listener list at each emit (as EventEmitter did before)
+				nodecpp::vector<event::Drain::callback> callbacks;
+				for ( size_t i=0; i<listenerCnt; ++i )
+					callbacks.push_back( [this]() { ++calls; } );
+				report( "copy and call (reference)", listenerCnt, measure( [&callbacks]() { auto copy = callbacks; for ( auto& cb : copy ) cb(); } ) );
+			}
+		}
+		printf( "(%zu calls)\n", calls );
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,24 @@
+#!/bin/bash
+# usage: ./run_bench.sh [requests] [connections]
+# the server is run at CPU 0, h2load at CPUs 1-2; HTTP/2 (h2c with prior knowledge) with 1, 10 and 100 concurrent streams
+# per connection, and HTTP/1.1 (h2load --h1) with as many pipelined requests, for comparison
+
+requests=${1:-500000}
+conns=${2:-16}
+
+taskset -c 0 ./build/server.bin &
+pid=$!
+sleep 1
+for path in / /big
+do
+	n=$([ $path = / ] && echo $requests || echo $((requests / 10)))
+	for streams in 1 10 100
+	do
+		echo "HTTP/2, $path, $conns connections, $streams streams per connection"
+		taskset -c 1,2 h2load -t2 -c$conns -m$streams -n$n http://127.0.0.1:2000$path | grep -E "^finished|^requests:|^traffic:|^time for request"
+		echo "HTTP/1.1, $path, $conns connections, $streams pipelined requests per connection"
+		taskset -c 1,2 h2load --h1 -t2 -c$conns -m$streams -n$n http://127.0.0.1:2000$path | grep -E "^finished|^requests:|^traffic:|^time for request"
+	done
+done
+kill $pid
+wait $pid 2>/dev/null
@@ -0,0 +1,7 @@
+// NetSocket.cpp : HTTP/2 load benchmark (server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,74 @@
+// NetSocket.h : HTTP/2 load benchmark (server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+	Buffer bigBody;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		bool h2 = true;
+		size_t bigSize = 0x10000;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 3 && argv[i].substr(0,3) == "h2=" )
+				h2 = atol(argv[i].c_str() + 3) != 0;
+			else if ( argv[i].size() > 4 && argv[i].substr(0,4) == "big=" )
+				bigSize = atol(argv[i].c_str() + 4);
+		}
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "HTTP/2: {}; /big is {} bytes", h2 ? "on" : "off", bigSize );
+
+		bigBody = Buffer( bigSize );
+		for ( size_t i=0; i<bigSize; ++i )
+			bigBody.appendUint8( (int8_t)( 'a' + i % 26 ) );
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		srv->enableHttp2( h2 );
+		// small responses: per-stream overhead (HPACK, frames, scheduling) dominates
+		srv->getRouter().get( "/", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+			co_await response->end( nodecpp::string_literal( "Hello, world!\r\n" ) );
+			CO_RETURN;
+		} );
+		// large responses: flow control and DATA framing
+		srv->getRouter().get( "/big", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+			response->writeHead(200, {{"Content-Type", "application/octet-stream"}, {"Server", "node.cpp"}});
+			co_await response->end( BufferView( bigBody ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(2000, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,26 @@
+#!/bin/bash
+# usage: ./run_bench.sh [requests]
+# runs the http_server sample (test/experimental/http_server, to be built beforehand) at CPU 0 and the client at CPU 1
+# with and without pipelining; wrk with the same number of connections is run for comparison
+
+requests=${1:-200000}
+server=../../../experimental/http_server/build/server.bin
+
+taskset -c 0 $server &
+pid=$!
+sleep 1
+for depth in 1 8
+do
+	for conns in 1 8
+	do
+		echo "client: $conns connections, pipeline depth $depth"
+		taskset -c 1 ./build/client.bin requests=$requests conns=$conns depth=$depth workers=$((conns * depth * 2))
+	done
+done
+for conns in 1 8
+do
+	echo "wrk: $conns connections"
+	taskset -c 1 wrk -t1 -c$conns -d10s http://127.0.0.1:2000/
+done
+kill $pid
+wait $pid 2>/dev/null
@@ -0,0 +1,7 @@
+// NetSocket.cpp : HTTP client benchmark
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
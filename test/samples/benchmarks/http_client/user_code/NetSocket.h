@@ -0,0 +1,121 @@
+// NetSocket.h : HTTP client benchmark; see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_client.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+	nodecpp::safememory::owning_ptr<nodecpp::net::HttpClient> client;
+	nodecpp::string ip = "127.0.0.1";
+	uint16_t port = 2000;
+	nodecpp::string path = "/";
+	size_t total = 100000;
+	size_t issued = 0;
+	size_t errors = 0;
+	size_t bodyBytes = 0;
+	size_t workersRunning = 0;
+	std::vector<uint32_t> latenciesUs;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t workers = 64;
+		nodecpp::net::HttpClient::Options options;
+		options.maxConnectionsPerOrigin = 8;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 8 && argv[i].substr(0,8) == "workers=" )
+				workers = atol(argv[i].c_str() + 8);
+			else if ( argv[i].size() > 6 && argv[i].substr(0,6) == "conns=" )
+				options.maxConnectionsPerOrigin = atol(argv[i].c_str() + 6);
+			else if ( argv[i].size() > 6 && argv[i].substr(0,6) == "depth=" )
+				options.pipelineDepth = atol(argv[i].c_str() + 6);
+			else if ( argv[i].size() > 9 && argv[i].substr(0,9) == "requests=" )
+				total = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 3 && argv[i].substr(0,3) == "ip=" )
+				ip = argv[i].substr(3).c_str();
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "port=" )
+				port = (uint16_t)atol(argv[i].c_str() + 5);
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "path=" )
+				path = argv[i].substr(5).c_str();
+		}
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} requests to {}:{}{}; {} concurrent requests over at most {} connections, pipeline depth {}", total, ip, port, path, workers, options.maxConnectionsPerOrigin, options.pipelineDepth );
+
+		client = nodecpp::net::createHttpClient( options );
+		latenciesUs.reserve( total );
+		start = std::chrono::steady_clock::now();
+		workersRunning = workers;
+		for ( size_t i=0; i<workers; ++i )
+			requestLoop();
+
+		CO_RETURN;
+	}
+
+	// issues requests one after another till the total number is reached
+	nodecpp::handler_ret_type requestLoop()
+	{
+		nodecpp::net::HttpClientRequest req;
+		req.path = path;
+		Buffer body;
+		while ( issued < total )
+		{
+			++issued;
+			auto reqStart = std::chrono::steady_clock::now();
+			try
+			{
+				nodecpp::net::HttpClientResponse response;
+				co_await client->a_request( ip.c_str(), port, req, response );
+				co_await response.a_readAll( body );
+				if ( response.getStatusCode() == 200 )
+				{
+					bodyBytes += body.size();
+					latenciesUs.push_back( (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - reqStart ).count() );
+				}
+				else
+					++errors;
+			}
+			catch (...)
+			{
+				++errors;
+			}
+		}
+		if ( --workersRunning == 0 )
+			report();
+		CO_RETURN;
+	}
+
+	void report()
+	{
+		uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		std::sort( latenciesUs.begin(), latenciesUs.end() );
+		auto percentile = [this]( double p ) { return latenciesUs.empty() ? 0 : latenciesUs[ (size_t)( p * ( latenciesUs.size() - 1 ) ) ]; };
+		uint64_t sum = 0;
+		for ( auto l : latenciesUs )
+			sum += l;
+		double rps = latenciesUs.size() * 1e9 / ns;
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} responses ({} errors) in {} ms: {} req/s", latenciesUs.size(), errors, ns / 1000000, rps );
+		printf( "%zu responses, %zu errors, %zu body bytes in %.1f ms: %.0f req/s\n", latenciesUs.size(), errors, bodyBytes, ns / 1e6, rps );
+		printf( "latency, us: mean %.1f, p50 %u, p90 %u, p99 %u, max %u\n", latenciesUs.empty() ? 0. : (double)sum / latenciesUs.size(), percentile( 0.5 ), percentile( 0.9 ), percentile( 0.99 ), percentile( 1.0 ) );
+		exit( errors ? 1 : 0 ); // nothing else is to be run by the loop
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,156 @@
+// NetSocket.h : inter-thread message queue (MPSCBoundedQueue) benchmark; see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/logging.h>
+#include <clustering_impl/interthread_comm_impl.h>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+	struct Msg
+	{
+		size_t producer = 0;
+		uint64_t seq = 0;
+		int64_t sentNs = 0;
+		Msg() {}
+		Msg( size_t producer_, uint64_t seq_, int64_t sentNs_ ) : producer( producer_ ), seq( seq_ ), sentNs( sentNs_ ) {}
+	};
+
+	// reference: what a queue with a lock looks like under the same load
+	class MutexQueue
+	{
+		std::mutex mx;
+		std::deque<Msg> items;
+	public:
+		bool push_back( Msg&& msg ) { std::unique_lock<std::mutex> lock(mx); items.push_back( std::move( msg ) ); return true; }
+		size_t pop_front( Msg* messages, size_t count )
+		{
+			std::unique_lock<std::mutex> lock(mx);
+			size_t i = 0;
+			for ( ; i < count && !items.empty(); ++i )
+			{
+				messages[i] = std::move( items.front() );
+				items.pop_front();
+			}
+			return i;
+		}
+	};
+
+	static int64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count(); }
+
+	size_t messagesPerProducer = 2000000;
+
+	// producerCnt threads push as fast as they can; this thread pops in batches, as the loop does
+	template<class Queue>
+	void throughput( const char* name, size_t producerCnt )
+	{
+		auto q = std::make_unique<Queue>();
+		std::atomic<bool> go{false};
+		std::vector<std::thread> producers;
+		for ( size_t p=0; p<producerCnt; ++p )
+			producers.emplace_back( [&q, &go, p, this]() {
+				while ( !go.load( std::memory_order_acquire ) )
+					;
+				for ( uint64_t i=0; i<messagesPerProducer; ++i )
+					while ( !q->push_back( Msg( p, i, 0 ) ) )
+						std::this_thread::yield();
+			} );
+		size_t total = producerCnt * messagesPerProducer;
+		size_t received = 0;
+		Msg batch[32];
+		int64_t start = nowNs();
+		go.store( true, std::memory_order_release );
+		while ( received < total )
+			received += q->pop_front( batch, 32 );
+		int64_t ns = nowNs() - start;
+		for ( auto& t : producers )
+			t.join();
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{}, {} producer(s): {} Mmsg/s", name, producerCnt, total * 1e3 / ns );
+		printf( "%-36s %zu producer(s): %7.2f Mmsg/s\n", name, producerCnt, total * 1e3 / ns );
+	}
+
+	// each of producerCnt threads sends a message every intervalNs (a load the consumer keeps up with); latency is from push to pop
+	template<class Queue>
+	void latency( const char* name, size_t producerCnt )
+	{
+		static constexpr size_t samplesPerProducer = 100000;
+		static constexpr int64_t intervalNs = 2000;
+		auto q = std::make_unique<Queue>();
+		std::vector<std::thread> producers;
+		for ( size_t p=0; p<producerCnt; ++p )
+			producers.emplace_back( [&q, p]() {
+				int64_t next = nowNs();
+				for ( uint64_t i=0; i<samplesPerProducer; ++i )
+				{
+					while ( nowNs() < next )
+						;
+					next += intervalNs;
+					while ( !q->push_back( Msg( p, i, nowNs() ) ) )
+						std::this_thread::yield();
+				}
+			} );
+		size_t total = producerCnt * samplesPerProducer;
+		std::vector<uint32_t> latencies;
+		latencies.reserve( total );
+		Msg batch[32];
+		while ( latencies.size() < total )
+		{
+			size_t cnt = q->pop_front( batch, 32 );
+			int64_t now = nowNs();
+			for ( size_t i=0; i<cnt; ++i )
+				latencies.push_back( (uint32_t)( now - batch[i].sentNs ) );
+		}
+		for ( auto& t : producers )
+			t.join();
+		std::sort( latencies.begin(), latencies.end() );
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{}, {} producer(s): latency p50 {} ns, p99 {} ns", name, producerCnt, latencies[total / 2], latencies[total * 99 / 100] );
+		printf( "%-36s %zu producer(s): latency p50 %6u ns, p99 %7u ns, p99.9 %8u ns\n", name, producerCnt, latencies[total / 2], latencies[total * 99 / 100], latencies[total * 999 / 1000] );
+	}
+
+public:
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t maxProducers = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 10 && argv[i].substr(0,10) == "producers=" )
+				maxProducers = atol(argv[i].c_str() + 10);
+			else if ( argv[i].size() > 9 && argv[i].substr(0,9) == "messages=" )
+				messagesPerProducer = atol(argv[i].c_str() + 9);
+		}
+
+		for ( size_t producerCnt=1; producerCnt<=maxProducers; producerCnt*=2 )
+		{
+			throughput<MPSCBoundedQueue<Msg, 64, QueueOverflowPolicy::spill>>( "ring of 64, spill (as MsgQueue)", producerCnt );
+			throughput<MPSCBoundedQueue<Msg, 1024, QueueOverflowPolicy::spill>>( "ring of 1024, spill", producerCnt );
+			throughput<MPSCBoundedQueue<Msg, 1024, QueueOverflowPolicy::reject>>( "ring of 1024, reject (and retry)", producerCnt );
+			throughput<MutexQueue>( "std::deque with std::mutex", producerCnt );
+		}
+		for ( size_t producerCnt=1; producerCnt<=maxProducers; producerCnt*=2 )
+		{
+			latency<MPSCBoundedQueue<Msg, 64, QueueOverflowPolicy::spill>>( "ring of 64, spill (as MsgQueue)", producerCnt );
+			latency<MutexQueue>( "std::deque with std::mutex", producerCnt );
+		}
+		exit( 0 ); // nothing else is to be run by the loop
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
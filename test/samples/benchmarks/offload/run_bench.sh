@@ -0,0 +1,29 @@
+#!/bin/bash
+# usage: ./run_bench.sh [offload threads] [duration, s]
+# the server (a single worker and a pool of N offload threads) is run at CPUs 0..N, and wrk at the CPUs after them.
+# CPU-heavy requests (/heavy, 1 ms of CPU each) are loaded together with light ones (/); with heavy work done at the
+# loop, light requests wait for it; with offload=1 they do not, and heavy ones are spread over pool threads.
+# Then work=0 measures the bare cost of an offload round trip. Pool statistics are taken from /stats.
+
+threads=${1:-4}
+duration=${2:-10}
+cpus=$(nproc)
+wrkcpus=$((threads + 1))-$((cpus - 1))
+
+for mode in "offload=0 work=1000" "offload=1 work=1000" "offload=1 work=0"
+do
+	taskset -c 0-$threads ./build/server.bin $mode offloadthreads=$threads > /dev/null &
+	pid=$!
+	sleep 1
+	echo "$mode, $threads offload threads"
+	taskset -c $wrkcpus wrk -t1 -c32 -d${duration}s http://127.0.0.1:2000/heavy > heavy.txt &
+	heavypid=$!
+	taskset -c $wrkcpus wrk -t1 -c32 -d${duration}s --latency http://127.0.0.1:2000/ | grep -E "^Requests/sec|^ +(50|99)%"
+	wait $heavypid
+	echo "heavy:"
+	grep -E "^Requests/sec|Non-2xx" heavy.txt
+	rm heavy.txt
+	curl -s http://127.0.0.1:2000/stats
+	kill $pid
+	wait $pid 2>/dev/null
+done
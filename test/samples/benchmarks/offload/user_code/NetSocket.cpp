@@ -0,0 +1,7 @@
+// NetSocket.cpp : offload pool benchmark (clustered server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,115 @@
+// NetSocket.h : offload pool benchmark (clustered server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/offload.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+	uint64_t heavyWorkUs = 1000;
+	bool useOffload = true;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	// stands for hashing a password and the like
+	static uint64_t cpuHeavyWork( uint64_t us )
+	{
+		auto start = std::chrono::steady_clock::now();
+		uint64_t x = 0;
+		while ( std::chrono::steady_clock::now() - start < std::chrono::microseconds( us ) )
+			for ( size_t i=0; i<1000; ++i )
+				x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		return x;
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t coreCnt = 1;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+				coreCnt = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "work=" )
+				heavyWorkUs = atol(argv[i].c_str() + 5);
+			else if ( argv[i].size() > 8 && argv[i].substr(0,8) == "offload=" )
+				useOffload = atol(argv[i].c_str() + 8) != 0;
+		}
+
+		if ( getCluster().isMaster() ) 
+		{
+			// offloadthreads= and offloadqueue= are taken from the command line by the pool itself
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers; /heavy takes {} us of CPU, {}", coreCnt, heavyWorkUs, useOffload ? "at the offload pool" : "at the event loop" );
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+		{
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			srv->getRouter().get( "/", [](auto request, auto response) -> nodecpp::handler_ret_type {
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::string_literal( "Hello, world!\r\n" ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().get( "/heavy", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+				uint64_t x;
+				if ( useOffload )
+				{
+					try
+					{
+						uint64_t us = heavyWorkUs;
+						x = co_await nodecpp::offload( [us]() { return cpuHeavyWork( us ); } );
+					}
+					catch (...) // the pool queue is full
+					{
+						response->writeHead(503, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+						co_await response->end( nodecpp::string_literal( "Busy\r\n" ) );
+						CO_RETURN;
+					}
+				}
+				else
+					x = cpuHeavyWork( heavyWorkUs );
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::format( "{}\r\n", x ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().get( "/stats", [](auto request, auto response) -> nodecpp::handler_ret_type {
+				OffloadStats stats = getOffloadStats();
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::format( "offload pool: {} threads, {} completed, {} rejected, {} queued now; queue latency avg {} us, max {} us; run time avg {} us\r\n",
+					stats.threads, stats.completed, stats.rejected, stats.queued, stats.avgQueueLatencyUs, stats.maxQueueLatencyUs, stats.avgRunTimeUs ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(2000, "0.0.0.0", 5000);
+		}
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
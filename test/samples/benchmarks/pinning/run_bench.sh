@@ -0,0 +1,31 @@
+#!/bin/bash
+# usage: ./run_bench.sh [workers] [duration, s] [server CPUs]
+# the server is run at 'server CPUs' (by default 0..workers; on a multi-node machine, list CPUs of several nodes)
+# and wrk at the CPUs after the last of them. The server is run unpinned, then with workers pinned (workercpus=auto:
+# one per available CPU) and the listener isolated at the last server CPU. Cross-node memory traffic of the server
+# is counted by perf stat (node-load/store misses are accesses served by another node) and shown by numastat; on a
+# single-node machine both show next to nothing, and only throughput is of interest
+
+workers=${1:-8}
+duration=${2:-10}
+servercpus=${3:-0-$workers}
+cpus=$(nproc)
+listenercpu=${servercpus##*[,-]}
+wrkcpus=$((listenercpu + 1))-$((cpus - 1))
+
+for pinning in "" "workercpus=auto listenercpus=$listenercpu isolatelistener=1"
+do
+	taskset -c $servercpus ./build/server.bin numcores=$workers $pinning > /dev/null &
+	pid=$!
+	sleep 2
+	echo "${pinning:-no pinning}, $workers workers at CPUs $servercpus"
+	perf stat -e node-loads,node-load-misses,node-stores,node-store-misses -p $pid -- sleep $duration 2> perf.txt &
+	perfpid=$!
+	taskset -c $wrkcpus wrk -t4 -c256 -d${duration}s http://127.0.0.1:2000/ | grep -E "^Requests/sec|Latency|Transfer/sec"
+	wait $perfpid
+	grep -E "node-" perf.txt
+	rm perf.txt
+	numastat -p $pid | tail -n 4
+	kill $pid
+	wait $pid 2>/dev/null
+done
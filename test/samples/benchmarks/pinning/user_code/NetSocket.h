@@ -0,0 +1,88 @@
+// NetSocket.h : CPU pinning benchmark (clustered server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	// worker-local data each request reads a part of; it is allocated (and first touched) by the worker thread, so it is
+	// local to the NUMA node the worker runs at, unless the worker is moved to another node later
+	std::vector<uint64_t> table;
+	size_t scanSize = 0x1000; // items read per request
+	size_t scanPos = 0;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t coreCnt = 1;
+		size_t tableSize = 0x100000 * 4; // 32 MB per worker; larger than caches
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+				coreCnt = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 6 && argv[i].substr(0,6) == "table=" ) // MB
+				tableSize = atol(argv[i].c_str() + 6) * 0x100000 / sizeof(uint64_t);
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "scan=" ) // KB
+				scanSize = atol(argv[i].c_str() + 5) * 0x400 / sizeof(uint64_t);
+		}
+
+		if ( getCluster().isMaster() ) 
+		{
+			// workercpus=, listenercpus= and isolatelistener= are taken from the command line by the cluster itself
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, {} MB of data per worker, {} KB read per request", coreCnt, tableSize * sizeof(uint64_t) / 0x100000, scanSize * sizeof(uint64_t) / 0x400 );
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+		{
+			table.resize( tableSize );
+			for ( size_t i=0; i<tableSize; ++i )
+				table[i] = i * 2654435761ULL;
+			if ( scanSize > tableSize )
+				scanSize = tableSize;
+
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			srv->getRouter().get( "/", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+				uint64_t sum = 0;
+				for ( size_t i=0; i<scanSize; ++i )
+					sum += table[( scanPos + i ) % table.size()];
+				scanPos = ( scanPos + scanSize ) % table.size();
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::format( "{}\r\n", sum ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(2000, "0.0.0.0", 5000);
+		}
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
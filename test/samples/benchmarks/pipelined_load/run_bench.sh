@@ -0,0 +1,17 @@
+#!/bin/bash
+# usage: ./run_bench.sh [duration] [connections]
+# the server is run at CPU 0, wrk at CPUs 1-2
+
+duration=${1:-10s}
+conns=${2:-64}
+
+for depth in 1 4 16 64
+do
+	taskset -c 0 ./build/server.bin depth=$depth &
+	pid=$!
+	sleep 1
+	echo "depth $depth"
+	taskset -c 1,2 wrk -t2 -c$conns -d$duration -s pipeline.lua http://127.0.0.1:2000/ -- $depth
+	kill $pid
+	wait $pid 2>/dev/null
+done
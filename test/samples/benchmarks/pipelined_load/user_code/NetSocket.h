@@ -0,0 +1,69 @@
+// NetSocket.h : pipelined load benchmark (server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	uint64_t rqCnt = 0;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t depth = 16;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 6 && argv[i].substr(0,6) == "depth=" )
+				depth = atol(argv[i].c_str() + 6);
+		}
+		if ( depth == 0 )
+			depth = 1;
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "pipeline depth: {}", depth );
+
+		// requests are handled by a handler rather than by a single a_request() loop so that requests pipelined at a connection are processed concurrently
+		nodecpp::net::HttpServerBase::addHttpHandler<ServerType, nodecpp::net::HttpServerBase::Handler::IncomingRequest, &MySampleTNode::onRequest>(this);
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		srv->setPipelineDepth( depth );
+		srv->listen(2000, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+
+	virtual nodecpp::handler_ret_type onRequest(nodecpp::safememory::soft_ptr<ServerType> server, nodecpp::safememory::soft_ptr<nodecpp::net::IncomingHttpMessageAtServer> request, nodecpp::safememory::soft_ptr<nodecpp::net::HttpServerResponse> response)
+	{
+		++rqCnt;
+		response->writeHead(200, {{"Content-Type", "text/plain"}});
+		co_await response->end( nodecpp::string_literal( "Hello, World!" ) );
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
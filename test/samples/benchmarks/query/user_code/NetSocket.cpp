@@ -0,0 +1,7 @@
+// NetSocket.cpp : query string parsing benchmark
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
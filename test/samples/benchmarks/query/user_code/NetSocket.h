@@ -0,0 +1,83 @@
+// NetSocket.h : query string parsing benchmark; see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/url.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+	static constexpr size_t rounds = 1000000;
+	size_t sink = 0; // keeps results alive
+
+	template<class F>
+	uint64_t measure( F&& f )
+	{
+		auto start = std::chrono::steady_clock::now();
+		for ( size_t i=0; i<rounds; ++i )
+			f();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+	}
+
+	void report( const char* what, const char* urlKind, uint64_t ns )
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} ({} URL): {} ns per URL", what, urlKind, (double)ns / rounds );
+		printf( "%-34s %-8s URL: %8.2f ns per URL\n", what, urlKind, (double)ns / rounds );
+	}
+
+public:
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		struct UrlSample { const char* kind; nodecpp::string url; };
+		nodecpp::string longUrl = "/list?";
+		for ( size_t i=0; i<30; ++i )
+			longUrl += nodecpp::format( "param{}=value%20{}&", i, i );
+		longUrl += "q=last+one&page=3&sort=name";
+		UrlSample samples[] = {
+			{ "short", "/search?q=node&page=2" },
+			{ "typical", "/api/items?q=caf%C3%A9+latte&page=2&limit=50&sort=-date&fields=id,name,price&lang=en&utm_source=mail&sort=name" },
+			{ "long", longUrl },
+		};
+
+		for ( auto& sample : samples )
+		{
+			const nodecpp::string& url = sample.url;
+			// what a typical handler does: look up a few keys and decode one of values
+			report( "UrlQueryView", sample.kind, measure( [this, &url]() {
+				nodecpp::UrlQueryView view( url );
+				std::string_view q, page, sort;
+				view.get( "q", q );
+				view.get( "page", page );
+				view.get( "sort", sort );
+				char decoded[64];
+				sink += ( q.size() <= sizeof(decoded) ? nodecpp::UrlQueryView::decode( q, decoded ) : 0 ) + page.size() + sort.size();
+			} ) );
+			report( "UrlQueryView::forEach()", sample.kind, measure( [this, &url]() {
+				nodecpp::UrlQueryView view( url );
+				view.forEach( [this]( const nodecpp::UrlQueryView::Item& item ) { sink += item.value.size(); } );
+			} ) );
+			report( "Url::parseUrlQueryString()", sample.kind, measure( [this, &url]() {
+				nodecpp::UrlQuery query = nodecpp::Url::parseUrlQueryString( url );
+				sink += query["q"].toStr().size() + query["page"].toStr().size() + query["sort"].toStr().size();
+			} ) );
+		}
+		printf( "(%zu)\n", sink );
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
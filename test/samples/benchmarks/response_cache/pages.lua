@@ -0,0 +1,10 @@
+-- requests /page?id=<n> for random n of <keys> distinct values: wrk ... -s pages.lua <url> -- <keys>
+
+init = function(args)
+	keys = tonumber(args[1]) or 10
+	math.randomseed(os.time())
+end
+
+request = function()
+	return wrk.format(nil, "/page?id=" .. math.random(1, keys))
+end
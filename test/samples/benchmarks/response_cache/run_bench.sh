@@ -0,0 +1,21 @@
+#!/bin/bash
+# usage: ./run_bench.sh [duration] [connections]
+# the server is run at CPU 0, wrk at CPUs 1-2; with 10 distinct keys nearly all requests are cache hits,
+# with 100000 keys most of them are misses (the cost of keeping the cache)
+
+duration=${1:-10s}
+conns=${2:-64}
+
+for keys in 10 100000
+do
+	for cache in 0 1
+	do
+		taskset -c 0 ./build/server.bin cache=$cache &
+		pid=$!
+		sleep 1
+		echo "cache=$cache, $keys keys"
+		taskset -c 1,2 wrk -t2 -c$conns -d$duration -s pages.lua http://127.0.0.1:2000/ -- $keys
+		kill $pid
+		wait $pid 2>/dev/null
+	done
+done
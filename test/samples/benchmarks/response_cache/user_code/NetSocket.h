@@ -0,0 +1,84 @@
+// NetSocket.h : response cache benchmark (server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/url.h>
+#include <nodecpp/logging.h>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	uint64_t rendered = 0;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	// stands for a handler doing real work (e.g. templating data taken from a database): a page of 200 table rows
+	nodecpp::string renderPage( std::string_view id )
+	{
+		++rendered;
+		nodecpp::string page = "<html><body><table>\r\n";
+		for ( size_t i=0; i<200; ++i )
+			page += nodecpp::format( "<tr><td>{}</td><td>item {} of page {}</td><td>{}</td></tr>\r\n", i, i, id, ( i * 7919 ) % 1000 );
+		page += "</table></body></html>\r\n";
+		return page;
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		bool cache = true;
+		size_t ttlMs = 1000;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 6 && argv[i].substr(0,6) == "cache=" )
+				cache = atol(argv[i].c_str() + 6) != 0;
+			else if ( argv[i].size() > 4 && argv[i].substr(0,4) == "ttl=" )
+				ttlMs = atol(argv[i].c_str() + 4);
+		}
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "response cache: {}, ttl {} ms", cache ? "on" : "off", ttlMs );
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		if ( cache )
+		{
+			nodecpp::net::HttpResponseCache::Options options;
+			options.ttlMs = ttlMs;
+			srv->enableResponseCache( std::move( options ) );
+		}
+		srv->getRouter().get( "/page", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+			nodecpp::UrlQueryView query( request->getUrl() );
+			std::string_view id;
+			query.get( "id", id );
+			response->writeHead(200, {{"Content-Type", "text/html"}});
+			co_await response->end( renderPage( id ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(2000, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
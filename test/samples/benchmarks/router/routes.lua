@@ -0,0 +1,11 @@
+-- requests paths of random routes of the router benchmark: wrk ... -s routes.lua <url> -- <routes>
+
+init = function(args)
+	routes = tonumber(args[1]) or 500
+	math.randomseed(os.time())
+end
+
+request = function()
+	local i = math.random(0, routes - 1)
+	return wrk.format(nil, string.format("/api/v%d/resource%d/%d", i % 4, i, i * 7))
+end
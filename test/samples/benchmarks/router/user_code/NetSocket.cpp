@@ -0,0 +1,7 @@
+// NetSocket.cpp : router benchmark (server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,89 @@
+// NetSocket.h : router benchmark (server with many routes); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	// route i is "/api/v<i % 4>/resource<i>/:id"; see routes.lua
+	static nodecpp::string pattern( size_t i ) { return nodecpp::format( "/api/v{}/resource{}/:id", i % 4, i ); }
+	static nodecpp::string path( size_t i ) { return nodecpp::format( "/api/v{}/resource{}/{}", i % 4, i, i * 7 ); }
+
+	// match() alone, over all routes in turn
+	void measureMatching( const nodecpp::net::HttpRouter& router, size_t routeCnt )
+	{
+		nodecpp::vector<nodecpp::string> paths;
+		for ( size_t i=0; i<routeCnt; ++i )
+			paths.push_back( path( i ) );
+		paths.push_back( "/api/v0/none/1" ); // and a miss
+
+		constexpr size_t rounds = 1000000;
+		nodecpp::net::HttpRouteParams params;
+		size_t matchedCnt = 0;
+		auto start = std::chrono::steady_clock::now();
+		for ( size_t i=0; i<rounds; ++i )
+			if ( router.match( "GET", paths[ i % paths.size() ], params ) != nullptr )
+				++matchedCnt;
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} routes: {} matches ({} matched) in {} ns, {} ns per match", routeCnt, rounds, matchedCnt, ns, ns / rounds );
+		printf( "%zu routes: %zu ns per match\n", routeCnt, (size_t)(ns / rounds) );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t routeCnt = 500;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 7 && argv[i].substr(0,7) == "routes=" )
+				routeCnt = atol(argv[i].c_str() + 7);
+		}
+		if ( routeCnt == 0 )
+			routeCnt = 1;
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		nodecpp::net::HttpRouter& router = srv->getRouter();
+		for ( size_t i=0; i<routeCnt; ++i )
+			router.get( pattern( i ).c_str(), [](auto request, auto response) -> nodecpp::handler_ret_type {
+				response->writeHead(200, {{"Content-Type", "text/plain"}});
+				co_await response->end( nodecpp::string( request->getParam( "id" ) ) );
+				CO_RETURN;
+			} );
+		router.build();
+
+		measureMatching( router, routeCnt );
+
+		srv->listen(2000, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,30 @@
+#!/bin/bash
+# usage: ./run_bench.sh [workers] [heavy connections] [light connections] [duration, s]
+# workers are pinned to CPUs 0..n-1 and wrk is run at the CPUs left. A few connections requesting /heavy (CPU-bound,
+# see work=) are opened first; then many connections requesting / (light) are opened while they run. With the least
+# connections policy light connections are spread evenly, also to workers busy with heavy ones; latency of light
+# requests shows how well the other policy avoids them
+
+workers=${1:-4}
+heavy=${2:-2}
+light=${3:-128}
+duration=${4:-10}
+cpus=$(nproc)
+
+for policy in connections p2c
+do
+	./build/server.bin numcores=$workers workercpus=0-$((workers - 1)) policy=$policy work=1000 > /dev/null &
+	pid=$!
+	sleep 1
+	taskset -c $workers-$((cpus - 1)) wrk -t1 -c$heavy -d$((duration + 2))s http://127.0.0.1:2000/heavy > heavy.txt &
+	heavypid=$!
+	sleep 1 # let heavy connections land first, and workers publish their load
+	echo "policy=$policy, $workers workers, $heavy heavy and $light light connections"
+	taskset -c $workers-$((cpus - 1)) wrk -t2 -c$light -d${duration}s --latency http://127.0.0.1:2000/ | grep -E "^Requests/sec|^ +(50|90|99)%|Latency"
+	wait $heavypid
+	echo "heavy:"
+	grep -E "^Requests/sec" heavy.txt
+	rm heavy.txt
+	kill $pid
+	wait $pid 2>/dev/null
+done
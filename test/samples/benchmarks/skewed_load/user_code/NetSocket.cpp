@@ -0,0 +1,7 @@
+// NetSocket.cpp : skewed load benchmark (clustered server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
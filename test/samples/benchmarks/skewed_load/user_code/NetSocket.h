@@ -0,0 +1,86 @@
+// NetSocket.h : skewed load benchmark (clustered server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+	uint64_t heavyWorkUs = 1000;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t coreCnt = 1;
+		bool p2c = false;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+				coreCnt = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 7 && argv[i].substr(0,7) == "policy=" )
+				p2c = argv[i].substr(7) == "p2c";
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "work=" )
+				heavyWorkUs = atol(argv[i].c_str() + 5);
+		}
+
+		if ( getCluster().isMaster() ) 
+		{
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, worker selection: {}; /heavy takes {} us of CPU", coreCnt, p2c ? "power of two choices over published load metrics" : "least connections", heavyWorkUs );
+			if ( p2c )
+				getCluster().setSchedulingPolicy( WorkerSelectionPolicy::powerOfTwoChoices );
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+		{
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			srv->getRouter().get( "/", [](auto request, auto response) -> nodecpp::handler_ret_type {
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::string_literal( "Hello, world!\r\n" ) );
+				CO_RETURN;
+			} );
+			// keeps the loop busy for heavyWorkUs; a few connections requesting it make their workers much busier than the others
+			srv->getRouter().get( "/heavy", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+				auto start = std::chrono::steady_clock::now();
+				uint64_t x = 0;
+				while ( std::chrono::steady_clock::now() - start < std::chrono::microseconds( heavyWorkUs ) )
+					for ( size_t i=0; i<1000; ++i )
+						x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( nodecpp::format( "{}\r\n", x ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(2000, "0.0.0.0", 5000);
+		}
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
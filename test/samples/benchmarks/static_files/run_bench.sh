@@ -0,0 +1,30 @@
+#!/bin/bash
+# usage: ./run_bench.sh [duration] [connections]
+# creates www/ with files of 1 KB, 64 KB and 10 MB, then loads the server (at CPU 0) with wrk (at CPUs 1-2) for each file:
+# served from file (/files/), revalidated by If-None-Match (304), and served from memory (/mem/) for comparison
+
+duration=${1:-10s}
+conns=${2:-32}
+
+mkdir -p www
+[ -f www/small.html ] || head -c 1024 /dev/urandom | base64 -w 0 | head -c 1024 > www/small.html
+[ -f www/medium.bin ] || head -c 65536 /dev/urandom > www/medium.bin
+[ -f www/large.bin ] || head -c 10485760 /dev/urandom > www/large.bin
+
+taskset -c 0 ./build/server.bin root=www &
+pid=$!
+sleep 1
+
+for name in small.html medium.bin large.bin
+do
+	echo "$name from file"
+	taskset -c 1,2 wrk -t2 -c$conns -d$duration http://127.0.0.1:2000/files/$name
+	etag=$(curl -sI http://127.0.0.1:2000/files/$name | tr -d '\r' | sed -n 's/^[Ee][Tt][Aa][Gg]: //p')
+	echo "$name revalidated (If-None-Match: $etag)"
+	taskset -c 1,2 wrk -t2 -c$conns -d$duration -H "If-None-Match: $etag" http://127.0.0.1:2000/files/$name
+	echo "$name from memory"
+	taskset -c 1,2 wrk -t2 -c$conns -d$duration http://127.0.0.1:2000/mem/$name
+done
+
+kill $pid
+wait $pid 2>/dev/null
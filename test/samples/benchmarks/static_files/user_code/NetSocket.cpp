@@ -0,0 +1,7 @@
+// NetSocket.cpp : static file serving benchmark (server)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,93 @@
+// NetSocket.h : static file serving benchmark (server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/http_static.h>
+#include <nodecpp/logging.h>
+#include <cstdio>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+	nodecpp::safememory::owning_ptr<nodecpp::net::HttpStaticFiles> staticFiles;
+
+	// the same files, read at startup and sent from memory, for comparison
+	static constexpr const char* fileNames[] = { "small.html", "medium.bin", "large.bin" };
+	Buffer inMemory[sizeof(fileNames) / sizeof(fileNames[0])];
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	void readFile( const nodecpp::string& path, Buffer& b )
+	{
+		FILE* f = fopen( path.c_str(), "rb" );
+		if ( f == nullptr )
+		{
+			nodecpp::log::default_log::warning( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "cannot open {}", path );
+			return;
+		}
+		uint8_t chunk[0x10000];
+		size_t sz;
+		while ( ( sz = fread( chunk, 1, sizeof(chunk), f ) ) != 0 )
+			b.append( chunk, sz );
+		fclose( f );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		nodecpp::net::HttpStaticFiles::Options options;
+		options.root = "www";
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 5 && argv[i].substr(0,5) == "root=" )
+				options.root = argv[i].substr(5);
+		}
+
+		for ( size_t i=0; i<sizeof(fileNames) / sizeof(fileNames[0]); ++i )
+			readFile( options.root + "/" + fileNames[i], inMemory[i] );
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		staticFiles = nodecpp::safememory::make_owning<nodecpp::net::HttpStaticFiles>( options );
+		staticFiles->mount( srv->getRouter(), "/files" ); // /files/<name>: from file, by sendfile()
+		srv->getRouter().get( "/mem/:name", [this](auto request, auto response) -> nodecpp::handler_ret_type { // /mem/<name>: from memory
+			std::string_view name = request->getParam( "name" );
+			for ( size_t i=0; i<sizeof(fileNames) / sizeof(fileNames[0]); ++i )
+				if ( name == fileNames[i] )
+				{
+					response->writeHead(200, {{"Content-Type", "application/octet-stream"}});
+					co_await response->end( BufferView( inMemory[i] ) );
+					CO_RETURN;
+				}
+			response->writeHead(404, {{"Content-Type", "text/plain"}});
+			co_await response->end( nodecpp::string_literal( "not found" ) );
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(2000, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
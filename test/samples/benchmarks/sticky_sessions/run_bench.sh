@@ -0,0 +1,22 @@
+#!/bin/bash
+# usage: ./run_bench.sh [workers] [clients] [rounds]
+# workers are pinned to CPUs 0..n-1, the client is run at the CPUs left; each worker keeps state of up to
+# 'clients' / 'workers' * 1.5 clients, so that all of them fit into workers when each client sticks to one worker
+# (sticky=1), but not when every worker sees every client (sticky=0)
+
+workers=${1:-4}
+clients=${2:-2000}
+rounds=${3:-10}
+cpus=$(nproc)
+capacity=$((clients * 3 / 2 / workers))
+
+for sticky in 0 1
+do
+	./build/server.bin numcores=$workers workercpus=0-$((workers - 1)) sticky=$sticky capacity=$capacity > /dev/null &
+	pid=$!
+	sleep 1
+	echo "sticky=$sticky, $workers workers, $clients clients, up to $capacity sessions per worker"
+	taskset -c $workers-$((cpus - 1)) python3 sticky_client.py clients=$clients rounds=$rounds
+	kill $pid
+	wait $pid 2>/dev/null
+done
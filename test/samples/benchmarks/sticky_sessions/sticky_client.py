@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# sticky_client.py : reconnecting clients for the sticky sessions benchmark; see ../README.txt
+#
+# Each of 'clients' simulated clients has its own source address in 127.0.0.0/8 (Linux accepts any of them at
+# loopback), as distribution by client address sees nothing but 127.0.0.1 otherwise. Clients make 'rounds' requests
+# each, one per connection; the server answers 'hit' if the worker that got the connection has the client's state.
+# Prints the hit rate, requests per second and latency percentiles.
+
+import socket
+import sys
+import threading
+import time
+
+def arg(name, default):
+	for a in sys.argv[1:]:
+		if a.startswith(name + '='):
+			return type(default)(a[len(name) + 1:])
+	return default
+
+host = arg('ip', '127.0.0.1')
+port = arg('port', 2000)
+clientCnt = arg('clients', 2000)
+rounds = arg('rounds', 10)
+threadCnt = arg('threads', 16)
+
+def sourceAddress(k):
+	k += 1 # 127.0.0.0 is not used
+	return '127.%d.%d.%d' % ((k >> 16) & 0xff, (k >> 8) & 0xff, k & 0xff)
+
+def oneRequest(k):
+	s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+	s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+	s.bind((sourceAddress(k), 0))
+	s.connect((host, port))
+	s.sendall(('GET /session?id=%d HTTP/1.1\r\nHost: %s:%d\r\nConnection: close\r\n\r\n' % (k, host, port)).encode())
+	data = b''
+	while True:
+		part = s.recv(4096)
+		if not part:
+			break
+		data += part
+		if data.endswith(b'\r\n\r\nhit\r\n') or data.endswith(b'\r\n\r\nmiss\r\n'):
+			break
+	s.close()
+	if data.endswith(b'hit\r\n'):
+		return True
+	if data.endswith(b'miss\r\n'):
+		return False
+	raise Exception('unexpected response: %r' % data[:100])
+
+results = []
+lock = threading.Lock()
+
+def run(first):
+	hits = misses = errors = 0
+	latencies = []
+	for r in range(rounds):
+		for k in range(first, clientCnt, threadCnt):
+			start = time.perf_counter()
+			try:
+				if oneRequest(k):
+					hits += 1
+				else:
+					misses += 1
+				latencies.append(time.perf_counter() - start)
+			except Exception:
+				errors += 1
+	with lock:
+		results.append((hits, misses, errors, latencies))
+
+start = time.perf_counter()
+threads = [threading.Thread(target=run, args=(i,)) for i in range(threadCnt)]
+for t in threads:
+	t.start()
+for t in threads:
+	t.join()
+elapsed = time.perf_counter() - start
+
+hits = sum(r[0] for r in results)
+misses = sum(r[1] for r in results)
+errors = sum(r[2] for r in results)
+latencies = sorted(l for r in results for l in r[3])
+def percentile(p):
+	return latencies[int(p * (len(latencies) - 1))] * 1e6 if latencies else 0
+print('%d clients, %d rounds: %d hits, %d misses (hit rate %.1f%%, first requests of clients are misses anyway), %d errors' % (clientCnt, rounds, hits, misses, 100.0 * hits / max(hits + misses, 1), errors))
+print('%.0f requests/s; latency, us: p50 %.0f, p90 %.0f, p99 %.0f, max %.0f' % ((hits + misses) / elapsed, percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0)))
+sys.exit(1 if errors else 0)
@@ -0,0 +1,104 @@
+// NetSocket.h : sticky sessions benchmark (clustered server); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/url.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+#include <deque>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv; 
+
+	// worker-local per-client state, such as a decoded auth token; the oldest entry is evicted when capacity is reached
+	std::unordered_map<std::string, uint64_t> sessions;
+	std::deque<std::string> sessionOrder;
+	size_t capacity = 1000;
+	uint64_t missWorkUs = 200; // what it takes to rebuild the state
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		size_t coreCnt = 1;
+		bool sticky = false;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i].size() > 9 && argv[i].substr(0,9) == "numcores=" )
+				coreCnt = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 7 && argv[i].substr(0,7) == "sticky=" )
+				sticky = atol(argv[i].c_str() + 7) != 0;
+			else if ( argv[i].size() > 9 && argv[i].substr(0,9) == "capacity=" )
+				capacity = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "work=" )
+				missWorkUs = atol(argv[i].c_str() + 5);
+		}
+
+		if ( getCluster().isMaster() ) 
+		{
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} workers, distribution {}; up to {} sessions per worker, {} us to rebuild one", coreCnt, sticky ? "by client address" : "by load", capacity, missWorkUs );
+			for ( size_t i=0; i<coreCnt; ++i )
+				getCluster().fork();
+		}
+		else
+		{
+			srv = nodecpp::net::createHttpServer<ServerType>();
+			if ( sticky )
+				srv->setConnectionDistribution( nodecpp::net::ConnectionDistribution::byClientAddress );
+			srv->getRouter().get( "/session", [this](auto request, auto response) -> nodecpp::handler_ret_type {
+				nodecpp::UrlQueryView query( request->getUrl() );
+				std::string_view id;
+				query.get( "id", id );
+				std::string key( id );
+				bool hit = sessions.find( key ) != sessions.end();
+				if ( !hit )
+				{
+					auto start = std::chrono::steady_clock::now();
+					uint64_t x = 0;
+					while ( std::chrono::steady_clock::now() - start < std::chrono::microseconds( missWorkUs ) )
+						for ( size_t i=0; i<1000; ++i )
+							x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+					if ( sessions.size() >= capacity && !sessionOrder.empty() )
+					{
+						sessions.erase( sessionOrder.front() );
+						sessionOrder.pop_front();
+					}
+					sessions.emplace( key, x );
+					sessionOrder.push_back( std::move( key ) );
+				}
+				response->writeHead(200, {{"Content-Type", "text/plain"}, {"Server", "node.cpp"}});
+				co_await response->end( hit ? nodecpp::string_literal( "hit\r\n" ) : nodecpp::string_literal( "miss\r\n" ) );
+				CO_RETURN;
+			} );
+			srv->getRouter().build();
+			srv->listen(2000, "0.0.0.0", 5000);
+		}
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
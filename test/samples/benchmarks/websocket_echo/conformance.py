@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+# conformance.py : a subset of Autobahn|Testsuite cases (their numbers are given in brackets) run against the echo server
+# of this sample; needs nothing but python3, so it can be run offline.
+# usage: ./conformance.py [host] [port]
+
+import base64
+import hashlib
+import os
+import socket
+import struct
+import sys
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else '127.0.0.1'
+PORT = int(sys.argv[2]) if len(sys.argv) > 2 else 2000
+TIMEOUT = 2.0
+
+CONT, TEXT, BINARY, CLOSE, PING, PONG = 0x0, 0x1, 0x2, 0x8, 0x9, 0xA
+
+
+class Failure(Exception):
+	pass
+
+
+class Conn:
+	def __init__(self):
+		self.sock = socket.create_connection((HOST, PORT), timeout=TIMEOUT)
+		self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+		self.buf = b''
+		key = base64.b64encode(os.urandom(16)).decode()
+		self.sock.sendall(('GET /echo HTTP/1.1\r\nHost: %s:%d\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+			'Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n' % (HOST, PORT, key)).encode())
+		while b'\r\n\r\n' not in self.buf:
+			self.fill()
+		head, self.buf = self.buf.split(b'\r\n\r\n', 1)
+		lines = head.decode('latin-1').split('\r\n')
+		if not lines[0].startswith('HTTP/1.1 101'):
+			raise Failure('handshake: ' + lines[0])
+		accept = base64.b64encode(hashlib.sha1((key + '258EAFA5-E914-47DA-95CA-C5AB0DC85B11').encode()).digest()).decode()
+		headers = dict((k.strip().lower(), v.strip()) for k, v in (l.split(':', 1) for l in lines[1:]))
+		if headers.get('sec-websocket-accept') != accept:
+			raise Failure('handshake: wrong Sec-WebSocket-Accept')
+
+	def fill(self):
+		try:
+			data = self.sock.recv(65536)
+		except socket.timeout:
+			raise Failure('timeout')
+		except ConnectionResetError:
+			raise EOFError()
+		if not data:
+			raise EOFError()
+		self.buf += data
+
+	def read(self, n):
+		while len(self.buf) < n:
+			self.fill()
+		data, self.buf = self.buf[:n], self.buf[n:]
+		return data
+
+	def send(self, opcode, payload=b'', fin=True, rsv=0, mask=True, chop=0):
+		if isinstance(payload, str):
+			payload = payload.encode()
+		frame = bytes([(0x80 if fin else 0) | (rsv << 4) | opcode])
+		m = 0x80 if mask else 0
+		if len(payload) < 126:
+			frame += bytes([m | len(payload)])
+		elif len(payload) <= 0xFFFF:
+			frame += bytes([m | 126]) + struct.pack('!H', len(payload))
+		else:
+			frame += bytes([m | 127]) + struct.pack('!Q', len(payload))
+		if mask:
+			key = os.urandom(4)
+			n = len(payload)
+			frame += key + (int.from_bytes(payload, 'big') ^ int.from_bytes((key * (n // 4 + 1))[:n], 'big')).to_bytes(n, 'big')
+		else:
+			frame += payload
+		if chop:
+			for i in range(0, len(frame), chop):
+				self.sock.sendall(frame[i:i + chop])
+		else:
+			self.sock.sendall(frame)
+
+	def recv(self):
+		b0, b1 = self.read(2)
+		if b1 & 0x80:
+			raise Failure('server frame is masked')
+		n = b1 & 0x7F
+		if n == 126:
+			n = struct.unpack('!H', self.read(2))[0]
+		elif n == 127:
+			n = struct.unpack('!Q', self.read(8))[0]
+		return bool(b0 & 0x80), b0 & 0x0F, self.read(n)
+
+	def expect(self, opcode, payload):
+		if isinstance(payload, str):
+			payload = payload.encode()
+		fin, op, data = self.recv()
+		if not fin or op != opcode or data != payload:
+			raise Failure('expected opcode %d with %d bytes, got opcode %d with %d bytes' % (opcode, len(payload), op, len(data)))
+
+	def expect_close(self, codes):  # None in codes stands for a close frame with no status code
+		try:
+			fin, op, data = self.recv()
+		except EOFError:
+			raise Failure('connection is dropped with no close frame')
+		if op != CLOSE:
+			raise Failure('expected close, got opcode %d' % op)
+		code = struct.unpack('!H', data[:2])[0] if len(data) >= 2 else None
+		if code not in codes:
+			raise Failure('close code %s, expected %s' % (code, codes))
+		try:  # the server is to close TCP connection after closing handshake
+			while True:
+				self.fill()
+		except EOFError:
+			pass
+
+	def close(self, code=1000):
+		self.send(CLOSE, struct.pack('!H', code))
+		self.expect_close([code])
+
+
+def echo(opcode, payload, chop=0):
+	def run(c):
+		c.send(opcode, payload, chop=chop)
+		c.expect(opcode, payload)
+		c.close()
+	return run
+
+
+def protocol_error(*frames, code=1002):  # frames are (opcode, payload, fin, rsv, mask)
+	def run(c):
+		for f in frames:
+			c.send(*f)
+		c.expect_close([code])
+	return run
+
+
+def close_with(payload, codes):
+	def run(c):
+		c.send(CLOSE, payload)
+		c.expect_close(codes)
+	return run
+
+
+def pings(c):  # [2.10]
+	for i in range(10):
+		c.send(PING, 'payload-%d' % i)
+	for i in range(10):
+		c.expect(PONG, 'payload-%d' % i)
+	c.close()
+
+
+def unsolicited_pong(c):  # [2.9]
+	c.send(PONG, 'unsolicited')
+	c.send(PING, 'ping')
+	c.expect(PONG, 'ping')
+	c.close()
+
+
+def fragmented_text(c):  # [5.3]
+	c.send(TEXT, 'fragment1', fin=False)
+	c.send(CONT, 'fragment2')
+	c.expect(TEXT, 'fragment1fragment2')
+	c.close()
+
+
+def ping_between_fragments(c):  # [5.6]
+	c.send(TEXT, 'fragment1', fin=False)
+	c.send(PING, 'ping')
+	c.send(CONT, 'fragment2')
+	c.expect(PONG, 'ping')
+	c.expect(TEXT, 'fragment1fragment2')
+	c.close()
+
+
+def many_fragments(c):  # [5.19] in spirit: a message of 100 fragments
+	parts = ['part%03d;' % i for i in range(100)]
+	c.send(TEXT, parts[0], fin=False)
+	for p in parts[1:-1]:
+		c.send(CONT, p, fin=False)
+	c.send(CONT, parts[-1])
+	c.expect(TEXT, ''.join(parts))
+	c.close()
+
+
+def invalid_utf8_fail_fast(c):  # [6.4.1]: invalid text is detected in the first fragment, before the message is complete
+	c.send(TEXT, b'\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5\xf4\x90\x80\x80', fin=False)
+	c.expect_close([1007])
+
+
+def ping_after_close(c):  # [7.1.3]: nothing is answered after close frame
+	c.send(CLOSE, struct.pack('!H', 1000))
+	c.send(PING, 'ping')
+	c.expect_close([1000])
+
+
+VALID_UTF8 = 'Hello-µ@ßöäüàá-UTF-8!!'
+INVALID_UTF8 = b'\xce\xba\xe1\xbd\xb9\xcf\x83\xce\xbc\xce\xb5\xed\xa0\x80edited'  # valid text, then a surrogate (U+D800)
+
+CASES = [
+	('1.1.1', 'text, empty', echo(TEXT, '')),
+	('1.1.2', 'text, 125 bytes', echo(TEXT, '*' * 125)),
+	('1.1.3', 'text, 126 bytes', echo(TEXT, '*' * 126)),
+	('1.1.6', 'text, 65535 bytes', echo(TEXT, '*' * 65535)),
+	('1.1.7', 'text, 65536 bytes', echo(TEXT, '*' * 65536)),
+	('1.1.8', 'text, 65536 bytes sent in chops of 997 bytes', echo(TEXT, '*' * 65536, chop=997)),
+	('1.2.1', 'binary, empty', echo(BINARY, b'')),
+	('1.2.6', 'binary, 65535 bytes', echo(BINARY, b'\xfe' * 65535)),
+	('2.1', 'ping, empty', lambda c: (c.send(PING, ''), c.expect(PONG, ''), c.close())),
+	('2.3', 'ping, binary payload', lambda c: (c.send(PING, b'\x00\xff\xfe\xfd\xfc\xfb\x00\xff'), c.expect(PONG, b'\x00\xff\xfe\xfd\xfc\xfb\x00\xff'), c.close())),
+	('2.4', 'ping, 125 bytes', lambda c: (c.send(PING, b'\xfe' * 125), c.expect(PONG, b'\xfe' * 125), c.close())),
+	('2.5', 'ping, 126 bytes', protocol_error((PING, b'\xfe' * 126))),
+	('2.6', 'ping, 125 bytes sent in chops of 1 byte', lambda c: (c.send(PING, b'\xfe' * 125, chop=1), c.expect(PONG, b'\xfe' * 125), c.close())),
+	('2.9', 'unsolicited pong, then ping', unsolicited_pong),
+	('2.10', '10 pings', pings),
+	('3.1', 'text with RSV = 1', protocol_error((TEXT, 'Hello', True, 1))),
+	('3.4', 'ping with RSV = 4', protocol_error((PING, 'Hello', True, 4))),
+	('3.7', 'close with RSV = 7', protocol_error((CLOSE, struct.pack('!H', 1000), True, 7))),
+	('4.1.1', 'reserved non-control opcode 3', protocol_error((3, ''))),
+	('4.2.1', 'reserved control opcode 11', protocol_error((11, ''))),
+	('5.1', 'fragmented ping', protocol_error((PING, 'fragment1', False), (CONT, 'fragment2'))),
+	('5.3', 'text in 2 fragments', fragmented_text),
+	('5.6', 'text in 2 fragments, ping in between', ping_between_fragments),
+	('5.9', 'continuation with no message started', protocol_error((CONT, 'fragment1'))),
+	('5.18', 'new text message inside a fragmented one', protocol_error((TEXT, 'fragment1', False), (TEXT, 'fragment2'))),
+	('5.19+', 'text in 100 fragments', many_fragments),
+	('6.2.1', 'valid UTF-8', echo(TEXT, VALID_UTF8)),
+	('6.2.3', 'valid UTF-8 sent in chops of 1 byte', echo(TEXT, VALID_UTF8, chop=1)),
+	('6.3.1', 'invalid UTF-8', protocol_error((TEXT, INVALID_UTF8), code=1007)),
+	('6.3.2', 'invalid UTF-8 split over fragments', protocol_error((TEXT, INVALID_UTF8[:7], False), (CONT, INVALID_UTF8[7:]), code=1007)),
+	('6.4.1', 'invalid UTF-8 is detected with no waiting for the last fragment', invalid_utf8_fail_fast),
+	('6.6.x', 'UTF-8 sequence cut at the end of the message', protocol_error((TEXT, b'\xce\xba\xe1\xbd'), code=1007)),
+	('6.21.x', 'overlong UTF-8 encoding', protocol_error((TEXT, b'\xc0\xaf'), code=1007)),
+	('7.1.1', 'text, then close', lambda c: (c.send(TEXT, 'Hello'), c.expect(TEXT, 'Hello'), c.close())),
+	('7.1.3', 'ping after close', ping_after_close),
+	('7.3.1', 'close with no payload', close_with(b'', [None])),
+	('7.3.2', 'close with 1 byte of payload', close_with(b'a', [1002])),
+	('7.3.3', 'close with status code only', close_with(struct.pack('!H', 1000), [1000])),
+	('7.3.4', 'close with status code and reason', close_with(struct.pack('!H', 1000) + b'Hello World!', [1000])),
+	('7.3.6', 'close with 126 bytes of payload', close_with(struct.pack('!H', 1000) + b'*' * 124, [1002])),
+	('7.5.1', 'close with invalid UTF-8 reason', close_with(struct.pack('!H', 1000) + INVALID_UTF8, [1007])),
+]
+CASES += [('7.7.x', 'close with valid code %d' % code, close_with(struct.pack('!H', code), [code]))
+	for code in (1000, 1001, 1002, 1003, 1007, 1008, 1009, 1010, 1011, 3000, 3999, 4000, 4999)]
+CASES += [('7.9.x', 'close with invalid code %d' % code, close_with(struct.pack('!H', code), [1002]))
+	for code in (0, 999, 1004, 1005, 1006, 1016, 1100, 2000, 2999, 5000, 65535)]
+CASES += [
+	('9.1.x', 'text, 1 MB', echo(TEXT, '*' * 0x100000)),
+	('9.2.x', 'binary, 4 MB', echo(BINARY, b'\xfe' * 0x400000)),
+	('RFC 5.1', 'unmasked client frame', protocol_error((TEXT, 'Hello', True, 0, False))),
+]
+
+
+def main():
+	failed = 0
+	for num, descr, run in CASES:
+		try:
+			c = Conn()
+			try:
+				run(c)
+			finally:
+				c.sock.close()
+			print('[%-6s] %-64s OK' % (num, descr))
+		except (Failure, EOFError, OSError) as e:
+			failed += 1
+			print('[%-6s] %-64s FAILED: %s' % (num, descr, e if str(e) else type(e).__name__))
+	print('%d cases, %d failed' % (len(CASES), failed))
+	return 1 if failed else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
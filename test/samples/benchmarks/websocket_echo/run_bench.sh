@@ -0,0 +1,20 @@
+#!/bin/bash
+# usage: ./run_bench.sh [messages per connection]
+# the server is run at CPU 0, the client at CPU 1; then the conformance subset is run against the same server
+
+messages=${1:-100000}
+
+taskset -c 0 ./build/websocket_echo.bin &
+pid=$!
+sleep 1
+for size in 16 1024 65536
+do
+	for conns in 1 16
+	do
+		echo "$conns connections, $size bytes"
+		taskset -c 1 ./build/websocket_echo.bin client conns=$conns size=$size messages=$((size < 65536 ? messages : messages / 10))
+	done
+done
+./conformance.py 127.0.0.1 2000
+kill $pid
+wait $pid 2>/dev/null
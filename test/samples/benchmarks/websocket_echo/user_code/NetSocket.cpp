@@ -0,0 +1,7 @@
+// NetSocket.cpp : WebSocket echo benchmark (server and client)
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<MySampleTNode>> noname( "MySampleTemplateNode" );
@@ -0,0 +1,197 @@
+// NetSocket.h : WebSocket echo benchmark (server and client); see ../../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/logging.h>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class MySampleTNode : public NodeBase
+{
+public:
+	class MyHttpServer : public nodecpp::net::HttpServer<MySampleTNode>
+	{
+	public:
+		MyHttpServer() {}
+		MyHttpServer(MySampleTNode* node) : HttpServer<MySampleTNode>(node) {}
+		virtual ~MyHttpServer() {}
+	};
+
+	using ServerType = MyHttpServer;
+	nodecpp::safememory::owning_ptr<ServerType> srv;
+
+	// client mode
+	nodecpp::string ip = "127.0.0.1";
+	uint16_t port = 2000;
+	size_t payloadSize = 64;
+	size_t messagesPerConn = 100000;
+	size_t connsRunning = 0;
+	size_t errors = 0;
+	std::vector<uint32_t> latenciesUs;
+	std::chrono::steady_clock::time_point start;
+
+	MySampleTNode()
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "MySampleTNode::MySampleTNode()" );
+	}
+
+	virtual nodecpp::handler_ret_type main()
+	{
+		bool client = false;
+		size_t conns = 16;
+		auto argv = getArgv();
+		for ( size_t i=1; i<argv.size(); ++i )
+		{
+			if ( argv[i] == "client" )
+				client = true;
+			else if ( argv[i].size() > 6 && argv[i].substr(0,6) == "conns=" )
+				conns = atol(argv[i].c_str() + 6);
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "size=" )
+				payloadSize = atol(argv[i].c_str() + 5);
+			else if ( argv[i].size() > 9 && argv[i].substr(0,9) == "messages=" )
+				messagesPerConn = atol(argv[i].c_str() + 9);
+			else if ( argv[i].size() > 3 && argv[i].substr(0,3) == "ip=" )
+				ip = argv[i].substr(3).c_str();
+			else if ( argv[i].size() > 5 && argv[i].substr(0,5) == "port=" )
+				port = (uint16_t)atol(argv[i].c_str() + 5);
+		}
+
+		if ( client )
+		{
+			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "client: {} connections to {}:{}, {} messages of {} bytes each", conns, ip, port, messagesPerConn, payloadSize );
+			latenciesUs.reserve( conns * messagesPerConn );
+			start = std::chrono::steady_clock::now();
+			connsRunning = conns;
+			for ( size_t i=0; i<conns; ++i )
+				clientLoop();
+			CO_RETURN;
+		}
+
+		srv = nodecpp::net::createHttpServer<ServerType>();
+		srv->getRouter().get( "/echo", [](auto request, auto response) -> nodecpp::handler_ret_type {
+			if ( !request->isWebSocketUpgrade() )
+			{
+				response->writeHead(426, {{"Upgrade", "websocket"}, {"Content-Type", "text/plain"}});
+				co_await response->end( nodecpp::string_literal( "WebSocket only\r\n" ) );
+				CO_RETURN;
+			}
+			nodecpp::net::WebSocket ws;
+			co_await response->a_acceptWebSocket( ws );
+			Buffer msg;
+			nodecpp::net::WebSocket::Opcode opcode;
+			try
+			{
+				while ( co_await ws.a_readMessage( msg, opcode ) )
+					co_await ws.a_send( msg, opcode );
+			}
+			catch (...) {} // connection is lost while sending
+			CO_RETURN;
+		} );
+		srv->getRouter().build();
+		srv->listen(port, "0.0.0.0", 5000);
+
+		CO_RETURN;
+	}
+
+	// client side of a single connection: handshake, then messages are sent one at a time, each after the echo of the previous one
+	nodecpp::handler_ret_type clientLoop()
+	{
+		auto sock = nodecpp::net::createSocket();
+		Buffer part( 0x10000 );
+		Buffer received;
+		try
+		{
+			co_await sock->a_connect( port, ip.c_str() );
+			nodecpp::string handshake = nodecpp::format( "GET /echo HTTP/1.1\r\nHost: {}:{}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+				"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n", ip, port );
+			co_await sock->a_write( BufferView( handshake.c_str(), handshake.size() ), BufferView() );
+			std::string_view head;
+			for(;;)
+			{
+				co_await sock->a_read( part );
+				received.append( part );
+				head = std::string_view( (const char*)(received.begin()), received.size() );
+				if ( head.find( "\r\n\r\n" ) != std::string_view::npos )
+					break;
+			}
+			if ( head.substr( 0, 12 ) != "HTTP/1.1 101" || head.find( "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=" ) == std::string_view::npos ) // accept key of RFC 6455, 1.3
+				throw Error();
+			received.popFront( head.find( "\r\n\r\n" ) + 4 );
+
+			// client frames are masked; the payload is masked once, as it is the same for all messages
+			static constexpr uint8_t key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+			uint8_t hdr[14];
+			size_t hdrSize = 2;
+			hdr[0] = 0x82; // FIN, binary
+			if ( payloadSize < 126 )
+				hdr[1] = 0x80 | (uint8_t)payloadSize;
+			else if ( payloadSize <= 0xFFFF )
+			{
+				hdr[1] = 0x80 | 126;
+				hdr[2] = (uint8_t)( payloadSize >> 8 );
+				hdr[3] = (uint8_t)payloadSize;
+				hdrSize = 4;
+			}
+			else
+			{
+				hdr[1] = 0x80 | 127;
+				for ( size_t i=0; i<8; ++i )
+					hdr[9 - i] = (uint8_t)( (uint64_t)payloadSize >> ( i * 8 ) );
+				hdrSize = 10;
+			}
+			memcpy( hdr + hdrSize, key, 4 );
+			hdrSize += 4;
+			Buffer payload( payloadSize );
+			for ( size_t i=0; i<payloadSize; ++i )
+				payload.appendUint8( (uint8_t)( ( 'a' + i % 26 ) ^ key[i & 3] ) );
+			size_t echoSize = ( payloadSize < 126 ? 2 : ( payloadSize <= 0xFFFF ? 4 : 10 ) ) + payloadSize; // server frames are not masked
+
+			for ( size_t i=0; i<messagesPerConn; ++i )
+			{
+				auto msgStart = std::chrono::steady_clock::now();
+				co_await sock->a_write( BufferView( hdr, hdrSize ), BufferView( payload ) );
+				while ( received.size() < echoSize )
+				{
+					co_await sock->a_read( part );
+					received.append( part );
+				}
+				if ( received.begin()[0] != 0x82 )
+					throw Error();
+				received.popFront( echoSize );
+				latenciesUs.push_back( (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - msgStart ).count() );
+			}
+			static constexpr uint8_t closeFrame[8] = { 0x88, 0x82, 0x37, 0xfa, 0x21, 0x3d, 0x03 ^ 0x37, 0xe8 ^ 0xfa }; // 1000, masked
+			co_await sock->a_write( BufferView( closeFrame, sizeof(closeFrame) ), BufferView() );
+		}
+		catch (...)
+		{
+			++errors;
+		}
+		sock->end();
+		if ( --connsRunning == 0 )
+			report();
+		CO_RETURN;
+	}
+
+	void report()
+	{
+		uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		std::sort( latenciesUs.begin(), latenciesUs.end() );
+		auto percentile = [this]( double p ) { return latenciesUs.empty() ? 0 : latenciesUs[ (size_t)( p * ( latenciesUs.size() - 1 ) ) ]; };
+		double mps = latenciesUs.size() * 1e9 / ns;
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::nodecpp_module_id), "{} messages of {} bytes echoed ({} connections failed) in {} ms: {} msg/s", latenciesUs.size(), payloadSize, errors, ns / 1000000, mps );
+		printf( "%zu messages of %zu bytes echoed, %zu connections failed, in %.1f ms: %.0f msg/s, %.1f MB/s each way\n", latenciesUs.size(), payloadSize, errors, ns / 1e6, mps, mps * payloadSize / 1e6 );
+		printf( "round trip, us: p50 %u, p90 %u, p99 %u, max %u\n", percentile( 0.5 ), percentile( 0.9 ), percentile( 0.99 ), percentile( 1.0 ) );
+		exit( errors ? 1 : 0 ); // nothing else is to be run by the loop
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,7 @@
+// NetSocket.cpp : unit checks
+
+
+#include <infrastructure.h>
+#include "NetSocket.h"
+
+static NodeRegistrator<Runnable<UnitChecksNode>> noname( "UnitChecksNode" );
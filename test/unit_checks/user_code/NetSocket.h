@@ -0,0 +1,45 @@
+// NetSocket.h : unit checks of self-contained parts of node.cpp (parsers, codecs, containers); see ../README.txt
+
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+
+#include <nodecpp/common.h>
+#include <nodecpp/http_server.h>
+#include <nodecpp/url.h>
+#include <nodecpp/logging.h>
+
+#include "checks.h"
+#include "chunked_decoder_checks.h"
+#include "hpack_checks.h"
+#include "http_router_checks.h"
+#include "mpsc_queue_checks.h"
+#include "url_query_checks.h"
+#include "websocket_checks.h"
+
+using namespace std;
+using namespace nodecpp;
+using namespace fmt;
+
+class UnitChecksNode : public NodeBase
+{
+public:
+	virtual nodecpp::handler_ret_type main()
+	{
+		chunked_decoder_checks::run();
+		hpack_checks::run();
+		http_router_checks::run();
+#ifdef NODECPP_ENABLE_CLUSTERING
+		mpsc_queue_checks::run();
+#endif
+		url_query_checks::run();
+		websocket_checks::run();
+
+		printf( "%zu checks, %zu failed\n", checkStats().total, checkStats().failed );
+		exit( checkStats().failed ? 1 : 0 ); // nothing else is to be run by the loop
+
+		CO_RETURN;
+	}
+};
+
+#endif // NET_SOCKET_H
@@ -0,0 +1,27 @@
+// checks.h : minimal helpers for unit checks
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <cstdio>
+#include <cstring>
+
+struct CheckStats
+{
+	size_t total = 0;
+	size_t failed = 0;
+};
+
+inline CheckStats& checkStats() { static CheckStats stats; return stats; }
+
+// reports a failed check and goes on with the rest
+#define UNIT_CHECK( cond ) \
+	do { \
+		++(checkStats().total); \
+		if ( !(cond) ) { \
+			++(checkStats().failed); \
+			printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond ); \
+		} \
+	} while ( 0 )
+
+#endif // CHECKS_H
@@ -0,0 +1,130 @@
+// chunked_decoder_checks.h : checks of nodecpp::net::ChunkedDecoder
+
+#ifndef CHUNKED_DECODER_CHECKS_H
+#define CHUNKED_DECODER_CHECKS_H
+
+#include "checks.h"
+
+namespace chunked_decoder_checks {
+
+	using TrailersT = std::map<nodecpp::string, nodecpp::string>;
+
+	struct Result
+	{
+		nodecpp::string data;
+		TrailersT trailers;
+		size_t consumed = 0;
+		bool done = false;
+		bool error = false;
+	};
+
+	// feeds s by pieces of at most step bytes
+	inline Result decode( const char* s, size_t step = SIZE_MAX )
+	{
+		Result r;
+		nodecpp::net::ChunkedDecoder decoder;
+		size_t sz = strlen( s );
+		auto onData = [&r]( const uint8_t* ptr, size_t sz ) { r.data.append( (const char*)ptr, sz ); };
+		while ( r.consumed < sz && !decoder.isDone() && !decoder.isError() )
+		{
+			size_t piece = sz - r.consumed < step ? sz - r.consumed : step;
+			size_t consumed = decoder.feed( (const uint8_t*)s + r.consumed, piece, onData, r.trailers );
+			r.consumed += consumed;
+			if ( consumed < piece )
+				break;
+		}
+		r.done = decoder.isDone();
+		r.error = decoder.isError();
+		return r;
+	}
+
+	inline void run()
+	{
+		const char* wiki = "4\r\nWiki\r\n5\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\n\r\n";
+		for ( size_t step : { SIZE_MAX, (size_t)1, (size_t)2, (size_t)7 } ) // framing split at any byte boundary
+		{
+			Result r = decode( wiki, step );
+			UNIT_CHECK( r.done );
+			UNIT_CHECK( r.data == "Wikipedia in\r\n\r\nchunks." );
+			UNIT_CHECK( r.consumed == strlen( wiki ) );
+		}
+
+		{ // hex digits of both cases, extensions, trailers
+			Result r = decode( "a;name=value\r\n0123456789\r\nB ; x\r\nhello world\r\n0\r\nX-Checksum:  abc \r\nExpires: never\r\n\r\n" );
+			UNIT_CHECK( r.done );
+			UNIT_CHECK( r.data == "0123456789hello world" );
+			UNIT_CHECK( r.trailers.size() == 2 );
+			UNIT_CHECK( r.trailers["x-checksum"] == "abc" );
+			UNIT_CHECK( r.trailers["expires"] == "never" );
+		}
+
+		{ // bare LF line ends are tolerated
+			Result r = decode( "3\nabc\n0\n\n" );
+			UNIT_CHECK( r.done );
+			UNIT_CHECK( r.data == "abc" );
+		}
+
+		{ // stops right after the last chunk, leaving the next request untouched
+			const char* s = "1\r\nx\r\n0\r\n\r\nGET / HTTP/1.1\r\n";
+			Result r = decode( s );
+			UNIT_CHECK( r.done );
+			UNIT_CHECK( r.consumed == strlen( "1\r\nx\r\n0\r\n\r\n" ) );
+		}
+
+		{ // incomplete body is neither done nor an error
+			Result r = decode( "5\r\nhel" );
+			UNIT_CHECK( !r.done );
+			UNIT_CHECK( !r.error );
+			UNIT_CHECK( r.data == "hel" );
+		}
+
+		{ // stopAfterData returns right after the first payload range
+			nodecpp::net::ChunkedDecoder decoder;
+			TrailersT trailers;
+			nodecpp::string data;
+			const char* s = "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n";
+			size_t consumed = decoder.feed( (const uint8_t*)s, strlen( s ), [&data]( const uint8_t* ptr, size_t sz ) { data.append( (const char*)ptr, sz ); }, trailers, true );
+			UNIT_CHECK( consumed == 6 );
+			UNIT_CHECK( data == "abc" );
+			UNIT_CHECK( !decoder.isDone() );
+		}
+
+		// malformed framing
+		UNIT_CHECK( decode( "x\r\n" ).error ); // not a hex digit
+		UNIT_CHECK( decode( "\r\nabc\r\n" ).error ); // no size
+		UNIT_CHECK( decode( ";ext\r\n" ).error ); // no size before an extension
+		UNIT_CHECK( decode( "3\r\nabcX\r\n" ).error ); // no CRLF after data
+		UNIT_CHECK( decode( "3\rX" ).error ); // CR not followed by LF
+		UNIT_CHECK( decode( "10000000000000000\r\n" ).error ); // size overflow
+		UNIT_CHECK( decode( "0\r\nno colon\r\n\r\n" ).error ); // malformed trailer
+		UNIT_CHECK( decode( "0\r\n: value\r\n\r\n" ).error ); // empty trailer name
+
+		{ // trailers are bounded both per line and in total
+			using Decoder = nodecpp::net::ChunkedDecoder;
+			nodecpp::string s = "0\r\nX-Long: ";
+			s.append( Decoder::maxTrailerLineSize - ( s.size() - 3 ), 'a' ); // the line (after "0\r\n") is of the limit exactly
+			s.append( "\r\n\r\n" );
+			UNIT_CHECK( decode( s.c_str() ).done );
+			s.insert( 3, "a" );
+			UNIT_CHECK( decode( s.c_str(), 100 ).error );
+
+			s = "0\r\n";
+			for ( size_t i=0, total=0; total <= Decoder::maxTrailersSize; ++i ) // many short lines
+			{
+				nodecpp::string line = nodecpp::format( "X-Trailer-{}: value", i );
+				total += line.size();
+				s.append( line );
+				s.append( "\r\n" );
+			}
+			s.append( "\r\n" );
+			UNIT_CHECK( decode( s.c_str() ).error );
+
+			nodecpp::string endless = "0\r\nX-Endless: ";
+			endless.append( 0x100000, 'a' );
+			UNIT_CHECK( decode( endless.c_str() ).error );
+		}
+	}
+
+} // namespace chunked_decoder_checks
+
+#endif // CHUNKED_DECODER_CHECKS_H
@@ -0,0 +1,222 @@
+// hpack_checks.h : checks of HPACK encoding and decoding (nodecpp::net::HpackEncoder, HpackDecoder) against examples of RFC 7541, Appendix C
+
+#ifndef HPACK_CHECKS_H
+#define HPACK_CHECKS_H
+
+#include "checks.h"
+
+namespace hpack_checks {
+
+	using nodecpp::net::Hpack;
+	using nodecpp::net::HpackDynamicTable;
+	using nodecpp::net::HpackDecoder;
+	using nodecpp::net::HpackEncoder;
+
+	inline nodecpp::Buffer fromHex( const char* hex ) // spaces are ignored
+	{
+		auto val = []( char ch ) { return ch <= '9' ? ch - '0' : ( ch | 0x20 ) - 'a' + 10; };
+		nodecpp::Buffer b;
+		for ( const char* p = hex; *p; )
+		{
+			if ( *p == ' ' )
+			{
+				++p;
+				continue;
+			}
+			b.appendUint8( (int8_t)( ( val( p[0] ) << 4 ) | val( p[1] ) ) );
+			p += 2;
+		}
+		return b;
+	}
+
+	inline nodecpp::string toHex( const nodecpp::Buffer& b )
+	{
+		static constexpr char digits[] = "0123456789abcdef";
+		nodecpp::string ret;
+		for ( size_t i=0; i<b.size(); ++i )
+		{
+			ret += digits[ b.begin()[i] >> 4 ];
+			ret += digits[ b.begin()[i] & 0xF ];
+		}
+		return ret;
+	}
+
+	// fields as "name: value\n" lines, or "<error>"
+	inline nodecpp::string decode( HpackDecoder& decoder, const nodecpp::Buffer& block, bool* tooLarge = nullptr )
+	{
+		nodecpp::string ret;
+		bool tooLargeDummy;
+		if ( !decoder.decode( block.begin(), block.size(), tooLarge ? *tooLarge : tooLargeDummy, [&ret]( const nodecpp::string& name, const nodecpp::string& value ) {
+				ret += name;
+				ret += ": ";
+				ret += value;
+				ret += "\n";
+			} ) )
+			return "<error>";
+		return ret;
+	}
+
+	inline nodecpp::string decode( HpackDecoder& decoder, const char* hex ) { return decode( decoder, fromHex( hex ) ); }
+
+	inline bool decodesInt( const char* hex, uint8_t prefixBits, uint64_t expected )
+	{
+		nodecpp::Buffer b = fromHex( hex );
+		const uint8_t* ptr = b.begin();
+		uint64_t val = 0;
+		return Hpack::decodeInt( ptr, b.end(), prefixBits, val ) && val == expected && ptr == b.end();
+	}
+
+	inline nodecpp::string encodedInt( uint64_t val, uint8_t prefixBits, uint8_t firstByteFlags = 0 )
+	{
+		nodecpp::Buffer b;
+		Hpack::encodeInt( val, prefixBits, firstByteFlags, b );
+		return toHex( b );
+	}
+
+	inline void run()
+	{
+		{ // C.1: integers
+			UNIT_CHECK( encodedInt( 10, 5 ) == "0a" );
+			UNIT_CHECK( encodedInt( 1337, 5 ) == "1f9a0a" );
+			UNIT_CHECK( encodedInt( 42, 8 ) == "2a" );
+			UNIT_CHECK( encodedInt( 31, 5, 0xE0 ) == "ff00" ); // the prefix is full: a zero byte follows
+			UNIT_CHECK( decodesInt( "0a", 5, 10 ) );
+			UNIT_CHECK( decodesInt( "ea", 5, 10 ) ); // bits above the prefix are not a part of the value
+			UNIT_CHECK( decodesInt( "1f9a0a", 5, 1337 ) );
+			UNIT_CHECK( decodesInt( "2a", 8, 42 ) );
+			UNIT_CHECK( !decodesInt( "1f9a", 5, 1337 ) ); // cut
+			UNIT_CHECK( !decodesInt( "1fffffffffffffffffffff7f", 5, 0 ) ); // too long
+		}
+
+		{ // C.2: a single field of each representation, each with a decoder of its own
+			HpackDecoder d1, d2, d3, d4;
+			UNIT_CHECK( decode( d1, "400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572" ) == "custom-key: custom-header\n" ); // C.2.1
+			UNIT_CHECK( decode( d1, "be" ) == "custom-key: custom-header\n" ); // added to the dynamic table
+			UNIT_CHECK( decode( d2, "040c 2f73 616d 706c 652f 7061 7468" ) == ":path: /sample/path\n" ); // C.2.2
+			UNIT_CHECK( decode( d2, "be" ) == "<error>" ); // not added
+			UNIT_CHECK( decode( d3, "1008 7061 7373 776f 7264 0673 6563 7265 74" ) == "password: secret\n" ); // C.2.3
+			UNIT_CHECK( decode( d3, "be" ) == "<error>" ); // not added
+			UNIT_CHECK( decode( d4, "82" ) == ":method: GET\n" ); // C.2.4
+		}
+
+		const char* request1 = ":method: GET\n:scheme: http\n:path: /\n:authority: www.example.com\n";
+		const char* request2 = ":method: GET\n:scheme: http\n:path: /\n:authority: www.example.com\ncache-control: no-cache\n";
+		const char* request3 = ":method: GET\n:scheme: https\n:path: /index.html\n:authority: www.example.com\ncustom-key: custom-value\n";
+
+		{ // C.3: requests, no Huffman coding
+			HpackDecoder decoder;
+			UNIT_CHECK( decode( decoder, "8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d" ) == request1 );
+			UNIT_CHECK( decode( decoder, "8286 84be 5808 6e6f 2d63 6163 6865" ) == request2 );
+			UNIT_CHECK( decode( decoder, "8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65" ) == request3 );
+		}
+
+		{ // C.4: the same requests, Huffman-coded
+			HpackDecoder decoder;
+			UNIT_CHECK( decode( decoder, "8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff" ) == request1 );
+			UNIT_CHECK( decode( decoder, "8286 84be 5886 a8eb 1064 9cbf" ) == request2 );
+			UNIT_CHECK( decode( decoder, "8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf" ) == request3 );
+		}
+
+		const char* response1 = ":status: 302\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:21 GMT\nlocation: https://www.example.com\n";
+		const char* response2 = ":status: 307\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:21 GMT\nlocation: https://www.example.com\n";
+		const char* response3 = ":status: 200\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:22 GMT\nlocation: https://www.example.com\n"
+			"content-encoding: gzip\nset-cookie: foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1\n";
+
+		// C.5 and C.6 assume a table of 256 bytes, so that entries are evicted; here it is set by a size update ("3fe101") before the first block
+		{ // C.5: responses, no Huffman coding
+			HpackDecoder decoder;
+			UNIT_CHECK( decode( decoder, "3fe101 4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3120 474d 546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70 6c65 2e63 6f6d" ) == response1 );
+			UNIT_CHECK( decode( decoder, "4803 3330 37c1 c0bf" ) == response2 );
+			UNIT_CHECK( decode( decoder, "88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3220 474d 54c0 5a04 677a 6970 7738 666f 6f3d 4153 444a 4b48 514b 425a 584f 5157 454f 5049 5541 5851 5745 4f49 553b 206d 6178 2d61 6765 3d33 3630 303b 2076 6572 7369 6f6e 3d31" ) == response3 );
+			UNIT_CHECK( decode( decoder, "c4" ) == "<error>" ); // only three entries are left
+		}
+
+		{ // C.6: the same responses, Huffman-coded
+			HpackDecoder decoder;
+			UNIT_CHECK( decode( decoder, "3fe101 4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4 44a8 2005 9504 0b81 66e0 82a6 2d1b ff6e 919d 29ad 1718 63c7 8f0b 97c8 e9ae 82ae 43d3" ) == response1 );
+			UNIT_CHECK( decode( decoder, "4883 640e ffc1 c0bf" ) == response2 );
+			UNIT_CHECK( decode( decoder, "88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff c05a 839b d9ab 77ad 94e7 821d d7f2 e6c7 b335 dfdf cd5b 3960 d5af 2708 7f36 72c1 ab27 0fb5 291f 9587 3160 65c0 03ed 4ee5 b106 3d50 07" ) == response3 );
+		}
+
+		{ // dynamic table: eviction as in C.5.2
+			HpackDynamicTable table;
+			table.setMaxSize( 256 );
+			table.add( ":status", "302" );
+			table.add( "cache-control", "private" );
+			table.add( "date", "Mon, 21 Oct 2013 20:13:21 GMT" );
+			table.add( "location", "https://www.example.com" );
+			UNIT_CHECK( table.count() == 4 ); // 222 bytes
+			table.add( ":status", "307" );
+			UNIT_CHECK( table.count() == 4 ); // the oldest one is evicted
+			UNIT_CHECK( table.getDynamic( 62 ) != nullptr && table.getDynamic( 62 )->second == "307" );
+			UNIT_CHECK( table.getDynamic( 65 ) != nullptr && table.getDynamic( 65 )->first == "cache-control" );
+			UNIT_CHECK( table.getDynamic( 66 ) == nullptr );
+			UNIT_CHECK( table.getDynamic( 61 ) == nullptr ); // static
+			UNIT_CHECK( table.find( "location", "https://www.example.com" ) == 63 );
+			table.add( "x", nodecpp::string( 300, 'x' ) ); // larger than the table: it is just emptied
+			UNIT_CHECK( table.count() == 0 );
+		}
+
+		{ // compression errors
+			HpackDecoder decoder;
+			UNIT_CHECK( decode( decoder, "80" ) == "<error>" ); // index 0
+			UNIT_CHECK( decode( decoder, "be" ) == "<error>" ); // index 62 with the dynamic table empty
+			UNIT_CHECK( decode( decoder, "82 20" ) == "<error>" ); // size update after a field
+			UNIT_CHECK( decode( decoder, "3fe21f" ) == "<error>" ); // size update to 4097, above SETTINGS_HEADER_TABLE_SIZE
+			UNIT_CHECK( decode( decoder, "400a 6375 7374 6f6d" ) == "<error>" ); // cut string
+			UNIT_CHECK( decode( decoder, "0f" ) == "<error>" ); // cut integer
+			UNIT_CHECK( decode( decoder, "0001 61 81 00" ) == "<error>" ); // Huffman: '0' (00000), then padding that is not all ones
+			UNIT_CHECK( decode( decoder, "0001 61 85 ffff ffff ff" ) == "<error>" ); // EOS
+			UNIT_CHECK( decode( decoder, "0001 61 81 07" ) == "a: 0\n" ); // '0' (00000) and padding of 3 ones
+		}
+
+		{ // SETTINGS_MAX_HEADER_LIST_SIZE: fields beyond the limit are not reported, but the dynamic table is still updated
+			HpackDecoder decoder;
+			decoder.setMaxListSize( 100 );
+			bool tooLarge = false;
+			nodecpp::string ret = decode( decoder, fromHex( "400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572 be be be" ), &tooLarge ); // 55 bytes each
+			UNIT_CHECK( ret == "custom-key: custom-header\n" && tooLarge );
+			UNIT_CHECK( decode( decoder, fromHex( "be" ), &tooLarge ) == "custom-key: custom-header\n" && !tooLarge );
+			UNIT_CHECK( decode( decoder, fromHex( "be be bf" ), &tooLarge ) == "<error>" ); // an index beyond the limit is still checked
+		}
+
+		{ // encoder: what it produces is decoded back, fields that repeat are indexed
+			HpackEncoder encoder;
+			HpackDecoder decoder;
+			nodecpp::Buffer block;
+			encoder.beginBlock( block );
+			encoder.encodeStatus( 200, block );
+			encoder.encode( "custom-key", "custom-header", block );
+			UNIT_CHECK( toHex( block ) == "88400a637573746f6d2d6b65790d637573746f6d2d686561646572" ); // C.2.4-like indexed status, then C.2.1
+			UNIT_CHECK( decode( decoder, block ) == ":status: 200\ncustom-key: custom-header\n" );
+
+			block.clear();
+			encoder.beginBlock( block );
+			encoder.encodeStatus( 302, block );
+			encoder.encode( "custom-key", "custom-header", block );
+			encoder.encode( "content-type", "text/html", block );
+			encoder.encode( "content-length", "1234", block );
+			encoder.encode( "set-cookie", "a=b", block );
+			UNIT_CHECK( decode( decoder, block ) == ":status: 302\ncustom-key: custom-header\ncontent-type: text/html\ncontent-length: 1234\nset-cookie: a=b\n" );
+
+			block.clear();
+			encoder.beginBlock( block );
+			encoder.encode( "content-type", "text/html", block );
+			encoder.encode( "custom-key", "custom-header", block );
+			encoder.encode( "content-length", "1234", block );
+			UNIT_CHECK( toHex( block ) == "bebf0f0d0431323334" ); // indexed, indexed, content-length is never added to the table
+			UNIT_CHECK( decode( decoder, block ) == "content-type: text/html\ncustom-key: custom-header\ncontent-length: 1234\n" );
+
+			encoder.setPeerMaxTableSize( 0 ); // the table is emptied, and the next block starts with a size update
+			decoder.setMaxTableSizeAllowed( 0 );
+			block.clear();
+			encoder.beginBlock( block );
+			encoder.encode( "content-type", "text/html", block );
+			UNIT_CHECK( block.size() > 0 && block.begin()[0] == 0x20 );
+			UNIT_CHECK( decode( decoder, block ) == "content-type: text/html\n" );
+		}
+	}
+
+} // namespace hpack_checks
+
+#endif // HPACK_CHECKS_H
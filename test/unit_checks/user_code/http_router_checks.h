@@ -0,0 +1,137 @@
+// http_router_checks.h : checks of nodecpp::net::HttpRouter
+
+#ifndef HTTP_ROUTER_CHECKS_H
+#define HTTP_ROUTER_CHECKS_H
+
+#include "checks.h"
+
+namespace http_router_checks {
+
+	using nodecpp::net::HttpRouter;
+	using nodecpp::net::HttpRouteParams;
+
+	struct Route // a handler that tells which route is matched
+	{
+		int id;
+		nodecpp::handler_ret_type operator()( nodecpp::safememory::soft_ptr<nodecpp::net::IncomingHttpMessageAtServer>, nodecpp::safememory::soft_ptr<nodecpp::net::HttpServerResponse> ) const { CO_RETURN; } // never called
+	};
+
+	inline int matched( const HttpRouter& router, const char* method, const char* path, HttpRouteParams& params )
+	{
+		const HttpRouter::HandlerT* h = router.match( method, path, params );
+		return h != nullptr ? h->target<Route>()->id : -1;
+	}
+
+	inline int matched( const HttpRouter& router, const char* method, const char* path )
+	{
+		HttpRouteParams params;
+		return matched( router, method, path, params );
+	}
+
+	inline bool throwsOnAdd( HttpRouter& router, const char* method, const char* pattern )
+	{
+		try { router.add( method, pattern, Route{ 1000 } ); }
+		catch (...) { return true; }
+		return false;
+	}
+
+	inline void run()
+	{
+		HttpRouter router;
+		router.get( "/", Route{ 0 } );
+		router.get( "/users", Route{ 1 } );
+		router.get( "/users/:id", Route{ 2 } );
+		router.get( "/users/:id/posts/:postId", Route{ 3 } );
+		router.get( "/users/me", Route{ 4 } );
+		router.get( "/static/*path", Route{ 5 } );
+		router.post( "/users", Route{ 6 } );
+		router.all( "/any", Route{ 7 } );
+		router.get( "/u", Route{ 8 } );
+		router.del( "/users/:id", Route{ 9 } );
+
+		// conflicting or malformed routes
+		UNIT_CHECK( throwsOnAdd( router, "GET", "/users/:userId/x" ) ); // same position, another parameter name
+		UNIT_CHECK( throwsOnAdd( router, "GET", "/users" ) ); // duplicate
+		UNIT_CHECK( throwsOnAdd( router, "GET", "/static/*path/x" ) ); // wildcard not at the end
+		UNIT_CHECK( throwsOnAdd( router, "GET", "users" ) ); // not starting with '/'
+		UNIT_CHECK( throwsOnAdd( router, "FETCH", "/fetch" ) ); // unknown method
+
+		router.build();
+		UNIT_CHECK( router.isBuilt() );
+
+		UNIT_CHECK( matched( router, "GET", "/" ) == 0 );
+		UNIT_CHECK( matched( router, "GET", "/users" ) == 1 );
+		UNIT_CHECK( matched( router, "POST", "/users" ) == 6 );
+		UNIT_CHECK( matched( router, "GET", "/u" ) == 8 );
+		UNIT_CHECK( matched( router, "GET", "/users/me" ) == 4 ); // static text takes precedence over a parameter
+		UNIT_CHECK( matched( router, "PUT", "/any" ) == 7 );
+		UNIT_CHECK( matched( router, "DELETE", "/any" ) == 7 );
+
+		{
+			HttpRouteParams params;
+			UNIT_CHECK( matched( router, "GET", "/users/42", params ) == 2 );
+			UNIT_CHECK( params.size() == 1 );
+			UNIT_CHECK( params.get( "id" ) == "42" );
+			UNIT_CHECK( matched( router, "DELETE", "/users/42", params ) == 9 );
+			UNIT_CHECK( params.get( "id" ) == "42" );
+		}
+		{
+			HttpRouteParams params;
+			UNIT_CHECK( matched( router, "GET", "/users/42/posts/7", params ) == 3 );
+			UNIT_CHECK( params.size() == 2 );
+			UNIT_CHECK( params.nameAt( 0 ) == "id" && params.valueAt( 0 ) == "42" );
+			UNIT_CHECK( params.nameAt( 1 ) == "postId" && params.valueAt( 1 ) == "7" );
+			UNIT_CHECK( params.get( "none" ).empty() );
+		}
+		{
+			HttpRouteParams params;
+			UNIT_CHECK( matched( router, "GET", "/static/css/site.css", params ) == 5 );
+			UNIT_CHECK( params.get( "path" ) == "css/site.css" );
+			UNIT_CHECK( matched( router, "GET", "/static/", params ) == 5 ); // wildcard matches an empty rest, too
+			UNIT_CHECK( params.get( "path" ).empty() );
+		}
+
+		// no match
+		UNIT_CHECK( matched( router, "GET", "/nope" ) == -1 );
+		UNIT_CHECK( matched( router, "GET", "/users/" ) == -1 ); // a parameter is not empty
+		UNIT_CHECK( matched( router, "GET", "/users/42/posts" ) == -1 );
+		UNIT_CHECK( matched( router, "GET", "/usersX" ) == -1 );
+		UNIT_CHECK( matched( router, "PUT", "/users" ) == -1 );
+		{
+			HttpRouteParams params;
+			UNIT_CHECK( matched( router, "GET", "/users/42/posts", params ) == -1 );
+			UNIT_CHECK( params.size() == 0 ); // parameters of a partial match are not left
+		}
+
+		// for 405 Method Not Allowed
+		UNIT_CHECK( router.allowedMethods( "/users" ) == "GET, POST" );
+		UNIT_CHECK( router.allowedMethods( "/users/42" ) == "GET, DELETE" );
+		UNIT_CHECK( router.allowedMethods( "/nope" ).empty() );
+
+		{ // hundreds of routes, each matched by its own path only
+			HttpRouter many;
+			char buff[64];
+			for ( int i=0; i<300; ++i )
+			{
+				snprintf( buff, sizeof(buff), "/api/v%d/resource%d/:id", i % 3, i );
+				many.get( buff, Route{ i } );
+			}
+			many.build();
+			bool allMatched = true;
+			for ( int i=0; i<300; ++i )
+			{
+				HttpRouteParams params;
+				snprintf( buff, sizeof(buff), "/api/v%d/resource%d/%d", i % 3, i, i * 7 );
+				char id[16];
+				snprintf( id, sizeof(id), "%d", i * 7 );
+				if ( matched( many, "GET", buff, params ) != i || params.get( "id" ) != id )
+					allMatched = false;
+			}
+			UNIT_CHECK( allMatched );
+			UNIT_CHECK( matched( many, "GET", "/api/v0/resource1/5" ) == -1 ); // resource1 is at v1
+		}
+	}
+
+} // namespace http_router_checks
+
+#endif // HTTP_ROUTER_CHECKS_H
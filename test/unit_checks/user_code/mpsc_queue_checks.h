@@ -0,0 +1,141 @@
+// mpsc_queue_checks.h : checks of MPSCBoundedQueue (queue of inter-thread messages; see src/clustering_impl/interthread_comm_impl.h)
+
+#ifndef MPSC_QUEUE_CHECKS_H
+#define MPSC_QUEUE_CHECKS_H
+
+#ifdef NODECPP_ENABLE_CLUSTERING
+
+#include "checks.h"
+#include <clustering_impl/interthread_comm_impl.h>
+#include <thread>
+#include <memory>
+#include <vector>
+
+namespace mpsc_queue_checks {
+
+	struct Item
+	{
+		size_t producer = 0;
+		size_t seq = 0;
+		Item() {}
+		Item( size_t producer_, size_t seq_ ) : producer( producer_ ), seq( seq_ ) {}
+	};
+
+	// each of producerCnt threads pushes itemCnt items, retrying rejected ones; the calling thread pops them checking per-producer order
+	template<class Queue>
+	bool stress( size_t producerCnt, size_t itemCnt )
+	{
+		Queue q;
+		std::vector<std::thread> producers;
+		for ( size_t p=0; p<producerCnt; ++p )
+			producers.emplace_back( [&q, p, itemCnt]() {
+				for ( size_t i=0; i<itemCnt; ++i )
+					while ( !q.push_back( Item( p, i ) ) )
+						std::this_thread::yield();
+			} );
+		std::vector<size_t> next( producerCnt, 0 );
+		bool inOrder = true;
+		for ( size_t received = 0; received < producerCnt * itemCnt; )
+		{
+			Item it;
+			if ( !q.try_pop_front( it ) )
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			inOrder = inOrder && it.producer < producerCnt && it.seq == next[it.producer];
+			if ( it.producer < producerCnt )
+				++next[it.producer];
+			++received;
+		}
+		for ( auto& t : producers )
+			t.join();
+		Item extra;
+		return inOrder && !q.try_pop_front( extra ) && q.approxSize() == 0;
+	}
+
+	inline void run()
+	{
+		{ // a single thread: FIFO within capacity
+			MPSCBoundedQueue<Item, 8> q;
+			Item it;
+			UNIT_CHECK( !q.try_pop_front( it ) );
+			for ( size_t i=0; i<8; ++i )
+				q.push_back( Item( 0, i ) );
+			UNIT_CHECK( q.approxSize() == 8 );
+			UNIT_CHECK( q.spilledCount() == 0 );
+			bool inOrder = true;
+			for ( size_t i=0; i<8; ++i )
+				inOrder = inOrder && q.try_pop_front( it ) && it.seq == i;
+			UNIT_CHECK( inOrder );
+			UNIT_CHECK( !q.try_pop_front( it ) && q.approxSize() == 0 );
+
+			for ( size_t round=0; round<100; ++round ) // positions wrap around the ring many times
+			{
+				q.push_back( Item( 0, round ) );
+				q.push_back( Item( 1, round ) );
+				Item a, b;
+				inOrder = inOrder && q.try_pop_front( a ) && q.try_pop_front( b ) && a.producer == 0 && b.producer == 1 && a.seq == round && b.seq == round;
+			}
+			UNIT_CHECK( inOrder );
+		}
+
+		{ // spill: nothing is lost, and the order is kept across the ring and the spill
+			MPSCBoundedQueue<Item, 4, QueueOverflowPolicy::spill> q;
+			for ( size_t i=0; i<6; ++i )
+				UNIT_CHECK( q.push_back( Item( 0, i ) ) );
+			UNIT_CHECK( q.spilledCount() == 2 );
+			UNIT_CHECK( q.approxSize() == 6 );
+			Item it;
+			UNIT_CHECK( q.try_pop_front( it ) && it.seq == 0 );
+			UNIT_CHECK( q.push_back( Item( 0, 6 ) ) ); // the ring has room again, but this one must go after the spilled ones
+			UNIT_CHECK( q.spilledCount() == 3 );
+			size_t popped[6];
+			size_t cnt = 0;
+			while ( cnt < 6 && q.try_pop_front( it ) )
+				popped[cnt++] = it.seq;
+			bool inOrder = cnt == 6;
+			for ( size_t i=0; i<cnt; ++i )
+				inOrder = inOrder && popped[i] == i + 1;
+			UNIT_CHECK( inOrder );
+			UNIT_CHECK( !q.try_pop_front( it ) );
+			UNIT_CHECK( q.push_back( Item( 0, 7 ) ) && q.spilledCount() == 3 ); // the spill is empty: back to the ring
+		}
+
+		{ // reject
+			MPSCBoundedQueue<Item, 4, QueueOverflowPolicy::reject> q;
+			for ( size_t i=0; i<4; ++i )
+				UNIT_CHECK( q.push_back( Item( 0, i ) ) );
+			UNIT_CHECK( !q.push_back( Item( 0, 4 ) ) );
+			UNIT_CHECK( q.rejectedCount() == 1 );
+			Item items[8];
+			UNIT_CHECK( q.pop_front( items, 2 ) == 2 && items[0].seq == 0 && items[1].seq == 1 );
+			UNIT_CHECK( q.push_back( Item( 0, 4 ) ) );
+			UNIT_CHECK( q.pop_front( items, 8 ) == 3 && items[0].seq == 2 && items[2].seq == 4 );
+		}
+
+		{ // spin: gives up after spinLimit attempts if nothing is popped meanwhile
+			MPSCBoundedQueue<Item, 2, QueueOverflowPolicy::spin, 4> q;
+			UNIT_CHECK( q.push_back( Item( 0, 0 ) ) && q.push_back( Item( 0, 1 ) ) );
+			UNIT_CHECK( !q.push_back( Item( 0, 2 ) ) && q.rejectedCount() == 1 );
+		}
+
+		{ // items left in the ring and in the spill are destroyed with the queue (as checked by a leak checker)
+			MPSCBoundedQueue<std::unique_ptr<size_t>, 4, QueueOverflowPolicy::spill> q;
+			for ( size_t i=0; i<7; ++i )
+				q.push_back( std::make_unique<size_t>( i ) );
+			std::unique_ptr<size_t> first;
+			UNIT_CHECK( q.try_pop_front( first ) && first != nullptr && *first == 0 );
+		}
+
+		// concurrent producers: per-producer order is kept with any policy
+		UNIT_CHECK( ( stress<MPSCBoundedQueue<Item, 64, QueueOverflowPolicy::spill>>( 4, 100000 ) ) );
+		UNIT_CHECK( ( stress<MPSCBoundedQueue<Item, 64, QueueOverflowPolicy::reject>>( 4, 100000 ) ) );
+		UNIT_CHECK( ( stress<MPSCBoundedQueue<Item, 8, QueueOverflowPolicy::spin, 16>>( 8, 20000 ) ) );
+	}
+
+} // namespace mpsc_queue_checks
+
+#endif // NODECPP_ENABLE_CLUSTERING
+
+#endif // MPSC_QUEUE_CHECKS_H
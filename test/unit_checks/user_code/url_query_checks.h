@@ -0,0 +1,94 @@
+// url_query_checks.h : checks of nodecpp::UrlQueryView and nodecpp::Url::parseUrlQueryString()
+
+#ifndef URL_QUERY_CHECKS_H
+#define URL_QUERY_CHECKS_H
+
+#include "checks.h"
+
+namespace url_query_checks {
+
+	using nodecpp::UrlQueryView;
+
+	inline nodecpp::string valueOf( const UrlQueryView& view, std::string_view key, bool caseInsensitive = false )
+	{
+		std::string_view raw;
+		if ( !view.get( key, raw, caseInsensitive ) )
+			return "<none>";
+		return UrlQueryView::decode( raw );
+	}
+
+	inline void run()
+	{
+		const char* url = "/api?name=J%C3%BCrgen+M&tag=a&tag=b&&Empty&x%41y=1%2&k=v=w#frag&hidden=1";
+		UrlQueryView view( url );
+		UNIT_CHECK( view.getQuery() == "name=J%C3%BCrgen+M&tag=a&tag=b&&Empty&x%41y=1%2&k=v=w" ); // fragment is not a part of the query
+
+		size_t itemCnt = 0;
+		view.forEach( [&itemCnt]( const UrlQueryView::Item& ) { ++itemCnt; } );
+		UNIT_CHECK( itemCnt == 6 ); // empty item is skipped
+
+		UNIT_CHECK( valueOf( view, "name" ) == "J\xC3\xBCrgen M" ); // '+' and percent-encoded UTF-8
+		UNIT_CHECK( valueOf( view, "tag" ) == "a" ); // first occurrence
+		UNIT_CHECK( view.count( "tag" ) == 2 );
+		UNIT_CHECK( valueOf( view, "Empty" ).empty() ); // no '='
+		UNIT_CHECK( view.has( "Empty" ) );
+		UNIT_CHECK( !view.has( "empty" ) );
+		UNIT_CHECK( view.has( "EMPTY", true ) );
+		UNIT_CHECK( valueOf( view, "xAy" ) == "1%2" ); // encoded key is matched as decoded; malformed escape is kept as is
+		UNIT_CHECK( valueOf( view, "xay", true ) == "1%2" );
+		UNIT_CHECK( !view.has( "xay" ) );
+		UNIT_CHECK( !view.has( "x%41y" ) );
+		UNIT_CHECK( valueOf( view, "k" ) == "v=w" ); // value is up to '&'
+		UNIT_CHECK( !view.has( "hidden" ) );
+		UNIT_CHECK( !view.has( "" ) );
+
+		UNIT_CHECK( UrlQueryView( "/path" ).empty() );
+		UNIT_CHECK( UrlQueryView( "/path?" ).empty() );
+		UNIT_CHECK( UrlQueryView( "/path?#a=1" ).empty() );
+		UNIT_CHECK( !UrlQueryView( "/path?a" ).empty() );
+
+		// decoding
+		UNIT_CHECK( UrlQueryView::decode( "" ).empty() );
+		UNIT_CHECK( UrlQueryView::decode( "plain" ) == "plain" );
+		UNIT_CHECK( UrlQueryView::decode( "a%20b+c" ) == "a b c" );
+		UNIT_CHECK( UrlQueryView::decode( "%2f%2F" ) == "//" );
+		UNIT_CHECK( UrlQueryView::decode( "%" ) == "%" );
+		UNIT_CHECK( UrlQueryView::decode( "%4" ) == "%4" );
+		UNIT_CHECK( UrlQueryView::decode( "%zz" ) == "%zz" );
+		UNIT_CHECK( UrlQueryView::decode( "100%25" ) == "100%" );
+		UNIT_CHECK( UrlQueryView::keyEquals( "a%2Bb", "a+b" ) );
+		UNIT_CHECK( !UrlQueryView::keyEquals( "a+b", "a+b" ) ); // '+' is a space
+		UNIT_CHECK( UrlQueryView::keyEquals( "a+b", "a b" ) );
+		UNIT_CHECK( !UrlQueryView::keyEquals( "ab%20", "ab" ) );
+
+		{ // needsDecoding() scans a word at a time: '%' or '+' at any position and at any length
+			bool allRight = true;
+			for ( size_t len = 0; len <= 20; ++len )
+				for ( size_t pos = 0; pos <= len; ++pos )
+					for ( char special : { '%', '+', 'x' } )
+					{
+						char s[20];
+						memset( s, 'a', sizeof(s) );
+						if ( pos < len )
+							s[pos] = special;
+						bool expected = pos < len && special != 'x';
+						if ( UrlQueryView::needsDecoding( std::string_view( s, len ) ) != expected )
+							allRight = false;
+					}
+			UNIT_CHECK( allRight );
+			UNIT_CHECK( UrlQueryView::needsDecoding( "\xAB\xC5\xA0\xFF\x80\x25\x2B" ) ); // high bytes next to '%' and '+'
+			UNIT_CHECK( !UrlQueryView::needsDecoding( "\xA5\xAB\xA5\xAB\xA5\xAB\xA5\xAB\xA5" ) ); // '%' and '+' with the high bit set are not them
+		}
+
+		{ // convenience layer: decoded, all values of a key collected
+			nodecpp::UrlQuery q = nodecpp::Url::parseUrlQueryString( nodecpp::string( url ) );
+			UNIT_CHECK( q["tag"].toStr() == "a,b" );
+			UNIT_CHECK( q["name"].toStr() == "J\xC3\xBCrgen M" );
+			UNIT_CHECK( q["xAy"].toStr() == "1%2" );
+			UNIT_CHECK( q["none"].toStr().empty() );
+		}
+	}
+
+} // namespace url_query_checks
+
+#endif // URL_QUERY_CHECKS_H
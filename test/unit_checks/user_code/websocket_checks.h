@@ -0,0 +1,122 @@
+// websocket_checks.h : checks of WebSocket handshake and framing helpers (SHA-1, base64, unmasking, UTF-8 validation)
+
+#ifndef WEBSOCKET_CHECKS_H
+#define WEBSOCKET_CHECKS_H
+
+#include "checks.h"
+
+namespace websocket_checks {
+
+	namespace ws = nodecpp::net::internal_usage_only;
+
+	inline nodecpp::string sha1Hex( const void* data, size_t sz )
+	{
+		uint8_t digest[20];
+		ws::sha1( (const uint8_t*)data, sz, digest );
+		nodecpp::string ret;
+		for ( size_t i=0; i<20; ++i )
+			ret += nodecpp::format( "{:02x}", digest[i] );
+		return ret;
+	}
+
+	inline nodecpp::string sha1Hex( const char* str ) { return sha1Hex( str, strlen( str ) ); }
+
+	inline nodecpp::string base64( const char* str ) { return ws::base64( (const uint8_t*)str, strlen( str ) ); }
+
+	inline bool isValidUtf8( const char* str ) { return ws::isValidUtf8( (const uint8_t*)str, strlen( str ) ); }
+
+	inline void run()
+	{
+		{ // SHA-1: FIPS 180 examples and messages around block boundaries (padding fits into the last block or takes one more)
+			UNIT_CHECK( sha1Hex( "" ) == "da39a3ee5e6b4b0d3255bfef95601890afd80709" );
+			UNIT_CHECK( sha1Hex( "abc" ) == "a9993e364706816aba3e25717850c26c9cd0d89d" );
+			UNIT_CHECK( sha1Hex( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) == "84983e441c3bd26ebaae4aa1f95129e5e54670f1" );
+			UNIT_CHECK( sha1Hex( "The quick brown fox jumps over the lazy dog" ) == "2fd4e1c67a2d28fced849ee1bb76e7391b93eb12" );
+			std::vector<char> a( 1000000, 'a' );
+			UNIT_CHECK( sha1Hex( a.data(), 55 ) == "c1c8bbdc22796e28c0e15163d20899b65621d65a" );
+			UNIT_CHECK( sha1Hex( a.data(), 56 ) == "c2db330f6083854c99d4b5bfb6e8f29f201be699" );
+			UNIT_CHECK( sha1Hex( a.data(), 63 ) == "03f09f5b158a7a8cdad920bddc29b81c18a551f5" );
+			UNIT_CHECK( sha1Hex( a.data(), 64 ) == "0098ba824b5c16427bd7a1122a5a442a25ec644d" );
+			UNIT_CHECK( sha1Hex( a.data(), 65 ) == "11655326c708d70319be2610e8a57d9a5b959d3b" );
+			UNIT_CHECK( sha1Hex( a.data(), a.size() ) == "34aa973cd4c4daa4f61eeb2bdbad27316534016f" );
+		}
+
+		{ // base64: RFC 4648, 10
+			UNIT_CHECK( base64( "" ) == "" );
+			UNIT_CHECK( base64( "f" ) == "Zg==" );
+			UNIT_CHECK( base64( "fo" ) == "Zm8=" );
+			UNIT_CHECK( base64( "foo" ) == "Zm9v" );
+			UNIT_CHECK( base64( "foob" ) == "Zm9vYg==" );
+			UNIT_CHECK( base64( "fooba" ) == "Zm9vYmE=" );
+			UNIT_CHECK( base64( "foobar" ) == "Zm9vYmFy" );
+			const uint8_t high[] = { 0xfb, 0xff, 0xbf };
+			UNIT_CHECK( ws::base64( high, sizeof(high) ) == "+/+/" ); // the last two characters of the alphabet
+		}
+
+		// Sec-WebSocket-Accept: RFC 6455, 1.3
+		UNIT_CHECK( nodecpp::net::WebSocket::acceptKey( "dGhlIHNhbXBsZSBub25jZQ==" ) == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=" );
+
+		{ // unmasking: the same as byte by byte XOR for any size and starting key position, also when done in parts
+			const uint8_t key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+			uint8_t plain[41];
+			for ( size_t i=0; i<sizeof(plain); ++i )
+				plain[i] = (uint8_t)( i * 13 + 1 );
+			bool allMatch = true;
+			bool keyPosMatch = true;
+			for ( size_t startPos=0; startPos<4; ++startPos )
+				for ( size_t sz=0; sz<=sizeof(plain); ++sz )
+				{
+					uint8_t buff[sizeof(plain)];
+					memcpy( buff, plain, sz );
+					size_t keyPos = startPos;
+					ws::wsUnmask( buff, sz, key, keyPos );
+					for ( size_t i=0; i<sz; ++i )
+						allMatch = allMatch && buff[i] == ( plain[i] ^ key[( startPos + i ) & 3] );
+					keyPosMatch = keyPosMatch && keyPos == ( ( startPos + sz ) & 3 );
+				}
+			UNIT_CHECK( allMatch );
+			UNIT_CHECK( keyPosMatch );
+
+			uint8_t whole[sizeof(plain)], parts[sizeof(plain)];
+			memcpy( whole, plain, sizeof(plain) );
+			memcpy( parts, plain, sizeof(plain) );
+			size_t keyPos = 0;
+			ws::wsUnmask( whole, sizeof(whole), key, keyPos );
+			keyPos = 0;
+			ws::wsUnmask( parts, 5, key, keyPos );
+			ws::wsUnmask( parts + 5, 11, key, keyPos );
+			ws::wsUnmask( parts + 16, sizeof(parts) - 16, key, keyPos );
+			UNIT_CHECK( memcmp( whole, parts, sizeof(whole) ) == 0 ); // as payload is unmasked when split between two parts of the read ring
+		}
+
+		{ // UTF-8 validation
+			UNIT_CHECK( isValidUtf8( "" ) );
+			UNIT_CHECK( isValidUtf8( "Hello-\xC2\xB5@\xC3\x9F\xC3\xB6\xC3\xA4\xC3\xBC\xC3\xA0\xC3\xA1-UTF-8!!" ) );
+			UNIT_CHECK( isValidUtf8( "\xE2\x82\xAC\xF0\x9F\x98\x80" ) ); // 3 and 4 bytes
+			UNIT_CHECK( isValidUtf8( "\xF4\x8F\xBF\xBF" ) ); // U+10FFFF
+			UNIT_CHECK( isValidUtf8( "\xEE\x80\x80" ) ); // U+E000, right after surrogates
+			UNIT_CHECK( !isValidUtf8( "\xF4\x90\x80\x80" ) ); // above U+10FFFF
+			UNIT_CHECK( !isValidUtf8( "\xED\xA0\x80" ) ); // surrogate
+			UNIT_CHECK( !isValidUtf8( "\xC0\xAF" ) ); // overlong
+			UNIT_CHECK( !isValidUtf8( "\xE0\x80\xAF" ) ); // overlong
+			UNIT_CHECK( !isValidUtf8( "\xF0\x80\x80\xAF" ) ); // overlong
+			UNIT_CHECK( !isValidUtf8( "\x80" ) ); // continuation byte with no lead byte
+			UNIT_CHECK( !isValidUtf8( "\xF8\x88\x80\x80\x80" ) ); // 5-byte form
+			UNIT_CHECK( !isValidUtf8( "\xCE\xBA\xE1\xBD" ) ); // cut at the end
+			UNIT_CHECK( !isValidUtf8( "\xC3\x28" ) ); // no continuation byte
+
+			// fed in parts, as with fragmented messages
+			ws::Utf8Validator v;
+			const uint8_t euro[] = { 0xE2, 0x82, 0xAC };
+			UNIT_CHECK( v.feed( euro, 1 ) && !v.isComplete() );
+			UNIT_CHECK( v.feed( euro + 1, 1 ) && !v.isComplete() );
+			UNIT_CHECK( v.feed( euro + 2, 1 ) && v.isComplete() );
+			v.reset();
+			const uint8_t bad[] = { 0xCE, 0xBA, 0xF4, 0x90, 0x80, 0x80 };
+			UNIT_CHECK( !v.feed( bad, sizeof(bad) ) ); // detected in the fragment it is in, with no waiting for the message end
+		}
+	}
+
+} // namespace websocket_checks
+
+#endif // WEBSOCKET_CHECKS_H